@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -52,6 +53,26 @@
 
 namespace bustub {
 
+namespace {
+
+/** @return the value of a boolean index option, a bare option turns it on */
+auto BindBooleanIndexOption(duckdb_libpgquery::PGDefElem *def_elem) -> bool {
+  std::string flag = "true";
+  if (def_elem->arg != nullptr && def_elem->arg->type == duckdb_libpgquery::T_PGString) {
+    flag = StringUtil::Lower(reinterpret_cast<duckdb_libpgquery::PGValue *>(def_elem->arg)->val.str);
+  } else if (def_elem->arg != nullptr && def_elem->arg->type == duckdb_libpgquery::T_PGInteger) {
+    flag = std::to_string(reinterpret_cast<duckdb_libpgquery::PGValue *>(def_elem->arg)->val.ival);
+  } else if (def_elem->arg != nullptr) {
+    throw NotImplementedException(fmt::format("index option {} must be a boolean", def_elem->defname));
+  }
+  if (flag != "true" && flag != "on" && flag != "1" && flag != "false" && flag != "off" && flag != "0") {
+    throw bustub::Exception(fmt::format("invalid value {} of index option {}", flag, def_elem->defname));
+  }
+  return flag == "true" || flag == "on" || flag == "1";
+}
+
+}  // namespace
+
 auto Binder::BindColumnDefinition(duckdb_libpgquery::PGColumnDef *cdef) -> Column {
   std::string colname;
   if (cdef->colname != nullptr) {
@@ -85,6 +106,19 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
   auto table = std::string(pg_stmt->relation->relname);
   auto columns = std::vector<Column>{};
   size_t column_count = 0;
+  std::vector<std::string> primary_key;
+
+  // a primary key is the only constraint, declared on its column or for the table
+  auto bind_primary_key = [&primary_key](duckdb_libpgquery::PGConstraint *constraint,
+                                         std::vector<std::string> key_columns) {
+    if (constraint->contype != duckdb_libpgquery::PG_CONSTR_PRIMARY) {
+      throw NotImplementedException("constraints other than primary key not supported");
+    }
+    if (!primary_key.empty()) {
+      throw bustub::Exception("multiple primary keys are not allowed");
+    }
+    primary_key = std::move(key_columns);
+  };
 
   for (auto c = pg_stmt->tableElts->head; c != nullptr; c = lnext(c)) {
     auto node = reinterpret_cast<duckdb_libpgquery::PGNode *>(c->data.ptr_value);
@@ -93,14 +127,24 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
         auto cdef = reinterpret_cast<duckdb_libpgquery::PGColumnDef *>(c->data.ptr_value);
         auto centry = BindColumnDefinition(cdef);
         if (cdef->constraints != nullptr) {
-          throw NotImplementedException("constraints not supported");
+          for (auto cell = cdef->constraints->head; cell != nullptr; cell = lnext(cell)) {
+            bind_primary_key(reinterpret_cast<duckdb_libpgquery::PGConstraint *>(cell->data.ptr_value),
+                             {centry.GetName()});
+          }
         }
         columns.push_back(std::move(centry));
         column_count++;
         break;
       }
       case duckdb_libpgquery::T_PGConstraint: {
-        throw NotImplementedException("constraints not supported");
+        auto constraint = reinterpret_cast<duckdb_libpgquery::PGConstraint *>(c->data.ptr_value);
+        std::vector<std::string> key_columns;
+        if (constraint->keys != nullptr) {
+          for (auto cell = constraint->keys->head; cell != nullptr; cell = lnext(cell)) {
+            key_columns.emplace_back(reinterpret_cast<duckdb_libpgquery::PGValue *>(cell->data.ptr_value)->val.str);
+          }
+        }
+        bind_primary_key(constraint, std::move(key_columns));
         break;
       }
       default:
@@ -112,7 +156,22 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
     throw bustub::Exception("should have at least 1 column");
   }
 
-  return std::make_unique<CreateStatement>(std::move(table), std::move(columns));
+  // the table is stored in the b+ tree of its primary key, and a row is found by the key, which is its rid
+  if (!primary_key.empty()) {
+    if (primary_key.size() != 1) {
+      throw NotImplementedException("a primary key of several columns is not supported");
+    }
+    auto column = std::find_if(columns.begin(), columns.end(),
+                               [&primary_key](const Column &col) { return col.GetName() == primary_key[0]; });
+    if (column == columns.end()) {
+      throw bustub::Exception(fmt::format("primary key column {} does not exist", primary_key[0]));
+    }
+    if (column->GetType() != TypeId::INTEGER) {
+      throw NotImplementedException("a primary key must be an integer column");
+    }
+  }
+
+  return std::make_unique<CreateStatement>(std::move(table), std::move(columns), std::move(primary_key));
 }
 
 auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement> {
@@ -129,7 +188,104 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // `WITH (include = 'c1, c2')` stores more columns in the index, after the key columns,
+  // `WITH (subtree_counts = true)` makes the index count its entries per subtree,
+  // `WITH (adaptive_hash = false)` keeps the index from hashing its hot keys to their leaves,
+  // `WITH (change_buffer = false)` makes the index apply every entry right away, even if its leaf is on disk, and
+  // `WITH (bloom_filter = true)` makes the index keep a Bloom filter of its keys, so probes of missing keys stop early
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols;
+  bool subtree_counts = false;
+  bool adaptive_hash = true;
+  bool change_buffer = true;
+  bool bloom_filter = false;
+  if (stmt->options != nullptr) {
+    for (auto cell = stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto def_elem = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      auto option = StringUtil::Lower(def_elem->defname);
+      if (option == "subtree_counts") {
+        subtree_counts = BindBooleanIndexOption(def_elem);
+        continue;
+      }
+      if (option == "adaptive_hash") {
+        adaptive_hash = BindBooleanIndexOption(def_elem);
+        continue;
+      }
+      if (option == "change_buffer") {
+        change_buffer = BindBooleanIndexOption(def_elem);
+        continue;
+      }
+      if (option == "bloom_filter") {
+        bloom_filter = BindBooleanIndexOption(def_elem);
+        continue;
+      }
+      if (option != "include") {
+        throw NotImplementedException(fmt::format("index option {} is not supported", def_elem->defname));
+      }
+      std::string names;
+      if (def_elem->arg->type == duckdb_libpgquery::T_PGString) {
+        names = reinterpret_cast<duckdb_libpgquery::PGValue *>(def_elem->arg)->val.str;
+      } else if (def_elem->arg->type == duckdb_libpgquery::T_PGTypeName) {
+        // a bare column name parses as a type name
+        auto type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(def_elem->arg);
+        names = reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str;
+      } else {
+        throw NotImplementedException("index include columns must be a list of column names");
+      }
+      for (const auto &name : StringUtil::Split(names, ',')) {
+        auto column_ref = ResolveColumn(*table, std::vector{StringUtil::Lower(StringUtil::Strip(name, ' '))});
+        auto &bound_column = dynamic_cast<const BoundColumnRef &>(*column_ref);
+        auto is_same = [&](const auto &col) { return col->col_name_ == bound_column.col_name_; };
+        if (std::any_of(cols.begin(), cols.end(), is_same) ||
+            std::any_of(include_cols.begin(), include_cols.end(), is_same)) {
+          throw bustub::Exception(fmt::format("column {} is already in the index", bound_column.ToString()));
+        }
+        include_cols.emplace_back(std::make_unique<BoundColumnRef>(bound_column));
+      }
+    }
+  }
+
+  // `USING lsm` builds a log-structured merge tree, `USING art` an adaptive radix tree, `USING learned` a piecewise
+  // geometric model, `USING trie` a trie of the strings of a single varchar column and `USING hash` an extendible hash
+  // table, which have no subtree counts to enable, the b+ tree is the default
+  auto index_type = IndexType::BPlusTree;
+  auto access_method = StringUtil::Lower(stmt->accessMethod);
+  if (access_method == "lsm" || access_method == "art" || access_method == "learned" || access_method == "trie" ||
+      access_method == "hash") {
+    index_type = access_method == "lsm"       ? IndexType::LSMTree
+                 : access_method == "art"     ? IndexType::AdaptiveRadixTree
+                 : access_method == "learned" ? IndexType::PiecewiseGeometricModel
+                 : access_method == "hash"    ? IndexType::ExtendibleHash
+                                              : IndexType::Trie;
+    if (subtree_counts) {
+      throw NotImplementedException("subtree counts need a b+ tree index");
+    }
+    if (bloom_filter && index_type != IndexType::ExtendibleHash) {
+      throw NotImplementedException("bloom filters need a b+ tree or hash index");
+    }
+    if (index_type == IndexType::Trie &&
+        (cols.size() != 1 || !include_cols.empty() ||
+         table->schema_.GetColumn(table->schema_.GetColIdx(cols[0]->col_name_.back())).GetType() != TypeId::VARCHAR)) {
+      throw NotImplementedException("a trie index needs a single varchar key column");
+    }
+    // the entries of a hash index are found by their whole key, include columns would make them part of it
+    if (index_type == IndexType::ExtendibleHash && !include_cols.empty()) {
+      throw NotImplementedException("a hash index cannot include columns");
+    }
+  } else if (access_method != DEFAULT_INDEX_TYPE && access_method != "btree") {
+    throw NotImplementedException(fmt::format("index type {} is not supported", stmt->accessMethod));
+  }
+
+  // `WHERE <predicate>` makes a partial index, which holds only the rows the predicate is true for
+  std::unique_ptr<BoundExpression> where = nullptr;
+  if (stmt->whereClause != nullptr) {
+    auto ctx_guard = NewContext();
+    scope_ = table.get();
+    where = BindExpression(stmt->whereClause);
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), std::move(include_cols),
+                                          subtree_counts, adaptive_hash, change_buffer, index_type, bloom_filter,
+                                          std::move(where));
 }
 
 }  // namespace bustub
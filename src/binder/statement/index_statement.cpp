@@ -7,14 +7,54 @@
 namespace bustub {
 
 IndexStatement::IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                               std::vector<std::unique_ptr<BoundColumnRef>> cols)
+                               std::vector<std::unique_ptr<BoundColumnRef>> cols,
+                               std::vector<std::unique_ptr<BoundColumnRef>> include_cols, bool subtree_counts,
+                               bool adaptive_hash, bool change_buffer, IndexType index_type, bool bloom_filter,
+                               std::unique_ptr<BoundExpression> where)
     : BoundStatement(StatementType::INDEX_STATEMENT),
       index_name_(std::move(index_name)),
       table_(std::move(table)),
-      cols_(std::move(cols)) {}
+      cols_(std::move(cols)),
+      include_cols_(std::move(include_cols)),
+      subtree_counts_(subtree_counts),
+      adaptive_hash_(adaptive_hash),
+      change_buffer_(change_buffer),
+      index_type_(index_type),
+      bloom_filter_(bloom_filter),
+      where_(std::move(where)) {}
 
 auto IndexStatement::ToString() const -> std::string {
-  return fmt::format("BoundIndex {{ index_name={}, table={}, cols={} }}", index_name_, *table_, cols_);
+  std::string options;
+  if (!include_cols_.empty()) {
+    options += fmt::format(", include={}", include_cols_);
+  }
+  if (subtree_counts_) {
+    options += ", subtree_counts=true";
+  }
+  if (!adaptive_hash_) {
+    options += ", adaptive_hash=false";
+  }
+  if (!change_buffer_) {
+    options += ", change_buffer=false";
+  }
+  if (bloom_filter_) {
+    options += ", bloom_filter=true";
+  }
+  if (index_type_ == IndexType::LSMTree) {
+    options += ", using=lsm";
+  } else if (index_type_ == IndexType::AdaptiveRadixTree) {
+    options += ", using=art";
+  } else if (index_type_ == IndexType::PiecewiseGeometricModel) {
+    options += ", using=learned";
+  } else if (index_type_ == IndexType::Trie) {
+    options += ", using=trie";
+  } else if (index_type_ == IndexType::ExtendibleHash) {
+    options += ", using=hash";
+  }
+  if (where_ != nullptr) {
+    options += fmt::format(", where={}", where_);
+  }
+  return fmt::format("BoundIndex {{ index_name={}, table={}, cols={}{} }}", index_name_, *table_, cols_, options);
 }
 
 }  // namespace bustub
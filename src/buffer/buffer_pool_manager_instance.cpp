@@ -128,6 +128,12 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
   return true;
 }  // end UnpinPgImp
 
+auto BufferPoolManagerInstance::IsPageResident(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  return page_table_->Find(page_id, frame_id);
+}  // end IsPageResident
+
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
   frame_id_t frame_id;
 
@@ -37,6 +37,29 @@
 
 namespace bustub {
 
+namespace {
+
+/** Create an index whose keys are normalized into KeySize bytes. */
+template <size_t KeySize>
+auto CreateNormalizedIndex(Catalog *catalog, Transaction *txn, const IndexStatement &index_stmt,
+                           const Schema &key_schema, const std::vector<uint32_t> &col_ids,
+                           AbstractExpressionRef predicate) -> IndexInfo * {
+  return catalog->CreateIndex<GenericKey<KeySize>, RID, MemcmpComparator<KeySize>>(
+      txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
+      KeySize, HashFunction<GenericKey<KeySize>>{}, index_stmt.subtree_counts_, index_stmt.adaptive_hash_,
+      index_stmt.change_buffer_, index_stmt.index_type_, index_stmt.bloom_filter_, std::move(predicate));
+}
+
+/** Create a clustered table, whose rows are normalized into primary index keys of KeySize bytes. */
+template <size_t KeySize>
+auto CreateNormalizedClusteredTable(Catalog *catalog, Transaction *txn, const CreateStatement &create_stmt,
+                                    const Schema &schema, uint32_t primary_key) -> TableInfo * {
+  return catalog->CreateClusteredTable<GenericKey<KeySize>, RID, MemcmpComparator<KeySize>>(
+      txn, create_stmt.table_, schema, primary_key, KeySize);
+}
+
+}  // namespace
+
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
@@ -211,8 +234,29 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       case StatementType::CREATE_STATEMENT: {
         const auto &create_stmt = dynamic_cast<const CreateStatement &>(*statement);
 
+        Schema schema(create_stmt.columns_);
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_));
+        TableInfo *info;
+        if (create_stmt.primary_key_.empty()) {
+          info = catalog_->CreateTable(txn, create_stmt.table_, schema);
+        } else {
+          // a row of a clustered table is a key of its primary index, the smallest that holds the normalized columns
+          auto primary_key = schema.GetColIdx(create_stmt.primary_key_[0]);
+          auto key_size = NormalizedKeySize(schema);
+          if (key_size <= 4) {
+            info = CreateNormalizedClusteredTable<4>(catalog_, txn, create_stmt, schema, primary_key);
+          } else if (key_size <= 8) {
+            info = CreateNormalizedClusteredTable<8>(catalog_, txn, create_stmt, schema, primary_key);
+          } else if (key_size <= 16) {
+            info = CreateNormalizedClusteredTable<16>(catalog_, txn, create_stmt, schema, primary_key);
+          } else if (key_size <= 32) {
+            info = CreateNormalizedClusteredTable<32>(catalog_, txn, create_stmt, schema, primary_key);
+          } else if (key_size <= 64) {
+            info = CreateNormalizedClusteredTable<64>(catalog_, txn, create_stmt, schema, primary_key);
+          } else {
+            throw NotImplementedException(fmt::format("row of {} bytes is too large for a clustered table", key_size));
+          }
+        }
         l.unlock();
 
         if (info == nullptr) {
@@ -226,21 +270,41 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
 
         std::vector<uint32_t> col_ids;
         for (const auto &col : index_stmt.cols_) {
-          auto idx = index_stmt.table_->schema_.GetColIdx(col->col_name_.back());
-          col_ids.push_back(idx);
-          if (index_stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-            throw NotImplementedException("only support creating index on integer column");
-          }
+          col_ids.push_back(index_stmt.table_->schema_.GetColIdx(col->col_name_.back()));
         }
-        if (col_ids.size() != 1) {
-          throw NotImplementedException("only support creating index with exactly one column");
+        // include columns are a suffix of the key, so index-only scans can read them from the keys
+        for (const auto &col : index_stmt.include_cols_) {
+          col_ids.push_back(index_stmt.table_->schema_.GetColIdx(col->col_name_.back()));
         }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
 
+        // the smallest key that holds the normalized encoding of the key columns, a trie keeps the strings
+        // themselves whatever their length
+        auto key_size = index_stmt.index_type_ == IndexType::Trie ? 0 : NormalizedKeySize(key_schema);
+
+        // the predicate of a partial index is evaluated on the tuples of the table, like a filter of a scan of it
+        AbstractExpressionRef predicate;
+        if (index_stmt.where_ != nullptr) {
+          Planner planner(*catalog_);
+          auto scan = planner.PlanTableRef(*index_stmt.table_);
+          auto [_, condition] = planner.PlanExpression(*index_stmt.where_, {scan});
+          predicate = std::move(condition);
+        }
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-            txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+        IndexInfo *info;
+        if (key_size <= 4) {
+          info = CreateNormalizedIndex<4>(catalog_, txn, index_stmt, key_schema, col_ids, predicate);
+        } else if (key_size <= 8) {
+          info = CreateNormalizedIndex<8>(catalog_, txn, index_stmt, key_schema, col_ids, predicate);
+        } else if (key_size <= 16) {
+          info = CreateNormalizedIndex<16>(catalog_, txn, index_stmt, key_schema, col_ids, predicate);
+        } else if (key_size <= 32) {
+          info = CreateNormalizedIndex<32>(catalog_, txn, index_stmt, key_schema, col_ids, predicate);
+        } else if (key_size <= 64) {
+          info = CreateNormalizedIndex<64>(catalog_, txn, index_stmt, key_schema, col_ids, predicate);
+        } else {
+          throw NotImplementedException(fmt::format("index key of {} bytes is too large", key_size));
+        }
         l.unlock();
 
         if (info == nullptr) {
@@ -98,11 +98,15 @@ void TransactionManager::Abort(Transaction *txn) {
     } else if (item.wtype_ == WType::INSERT) {
       index_info->index_->DeleteEntry(new_key, item.rid_, txn);
     } else if (item.wtype_ == WType::UPDATE) {
-      // Delete the new key and insert the old key
-      index_info->index_->DeleteEntry(new_key, item.rid_, txn);
-      auto old_key = item.old_tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
-                                                  index_info->index_->GetKeyAttrs());
-      index_info->index_->InsertEntry(old_key, item.rid_, txn);
+      // Delete the new key and insert the old key, of the versions of the tuple that a partial index holds
+      if (index_info->Covers(item.tuple_, table_info->schema_)) {
+        index_info->index_->DeleteEntry(new_key, item.rid_, txn);
+      }
+      if (index_info->Covers(item.old_tuple_, table_info->schema_)) {
+        auto old_key = item.old_tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
+                                                    index_info->index_->GetKeyAttrs());
+        index_info->index_->InsertEntry(old_key, item.rid_, txn);
+      }
     }
     index_write_set->pop_back();
   }
@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,7 +29,18 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                          const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // the table starts with a directory of global depth 0 and its one bucket
+  auto *dir_page =
+      reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->NewPage(&directory_page_id_)->GetData());
+  dir_page->SetPageId(directory_page_id_);
+  page_id_t bucket_page_id;
+  auto *bucket =
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&bucket_page_id)->GetData());
+  bucket->Init();
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 }
 
 /*****************************************************************************
@@ -46,22 +60,128 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainContains(HASH_TABLE_BUCKET_TYPE *head, const KeyType &key, const ValueType &value)
+    -> bool {
+  std::vector<ValueType> values;
+  head->GetValue(key, comparator_, &values);
+  for (auto page_id = head->GetOverflowPageId(); page_id != INVALID_PAGE_ID;) {
+    auto *bucket = FetchBucketPage(page_id);
+    bucket->GetValue(key, comparator_, &values);
+    auto next_page_id = bucket->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return std::find(values.begin(), values.end(), value) != values.end();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainInsert(HASH_TABLE_BUCKET_TYPE *head, const KeyType &key, const ValueType &value,
+                                  bool may_overflow) -> bool {
+  // the pair is not in the chain, so an insert only fails on a full page
+  if (head->Insert(key, value, comparator_)) {
+    return true;
+  }
+  auto *tail = head;
+  page_id_t tail_page_id = INVALID_PAGE_ID;
+  while (tail->GetOverflowPageId() != INVALID_PAGE_ID) {
+    auto page_id = tail->GetOverflowPageId();
+    if (tail_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(tail_page_id, false);
+    }
+    tail = FetchBucketPage(page_id);
+    tail_page_id = page_id;
+    if (tail->Insert(key, value, comparator_)) {
+      buffer_pool_manager_->UnpinPage(tail_page_id, true);
+      return true;
+    }
+  }
+  if (may_overflow) {
+    page_id_t overflow_page_id;
+    auto *overflow =
+        reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&overflow_page_id)->GetData());
+    overflow->Init();
+    overflow->Insert(key, value, comparator_);
+    tail->SetOverflowPageId(overflow_page_id);
+    buffer_pool_manager_->UnpinPage(overflow_page_id, true);
+  }
+  if (tail_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(tail_page_id, may_overflow);
+  }
+  return may_overflow;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::SplitMakesRoom(HASH_TABLE_BUCKET_TYPE *head, const KeyType &key, uint32_t local_depth) -> bool {
+  // the directory tells keys apart by at most as many low bits of their hash as it has slots
+  if ((1U << local_depth) >= DIRECTORY_ARRAY_SIZE) {
+    return false;
+  }
+  // the split sends the entries whose bit at the local depth is set to the new bucket
+  uint32_t high_bit = 1U << local_depth;
+  auto key_bit = Hash(key) & high_bit;
+  auto moves = [&](HASH_TABLE_BUCKET_TYPE *bucket) {
+    for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE && bucket->IsOccupied(bucket_idx); bucket_idx++) {
+      if (bucket->IsReadable(bucket_idx) && (Hash(bucket->KeyAt(bucket_idx)) & high_bit) != key_bit) {
+        return true;
+      }
+    }
+    return false;
+  };
+  if (moves(head)) {
+    return true;
+  }
+  for (auto page_id = head->GetOverflowPageId(); page_id != INVALID_PAGE_ID;) {
+    auto *bucket = FetchBucketPage(page_id);
+    bool makes_room = moves(bucket);
+    auto next_page_id = bucket->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (makes_room) {
+      return true;
+    }
+    page_id = next_page_id;
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DrainChain(HASH_TABLE_BUCKET_TYPE *head, std::vector<MappingType> *entries) {
+  auto drain = [&](HASH_TABLE_BUCKET_TYPE *bucket) {
+    for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE && bucket->IsOccupied(bucket_idx); bucket_idx++) {
+      if (bucket->IsReadable(bucket_idx)) {
+        entries->emplace_back(bucket->KeyAt(bucket_idx), bucket->ValueAt(bucket_idx));
+      }
+    }
+  };
+  drain(head);
+  auto page_id = head->GetOverflowPageId();
+  head->Init();
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = FetchBucketPage(page_id);
+    drain(bucket);
+    auto next_page_id = bucket->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
 }
 
 /*****************************************************************************
@@ -69,7 +189,25 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  table_latch_.RLock();
+  auto *dir_page = FetchDirectoryPage();
+  auto bucket_page_id = KeyToPageId(key, dir_page);
+  auto *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->RLatch();
+  auto *head = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool found = head->GetValue(key, comparator_, result);
+  for (auto page_id = head->GetOverflowPageId(); page_id != INVALID_PAGE_ID;) {
+    auto *bucket = FetchBucketPage(page_id);
+    found = bucket->GetValue(key, comparator_, result) || found;
+    auto next_page_id = bucket->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +215,88 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  auto *dir_page = FetchDirectoryPage();
+  auto bucket_page_id = KeyToPageId(key, dir_page);
+  auto *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto *head = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  std::optional<bool> inserted;
+  if (ChainContains(head, key, value)) {
+    inserted = false;
+  } else if (ChainInsert(head, key, value, false)) {
+    inserted = true;
+  } else if (!SplitMakesRoom(head, key, dir_page->GetLocalDepth(KeyToDirectoryIndex(key, dir_page)))) {
+    // a split would not make room for the key, it goes to an overflow page of the bucket
+    inserted = ChainInsert(head, key, value, true);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted.value_or(false));
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+
+  // the bucket is full and a split would make room, which changes the directory
+  if (!inserted.has_value()) {
+    return SplitInsert(transaction, key, value);
+  }
+  return *inserted;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.WLock();
+  auto *dir_page = FetchDirectoryPage();
+  bool dir_dirty = false;
+  bool inserted;
+  while (true) {
+    // the bucket may have changed since the caller looked at it, and a split may not make room for the key, as all
+    // the entries may stay in its bucket
+    auto bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    auto bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    auto *head = FetchBucketPage(bucket_page_id);
+    if (ChainContains(head, key, value)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      inserted = false;
+      break;
+    }
+    auto local_depth = dir_page->GetLocalDepth(bucket_idx);
+    bool may_split =
+        SplitMakesRoom(head, key, local_depth) && (local_depth < dir_page->GetGlobalDepth() || dir_page->CanGrow());
+    if (ChainInsert(head, key, value, !may_split)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      inserted = true;
+      break;
+    }
+
+    // split the bucket: the slots whose bit at the old local depth is set go to a new bucket, its split image
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      dir_page->IncrGlobalDepth();
+    }
+    dir_dirty = true;
+    page_id_t image_page_id;
+    auto *image =
+        reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&image_page_id)->GetData());
+    image->Init();
+    uint32_t high_bit = 1U << local_depth;
+    for (uint32_t idx = 0; idx < dir_page->Size(); idx++) {
+      if (dir_page->GetBucketPageId(idx) == bucket_page_id) {
+        dir_page->SetLocalDepth(idx, static_cast<uint8_t>(local_depth + 1));
+        if ((idx & high_bit) != 0) {
+          dir_page->SetBucketPageId(idx, image_page_id);
+        }
+      }
+    }
+    std::vector<MappingType> entries;
+    DrainChain(head, &entries);
+    for (const auto &[entry_key, entry_value] : entries) {
+      ChainInsert((Hash(entry_key) & high_bit) != 0 ? image : head, entry_key, entry_value, true);
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -90,14 +304,101 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  auto *dir_page = FetchDirectoryPage();
+  auto bucket_page_id = KeyToPageId(key, dir_page);
+  auto *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto *head = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = head->Remove(key, value, comparator_);
+  // an overflow page that is left empty is unlinked from the chain, an empty head takes over the first one
+  auto *prev = head;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (auto page_id = head->GetOverflowPageId(); page_id != INVALID_PAGE_ID && !removed;) {
+    auto *bucket = FetchBucketPage(page_id);
+    removed = bucket->Remove(key, value, comparator_);
+    auto next_page_id = bucket->GetOverflowPageId();
+    if (removed && bucket->IsEmpty()) {
+      prev->SetOverflowPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    } else if (prev_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, removed);
+      prev = bucket;
+      prev_page_id = page_id;
+    } else {
+      prev = bucket;
+      prev_page_id = page_id;
+    }
+    page_id = next_page_id;
+  }
+  if (prev_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, removed);
+  }
+  if (removed && head->IsEmpty() && head->GetOverflowPageId() != INVALID_PAGE_ID) {
+    auto overflow_page_id = head->GetOverflowPageId();
+    auto *overflow_page = buffer_pool_manager_->FetchPage(overflow_page_id);
+    memcpy(page->GetData(), overflow_page->GetData(), BUSTUB_PAGE_SIZE);
+    buffer_pool_manager_->UnpinPage(overflow_page_id, false);
+    buffer_pool_manager_->DeletePage(overflow_page_id);
+  }
+  bool empty = head->IsEmpty() && head->GetOverflowPageId() == INVALID_PAGE_ID;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (removed && empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  auto *dir_page = FetchDirectoryPage();
+  bool dir_dirty = false;
+  // the bucket that takes over the key may be empty as well, merging goes on until it is not
+  while (true) {
+    auto bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    auto bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    auto local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    auto image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (dir_page->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    auto *bucket = FetchBucketPage(bucket_page_id);
+    bool empty = bucket->IsEmpty() && bucket->GetOverflowPageId() == INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (!empty) {
+      break;
+    }
+
+    // every slot of the bucket and of its image points to the image, one level shallower
+    auto image_page_id = dir_page->GetBucketPageId(image_idx);
+    for (uint32_t idx = 0; idx < dir_page->Size(); idx++) {
+      auto page_id = dir_page->GetBucketPageId(idx);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        dir_page->SetBucketPageId(idx, image_page_id);
+        dir_page->SetLocalDepth(idx, static_cast<uint8_t>(local_depth - 1));
+      }
+    }
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    while (dir_page->CanShrink()) {
+      dir_page->DecrGlobalDepth();
+    }
+    dir_dirty = true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
@@ -135,4 +436,10 @@ template class DiskExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16
 template class DiskExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class DiskExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class DiskExtendibleHashTable<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class DiskExtendibleHashTable<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class DiskExtendibleHashTable<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class DiskExtendibleHashTable<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class DiskExtendibleHashTable<GenericKey<64>, RID, MemcmpComparator<64>>;
+
 }  // namespace bustub
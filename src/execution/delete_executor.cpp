@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "execution/executors/delete_executor.h"
 
@@ -42,6 +44,10 @@ void DeleteExecutor::UpdateIndex(Tuple *tuple, RID *rid) {
     return;
   }
   for (auto index_info : table_indexs_) {
+    // a partial index holds only the tuples its predicate is true for, and a clustered table writes its primary index
+    if (index_info->clustered_ || !index_info->Covers(*tuple, table_info_->schema_)) {
+      continue;
+    }
     auto index = index_info->index_.get();
     auto key = tuple->KeyFromTuple(table_info_->schema_, *index->GetKeySchema(), index->GetKeyAttrs());
     index->DeleteEntry(key, *rid, GetExecutorContext()->GetTransaction());
@@ -61,20 +67,26 @@ auto DeleteExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   Tuple child_tuple{};
   int deleted_rows_num = 0;
 
-  // Insert tuples
+  // the child may scan an index that the deletes change, like the primary index of a clustered table, whose cursor
+  // would skip entries that move in its leaf; so every row is read before any is deleted
+  std::vector<std::pair<Tuple, RID>> rows;
   while (child_executor_->Next(&child_tuple, rid)) {
+    rows.emplace_back(child_tuple, *rid);
+  }
+
+  for (auto &[row, row_rid] : rows) {
     deleted_rows_num++;
 
     try {
-      if (!lock_manager_->LockRow(txn_, LockManager::LockMode::EXCLUSIVE, table_info_->oid_, *rid)) {
+      if (!lock_manager_->LockRow(txn_, LockManager::LockMode::EXCLUSIVE, table_info_->oid_, row_rid)) {
         throw ExecutionException("Fail to lock row");
       }
     } catch (TransactionAbortException &e) {
       throw ExecutionException("Fail to lock row");
     }
 
-    table_heap_->MarkDelete(*rid, GetExecutorContext()->GetTransaction());
-    UpdateIndex(&child_tuple, rid);
+    table_heap_->MarkDelete(row_rid, GetExecutorContext()->GetTransaction());
+    UpdateIndex(&row, &row_rid);
   }
 
   std::vector<Value> values{};
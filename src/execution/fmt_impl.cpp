@@ -8,6 +8,7 @@
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/aggregation_plan.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/sort_plan.h"
 #include "execution/plans/topn_plan.h"
@@ -35,6 +36,11 @@ auto AggregationPlanNode::PlanNodeToString() const -> std::string {
   return fmt::format("Agg {{ types={}, aggregates={}, group_by={} }}", agg_types_, aggregates_, group_bys_);
 }
 
+auto NestedIndexJoinPlanNode::PlanNodeToString() const -> std::string {
+  return fmt::format("NestedIndexJoin {{ type={}, key_predicates={}, index={}, index_table={} }}", join_type_,
+                     key_predicates_, index_name_, index_table_name_);
+}
+
 auto ProjectionPlanNode::PlanNodeToString() const -> std::string {
   return fmt::format("Projection {{ exprs={} }}", expressions_);
 }
@@ -47,7 +53,12 @@ auto SortPlanNode::PlanNodeToString() const -> std::string {
   return fmt::format("Sort {{ order_bys={} }}", order_bys_);
 }
 
-auto LimitPlanNode::PlanNodeToString() const -> std::string { return fmt::format("Limit {{ limit={} }}", limit_); }
+auto LimitPlanNode::PlanNodeToString() const -> std::string {
+  if (offset_ > 0) {
+    return fmt::format("Limit {{ limit={}, offset={} }}", limit_, offset_);
+  }
+  return fmt::format("Limit {{ limit={} }}", limit_);
+}
 
 auto TopNPlanNode::PlanNodeToString() const -> std::string {
   return fmt::format("TopN {{ n={}, order_bys={}}}", n_, order_bys_);
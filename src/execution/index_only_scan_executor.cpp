@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_executor.cpp
+//
+// Identification: src/execution/index_only_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/index_only_scan_executor.h"
+
+namespace bustub {
+IndexOnlyScanExecutor::IndexOnlyScanExecutor(ExecutorContext *exec_ctx, const IndexOnlyScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexOnlyScanExecutor::Init() {
+  auto *index_info = GetExecutorContext()->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  index_iter_ = index_info->index_->GetOffsetScanIterator(plan_->IsDescending(), plan_->GetOffset(),
+                                                          exec_ctx_->GetTransaction());
+}
+
+auto IndexOnlyScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  // a descending scan starts past the last entry and steps back before reading
+  if (plan_->IsDescending()) {
+    if (index_iter_->IsBegin()) {
+      return false;
+    }
+    index_iter_->Prev();
+  } else if (index_iter_->IsEnd()) {
+    return false;
+  }
+  *tuple = index_iter_->GetKey();
+  *rid = index_iter_->GetRID();
+  if (!plan_->IsDescending()) {
+    index_iter_->Next();
+  }
+  return true;
+}
+
+}  // namespace bustub
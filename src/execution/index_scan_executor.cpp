@@ -17,19 +17,61 @@ IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanP
 
 void IndexScanExecutor::Init() {
   auto *index_info = GetExecutorContext()->GetCatalog()->GetIndex(plan_->GetIndexOid());
-  auto *tree = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index_info->index_.get());
-  index_iter_ = tree->GetBeginIterator();
-  table_heap_ = GetExecutorContext()->GetCatalog()->GetTable(index_info->table_name_)->table_.get();
+  // a scan of a range is ascending and starts at the first entry of the range
+  if (plan_->HasRange()) {
+    index_iter_ =
+        index_info->index_->GetRangeIterator(plan_->GetLower(), plan_->GetUpper(), exec_ctx_->GetTransaction());
+  } else {
+    index_iter_ = index_info->index_->GetOffsetScanIterator(plan_->IsDescending(), plan_->GetOffset(),
+                                                            exec_ctx_->GetTransaction());
+  }
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable(index_info->table_name_);
+  table_heap_ = table_info->table_.get();
+
+  const auto &key_attrs = index_info->index_->GetKeyAttrs();
+  key_positions_.clear();
+  if (key_attrs.size() == table_info->schema_.GetColumnCount()) {
+    key_positions_.resize(key_attrs.size());
+    for (uint32_t i = 0; i < key_attrs.size(); i++) {
+      key_positions_[key_attrs[i]] = i;
+    }
+  }
 }
 
 auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (index_iter_.IsInvaildIndexIter() || index_iter_.IsEnd()) {
+  // a descending scan starts past the last entry and steps back before reading
+  if (plan_->IsDescending()) {
+    if (index_iter_->IsBegin()) {
+      return false;
+    }
+    index_iter_->Prev();
+    *rid = index_iter_->GetRID();
+    return ReadTuple(*rid, tuple);
+  }
+  if (index_iter_->IsEnd()) {
     return false;
   }
-  if (!table_heap_->GetTuple((*index_iter_).second, tuple, exec_ctx_->GetTransaction())) {
+  // a delete or update above the scan finds the tuple by rid
+  *rid = index_iter_->GetRID();
+  if (!ReadTuple(*rid, tuple)) {
     return false;
   }
-  ++index_iter_;
+  index_iter_->Next();
+  return true;
+}
+
+auto IndexScanExecutor::ReadTuple(const RID &rid, Tuple *tuple) -> bool {
+  if (key_positions_.empty()) {
+    return table_heap_->GetTuple(rid, tuple, exec_ctx_->GetTransaction());
+  }
+  auto key = index_iter_->GetKey();
+  const auto *key_schema = GetExecutorContext()->GetCatalog()->GetIndex(plan_->GetIndexOid())->index_->GetKeySchema();
+  std::vector<Value> values;
+  values.reserve(key_positions_.size());
+  for (auto position : key_positions_) {
+    values.push_back(key.GetValue(key_schema, position));
+  }
+  *tuple = Tuple{values, &GetOutputSchema()};
   return true;
 }
 
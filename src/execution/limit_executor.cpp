@@ -21,6 +21,14 @@ LimitExecutor::LimitExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *pla
 void LimitExecutor::Init() {
   child_executor_->Init();
   cursor_ = 0;
+  // the first offset tuples of the child are skipped
+  Tuple tuple;
+  RID rid;
+  for (size_t skipped = 0; skipped < plan_->GetOffset(); skipped++) {
+    if (!child_executor_->Next(&tuple, &rid)) {
+      break;
+    }
+  }
 }
 
 auto LimitExecutor::Next(Tuple *tuple, RID *rid) -> bool {
@@ -26,11 +26,13 @@ NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const Ne
 void NestIndexJoinExecutor::Init() {
   child_executor_->Init();
   index_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
-  index_tree_ = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index_info_->index_.get());
   auto table_info = exec_ctx_->GetCatalog()->GetTable(plan_->GetInnerTableOid());
   table_heap_ = table_info->table_.get();
   RID left_rid{};
   left_tuple_valid_ = child_executor_->Next(&left_tuple_, &left_rid);
+  left_tuple_probed_ = false;
+  inner_rids_.clear();
+  inner_idx_ = 0;
 }
 
 auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
@@ -39,32 +41,46 @@ auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   values.reserve(GetOutputSchema().GetColumnCount());
 
   while (left_tuple_valid_) {
-    // make search key for index
-    auto key_value = plan_->KeyPredicate().get()->Evaluate(&left_tuple_, child_executor_->GetOutputSchema());
-    std::vector<Value> key_values{key_value};
-    Tuple key_tuple(key_values, &index_info_->key_schema_);
+    if (!left_tuple_probed_) {
+      // make search key for index, which may cover the leading key columns only
+      std::vector<Value> key_values;
+      bool has_null = false;
+      for (const auto &key_predicate : plan_->KeyPredicates()) {
+        key_values.push_back(key_predicate->Evaluate(&left_tuple_, child_executor_->GetOutputSchema()));
+        has_null = has_null || key_values.back().IsNull();
+      }
 
-    std::vector<bustub::RID> scan_result;
-    index_tree_->ScanKey(key_tuple, &scan_result, exec_ctx_->GetTransaction());
+      inner_rids_.clear();
+      inner_idx_ = 0;
+      // a null key equals nothing
+      if (!has_null) {
+        for (auto iter = index_info_->index_->GetPrefixIterator(key_values, exec_ctx_->GetTransaction());
+             !iter->IsEnd(); iter->Next()) {
+          inner_rids_.push_back(iter->GetRID());
+        }
+      }
+      left_tuple_probed_ = true;
 
-    if (scan_result.empty()) {
-      if (plan_->GetJoinType() == JoinType::LEFT) {
+      if (inner_rids_.empty() && plan_->GetJoinType() == JoinType::LEFT) {
         AddTupleValuesToVector(&left_tuple_, child_executor_->GetOutputSchema(), values);
         AddTupleValuesToVector(nullptr, plan_->InnerTableSchema(), values);
         *tuple = Tuple(values, &GetOutputSchema());
         left_tuple_valid_ = child_executor_->Next(&left_tuple_, &left_rid);
+        left_tuple_probed_ = false;
         return true;
       }
-      left_tuple_valid_ = child_executor_->Next(&left_tuple_, &left_rid);
-    } else {
+    }
+
+    // a non-unique index may return several inner tuples for one outer tuple
+    while (inner_idx_ < inner_rids_.size()) {
       Tuple right_tuple{};
-      table_heap_->GetTuple(scan_result.at(0), &right_tuple, exec_ctx_->GetTransaction());
+      table_heap_->GetTuple(inner_rids_[inner_idx_++], &right_tuple, exec_ctx_->GetTransaction());
       if (ProcessJoinResult(&right_tuple, values, tuple)) {
-        left_tuple_valid_ = child_executor_->Next(&left_tuple_, &left_rid);
         return true;
       }
-      left_tuple_valid_ = child_executor_->Next(&left_tuple_, &left_rid);
     }
+    left_tuple_valid_ = child_executor_->Next(&left_tuple_, &left_rid);
+    left_tuple_probed_ = false;
   }
   return false;
 }
@@ -73,7 +89,7 @@ void NestIndexJoinExecutor::AddTupleValuesToVector(const Tuple *tuple, const Sch
                                                    std::vector<Value> &values) {
   if (tuple == nullptr) {
     for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
-      values.emplace_back(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+      values.emplace_back(ValueFactory::GetNullValueByType(schema.GetColumn(i).GetType()));
     }
     return;
   }
@@ -21,10 +21,13 @@ namespace bustub {
 
 class CreateStatement : public BoundStatement {
  public:
-  explicit CreateStatement(std::string table, std::vector<Column> columns);
+  explicit CreateStatement(std::string table, std::vector<Column> columns,
+                           std::vector<std::string> primary_key = {});
 
   std::string table_;
   std::vector<Column> columns_;
+  /** The columns of the primary key, whose b+ tree stores the rows of the table, or none for a table heap */
+  std::vector<std::string> primary_key_;
 
   auto ToString() const -> std::string override;
 };
@@ -11,17 +11,23 @@
 #include <string>
 #include <vector>
 
+#include "binder/bound_expression.h"
 #include "binder/bound_statement.h"
 #include "binder/expressions/bound_column_ref.h"
 #include "binder/table_ref/bound_base_table_ref.h"
 #include "catalog/column.h"
+#include "storage/index/index.h"
 
 namespace bustub {
 
 class IndexStatement : public BoundStatement {
  public:
   explicit IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                          std::vector<std::unique_ptr<BoundColumnRef>> cols);
+                          std::vector<std::unique_ptr<BoundColumnRef>> cols,
+                          std::vector<std::unique_ptr<BoundColumnRef>> include_cols = {}, bool subtree_counts = false,
+                          bool adaptive_hash = true, bool change_buffer = true,
+                          IndexType index_type = IndexType::BPlusTree, bool bloom_filter = false,
+                          std::unique_ptr<BoundExpression> where = nullptr);
 
   /** Name of the index */
   std::string index_name_;
@@ -32,6 +38,27 @@ class IndexStatement : public BoundStatement {
   /** Name of the columns */
   std::vector<std::unique_ptr<BoundColumnRef>> cols_;
 
+  /** Name of the columns stored in the index after the key columns */
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols_;
+
+  /** Whether the index counts its entries per subtree */
+  bool subtree_counts_;
+
+  /** Whether the index hashes its hot keys to the leaves that hold them */
+  bool adaptive_hash_;
+
+  /** Whether the index defers the entries whose leaves are not in the buffer pool */
+  bool change_buffer_;
+
+  /** The data structure of the index */
+  IndexType index_type_;
+
+  /** Whether the index keeps a Bloom filter of its keys */
+  bool bloom_filter_;
+
+  /** The predicate of the rows a partial index holds, or nullptr to index every row */
+  std::unique_ptr<BoundExpression> where_;
+
   auto ToString() const -> std::string override;
 };
 
@@ -87,6 +87,9 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /** @return whether the page is in the buffer pool, so that fetching it costs no read */
+  virtual auto IsPageResident(page_id_t page_id) -> bool = 0;
+
  protected:
   /**
    * Grading function. Do not modify!
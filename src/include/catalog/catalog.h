@@ -21,9 +21,15 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/index/adaptive_radix_tree_index.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/index/lsm_tree_index.h"
+#include "storage/index/piecewise_geometric_model_index.h"
+#include "storage/index/trie_index.h"
+#include "storage/table/clustered_table.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -70,15 +76,25 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param predicate The predicate of the tuples a partial index holds, or nullptr if it holds every tuple
+   * @param clustered Whether the index stores the rows of a clustered table
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, AbstractExpressionRef predicate = nullptr, bool clustered = false)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        predicate_{std::move(predicate)},
+        clustered_{clustered} {}
+
+  /** @return Whether the index holds the tuple, a tuple of its table with the given schema */
+  auto Covers(const Tuple &tuple, const Schema &tuple_schema) const -> bool {
+    return Index::SatisfiesPredicate(predicate_.get(), tuple, tuple_schema);
+  }
+
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -91,6 +107,10 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The predicate of a partial index over the tuples of its table, or nullptr */
+  AbstractExpressionRef predicate_;
+  /** Whether the index is the primary index of a clustered table, which the table writes itself */
+  const bool clustered_;
 };
 
 /**
@@ -154,6 +174,53 @@ class Catalog {
     return tmp;
   }
 
+  /**
+   * Create a new clustered table, whose rows are stored in the b+ tree of its primary key, and the primary index that
+   * holds them, see ClusteredTable. The index is named after the table, with a _pkey suffix.
+   * @param txn The transaction in which the table is being created
+   * @param table_name The name of the new table
+   * @param schema The schema of the new table
+   * @param primary_key The column of the primary key, an INTEGER
+   * @param keysize Size of the key, which holds every column
+   * @return A (non-owning) pointer to the metadata for the table
+   */
+  template <class KeyType, class ValueType, class KeyComparator>
+  auto CreateClusteredTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                            uint32_t primary_key, std::size_t keysize) -> TableInfo * {
+    if (table_names_.count(table_name) != 0) {
+      return NULL_TABLE_INFO;
+    }
+    BUSTUB_ASSERT(schema.GetColumn(primary_key).GetType() == TypeId::INTEGER, "the primary key must be an INTEGER");
+
+    // the key is the primary key followed by the other columns, so the leaves hold whole rows in primary key order
+    std::vector<uint32_t> key_attrs{primary_key};
+    for (uint32_t col_idx = 0; col_idx < schema.GetColumnCount(); col_idx++) {
+      if (col_idx != primary_key) {
+        key_attrs.push_back(col_idx);
+      }
+    }
+    auto key_schema = Schema::CopySchema(&schema, key_attrs);
+    auto index_name = table_name + "_pkey";
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    index->EnableRangeScans();
+    auto table = std::make_unique<ClusteredTable>(bpm_, lock_manager_, log_manager_, index.get(), schema);
+
+    const auto table_oid = next_table_oid_.fetch_add(1);
+    auto table_info = std::make_unique<TableInfo>(schema, table_name, std::move(table), table_oid);
+    auto *tmp = table_info.get();
+    tables_.emplace(table_oid, std::move(table_info));
+    table_names_.emplace(table_name, table_oid);
+
+    const auto index_oid = next_index_oid_.fetch_add(1);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, nullptr, true);
+    indexes_.emplace(index_oid, std::move(index_info));
+    index_names_.emplace(table_name, std::unordered_map<std::string, index_oid_t>{{index_name, index_oid}});
+
+    return tmp;
+  }
+
   /**
    * Query table metadata by name.
    * @param table_name The name of the table
@@ -196,12 +263,21 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param subtree_counts Whether the index counts its entries per subtree, for range counts and seeks by rank
+   * @param adaptive_hash Whether the index hashes its hot keys to the leaves that hold them
+   * @param change_buffer Whether the index defers the entries whose leaves are not in the buffer pool
+   * @param index_type The data structure of the index, the options above are for b+ trees
+   * @param bloom_filter Whether a b+ tree or hash index keeps a Bloom filter of its keys, to skip probes of missing
+   * keys
+   * @param predicate The predicate of the tuples of a partial index, nullptr indexes every tuple
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, bool subtree_counts = false, bool adaptive_hash = true,
+                   bool change_buffer = true, IndexType index_type = IndexType::BPlusTree, bool bloom_filter = false,
+                   AbstractExpressionRef predicate = nullptr) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -221,26 +297,75 @@ class Catalog {
     auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-
-    // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    std::unique_ptr<Index> index;
+    BPlusTreeIndex<KeyType, ValueType, KeyComparator> *filtered_index = nullptr;
+    if (index_type == IndexType::AdaptiveRadixTree) {
+      if constexpr (IsNormalizedKey<KeyComparator>::VALUE) {
+        index = std::make_unique<AdaptiveRadixTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta));
+      } else {
+        throw NotImplementedException("an adaptive radix tree index needs normalized keys");
+      }
+    } else if (index_type == IndexType::PiecewiseGeometricModel) {
+      if constexpr (IsNormalizedKey<KeyComparator>::VALUE) {
+        index = std::make_unique<PiecewiseGeometricModelIndex<KeyType, ValueType, KeyComparator>>(std::move(meta));
+      } else {
+        throw NotImplementedException("a learned index needs normalized keys");
+      }
+    } else if (index_type == IndexType::Trie) {
+      index = std::make_unique<TrieIndex>(std::move(meta));
+    } else if (index_type == IndexType::LSMTree) {
+      index = std::make_unique<LSMTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_, hash_function);
+    } else if (index_type == IndexType::ExtendibleHash) {
+      auto hash_index =
+          std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                         hash_function);
+      if (bloom_filter) {
+        hash_index->EnableBloomFilter();
+      }
+      index = std::move(hash_index);
+    } else {
+      auto b_plus_tree_index =
+          std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+      if (subtree_counts) {
+        b_plus_tree_index->EnableSubtreeCounts();
+      }
+      if (adaptive_hash) {
+        b_plus_tree_index->EnableAdaptiveHash();
+      }
+      if (change_buffer) {
+        b_plus_tree_index->EnableChangeBuffer();
+      }
+      if (bloom_filter) {
+        b_plus_tree_index->EnableBloomFilter();
+        filtered_index = b_plus_tree_index.get();
+      }
+      index = std::move(b_plus_tree_index);
+    }
 
     // Populate the index with all tuples in table heap
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    if (index->IsInMemory()) {
+      index->Rebuild(heap, schema, predicate.get(), txn);
+    } else {
+      for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+        if (!Index::SatisfiesPredicate(predicate.get(), *tuple, schema)) {
+          continue;
+        }
+        index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+      }
+    }
+    // the filter grew layer by layer while the table was loaded, one layer sized for all the keys is faster to probe
+    if (filtered_index != nullptr) {
+      filtered_index->RebuildBloomFilter();
     }
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
 
     // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, std::move(predicate));
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -298,7 +423,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -333,6 +458,20 @@ class Catalog {
     return indexes;
   }
 
+  /**
+   * Fill the indexes that live outside the buffer pool from their tables again, as they are empty when the database
+   * starts.
+   * @param txn The transaction in which the tables are read
+   */
+  void RebuildInMemoryIndexes(Transaction *txn) {
+    for (auto &[index_oid, index_info] : indexes_) {
+      if (index_info->index_->IsInMemory()) {
+        auto *table_info = GetTable(index_info->table_name_);
+        index_info->index_->Rebuild(table_info->table_.get(), table_info->schema_, index_info->predicate_.get(), txn);
+      }
+    }
+  }
+
   auto GetTableNames() -> std::vector<std::string> {
     std::vector<std::string> result;
     for (const auto &x : table_names_) {
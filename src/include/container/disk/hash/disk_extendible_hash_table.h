@@ -30,6 +30,15 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * A lookup reads the directory page and the bucket page of the key, however
+ * many entries the table has. A full bucket is only split if that moves an
+ * entry away from the bucket of the new key; otherwise, such as for the many
+ * values of one key, the bucket grows a chain of overflow pages.
+ *
+ * The table latch is shared by lookups, inserts and removes, which latch the
+ * head page of the bucket chain they touch, and is taken exclusively to split
+ * and merge buckets, which changes the directory.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class DiskExtendibleHashTable {
@@ -161,6 +170,31 @@ class DiskExtendibleHashTable {
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /**
+   * @return whether a page of the bucket chain that starts with head holds the key and value
+   */
+  auto ChainContains(HASH_TABLE_BUCKET_TYPE *head, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Inserts the key and value into the first page of the bucket chain that has room, which must not hold them yet.
+   *
+   * @param may_overflow whether a page is appended to the chain if none has room
+   * @return false if no page has room and may_overflow is not set
+   */
+  auto ChainInsert(HASH_TABLE_BUCKET_TYPE *head, const KeyType &key, const ValueType &value, bool may_overflow)
+      -> bool;
+
+  /**
+   * @return whether splitting the bucket chain that starts with head, of the local depth, would move one of its
+   * entries to the other bucket than key, and so make room for it
+   */
+  auto SplitMakesRoom(HASH_TABLE_BUCKET_TYPE *head, const KeyType &key, uint32_t local_depth) -> bool;
+
+  /**
+   * Moves the entries of the bucket chain that starts with head to entries, and frees its overflow pages.
+   */
+  void DrainChain(HASH_TABLE_BUCKET_TYPE *head, std::vector<MappingType> *entries);
+
   // member variables
   page_id_t directory_page_id_;
   BufferPoolManager *buffer_pool_manager_;
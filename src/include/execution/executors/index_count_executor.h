@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_count_executor.h
+//
+// Identification: src/include/execution/executors/index_count_executor.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/index_count_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IndexCountExecutor produces the number of index entries in a range as a single tuple, read off the subtree counts
+ * of the index.
+ */
+class IndexCountExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new index count executor.
+   * @param exec_ctx the executor context
+   * @param plan the index count plan to be executed
+   */
+  IndexCountExecutor(ExecutorContext *exec_ctx, const IndexCountPlanNode *plan);
+
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+ private:
+  /** The index count plan node to be executed. */
+  const IndexCountPlanNode *plan_;
+  /** Whether the count tuple has been produced. */
+  bool done_{false};
+};
+}  // namespace bustub
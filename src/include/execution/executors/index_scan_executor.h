@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "common/rid.h"
@@ -42,11 +43,19 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Read the tuple of the entry under the cursor, from the key if it holds every column. */
+  auto ReadTuple(const RID &rid, Tuple *tuple) -> bool;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
-  BPlusTreeIndexIteratorForOneIntegerColumn index_iter_ =
-      BPlusTreeIndexIteratorForOneIntegerColumn(nullptr, -1, nullptr);
+  /** The cursor over the index, which works for any key type. */
+  std::unique_ptr<IndexScanIterator> index_iter_;
 
   TableHeap *table_heap_ = nullptr;
+  /**
+   * The position of each column in the index key, if the key holds every column, like the one of the primary index of
+   * a clustered table; the tuples are then read from the leaves instead of the table. Empty otherwise.
+   */
+  std::vector<uint32_t> key_positions_;
 };
 }  // namespace bustub
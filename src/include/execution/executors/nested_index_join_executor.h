@@ -55,9 +55,12 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   const NestedIndexJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
   IndexInfo *index_info_ = nullptr;
-  BPlusTreeIndexForOneIntegerColumn *index_tree_ = nullptr;
   TableHeap *table_heap_ = nullptr;
   Tuple left_tuple_{};
   bool left_tuple_valid_ = false;
+  /** Inner tuples matching the current outer tuple, emitted one per call of Next. */
+  std::vector<RID> inner_rids_{};
+  size_t inner_idx_ = 0;
+  bool left_tuple_probed_ = false;
 };
 }  // namespace bustub
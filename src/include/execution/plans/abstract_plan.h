@@ -34,6 +34,8 @@ namespace bustub {
 enum class PlanType {
   SeqScan,
   IndexScan,
+  IndexOnlyScan,
+  IndexCount,
   Insert,
   Update,
   Delete,
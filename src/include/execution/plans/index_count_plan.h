@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_count_plan.h
+//
+// Identification: src/include/execution/plans/index_count_plan.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "catalog/catalog.h"
+#include "execution/plans/abstract_plan.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+/**
+ * IndexCountPlanNode counts the entries of an index whose leading key column lies in a range, from the subtree counts
+ * of the index and without visiting the entries. It produces a single tuple with the count in every column, the
+ * result of a `count(*)` aggregation over the range.
+ */
+class IndexCountPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new index count plan node.
+   * @param output the output format of this plan node, count columns only
+   * @param index_oid the identifier of the index to be counted, which keeps subtree counts
+   * @param lower the lower end of the range, none for a range that starts at the first non-null key
+   * @param upper the upper end of the range, none for a range up to the last key
+   */
+  IndexCountPlanNode(SchemaRef output, index_oid_t index_oid, std::optional<IndexBound> lower,
+                     std::optional<IndexBound> upper)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        lower_(std::move(lower)),
+        upper_(std::move(upper)) {}
+
+  auto GetType() const -> PlanType override { return PlanType::IndexCount; }
+
+  /** @return the identifier of the index that should be counted */
+  auto GetIndexOid() const -> index_oid_t { return index_oid_; }
+
+  /** @return the lower end of the range */
+  auto GetLower() const -> const std::optional<IndexBound> & { return lower_; }
+
+  /** @return the upper end of the range */
+  auto GetUpper() const -> const std::optional<IndexBound> & { return upper_; }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexCountPlanNode);
+
+  /** The index whose entries are counted. */
+  index_oid_t index_oid_;
+
+  /** The lower end of the range. */
+  std::optional<IndexBound> lower_;
+
+  /** The upper end of the range. */
+  std::optional<IndexBound> upper_;
+
+ protected:
+  auto PlanNodeToString() const -> std::string override {
+    auto lower = lower_.has_value() ? fmt::format("{}{}", lower_->inclusive_ ? ">=" : ">", lower_->value_) : "none";
+    auto upper = upper_.has_value() ? fmt::format("{}{}", upper_->inclusive_ ? "<=" : "<", upper_->value_) : "none";
+    return fmt::format("IndexCount {{ index_oid={}, lower={}, upper={} }}", index_oid_, lower, upper);
+  }
+};
+
+}  // namespace bustub
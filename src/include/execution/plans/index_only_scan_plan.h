@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_plan.h
+//
+// Identification: src/include/execution/plans/index_only_scan_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "catalog/catalog.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+/**
+ * IndexOnlyScanPlanNode scans an index in key order and produces the index keys themselves, without reading the
+ * table. The output schema is the key schema of the index.
+ */
+class IndexOnlyScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new index-only scan plan node.
+   * @param output the output format of this scan plan node, the key schema of the index
+   * @param index_oid the identifier of the index to be scanned
+   * @param descending whether the index is scanned from its last key to its first
+   * @param offset the number of index entries the scan leaves out at its start
+   */
+  IndexOnlyScanPlanNode(SchemaRef output, index_oid_t index_oid, bool descending = false, size_t offset = 0)
+      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid), descending_(descending), offset_(offset) {}
+
+  auto GetType() const -> PlanType override { return PlanType::IndexOnlyScan; }
+
+  /** @return the identifier of the index that should be scanned */
+  auto GetIndexOid() const -> index_oid_t { return index_oid_; }
+
+  /** @return whether the index is scanned in descending key order */
+  auto IsDescending() const -> bool { return descending_; }
+
+  /** @return the number of index entries the scan leaves out, which it seeks past by rank */
+  auto GetOffset() const -> size_t { return offset_; }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexOnlyScanPlanNode);
+
+  /** The index whose keys should be scanned. */
+  index_oid_t index_oid_;
+
+  /** Whether the keys are produced in descending order. */
+  bool descending_;
+
+  /** The number of entries skipped at the start of the scan. */
+  size_t offset_;
+
+ protected:
+  auto PlanNodeToString() const -> std::string override {
+    if (offset_ > 0) {
+      return fmt::format("IndexOnlyScan {{ index_oid={}, descending={}, offset={} }}", index_oid_, descending_,
+                         offset_);
+    }
+    return fmt::format("IndexOnlyScan {{ index_oid={}, descending={} }}", index_oid_, descending_);
+  }
+};
+
+}  // namespace bustub
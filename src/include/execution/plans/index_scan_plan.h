@@ -12,12 +12,14 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "storage/index/index.h"
 
 namespace bustub {
 /**
@@ -29,25 +31,69 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param descending whether the index is scanned from its last key to its first
+   * @param offset the number of index entries the scan leaves out at its start
+   * @param lower the lower end of the range of the leading key column that an ascending scan reads, or none
+   * @param upper the upper end of that range, or none
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, bool descending = false, size_t offset = 0,
+                    std::optional<IndexBound> lower = std::nullopt, std::optional<IndexBound> upper = std::nullopt)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        descending_(descending),
+        offset_(offset),
+        lower_(std::move(lower)),
+        upper_(std::move(upper)) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the identifier of the table that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  /** @return whether the index is scanned in descending key order */
+  auto IsDescending() const -> bool { return descending_; }
+
+  /** @return the number of index entries the scan leaves out, which it seeks past by rank */
+  auto GetOffset() const -> size_t { return offset_; }
+
+  /** @return whether the scan reads a range of the index rather than every entry */
+  auto HasRange() const -> bool { return lower_.has_value() || upper_.has_value(); }
+
+  /** @return the lower end of the range */
+  auto GetLower() const -> const std::optional<IndexBound> & { return lower_; }
+
+  /** @return the upper end of the range */
+  auto GetUpper() const -> const std::optional<IndexBound> & { return upper_; }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
   // Add anything you want here for index lookup
+  /** Whether the tuples are produced in descending key order. */
+  bool descending_;
+
+  /** The number of entries skipped at the start of the scan. */
+  size_t offset_;
+
+  /** The lower end of the range the scan reads. */
+  std::optional<IndexBound> lower_;
+
+  /** The upper end of the range the scan reads. */
+  std::optional<IndexBound> upper_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    if (HasRange()) {
+      auto lower = lower_.has_value() ? fmt::format("{}{}", lower_->inclusive_ ? ">=" : ">", lower_->value_) : "none";
+      auto upper = upper_.has_value() ? fmt::format("{}{}", upper_->inclusive_ ? "<=" : "<", upper_->value_) : "none";
+      return fmt::format("IndexScan {{ index_oid={}, lower={}, upper={} }}", index_oid_, lower, upper);
+    }
+    if (offset_ > 0) {
+      return fmt::format("IndexScan {{ index_oid={}, descending={}, offset={} }}", index_oid_, descending_, offset_);
+    }
+    return fmt::format("IndexScan {{ index_oid={}, descending={} }}", index_oid_, descending_);
   }
 };
 
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <limits>
 #include <string>
 #include <utility>
 
@@ -21,17 +22,22 @@
 namespace bustub {
 
 /**
- * Limit constraints the number of output tuples produced by its child executor.
+ * Limit constraints the number of output tuples produced by its child executor, after skipping the first offset
+ * tuples of the child.
  */
 class LimitPlanNode : public AbstractPlanNode {
  public:
+  /** The limit of an OFFSET clause without LIMIT. */
+  static constexpr std::size_t NO_LIMIT = std::numeric_limits<std::size_t>::max();
+
   /**
    * Construct a new LimitPlanNode instance.
    * @param child The child plan from which tuples are obtained
    * @param limit The number of output tuples
+   * @param offset The number of tuples of the child skipped before the output tuples
    */
-  LimitPlanNode(SchemaRef output, AbstractPlanNodeRef child, std::size_t limit)
-      : AbstractPlanNode(std::move(output), {std::move(child)}), limit_{limit} {}
+  LimitPlanNode(SchemaRef output, AbstractPlanNodeRef child, std::size_t limit, std::size_t offset = 0)
+      : AbstractPlanNode(std::move(output), {std::move(child)}), limit_{limit}, offset_{offset} {}
 
   /** @return The type of the plan node */
   auto GetType() const -> PlanType override { return PlanType::Limit; }
@@ -39,6 +45,9 @@ class LimitPlanNode : public AbstractPlanNode {
   /** @return The limit */
   auto GetLimit() const -> size_t { return limit_; }
 
+  /** @return The offset */
+  auto GetOffset() const -> size_t { return offset_; }
+
   /** @return The child plan node */
   auto GetChildPlan() const -> AbstractPlanNodeRef {
     BUSTUB_ASSERT(GetChildren().size() == 1, "Limit should have at most one child plan.");
@@ -50,6 +59,9 @@ class LimitPlanNode : public AbstractPlanNode {
   /** The limit */
   std::size_t limit_;
 
+  /** The offset */
+  std::size_t offset_;
+
  protected:
   auto PlanNodeToString() const -> std::string override;
 };
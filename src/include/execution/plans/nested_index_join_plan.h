@@ -33,11 +33,12 @@ namespace bustub {
  */
 class NestedIndexJoinPlanNode : public AbstractPlanNode {
  public:
-  NestedIndexJoinPlanNode(SchemaRef output, AbstractPlanNodeRef child, AbstractExpressionRef key_predicate,
-                          table_oid_t inner_table_oid, index_oid_t index_oid, std::string index_name,
-                          std::string index_table_name, SchemaRef inner_table_schema, JoinType join_type)
+  NestedIndexJoinPlanNode(SchemaRef output, AbstractPlanNodeRef child,
+                          std::vector<AbstractExpressionRef> key_predicates, table_oid_t inner_table_oid,
+                          index_oid_t index_oid, std::string index_name, std::string index_table_name,
+                          SchemaRef inner_table_schema, JoinType join_type)
       : AbstractPlanNode(std::move(output), {std::move(child)}),
-        key_predicate_(std::move(key_predicate)),
+        key_predicates_(std::move(key_predicates)),
         inner_table_oid_(inner_table_oid),
         index_oid_(index_oid),
         index_name_(std::move(index_name)),
@@ -47,8 +48,11 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
 
   auto GetType() const -> PlanType override { return PlanType::NestedIndexJoin; }
 
-  /** @return the predicate to be used to extract the join key from the child */
-  auto KeyPredicate() const -> const AbstractExpressionRef & { return key_predicate_; }
+  /**
+   * @return the expressions that extract the join key from the child, one per leading column of the index key;
+   * they may cover a prefix of the key columns only
+   */
+  auto KeyPredicates() const -> const std::vector<AbstractExpressionRef> & { return key_predicates_; }
 
   /** @return The join type used in the nested index join */
   auto GetJoinType() const -> JoinType { return join_type_; };
@@ -70,8 +74,8 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
 
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(NestedIndexJoinPlanNode);
 
-  /** The nested index join predicate. */
-  AbstractExpressionRef key_predicate_;
+  /** The nested index join predicates, one per leading index key column. */
+  std::vector<AbstractExpressionRef> key_predicates_;
   table_oid_t inner_table_oid_;
   index_oid_t index_oid_;
   const std::string index_name_;
@@ -82,9 +86,6 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
   JoinType join_type_;
 
  protected:
-  auto PlanNodeToString() const -> std::string override {
-    return fmt::format("NestedIndexJoin {{ type={}, key_predicate={}, index={}, index_table={} }}", join_type_,
-                       key_predicate_, index_name_, index_table_name_);
-  }
+  auto PlanNodeToString() const -> std::string override;
 };
 }  // namespace bustub
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "execution/expressions/abstract_expression.h"
+#include "storage/index/index.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+/** A range over one column of a table, built from the comparisons of a predicate. */
+struct ColumnRange {
+  std::optional<uint32_t> col_idx_;
+  TypeId col_type_{TypeId::INVALID};
+  std::optional<IndexBound> lower_;
+  std::optional<IndexBound> upper_;
+};
+
+/**
+ * Narrow range by the comparisons of a conjunction between one column and constants.
+ * @return false if a conjunct is anything else, or bounds one end of the range twice
+ */
+auto CollectRange(const AbstractExpression &expr, ColumnRange *range) -> bool;
+
+}  // namespace bustub
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+
+namespace bustub {
+
+/** Append the conjuncts of expr, which is split at every AND, to conjuncts. */
+void CollectConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts);
+
+/** @return the AND of the conjuncts, or nullptr if there are none */
+auto MakeConjunction(const std::vector<AbstractExpressionRef> &conjuncts) -> AbstractExpressionRef;
+
+/**
+ * Match the predicate of a scan to the predicate of a partial index of the scanned table. The index holds every tuple
+ * the scan reads if each conjunct of its predicate is a conjunct of the scan predicate, or a range of a column that
+ * holds a range of the scan predicate on that column.
+ * @param predicate the predicate of the scan, or nullptr
+ * @param index_predicate the predicate of the index, or nullptr if it holds every tuple
+ * @param[out] residual the conjuncts of predicate the index does not answer, which the scan of the index still checks
+ * @return false if the index may lack tuples that the scan reads
+ */
+auto MatchIndexPredicate(const AbstractExpressionRef &predicate, const AbstractExpressionRef &index_predicate,
+                         std::vector<AbstractExpressionRef> *residual) -> bool;
+
+}  // namespace bustub
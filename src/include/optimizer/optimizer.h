@@ -85,9 +85,37 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
-  /** @brief check if the index can be matched */
-  auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
-      -> std::optional<std::tuple<index_oid_t, std::string>>;
+  /**
+   * @brief read the columns from the index keys instead of the table if an index scan only needs key columns
+   */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief push the offset of a limit into an index scan below it, which seeks past the offset by rank if the index
+   * keeps subtree counts
+   */
+  auto OptimizeOffsetAsIndexSeek(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief answer a count(*) over a range of the leading column of an index from the subtree counts of the index, or
+   * over the tuples of a partial index whose predicate the filter implies
+   */
+  auto OptimizeCountAsIndexCount(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief scan only the range of an index that a filter over a sequential scan keeps, if the filter bounds the
+   * leading key column of an index that seeks to a range directly, or fixes the key of an index with point lookups.
+   * A partial index is scanned if the filter implies its predicate, with what the index does not answer left in a
+   * filter above the scan.
+   */
+  auto OptimizeFilterScanAsIndexRangeScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief check if an index of every tuple has the given columns as the leading columns of its key
+   * @return the oid, name and key columns of the matched index
+   */
+  auto MatchIndex(const std::string &table_name, const std::vector<uint32_t> &key_columns)
+      -> std::optional<std::tuple<index_oid_t, std::string, std::vector<uint32_t>>>;
 
   /**
    * @brief optimize sort + limit as top N
@@ -12,10 +12,11 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -24,30 +25,84 @@
 
 namespace bustub {
 
+class TrieNode;
+
+/**
+ * The children of a trie node, by their key chars.
+ *
+ * Like the nodes of an adaptive radix tree, the layout grows with the number
+ * of children: up to 4 and up to 16 children are kept in arrays sorted by key
+ * char, up to 48 behind a 256-entry index of slots, and more in 256 slots, one
+ * per key char. Key chars are ordered as unsigned chars.
+ *
+ * A pointer to a child stays valid until a child is added or removed.
+ */
+class TrieChildren {
+ public:
+  TrieChildren() = default;
+  TrieChildren(TrieChildren &&other) noexcept;
+  auto operator=(TrieChildren &&other) noexcept -> TrieChildren &;
+  ~TrieChildren();
+
+  /** @return the number of children */
+  auto Size() const -> size_t { return size_; }
+
+  /** @return the child of key_char, nullptr if there is none */
+  auto Find(char key_char) const -> std::unique_ptr<TrieNode> *;
+
+  /**
+   * Add a child for key_char, which must not have one yet.
+   * @return the added child
+   */
+  auto Add(char key_char, std::unique_ptr<TrieNode> &&child) -> std::unique_ptr<TrieNode> *;
+
+  /** Remove the child of key_char, if there is one. */
+  void Remove(char key_char);
+
+  /** @return the child with the smallest key char not below from, nullptr if there is none */
+  auto Next(int from) const -> std::unique_ptr<TrieNode> *;
+
+  /** @return the child with the largest key char not above to, nullptr if there is none */
+  auto Prev(int to) const -> std::unique_ptr<TrieNode> *;
+
+ private:
+  /** Move the children to the layout with room for capacity of them. */
+  void Resize(uint16_t capacity);
+
+  /** The number of children the layout has room for: 0, 4, 16, 48 or 256. */
+  uint16_t capacity_{0};
+  uint16_t size_{0};
+  /** The key chars of the slots, if there is room for up to 16 children */
+  std::array<uint8_t, 16> keys_{};
+  /** For up to 48 children, the slot of each key char plus one, 0 if it has no child */
+  std::unique_ptr<std::array<uint8_t, 256>> index_;
+  /** capacity_ slots; with room for 256 children, the slot of a child is its key char */
+  std::vector<std::unique_ptr<TrieNode>> slots_;
+};
+
 /**
  * TrieNode is a generic container for any node in Trie.
  */
 class TrieNode {
  public:
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Construct a new Trie Node object with the given key char.
-   * is_end_ flag should be initialized to false in this constructor.
    *
    * @param key_char Key character of this trie node
    */
-  explicit TrieNode(char key_char) {}
+  explicit TrieNode(char key_char) : key_char_(key_char) {}
 
   /**
-   * TODO(P0): Add implementation
-   *
-   * @brief Move constructor for trie node object. The unique pointers stored
-   * in children_ should be moved from other_trie_node to new trie node.
+   * @brief Move constructor for trie node object. The children are moved from
+   * other_trie_node to the new trie node; the latch is not, the new node has
+   * its own.
    *
    * @param other_trie_node Old trie node.
    */
-  TrieNode(TrieNode &&other_trie_node) noexcept {}
+  TrieNode(TrieNode &&other_trie_node) noexcept
+      : key_char_(other_trie_node.key_char_),
+        is_end_(other_trie_node.is_end_),
+        children_(std::move(other_trie_node.children_)) {}
 
   /**
    * @brief Destroy the TrieNode object.
@@ -55,103 +110,91 @@ class TrieNode {
   virtual ~TrieNode() = default;
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Whether this trie node has a child node with specified key char.
    *
    * @param key_char Key char of child node.
    * @return True if this trie node has a child with given key, false otherwise.
    */
-  bool HasChild(char key_char) const { return false; }
+  bool HasChild(char key_char) const { return children_.Find(key_char) != nullptr; }
 
   /**
-   * TODO(P0): Add implementation
-   *
-   * @brief Whether this trie node has any children at all. This is useful
-   * when implementing 'Remove' functionality.
+   * @brief Whether this trie node has any children at all.
    *
    * @return True if this trie node has any child node, false if it has no child node.
    */
-  bool HasChildren() const { return false; }
+  bool HasChildren() const { return children_.Size() > 0; }
+
+  /**
+   * @brief The number of child nodes of this trie node.
+   */
+  size_t GetChildCount() const { return children_.Size(); }
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Whether this trie node is the ending character of a key string.
    *
    * @return True if is_end_ flag is true, false if is_end_ is false.
    */
-  bool IsEndNode() const { return false; }
+  bool IsEndNode() const { return is_end_; }
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Return key char of this trie node.
    *
    * @return key_char_ of this trie node.
    */
-  char GetKeyChar() const { return 'a'; }
+  char GetKeyChar() const { return key_char_; }
 
   /**
-   * TODO(P0): Add implementation
-   *
-   * @brief Insert a child node for this trie node into children_ map, given the key char and
-   * unique_ptr of the child node. If specified key_char already exists in children_,
-   * return nullptr. If parameter `child`'s key char is different than parameter
+   * @brief Insert a child node for this trie node, given the key char and
+   * unique_ptr of the child node. If specified key_char already has a child,
+   * or if parameter `child`'s key char is different than parameter
    * `key_char`, return nullptr.
    *
-   * Note that parameter `child` is rvalue and should be moved when it is
-   * inserted into children_map.
-   *
-   * The return value is a pointer to unique_ptr because pointer to unique_ptr can access the
-   * underlying data without taking ownership of the unique_ptr. Further, we can set the return
-   * value to nullptr when error occurs.
-   *
-   * @param key Key of child node
-   * @param child Unique pointer created for the child node. This should be added to children_ map.
+   * @param key_char Key of child node
+   * @param child Unique pointer created for the child node, moved into this node.
    * @return Pointer to unique_ptr of the inserted child node. If insertion fails, return nullptr.
    */
-  std::unique_ptr<TrieNode> *InsertChildNode(char key_char, std::unique_ptr<TrieNode> &&child) { return nullptr; }
+  std::unique_ptr<TrieNode> *InsertChildNode(char key_char, std::unique_ptr<TrieNode> &&child) {
+    if (child == nullptr || child->key_char_ != key_char || children_.Find(key_char) != nullptr) {
+      return nullptr;
+    }
+    return children_.Add(key_char, std::move(child));
+  }
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Get the child node given its key char. If child node for given key char does
    * not exist, return nullptr.
    *
-   * @param key Key of child node
+   * @param key_char Key of child node
    * @return Pointer to unique_ptr of the child node, nullptr if child
    *         node does not exist.
    */
-  std::unique_ptr<TrieNode> *GetChildNode(char key_char) { return nullptr; }
+  std::unique_ptr<TrieNode> *GetChildNode(char key_char) { return children_.Find(key_char); }
 
   /**
-   * TODO(P0): Add implementation
-   *
-   * @brief Remove child node from children_ map.
-   * If key_char does not exist in children_, return immediately.
+   * @brief Remove child node. If key_char has no child node, return immediately.
    *
    * @param key_char Key char of child node to be removed
    */
-  void RemoveChildNode(char key_char) {}
+  void RemoveChildNode(char key_char) { children_.Remove(key_char); }
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Set the is_end_ flag to true or false.
    *
    * @param is_end Whether this trie node is ending char of a key string
    */
-  void SetEndNode(bool is_end) {}
+  void SetEndNode(bool is_end) { is_end_ = is_end; }
 
  protected:
+  friend class Trie;
+
   /** Key character of this trie node */
   char key_char_;
   /** whether this node marks the end of a key */
   bool is_end_{false};
-  /** A map of all child nodes of this trie node, which can be accessed by each
-   * child node's key char. */
-  std::unordered_map<char, std::unique_ptr<TrieNode>> children_;
+  /** All child nodes of this trie node, which can be accessed by each child node's key char. */
+  TrieChildren children_;
+  /** Guards is_end_ and children_ of this node, see Trie */
+  ReaderWriterLatch latch_;
 };
 
 /**
@@ -166,39 +209,24 @@ class TrieNodeWithValue : public TrieNode {
 
  public:
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Construct a new TrieNodeWithValue object from a TrieNode object and specify its value.
-   * This is used when a non-terminal TrieNode is converted to terminal TrieNodeWithValue.
-   *
-   * The children_ map of TrieNode should be moved to the new TrieNodeWithValue object.
-   * Since it contains unique pointers, the first parameter is a rvalue reference.
-   *
-   * You should:
-   * 1) invoke TrieNode's move constructor to move data from TrieNode to
-   * TrieNodeWithValue.
-   * 2) set value_ member variable of this node to parameter `value`.
-   * 3) set is_end_ to true
+   * This is used when a non-terminal TrieNode is converted to terminal TrieNodeWithValue; the
+   * children of trieNode are moved to the new node.
    *
    * @param trieNode TrieNode whose data is to be moved to TrieNodeWithValue
    * @param value
    */
-  TrieNodeWithValue(TrieNode &&trieNode, T value) {}
+  TrieNodeWithValue(TrieNode &&trieNode, T value) : TrieNode(std::move(trieNode)), value_(std::move(value)) {
+    is_end_ = true;
+  }
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Construct a new TrieNodeWithValue. This is used when a new terminal node is constructed.
    *
-   * You should:
-   * 1) Invoke the constructor for TrieNode with the given key_char.
-   * 2) Set value_ for this node.
-   * 3) set is_end_ to true.
-   *
    * @param key_char Key char of this node
    * @param value Value of this node
    */
-  TrieNodeWithValue(char key_char, T value) {}
+  TrieNodeWithValue(char key_char, T value) : TrieNode(key_char), value_(std::move(value)) { is_end_ = true; }
 
   /**
    * @brief Destroy the Trie Node With Value object
@@ -216,44 +244,180 @@ class TrieNodeWithValue : public TrieNode {
 /**
  * Trie is a concurrent key-value store. Each key is a string and its corresponding
  * value can be any type.
+ *
+ * Every node has its own latch, and operations couple them top down, so that
+ * operations on different branches run in parallel:
+ *
+ * - Lookups and scans take read latches, and let go of a node once they hold
+ *   its child (a scan holds the latches of the path to the node it visits).
+ * - Insert takes read latches down to the parent of the terminal node, which it
+ *   changes under write latches. A node that needs a new child on the way is
+ *   relatched for writing while the read latch of its parent keeps it in place.
+ * - Remove first tries the same, and falls back to write latches from the root
+ *   when the nodes it frees reach above the parent of the terminal node. It
+ *   then keeps the latches from the lowest node that stays, one that ends a key
+ *   or has another child.
+ *
+ * Replacing or freeing a node takes the write latches of the node and of its
+ * parent, so a node that an operation holds the latch of, or the latch of its
+ * parent, stays in place. The root holds no key char and never goes away.
  */
 class Trie {
  private:
   /* Root node of the trie */
   std::unique_ptr<TrieNode> root_;
-  /* Read-write lock for the trie */
-  ReaderWriterLatch latch_;
+
+  /**
+   * Take the read latches from the root down to the node of prefix.
+   * @return the node, read latched, or nullptr if there is none
+   */
+  TrieNode *LatchPrefix(const std::string &prefix) {
+    TrieNode *node = root_.get();
+    node->latch_.RLock();
+    for (char key_char : prefix) {
+      auto *child = node->GetChildNode(key_char);
+      if (child == nullptr) {
+        node->latch_.RUnlock();
+        return nullptr;
+      }
+      TrieNode *next = child->get();
+      next->latch_.RLock();
+      node->latch_.RUnlock();
+      node = next;
+    }
+    return node;
+  }
+
+  /**
+   * Remove key with write latches from the root, see Trie.
+   */
+  bool RemovePessimistic(const std::string &key) {
+    // the write latched nodes, from the lowest one that stays once the terminal node is freed
+    std::vector<TrieNode *> latched{root_.get()};
+    root_->latch_.WLock();
+    bool found = true;
+    for (char key_char : key) {
+      TrieNode *node = latched.back();
+      if (node->IsEndNode() || node->GetChildCount() > 1) {
+        for (size_t i = 0; i + 1 < latched.size(); i++) {
+          latched[i]->latch_.WUnlock();
+        }
+        latched.erase(latched.begin(), latched.end() - 1);
+      }
+      auto *child = node->GetChildNode(key_char);
+      if (child == nullptr) {
+        found = false;
+        break;
+      }
+      (*child)->latch_.WLock();
+      latched.push_back(child->get());
+    }
+
+    TrieNode *terminal = latched.back();
+    bool removed = found && terminal->IsEndNode();
+    if (removed && terminal->HasChildren()) {
+      terminal->SetEndNode(false);
+    } else if (removed) {
+      // free the terminal node, and the nodes above it that are left with no children and end no key
+      size_t i = latched.size() - 1;
+      for (; i > 0; i--) {
+        TrieNode *node = latched[i];
+        if (node != terminal && (node->IsEndNode() || node->HasChildren())) {
+          break;
+        }
+        char key_char = node->GetKeyChar();
+        node->latch_.WUnlock();
+        latched[i - 1]->RemoveChildNode(key_char);
+      }
+      latched.resize(i + 1);
+    }
+    for (auto *node : latched) {
+      node->latch_.WUnlock();
+    }
+    return removed;
+  }
+
+  /**
+   * Append the keys that start with *key below node, after bound, see ScanForward. The caller holds the read latch
+   * of node; bound, if any, starts with *key.
+   */
+  template <typename T>
+  void ScanForwardFrom(TrieNode *node, std::string *key, const std::string *bound, size_t limit,
+                       std::vector<std::pair<std::string, T>> *out) {
+    if (bound == nullptr && node->IsEndNode()) {
+      if (auto *with_value = dynamic_cast<TrieNodeWithValue<T> *>(node); with_value != nullptr) {
+        out->emplace_back(*key, with_value->GetValue());
+      }
+    }
+    int from = 0;
+    if (bound != nullptr && bound->size() == key->size()) {
+      // node is the bound, every key below it comes after it
+      bound = nullptr;
+    } else if (bound != nullptr) {
+      from = static_cast<uint8_t>((*bound)[key->size()]);
+    }
+    for (auto *child = node->children_.Next(from); child != nullptr && out->size() < limit;) {
+      TrieNode *next = child->get();
+      int next_char = static_cast<uint8_t>(next->GetKeyChar());
+      next->latch_.RLock();
+      key->push_back(next->GetKeyChar());
+      ScanForwardFrom(next, key, next_char == from ? bound : nullptr, limit, out);
+      key->pop_back();
+      next->latch_.RUnlock();
+      child = next_char == UINT8_MAX ? nullptr : node->children_.Next(next_char + 1);
+    }
+  }
+
+  /**
+   * Append the keys that start with *key below node, before bound, see ScanBackward. The caller holds the read latch
+   * of node; bound, if any, starts with *key.
+   */
+  template <typename T>
+  void ScanBackwardFrom(TrieNode *node, std::string *key, const std::string *bound, size_t limit,
+                        std::vector<std::pair<std::string, T>> *out) {
+    int to = UINT8_MAX;
+    if (bound != nullptr && bound->size() == key->size()) {
+      // node is the bound, every key below it comes after it
+      return;
+    }
+    if (bound != nullptr) {
+      to = static_cast<uint8_t>((*bound)[key->size()]);
+    }
+    for (auto *child = node->children_.Prev(to); child != nullptr && out->size() < limit;) {
+      TrieNode *next = child->get();
+      int next_char = static_cast<uint8_t>(next->GetKeyChar());
+      next->latch_.RLock();
+      key->push_back(next->GetKeyChar());
+      ScanBackwardFrom(next, key, next_char == to ? bound : nullptr, limit, out);
+      key->pop_back();
+      next->latch_.RUnlock();
+      child = next_char == 0 ? nullptr : node->children_.Prev(next_char - 1);
+    }
+    // a key comes after the keys it is a prefix of
+    if (out->size() < limit && node->IsEndNode()) {
+      if (auto *with_value = dynamic_cast<TrieNodeWithValue<T> *>(node); with_value != nullptr) {
+        out->emplace_back(*key, with_value->GetValue());
+      }
+    }
+  }
 
  public:
   /**
-   * TODO(P0): Add implementation
-   *
-   * @brief Construct a new Trie object. Initialize the root node with '\0'
-   * character.
+   * @brief Construct a new Trie object. The root node has the '\0' character.
    */
-  Trie() = default;
+  Trie() : root_(std::make_unique<TrieNode>('\0')) {}
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Insert key-value pair into the trie.
    *
    * If the key is an empty string, return false immediately.
    *
    * If the key already exists, return false. Duplicated keys are not allowed and
-   * you should never overwrite value of an existing key.
-   *
-   * When you reach the ending character of a key:
-   * 1. If TrieNode with this ending character does not exist, create new TrieNodeWithValue
-   * and add it to parent node's children_ map.
-   * 2. If the terminal node is a TrieNode, then convert it into TrieNodeWithValue by
-   * invoking the appropriate constructor.
-   * 3. If it is already a TrieNodeWithValue,
-   * then insertion fails and returns false. Do not overwrite existing data with new data.
+   * the value of an existing key is never overwritten.
    *
-   * You can quickly check whether a TrieNode pointer holds TrieNode or TrieNodeWithValue
-   * by checking the is_end_ flag. If is_end_ == false, then it points to TrieNode. If
-   * is_end_ == true, it points to TrieNodeWithValue.
+   * A missing terminal node is added as a TrieNodeWithValue, and a terminal
+   * node that ends no key yet is replaced by a TrieNodeWithValue that takes
+   * over its children.
    *
    * @param key Key used to traverse the trie and find the correct node
    * @param value Value to be inserted
@@ -261,31 +425,157 @@ class Trie {
    */
   template <typename T>
   bool Insert(const std::string &key, T value) {
-    return false;
+    if (key.empty()) {
+      return false;
+    }
+    // read latches down to the parent of the terminal node, which is write latched
+    size_t last = key.size() - 1;
+    TrieNode *parent = nullptr;
+    TrieNode *node = root_.get();
+    if (last == 0) {
+      node->latch_.WLock();
+    } else {
+      node->latch_.RLock();
+    }
+    for (size_t depth = 0; depth < last; depth++) {
+      auto *child = node->GetChildNode(key[depth]);
+      if (child == nullptr) {
+        // the latch of the parent keeps node in place while its latch is traded for a write latch, and the nodes
+        // below it are write latched from here on
+        node->latch_.RUnlock();
+        node->latch_.WLock();
+        if (parent != nullptr) {
+          parent->latch_.RUnlock();
+          parent = nullptr;
+        }
+        for (; depth < last; depth++) {
+          child = node->GetChildNode(key[depth]);
+          if (child == nullptr) {
+            child = node->InsertChildNode(key[depth], std::make_unique<TrieNode>(key[depth]));
+          }
+          TrieNode *next = child->get();
+          next->latch_.WLock();
+          node->latch_.WUnlock();
+          node = next;
+        }
+        break;
+      }
+      TrieNode *next = child->get();
+      if (depth + 1 == last) {
+        next->latch_.WLock();
+      } else {
+        next->latch_.RLock();
+      }
+      if (parent != nullptr) {
+        parent->latch_.RUnlock();
+      }
+      parent = node;
+      node = next;
+    }
+    if (parent != nullptr) {
+      parent->latch_.RUnlock();
+    }
+
+    char key_char = key[last];
+    auto *terminal = node->GetChildNode(key_char);
+    if (terminal == nullptr) {
+      node->InsertChildNode(key_char, std::make_unique<TrieNodeWithValue<T>>(key_char, std::move(value)));
+      node->latch_.WUnlock();
+      return true;
+    }
+    // the write latch of the terminal node waits for the readers that are still on it
+    TrieNode *terminal_node = terminal->get();
+    terminal_node->latch_.WLock();
+    if (terminal_node->IsEndNode()) {
+      terminal_node->latch_.WUnlock();
+      node->latch_.WUnlock();
+      return false;
+    }
+    std::unique_ptr<TrieNode> replaced = std::move(*terminal);
+    *terminal = std::make_unique<TrieNodeWithValue<T>>(std::move(*replaced), std::move(value));
+    replaced->latch_.WUnlock();
+    node->latch_.WUnlock();
+    return true;
   }
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Remove key value pair from the trie.
-   * This function should also remove nodes that are no longer part of another
+   * This function also removes nodes that are no longer part of another
    * key. If key is empty or not found, return false.
    *
-   * You should:
-   * 1) Find the terminal node for the given key.
-   * 2) If this terminal node does not have any children, remove it from its
-   * parent's children_ map.
-   * 3) Recursively remove nodes that have no children and are not terminal node
-   * of another key.
+   * A terminal node with children stays and only stops ending a key. One
+   * without is removed from its parent, and so are the nodes above it that are
+   * left with no children and do not end another key.
    *
    * @param key Key used to traverse the trie and find the correct node
    * @return True if the key exists and is removed, false otherwise
    */
-  bool Remove(const std::string &key) { return false; }
+  bool Remove(const std::string &key) {
+    if (key.empty()) {
+      return false;
+    }
+    // read latches down to the parent of the terminal node, which is write latched like the terminal node
+    size_t last = key.size() - 1;
+    TrieNode *parent = nullptr;
+    TrieNode *node = root_.get();
+    if (last == 0) {
+      node->latch_.WLock();
+    } else {
+      node->latch_.RLock();
+    }
+    for (size_t depth = 0; depth < last; depth++) {
+      auto *child = node->GetChildNode(key[depth]);
+      if (child == nullptr) {
+        node->latch_.RUnlock();
+        if (parent != nullptr) {
+          parent->latch_.RUnlock();
+        }
+        return false;
+      }
+      TrieNode *next = child->get();
+      if (depth + 1 == last) {
+        next->latch_.WLock();
+      } else {
+        next->latch_.RLock();
+      }
+      if (parent != nullptr) {
+        parent->latch_.RUnlock();
+      }
+      parent = node;
+      node = next;
+    }
+    if (parent != nullptr) {
+      parent->latch_.RUnlock();
+    }
+
+    auto *terminal = node->GetChildNode(key[last]);
+    if (terminal == nullptr) {
+      node->latch_.WUnlock();
+      return false;
+    }
+    TrieNode *terminal_node = terminal->get();
+    terminal_node->latch_.WLock();
+    bool removed = terminal_node->IsEndNode();
+    if (removed && terminal_node->HasChildren()) {
+      terminal_node->SetEndNode(false);
+    } else if (removed) {
+      if (node != root_.get() && !node->IsEndNode() && node->GetChildCount() == 1) {
+        // the parent of the terminal node goes away as well, which needs the latch of its own parent
+        terminal_node->latch_.WUnlock();
+        node->latch_.WUnlock();
+        return RemovePessimistic(key);
+      }
+      terminal_node->latch_.WUnlock();
+      node->RemoveChildNode(key[last]);
+      node->latch_.WUnlock();
+      return true;
+    }
+    terminal_node->latch_.WUnlock();
+    node->latch_.WUnlock();
+    return removed;
+  }
 
   /**
-   * TODO(P0): Add implementation
-   *
    * @brief Get the corresponding value of type T given its key.
    * If key is empty, set success to false.
    * If key does not exist in trie, set success to false.
@@ -293,10 +583,6 @@ class Trie {
    * (ie. GetValue<int> is called but terminal node holds std::string),
    * set success to false.
    *
-   * To check whether the two types are the same, dynamic_cast
-   * the terminal TrieNode to TrieNodeWithValue<T>. If the casted result
-   * is not nullptr, then type T is the correct type.
-   *
    * @param key Key used to traverse the trie and find the correct node
    * @param success Whether GetValue is successful or not
    * @return Value of type T if type matches
@@ -304,7 +590,60 @@ class Trie {
   template <typename T>
   T GetValue(const std::string &key, bool *success) {
     *success = false;
-    return {};
+    if (key.empty()) {
+      return {};
+    }
+    TrieNode *node = LatchPrefix(key);
+    if (node == nullptr) {
+      return {};
+    }
+    T value{};
+    if (auto *with_value = dynamic_cast<TrieNodeWithValue<T> *>(node); with_value != nullptr && node->IsEndNode()) {
+      value = with_value->GetValue();
+      *success = true;
+    }
+    node->latch_.RUnlock();
+    return value;
+  }
+
+  /**
+   * @brief Append the keys that start with prefix, and their values, to out in key order, until out holds
+   * limit entries. Keys whose value is not of type T are skipped.
+   *
+   * @param prefix The prefix of the keys, empty for all keys
+   * @param after If not nullptr, only the keys after it are appended; it must start with prefix
+   * @param limit The number of entries out holds at most
+   * @param out The entries found
+   */
+  template <typename T>
+  void ScanForward(const std::string &prefix, const std::string *after, size_t limit,
+                   std::vector<std::pair<std::string, T>> *out) {
+    TrieNode *node = LatchPrefix(prefix);
+    if (node == nullptr) {
+      return;
+    }
+    std::string key = prefix;
+    if (out->size() < limit) {
+      ScanForwardFrom(node, &key, after, limit, out);
+    }
+    node->latch_.RUnlock();
+  }
+
+  /**
+   * @brief Like ScanForward, in reverse key order, from the last key on or from the last key before `before`.
+   */
+  template <typename T>
+  void ScanBackward(const std::string &prefix, const std::string *before, size_t limit,
+                    std::vector<std::pair<std::string, T>> *out) {
+    TrieNode *node = LatchPrefix(prefix);
+    if (node == nullptr) {
+      return;
+    }
+    std::string key = prefix;
+    if (out->size() < limit) {
+      ScanBackwardFrom(node, &key, before, limit, out);
+    }
+    node->latch_.RUnlock();
   }
 };
 }  // namespace bustub
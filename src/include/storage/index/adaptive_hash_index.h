@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_hash_index.h
+//
+// Identification: src/include/storage/index/adaptive_hash_index.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * AdaptiveHashIndex remembers the leaf page and slot of the keys that a B+ tree looks up often, so that their
+ * lookups go straight to the leaf instead of descending from the root.
+ *
+ * The entries live in a fixed number of buckets, one key hash per bucket, so the memory is bounded by the
+ * capacity. A bucket counts the lookups of its key; the key gets its leaf and slot cached once it was looked up
+ * hot_threshold times, and a lookup of another key that falls into the bucket wears the count down before it
+ * takes the bucket over.
+ *
+ * An entry is only a hint. The tree drops the entries of a leaf while it holds the leaf write latched to split,
+ * merge or free it, and a reader latches the cached leaf and checks that the entry is still there before it
+ * trusts the leaf. The slot may be stale after inserts and removes in the leaf, the reader then searches the
+ * leaf for the key.
+ */
+class AdaptiveHashIndex {
+ public:
+  /** The number of entries an index caches by default. */
+  static constexpr size_t DEFAULT_CAPACITY = 4096;
+  /** The number of lookups of a key before it is cached by default. */
+  static constexpr uint32_t DEFAULT_HOT_THRESHOLD = 4;
+
+  /**
+   * @param capacity the maximum number of cached keys
+   * @param hot_threshold the number of lookups of a key before its leaf is cached
+   */
+  explicit AdaptiveHashIndex(size_t capacity = DEFAULT_CAPACITY, uint32_t hot_threshold = DEFAULT_HOT_THRESHOLD);
+
+  /**
+   * Count a lookup of the key with the hash.
+   * @return the leaf page id and slot cached for the key, or std::nullopt if the key is not cached
+   */
+  auto Lookup(uint64_t hash) -> std::optional<std::pair<page_id_t, int>>;
+
+  /** @return whether the entry of the key with the hash still points at the leaf page */
+  auto IsCached(uint64_t hash, page_id_t page_id) -> bool;
+
+  /**
+   * Cache the leaf page and slot where a lookup found the key with the hash, if the key is hot. The caller holds
+   * the leaf latched.
+   */
+  void Record(uint64_t hash, page_id_t page_id, int slot);
+
+  /** Drop the entry of the key with the hash, if it points at the leaf page. */
+  void Forget(uint64_t hash, page_id_t page_id);
+
+  /**
+   * Drop every entry that points at the leaf page. The caller holds the leaf write latched, before it splits,
+   * merges or frees the leaf.
+   */
+  void InvalidatePage(page_id_t page_id);
+
+  /** @return the number of lookups that found a cached leaf holding the key */
+  auto GetHitCount() const -> size_t { return hits_; }
+
+  /** Count a lookup that found its key in the cached leaf. */
+  void CountHit() { hits_++; }
+
+ private:
+  /** The number of independently latched parts of the buckets. */
+  static constexpr size_t NUM_PARTITIONS = 16;
+
+  struct Entry {
+    uint64_t hash_{0};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    int slot_{-1};
+    uint32_t lookups_{0};
+  };
+
+  struct Partition {
+    std::mutex latch_;
+    std::vector<Entry> entries_;
+  };
+
+  /** @return the partition and the bucket of the key with the hash */
+  auto BucketOf(uint64_t hash) -> std::pair<Partition *, Entry *>;
+
+  uint32_t hot_threshold_;
+  std::vector<Partition> partitions_;
+  std::atomic<size_t> hits_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.h
+//
+// Identification: src/include/storage/index/adaptive_radix_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <vector>
+
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define ART_TYPE AdaptiveRadixTree<KeyType, ValueType, KeyComparator>
+#define ART_ITERATOR_TYPE AdaptiveRadixTreeIterator<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class AdaptiveRadixTree;
+
+template <size_t KeyLength>
+struct ARTNode;
+template <size_t KeyLength>
+struct ARTLeaf;
+
+/**
+ * Cursor over the entries of an adaptive radix tree in key order, then in
+ * value order.
+ *
+ * The tree frees its nodes while readers may still hold them, so the cursor
+ * holds no node: it copies the entries a batch at a time, and reads the next
+ * batch after the last entry it has. It sees the changes to the entries it
+ * has not copied yet.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class AdaptiveRadixTreeIterator {
+ public:
+  /**
+   * @param batch the copied entries, sorted
+   * @param index the position of the cursor in batch, batch.size() past the last entry
+   * @param stop_length the number of leading bytes of stop_key that every entry of the scan starts with
+   */
+  AdaptiveRadixTreeIterator(ART_TYPE *tree, std::vector<MappingType> &&batch, size_t index, const KeyType &stop_key,
+                            size_t stop_length);
+
+  /** @return true if the cursor is past the last entry */
+  auto IsEnd() const -> bool { return index_ == batch_.size(); }
+
+  /** @return true if no entry comes before the one under the cursor */
+  auto IsBegin() -> bool;
+
+  auto operator*() -> const MappingType & { return batch_[index_]; }
+
+  auto operator++() -> AdaptiveRadixTreeIterator &;
+
+  auto operator--() -> AdaptiveRadixTreeIterator &;
+
+  /** The number of entries the cursor copies at a time. */
+  static constexpr size_t BATCH_SIZE = 64;
+
+ private:
+  ART_TYPE *tree_;
+  std::vector<MappingType> batch_;
+  size_t index_;
+  KeyType stop_key_;
+  size_t stop_length_;
+};
+
+/**
+ * Adaptive radix tree, an index for tables that fit in memory.
+ *
+ * The nodes live on the heap rather than in buffer pool pages, so a lookup
+ * pins and latches nothing: it walks down one byte of the key per level, and
+ * a node holds 4, 16, 48 or 256 children depending on how many it needs.
+ * Bytes that every key below a node shares are kept in the node as its
+ * prefix, and a key that no other key shares its next byte with is kept in a
+ * leaf right away.
+ *
+ * Keys must be normalized (see GenericKey::SetFromKey), so that their bytes
+ * sort like the keys themselves. The value is appended to the key, which
+ * makes every entry unique and lets keys repeat.
+ *
+ * Concurrency follows optimistic lock coupling: every node has a version,
+ * which a writer bumps once it changed the node under its lock. Readers take
+ * no lock; they read the version, then the node, and start over if the
+ * version moved meanwhile. A node that was replaced is kept until every
+ * operation that may still read it is over, tracked with two epochs.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class AdaptiveRadixTree {
+  static_assert(IsNormalizedKey<KeyComparator>::VALUE, "an adaptive radix tree needs keys that compare by bytes");
+
+ public:
+  /** The length of the bytes a leaf is found by, the key followed by the value. */
+  static constexpr size_t KEY_LENGTH = sizeof(KeyType) + sizeof(int64_t);
+
+  AdaptiveRadixTree();
+  AdaptiveRadixTree(const AdaptiveRadixTree &) = delete;
+  auto operator=(const AdaptiveRadixTree &) -> AdaptiveRadixTree & = delete;
+  ~AdaptiveRadixTree();
+
+  // Add the value to the values of key. Returns false if key already has it.
+  auto Insert(const KeyType &key, const ValueType &value) -> bool;
+
+  // Remove the value from the values of key. Returns false if key does not have it.
+  auto Remove(const KeyType &key, const ValueType &value) -> bool;
+
+  // Append the values of key to result. Returns false if it has none.
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  // Replace the entries with the given ones, built bottom up. Not safe while other operations run.
+  void BulkLoad(std::vector<MappingType> &&entries);
+
+  // Iterators over the entries; a scan from key may stop at the first entry that does not start with the first
+  // prefix_length bytes of key.
+  auto Begin() -> ART_ITERATOR_TYPE;
+  auto Begin(const KeyType &key, size_t prefix_length = 0) -> ART_ITERATOR_TYPE;
+  auto End() -> ART_ITERATOR_TYPE;
+
+ private:
+  friend class AdaptiveRadixTreeIterator<KeyType, ValueType, KeyComparator>;
+
+  using Key = std::array<uint8_t, KEY_LENGTH>;
+  using Node = ARTNode<KEY_LENGTH>;
+  using Leaf = ARTLeaf<KEY_LENGTH>;
+  // a tagged pointer to a node, or to a leaf if the lowest bit is set
+  using Child = uintptr_t;
+
+  enum class ScanState { CONTINUE, FULL, RESTART };
+
+  /** Keeps the nodes that the operation may read from being freed while it runs. */
+  class EpochGuard {
+   public:
+    explicit EpochGuard(AdaptiveRadixTree *tree);
+    EpochGuard(const EpochGuard &) = delete;
+    auto operator=(const EpochGuard &) -> EpochGuard & = delete;
+    ~EpochGuard();
+
+   private:
+    AdaptiveRadixTree *tree_;
+    uint64_t epoch_;
+  };
+
+  static auto EncodeKey(const KeyType &key, const ValueType &value) -> Key;
+  static auto DecodeKey(const Key &key) -> MappingType;
+
+  // Each returns std::nullopt if the operation has to start over.
+  auto TryInsert(const Key &key) -> std::optional<bool>;
+  auto TryRemove(const Key &key) -> std::optional<bool>;
+
+  /**
+   * Append to out, in key order, the entries after bound (or from bound on if inclusive, or from the first entry if
+   * bound is nullptr) until out holds limit entries, or an entry does not start with the first stop_length bytes of
+   * stop.
+   */
+  void ScanForward(const Key *bound, bool inclusive, const uint8_t *stop, size_t stop_length, size_t limit,
+                   std::vector<MappingType> *out);
+  // Append to out, in reverse key order, the entries before bound (or the last ones if it is nullptr).
+  void ScanBackward(const Key *bound, size_t limit, std::vector<MappingType> *out);
+  // The scans of the subtree of node, which hangs off parent at depth; parent_version is the version of parent that
+  // the child pointer was read at.
+  auto ScanForwardFrom(Node *node, const Node *parent, uint64_t parent_version, size_t depth, const Key *bound,
+                       bool inclusive, const uint8_t *stop, size_t stop_length, size_t limit,
+                       std::vector<MappingType> *out) -> ScanState;
+  auto ScanBackwardFrom(Node *node, const Node *parent, uint64_t parent_version, size_t depth, const Key *bound,
+                        size_t limit, std::vector<MappingType> *out) -> ScanState;
+
+  // Add the leaves between begin and end, which share the bytes before depth, to node, grouped by their byte at depth.
+  static void BuildChildren(Node *node, const std::vector<Leaf *> &leaves, size_t begin, size_t end, size_t depth);
+
+  // Hand over a node or leaf that was unlinked from the tree, to be freed once no operation may read it.
+  void Retire(Child child);
+  // Free the retired nodes of the epoch before the current one if no operation runs in it anymore, the caller holds
+  // retire_latch_.
+  void TryReclaim();
+  static void FreeSubtree(Child child);
+
+  // the number of retired nodes and leaves that makes Retire try to free them
+  static constexpr size_t RECLAIM_BATCH = 64;
+
+  Node *root_;
+  // operations run in the current epoch or the one before it, see TryReclaim
+  std::atomic<uint64_t> epoch_{0};
+  std::array<std::atomic<uint64_t>, 2> active_{};
+  std::mutex retire_latch_;
+  // what was retired in the even and in the odd epochs
+  std::array<std::vector<Child>, 2> retired_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_index.h
+//
+// Identification: src/include/storage/index/adaptive_radix_tree_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "storage/index/adaptive_radix_tree.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+#define ART_INDEX_TYPE AdaptiveRadixTreeIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * An index over an adaptive radix tree, for tables that fit in memory, see AdaptiveRadixTree. CREATE INDEX ...
+ * USING art builds one. The tree is not kept in the buffer pool, so it is gone when the database stops, and
+ * Rebuild fills it from the table again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class AdaptiveRadixTreeIndex : public Index {
+ public:
+  explicit AdaptiveRadixTreeIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  auto GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> override;
+
+  auto GetPrefixIterator(const std::vector<Value> &prefix, Transaction *transaction)
+      -> std::unique_ptr<IndexScanIterator> override;
+
+  auto IsInMemory() const -> bool override { return true; }
+
+  void Rebuild(TableHeap *table_heap, const Schema &tuple_schema, const AbstractExpression *predicate,
+               Transaction *transaction) override;
+
+  /** @return the key tuple that the index key was made from */
+  auto KeyToTuple(const KeyType &index_key) const -> Tuple;
+
+ protected:
+  // container
+  AdaptiveRadixTree<KeyType, ValueType, KeyComparator> container_;
+};
+
+}  // namespace bustub
@@ -10,51 +10,141 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "storage/index/adaptive_hash_index.h"
+#include "storage/index/bloom_filter.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 #define INVALID_THREAD_ID std::thread::id()
 
-enum class OperateType { Other = 0, Find, Insert, Delete, Iterator };
+enum class OperateType { Other = 0, Find, Insert, Delete, LazyDelete, Iterator };
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Duplicate keys share one leaf slot whose record ids live in a posting chain
  * (2) support insert & remove
- * (3) The structure should shrink and grow dynamically
+ * (3) The structure should shrink and grow dynamically, or with lazy deletes
+ *     shrink when Compact runs
  * (4) Implement index iterator for range scan
+ * (5) Optionally count the values below every child, for rank queries
+ * (6) Optionally cache the leaves of hot keys in an adaptive hash index, which
+ *     point lookups try before they descend from the root
+ * (7) Optionally defer the changes that would read a page from disk in a change
+ *     buffer, which readers and a background thread merge into the tree
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
+  enum class ChangeType { Insert, Remove, RemoveKey };
+
+  /** An insert or remove in the change buffer; RemoveKey removes every value of the key */
+  struct BufferedChange {
+    ChangeType type_;
+    KeyType key_;
+    ValueType value_;
+  };
+
  public:
+  static constexpr size_t DEFAULT_CHANGE_BUFFER_CAPACITY = 1024;
+  static constexpr std::chrono::milliseconds DEFAULT_MERGE_INTERVAL{100};
+
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
                      int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
 
+  ~BPlusTree();
+
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
 
-  // Insert a key-value pair into this B+ tree.
+  // Insert a key-value pair into this B+ tree, or defer it if the tree has a change buffer.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and all of its values from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove a single key-value pair from this B+ tree.
+  auto Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr) -> bool;
+
+  // Defer the rebalancing of removes: a remove only latches its leaf, which may underflow down to empty, and
+  // Compact merges sparse nodes later. A compaction interval above zero starts a background thread that runs
+  // Compact that often. Call before the tree is shared; lazy deletes stay on for the lifetime of the tree.
+  void EnableLazyDelete(std::chrono::milliseconds compaction_interval = std::chrono::milliseconds(0));
+
+  // Merge sparse sibling nodes and free the empty pages that lazy removes left behind.
+  void Compact();
+
+  // Keep the number of values below every child in the internal pages, so that Rank, Size and BeginAtRank take
+  // O(log n) pages. Call on an empty tree before it is shared; writers then latch their whole path from the root,
+  // and lazy deletes are not available.
+  void EnableSubtreeCounts();
+
+  auto HasSubtreeCounts() const -> bool { return subtree_counts_; }
+
+  // Cache the leaf and slot of hot keys in an adaptive hash index of at most capacity keys, which GetValue and
+  // Begin(key) try before they descend from the root. Call before the tree is shared.
+  void EnableAdaptiveHash(size_t capacity = AdaptiveHashIndex::DEFAULT_CAPACITY,
+                          uint32_t hot_threshold = AdaptiveHashIndex::DEFAULT_HOT_THRESHOLD);
+
+  // The adaptive hash index of this B+ tree, nullptr if it has none.
+  auto GetAdaptiveHash() const -> AdaptiveHashIndex * { return adaptive_hash_.get(); }
+
+  // Keep a Bloom filter of the keys, sized for expected_keys at first, which GetValue asks before anything else, so
+  // that a lookup of a missing key usually reads no page. Call before the tree is shared.
+  void EnableBloomFilter(size_t expected_keys = BloomFilter::DEFAULT_EXPECTED_KEYS);
+
+  // Fill the Bloom filter again from the keys in the tree, in one layer sized for them, which drops the keys that
+  // were removed since. Not safe while other operations run.
+  void RebuildBloomFilter();
+
+  // The Bloom filter of this B+ tree, nullptr if it has none.
+  auto GetBloomFilter() const -> BloomFilter * { return bloom_filter_.get(); }
+
+  // Whether the tree may hold key, false only if the Bloom filter rules it out.
+  auto MayContain(const KeyType &key) -> bool;
+
+  // Defer the inserts and removes whose way down from the root reaches a page that is not in the buffer pool, so
+  // that they read nothing from disk; a deferred change reports success. Up to capacity changes are deferred at a
+  // time. GetValue merges the changes of its key first, the iterators and rank queries merge all of them, and a
+  // merge interval above zero starts a background thread that merges them that often. Call before the tree is shared.
+  void EnableChangeBuffer(size_t capacity = DEFAULT_CHANGE_BUFFER_CAPACITY,
+                          std::chrono::milliseconds merge_interval = std::chrono::milliseconds(0));
+
+  // Apply every deferred change to the tree, in key order.
+  void MergeChangeBuffer();
+
+  // The number of deferred changes that are not merged yet.
+  auto GetBufferedChangeCount() const -> size_t { return buffered_change_count_; }
+
+  // The number of values whose key is less than key, or not greater than key if inclusive. Needs subtree counts.
+  auto Rank(const KeyType &key, bool inclusive = false) -> size_t;
+
+  // The number of values in this B+ tree. Needs subtree counts.
+  auto Size() -> size_t;
+
+  // return the values associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
   // return the page id of the root node
@@ -64,6 +154,8 @@ class BPlusTree {
   auto Begin() -> INDEXITERATOR_TYPE;
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
+  // iterator at the value that has rank values before it, needs subtree counts
+  auto BeginAtRank(size_t rank) -> INDEXITERATOR_TYPE;
 
   // print the B+ tree
   void Print(BufferPoolManager *buffer_pool_manager_);
@@ -87,14 +179,16 @@ class BPlusTree {
 
   auto GetLeaf(const KeyType &key, OperateType operator_type, Transaction *transaction = nullptr) -> Page *;
   void InsertParent(BPlusTreePage *page1, BPlusTreePage *page2, const KeyType &key, const ValueType &value,
-                    Transaction *transaction = nullptr);
+                    bool is_append, Transaction *transaction = nullptr);
   template <typename P>
   void RemoveEntry(P *node, const KeyType &key, Transaction *transaction = nullptr);
   void ReleaseResourcesd(Transaction *transaction = nullptr);
   void MakeRoot(const KeyType &key, const ValueType &value);
-  void InsertInFillNode(LeafPage *leaf1, Transaction *transaction);
+  void InsertInFillNode(LeafPage *leaf1, bool is_append, Transaction *transaction);
+  auto TryAppend(const KeyType &key, const ValueType &value) -> bool;
   void RenewRoot(BPlusTreePage *page1, BPlusTreePage *page2, const KeyType &key);
-  void InsertInFillParent(InternalPage *parent, const KeyType &key, const ValueType &value, Transaction *transaction);
+  void InsertInFillParent(InternalPage *parent, const KeyType &key, const ValueType &value, bool is_append,
+                          Transaction *transaction);
   void ReplaceRootByChildren(InternalPage *old_root, Transaction *transaction);
   auto GetSiblingIdx(InternalPage *parent_page, int page_id) -> int;
   void Coalesce(bool is_sibling_brother, BPlusTreePage *node, BPlusTreePage *sibling_page, const KeyType &key_plus,
@@ -103,13 +197,34 @@ class BPlusTree {
                     KeyType key_plus);
   auto IsSafe(BPlusTreePage *node, OperateType op) -> bool;
   void InsertLeaf(LeafPage *leaf, const KeyType &key, const ValueType &value);
+  auto InsertDuplicate(LeafPage *leaf, int index, const ValueType &value) -> bool;
+  auto RemoveDuplicate(LeafPage *leaf, int index, const ValueType &value, bool *is_last) -> bool;
+  auto GetLeafForLazyDelete(const KeyType &key) -> Page *;
+  void CompactInternal(InternalPage *node, std::vector<page_id_t> *deleted);
+  auto MergeSparseSiblings(InternalPage *parent, int index, BPlusTreePage *left, BPlusTreePage *right) -> bool;
+  void RunCompaction(std::chrono::milliseconds interval);
   void InsertInternal(InternalPage *internal, const KeyType &key, const ValueType &value);
+  auto ChildIndexForFind(InternalPage *internal, const KeyType &key) const -> int;
   auto GetNextPageIdForFind(InternalPage *internal, const KeyType &key) const -> page_id_t;
+  auto ValueCount(const ValueType &value) -> size_t;
+  auto SubtreeCount(BPlusTreePage *node) -> size_t;
+  void AddPathCount(Transaction *transaction, int64_t delta);
+  auto FetchRootForRead() -> Page *;
+  auto GetLeafFromHash(const KeyType &key, uint64_t hash, int *index) -> Page *;
+  void InvalidateHashedLeaf(page_id_t page_id);
+  auto BufferChange(ChangeType type, const KeyType &key, const ValueType &value) -> bool;
+  auto IsPathResident(const KeyType &key) -> bool;
+  void MergeBufferedChanges(const KeyType &key);
+  void WaitForMerge();
+  void ApplyChanges(const std::vector<BufferedChange> &changes);
+  void RunMerger(std::chrono::milliseconds interval);
   void RemoveRoot(BPlusTreePage *node, Transaction *transaction);
   void CoalesceLeafPages(LeafPage *node, LeafPage *sibling_page);
+  void LinkNextLeafBack(LeafPage *leaf);
   void CoalesceInternalPages(InternalPage *node, InternalPage *sibling_page, const KeyType &key_plus);
   auto RedistributeLeafPages(LeafPage *node, LeafPage *sibling_page, bool is_i_plus_before_i) -> KeyType;
-  auto RedistributeInternalPages(InternalPage *node, InternalPage *sibling_page, bool is_i_plus_before_i) -> KeyType;
+  auto RedistributeInternalPages(InternalPage *node, InternalPage *sibling_page, bool is_i_plus_before_i,
+                                 const KeyType &key_plus) -> KeyType;
   // member variable
   std::string index_name_;
   BufferPoolManager *buffer_pool_manager_;
@@ -118,6 +233,29 @@ class BPlusTree {
   int internal_max_size_;
   page_id_t root_page_id_;
   ReaderWriterLatch root_page_id_latch_;
+  // the leaf at the right edge of the tree, where appends go; guarded by root_page_id_latch_
+  page_id_t rightmost_leaf_page_id_{INVALID_PAGE_ID};
+  std::atomic<bool> lazy_delete_{false};
+  std::atomic<bool> enable_compaction_{false};
+  std::thread *compaction_thread_{nullptr};
+  bool subtree_counts_{false};
+  std::unique_ptr<AdaptiveHashIndex> adaptive_hash_;
+  std::unique_ptr<BloomFilter> bloom_filter_;
+  HashFunction<KeyType> hash_fn_;
+  // the change buffer is off while its capacity is zero
+  size_t change_buffer_capacity_{0};
+  // the deferred changes by the hash of their key, in the order they came in
+  std::unordered_map<uint64_t, std::vector<BufferedChange>> buffered_changes_;
+  std::mutex buffered_changes_latch_;
+  std::atomic<size_t> buffered_change_count_{0};
+  // writers share it while they decide whether to defer, a merge holds it alone
+  ReaderWriterLatch change_merge_latch_;
+  // the thread applying a merge, whose inserts and removes are not deferred again
+  std::atomic<std::thread::id> merging_thread_{INVALID_THREAD_ID};
+  bool enable_merger_{false};
+  std::mutex merger_latch_;
+  std::condition_variable merger_cv_;
+  std::thread *merger_thread_{nullptr};
 };
 
 }  // namespace bustub
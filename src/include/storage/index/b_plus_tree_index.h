@@ -35,25 +35,103 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  auto GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> override;
+
+  auto GetPrefixIterator(const std::vector<Value> &prefix, Transaction *transaction)
+      -> std::unique_ptr<IndexScanIterator> override;
+
+  auto HasSubtreeCounts() const -> bool override { return container_.HasSubtreeCounts(); }
+
+  auto CountRange(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                  Transaction *transaction) -> size_t override;
+
+  auto GetRankIterator(size_t rank, Transaction *transaction) -> std::unique_ptr<IndexScanIterator> override;
+
+  auto HasRangeScans() const -> bool override { return range_scans_; }
+
+  /** Seeks to the start of a range work for normalized keys only, a range of other keys is not scanned. */
+  auto GetRangeIterator(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                        Transaction *transaction) -> std::unique_ptr<IndexScanIterator> override;
+
+  /**
+   * Tell the optimizer to scan ranges of the leading key column with seeks to their start, which the primary index of
+   * a clustered table does. The keys must be normalized.
+   */
+  void EnableRangeScans() { range_scans_ = true; }
+
+  /** Count the entries per subtree from now on, see BPlusTree::EnableSubtreeCounts. The index must be empty. */
+  void EnableSubtreeCounts() { container_.EnableSubtreeCounts(); }
+
+  /** Cache the leaves of hot keys for point lookups and probes, see BPlusTree::EnableAdaptiveHash. */
+  void EnableAdaptiveHash() { container_.EnableAdaptiveHash(); }
+
+  /** Defer the entries whose leaves are not in the buffer pool, see BPlusTree::EnableChangeBuffer. */
+  void EnableChangeBuffer() {
+    container_.EnableChangeBuffer(BPLUSTREE_TYPE::DEFAULT_CHANGE_BUFFER_CAPACITY,
+                                  BPLUSTREE_TYPE::DEFAULT_MERGE_INTERVAL);
+  }
+
+  /**
+   * Keep a Bloom filter of the keys, which point lookups, and prefix scans over every key column, ask before they
+   * descend the tree, see BPlusTree::EnableBloomFilter. The index must be empty.
+   */
+  void EnableBloomFilter(size_t expected_keys = BloomFilter::DEFAULT_EXPECTED_KEYS) {
+    container_.EnableBloomFilter(expected_keys);
+  }
+
+  /** Fill the Bloom filter again from the keys in the index, see BPlusTree::RebuildBloomFilter. */
+  void RebuildBloomFilter() { container_.RebuildBloomFilter(); }
+
+  /** @return the Bloom filter of the index, nullptr if it has none */
+  auto GetBloomFilter() const -> BloomFilter * { return container_.GetBloomFilter(); }
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  /** @return the key tuple that the index key was made from, the inverse of MakeKey */
+  auto KeyToTuple(const KeyType &index_key) const -> Tuple;
+
  protected:
+  /** @return the index key of the key tuple, normalized if KeyComparator compares bytes */
+  auto MakeKey(const Tuple &key) const -> KeyType;
+
+  /**
+   * Set key to the leading key columns holding the prefix values, with the other columns zero.
+   * @return the length of the encoding of the prefix, or the size of the key if it is not normalized
+   * @throws NotImplementedException if a key that is not normalized cannot be set from the prefix alone
+   */
+  auto MakePrefixKey(const std::vector<Value> &prefix, KeyType *key) const -> size_t;
+
+  /** @return the number of entries before the bound, or up to and including it if after is set */
+  auto BoundRank(const IndexBound &bound, bool after) -> size_t;
+
+  /**
+   * Set key to the smallest normalized key at or past the bound, or past every key that starts with the bound if
+   * after is set.
+   * @return false if no key is past the bound
+   */
+  auto BoundKey(const IndexBound &bound, bool after, KeyType *key) const -> bool;
+
   // comparator for key
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
+  // whether the optimizer scans ranges of the index, see EnableRangeScans
+  bool range_scans_{false};
 };
 
-/** We only support index table with one integer key for now in BusTub. Hardcode everything here. */
+/**
+ * The index types for one integer key, hardcoded for the tests. The keys are normalized so that they compare with
+ * memcmp. CREATE INDEX picks the smallest GenericKey that fits its key schema instead, see NormalizedKeySize.
+ */
 
 constexpr static const auto INTEGER_SIZE = 4;
 using IntegerKeyType = GenericKey<INTEGER_SIZE>;
 using IntegerValueType = RID;
-using IntegerComparatorType = GenericComparator<INTEGER_SIZE>;
+using IntegerComparatorType = MemcmpComparator<INTEGER_SIZE>;
 using BPlusTreeIndexForOneIntegerColumn = BPlusTreeIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
 using BPlusTreeIndexIteratorForOneIntegerColumn =
     IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
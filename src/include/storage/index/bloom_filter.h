@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/storage/index/bloom_filter.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+/**
+ * BloomFilter tells an index which keys it surely does not hold, so that a probe for a missing key returns
+ * before it reads a page.
+ *
+ * The filter is blocked: the bits of a key all lie in one block of a cache line, so a probe touches a single
+ * line. It sees keys only by their hash, which equal keys must share.
+ *
+ * The filter grows with the keys. It starts with one layer sized for the expected number of keys, and once a
+ * layer holds as many keys as it was sized for, new keys go to a layer twice as large; a probe checks every
+ * layer. Removed keys stay in the filter, which makes it answer "maybe" more often, until it is cleared and
+ * filled again from the index.
+ *
+ * Inserts and probes take no lock. Only adding a layer does, and layers are not freed before Clear.
+ */
+class BloomFilter {
+ public:
+  /** The number of keys the first layer is sized for by default. */
+  static constexpr size_t DEFAULT_EXPECTED_KEYS = 1024;
+  /** The number of bits per key a layer has, for about one false positive in a hundred. */
+  static constexpr size_t BITS_PER_KEY = 10;
+  /** The number of bits a key sets in its block. */
+  static constexpr size_t NUM_PROBES = 6;
+
+  /** @param expected_keys the number of keys the first layer is sized for */
+  explicit BloomFilter(size_t expected_keys = DEFAULT_EXPECTED_KEYS);
+
+  /** Add the key with the hash. */
+  void Insert(uint64_t hash);
+
+  /** @return false if no key with the hash was inserted, true if one may have been */
+  auto MayContain(uint64_t hash) -> bool;
+
+  /** Drop every key and start over with one layer sized for expected_keys. Not safe while other operations run. */
+  void Clear(size_t expected_keys);
+
+  /** @return the number of keys inserted since the filter was created or cleared */
+  auto GetKeyCount() const -> size_t;
+
+  /** @return the number of layers */
+  auto GetLayerCount() const -> size_t { return num_layers_; }
+
+  /** @return the bytes of the bits of every layer */
+  auto GetMemoryUsage() const -> size_t;
+
+  /** @return the number of probes that the filter answered with false */
+  auto GetSkipCount() const -> size_t { return skips_; }
+
+ private:
+  /** A layer has at most this many times as many keys as the first one, 2^31 times. */
+  static constexpr size_t MAX_LAYERS = 32;
+  static constexpr size_t WORDS_PER_BLOCK = 8;
+
+  struct alignas(64) Block {
+    std::array<std::atomic<uint64_t>, WORDS_PER_BLOCK> words_;
+  };
+
+  struct Layer {
+    size_t capacity_;
+    size_t num_blocks_;
+    std::unique_ptr<Block[]> blocks_;
+    std::atomic<size_t> keys_{0};
+  };
+
+  static auto MakeLayer(size_t capacity) -> std::unique_ptr<Layer>;
+
+  /** @return the block of the layer that the key with the hash sets its bits in */
+  static auto BlockOf(const Layer &layer, uint64_t hash) -> Block &;
+
+  std::array<std::unique_ptr<Layer>, MAX_LAYERS> layers_;
+  std::atomic<size_t> num_layers_{0};
+  std::mutex grow_latch_;
+  std::atomic<size_t> skips_{0};
+};
+
+}  // namespace bustub
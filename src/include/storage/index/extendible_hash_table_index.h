@@ -14,17 +14,24 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "container/disk/hash/disk_extendible_hash_table.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/bloom_filter.h"
 #include "storage/index/index.h"
 
 namespace bustub {
 
 #define HASH_TABLE_INDEX_TYPE ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * An index over a disk-based extendible hash table, which finds the entries of a key in two page reads, the directory
+ * and the bucket, where a b+ tree reads a page per level. It keeps no key order, so it only serves lookups of whole
+ * keys. CREATE INDEX ... USING hash builds one.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTableIndex : public Index {
  public:
@@ -39,9 +46,32 @@ class ExtendibleHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  auto HasOrderedScans() const -> bool override { return false; }
+
+  auto HasPointLookups() const -> bool override { return true; }
+
+  /** Finds the entries of a whole key, the prefix must hold every key column. */
+  auto GetPrefixIterator(const std::vector<Value> &prefix, Transaction *transaction)
+      -> std::unique_ptr<IndexScanIterator> override;
+
+  /** Finds the entries of a single-column key, the range must hold only that key. */
+  auto GetRangeIterator(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                        Transaction *transaction) -> std::unique_ptr<IndexScanIterator> override;
+
+  /** Keep a Bloom filter of the keys, which ScanKey asks before it probes the table. The index must be empty. */
+  void EnableBloomFilter(size_t expected_keys = BloomFilter::DEFAULT_EXPECTED_KEYS) {
+    bloom_filter_ = std::make_unique<BloomFilter>(expected_keys);
+  }
+
+  /** @return the Bloom filter of the index, nullptr if it has none */
+  auto GetBloomFilter() const -> BloomFilter * { return bloom_filter_.get(); }
+
  protected:
   // comparator for key
   KeyComparator comparator_;
+  // the hash of the keys in the Bloom filter
+  HashFunction<KeyType> hash_fn_;
+  std::unique_ptr<BloomFilter> bloom_filter_;
   // container
   DiskExtendibleHashTable<KeyType, ValueType, KeyComparator> container_;
 };
@@ -12,8 +12,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
 
+#include "common/exception.h"
+#include "storage/page/b_plus_tree_key_search.h"
+#include "storage/page/b_plus_tree_key_store.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -35,10 +42,129 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  /**
+   * Set the key to the normalized encoding of the key tuple, whose bytes sort
+   * the same way as the column values (see MemcmpComparator). Integers are
+   * stored big endian with the sign bit flipped, doubles with the sign bit or
+   * all bits flipped, and strings as a 0x01 marker, their bytes with 0x00
+   * escaped as 0x00 0xFF, and a 0x00 0x00 terminator. A NULL string is a lone
+   * 0x00; the NULL of the other types is already their smallest value.
+   * @return the length of the encoding, the remaining bytes are zero
+   * @throws Exception if the encoding does not fit KeySize bytes
+   */
+  inline auto SetFromKey(const Tuple &tuple, const Schema &key_schema) -> size_t {
+    memset(data_, 0, KeySize);
+    size_t offset = 0;
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+      Value value = tuple.GetValue(&key_schema, i);
+      switch (value.GetTypeId()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          PutBigEndian(&offset, static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80U, 1);
+          break;
+        case TypeId::SMALLINT:
+          PutBigEndian(&offset, static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000U, 2);
+          break;
+        case TypeId::INTEGER:
+          PutBigEndian(&offset, static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000U, 4);
+          break;
+        case TypeId::BIGINT:
+          PutBigEndian(&offset, static_cast<uint64_t>(value.GetAs<int64_t>()) ^ (1ULL << 63), 8);
+          break;
+        case TypeId::TIMESTAMP:
+          PutBigEndian(&offset, value.GetAs<uint64_t>(), 8);
+          break;
+        case TypeId::DECIMAL: {
+          auto number = value.GetAs<double>();
+          uint64_t bits;
+          memcpy(&bits, &number, sizeof(bits));
+          PutBigEndian(&offset, (bits >> 63) != 0 ? ~bits : bits ^ (1ULL << 63), 8);
+          break;
+        }
+        case TypeId::VARCHAR: {
+          if (value.IsNull()) {
+            PutByte(&offset, 0x00);
+            break;
+          }
+          PutByte(&offset, 0x01);
+          const char *str = value.GetData();
+          for (uint32_t j = 0; j + 1 < value.GetLength(); j++) {
+            PutByte(&offset, static_cast<uint8_t>(str[j]));
+            if (str[j] == 0) {
+              PutByte(&offset, 0xFF);
+            }
+          }
+          PutByte(&offset, 0x00);
+          PutByte(&offset, 0x00);
+          break;
+        }
+        default:
+          throw Exception(ExceptionType::NOT_IMPLEMENTED, "type cannot be used in a normalized index key");
+      }
+    }
+    return offset;
+  }
+
+  /**
+   * Decode a key set by SetFromKey(tuple, key_schema) back into its column values.
+   * @return the values of the key columns, in key_schema order
+   */
+  inline auto ToValues(const Schema &key_schema) const -> std::vector<Value> {
+    std::vector<Value> values;
+    values.reserve(key_schema.GetColumnCount());
+    size_t offset = 0;
+    for (const auto &column : key_schema.GetColumns()) {
+      switch (column.GetType()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          values.emplace_back(column.GetType(), static_cast<int8_t>(GetBigEndian(&offset, 1) ^ 0x80U));
+          break;
+        case TypeId::SMALLINT:
+          values.emplace_back(column.GetType(), static_cast<int16_t>(GetBigEndian(&offset, 2) ^ 0x8000U));
+          break;
+        case TypeId::INTEGER:
+          values.emplace_back(column.GetType(), static_cast<int32_t>(GetBigEndian(&offset, 4) ^ 0x80000000U));
+          break;
+        case TypeId::BIGINT:
+          values.emplace_back(column.GetType(), static_cast<int64_t>(GetBigEndian(&offset, 8) ^ (1ULL << 63)));
+          break;
+        case TypeId::TIMESTAMP:
+          values.emplace_back(column.GetType(), GetBigEndian(&offset, 8));
+          break;
+        case TypeId::DECIMAL: {
+          auto bits = GetBigEndian(&offset, 8);
+          bits = (bits >> 63) != 0 ? bits ^ (1ULL << 63) : ~bits;
+          double number;
+          memcpy(&number, &bits, sizeof(number));
+          values.emplace_back(column.GetType(), number);
+          break;
+        }
+        case TypeId::VARCHAR: {
+          if (data_[offset++] == 0) {
+            values.emplace_back(column.GetType(), nullptr, 0, false);
+            break;
+          }
+          std::string str;
+          // an escaped zero is followed by 0xFF, the terminator by another zero
+          while (data_[offset] != 0 || static_cast<uint8_t>(data_[offset + 1]) == 0xFF) {
+            str.push_back(data_[offset]);
+            offset += data_[offset] == 0 ? 2 : 1;
+          }
+          offset += 2;
+          values.emplace_back(column.GetType(), str);
+          break;
+        }
+        default:
+          throw Exception(ExceptionType::NOT_IMPLEMENTED, "type cannot be used in a normalized index key");
+      }
+    }
+    return values;
+  }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    memcpy(data_, &key, std::min(sizeof(int64_t), KeySize));
   }
 
   inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
@@ -68,8 +194,64 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  inline void PutByte(size_t *offset, uint8_t byte) {
+    if (*offset == KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "normalized index key is larger than the key size");
+    }
+    data_[(*offset)++] = static_cast<char>(byte);
+  }
+
+  inline void PutBigEndian(size_t *offset, uint64_t value, size_t width) {
+    for (size_t shift = width * 8; shift > 0; shift -= 8) {
+      PutByte(offset, static_cast<uint8_t>(value >> (shift - 8)));
+    }
+  }
+
+  inline auto GetBigEndian(size_t *offset, size_t width) const -> uint64_t {
+    uint64_t value = 0;
+    for (size_t i = 0; i < width; i++) {
+      value = (value << 8) | static_cast<uint8_t>(data_[(*offset)++]);
+    }
+    return value;
+  }
 };
 
+/**
+ * @return the length of the normalized keys of key_schema, see GenericKey::SetFromKey. Strings are
+ * counted at their declared length without escapes; a longer key is rejected when it is set.
+ * @throws Exception if a column type cannot be normalized
+ */
+inline auto NormalizedKeySize(const Schema &key_schema) -> size_t {
+  size_t size = 0;
+  for (const auto &column : key_schema.GetColumns()) {
+    switch (column.GetType()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        size += 1;
+        break;
+      case TypeId::SMALLINT:
+        size += 2;
+        break;
+      case TypeId::INTEGER:
+        size += 4;
+        break;
+      case TypeId::BIGINT:
+      case TypeId::TIMESTAMP:
+      case TypeId::DECIMAL:
+        size += 8;
+        break;
+      case TypeId::VARCHAR:
+        size += 1 + column.GetLength() + 2;
+        break;
+      default:
+        throw Exception(ExceptionType::NOT_IMPLEMENTED, "type cannot be used in a normalized index key");
+    }
+  }
+  return size;
+}
+
 /**
  * Function object returns true if lhs < rhs, used for trees
  */
@@ -103,4 +285,71 @@ class GenericComparator {
   Schema *key_schema_;
 };
 
+/**
+ * Function object comparing keys set by GenericKey::SetFromKey(tuple, schema)
+ * byte by byte, which orders them the same way as GenericComparator orders the
+ * plain keys without decoding a Value per column.
+ */
+template <size_t KeySize>
+class MemcmpComparator {
+ public:
+  inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    int result = memcmp(lhs.data_, rhs.data_, KeySize);
+    return (result > 0) - (result < 0);
+  }
+
+  MemcmpComparator(const MemcmpComparator &other) = default;
+
+  // the key schema is only taken for the same construction as GenericComparator
+  explicit MemcmpComparator(Schema * /*key_schema*/) {}
+};
+
+/** Whether the keys of KeyComparator are normalized, see GenericKey::SetFromKey. */
+template <typename KeyComparator>
+struct IsNormalizedKey {
+  static constexpr bool VALUE = false;
+};
+
+template <size_t KeySize>
+struct IsNormalizedKey<MemcmpComparator<KeySize>> {
+  static constexpr bool VALUE = true;
+};
+
+/** Any prefix of a normalized key sorts between the keys it was cut from. */
+template <size_t KeySize>
+struct KeyTruncation<MemcmpComparator<KeySize>> {
+  static constexpr bool ENABLED = true;
+};
+
+/**
+ * A normalized key of 4 or 8 bytes compares like the unsigned big endian
+ * integer of its bytes, and so like that integer with the sign bit flipped
+ * under a signed comparison, whatever columns it encodes.
+ */
+template <size_t KeySize>
+struct IntegerKeyLayout<GenericKey<KeySize>, MemcmpComparator<KeySize>> {
+  static constexpr bool ENABLED = KeySize == 4 || KeySize == 8;
+  using IntType = std::conditional_t<KeySize == 8, int64_t, int32_t>;
+  using UIntType = std::make_unsigned_t<IntType>;
+  static constexpr UIntType SIGN_BIT = UIntType{1} << (sizeof(IntType) * 8 - 1);
+
+  static auto ToInt(const GenericKey<KeySize> &key) -> IntType {
+    UIntType bits = 0;
+    for (size_t i = 0; i < sizeof(IntType); i++) {
+      bits = static_cast<UIntType>(bits << 8) | static_cast<uint8_t>(key.data_[i]);
+    }
+    return static_cast<IntType>(bits ^ SIGN_BIT);
+  }
+
+  static auto FromInt(IntType value) -> GenericKey<KeySize> {
+    auto bits = static_cast<UIntType>(value) ^ SIGN_BIT;
+    GenericKey<KeySize> key;
+    memset(key.data_, 0, KeySize);
+    for (size_t i = 0; i < sizeof(IntType); i++) {
+      key.data_[i] = static_cast<char>(bits >> ((sizeof(IntType) - 1 - i) * 8));
+    }
+    return key;
+  }
+};
+
 }  // namespace bustub
@@ -12,19 +12,27 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
+#include "execution/expressions/abstract_expression.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
 namespace bustub {
 
+class TableHeap;
 class Transaction;
 
+/** The data structure of an index, which CREATE INDEX ... USING picks. */
+enum class IndexType { BPlusTree, LSMTree, AdaptiveRadixTree, Trie, PiecewiseGeometricModel, ExtendibleHash };
+
 /**
  * class IndexMetadata - Holds metadata of an index object.
  *
@@ -96,6 +104,47 @@ class IndexMetadata {
   std::shared_ptr<Schema> key_schema_;
 };
 
+/**
+ * struct IndexBound - One end of a range over the leading key column of an index.
+ */
+struct IndexBound {
+  /** The value of the leading key column at this end of the range */
+  Value value_;
+  /** Whether the entries whose leading key column equals value_ are in the range */
+  bool inclusive_;
+};
+
+/**
+ * class IndexScanIterator - Cursor over the entries of an index in key order.
+ *
+ * The cursor hides the key type of the index, so executors can scan any index
+ * the same way. A forward scan reads GetRID() and calls Next() until IsEnd();
+ * a backward scan starts past the last entry and calls Prev() before reading,
+ * until IsBegin().
+ */
+class IndexScanIterator {
+ public:
+  virtual ~IndexScanIterator() = default;
+
+  /** @return true if the cursor is past the last entry of the scan */
+  virtual auto IsEnd() -> bool = 0;
+
+  /** @return true if the cursor is at the first entry of the scan */
+  virtual auto IsBegin() -> bool = 0;
+
+  /** @return the RID of the entry under the cursor */
+  virtual auto GetRID() -> RID = 0;
+
+  /** @return the key of the entry under the cursor, a tuple of the key schema */
+  virtual auto GetKey() -> Tuple = 0;
+
+  /** Move the cursor to the next entry. */
+  virtual void Next() = 0;
+
+  /** Move the cursor to the previous entry. */
+  virtual void Prev() = 0;
+};
+
 /////////////////////////////////////////////////////////////////////
 // Index class definition
 /////////////////////////////////////////////////////////////////////
@@ -162,7 +211,7 @@ class Index {
   /**
    * Delete an index entry by key.
    * @param key The index key
-   * @param rid The RID associated with the key (unused)
+   * @param rid The RID associated with the key, entries of other RIDs under the same key are kept
    * @param transaction The transaction context
    */
   virtual void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
@@ -170,11 +219,166 @@ class Index {
   /**
    * Search the index for the provided key.
    * @param key The index key
-   * @param result The collection of RIDs that is populated with results of the search
+   * @param result The collection of RIDs that is populated with every match of the key
    * @param transaction The transaction context
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  ///////////////////////////////////////////////////////////////////
+  // Ordered Scan
+  ///////////////////////////////////////////////////////////////////
+
+  /**
+   * @return Whether the index keeps its entries in key order, so that GetScanIterator works and GetPrefixIterator
+   * takes any number of leading key columns; an index without order only finds whole keys
+   */
+  virtual auto HasOrderedScans() const -> bool { return true; }
+
+  /**
+   * @return Whether the index finds the entries of a whole key in a fixed number of page reads, however many entries
+   * it has, so that an equality on every key column is best answered by this index
+   */
+  virtual auto HasPointLookups() const -> bool { return false; }
+
+  /**
+   * Scan every entry of the index in key order.
+   * @param from_end Whether the cursor starts past the last entry, for a backward scan
+   * @return The cursor of the scan
+   */
+  virtual auto GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> {
+    (void)from_end;
+    throw NotImplementedException("index does not support ordered scans");
+  }
+
+  /**
+   * Scan the entries whose leading key columns equal the given values, in key order.
+   * @param prefix The values of the first prefix.size() key columns
+   * @param transaction The transaction context
+   * @return The forward cursor of the scan
+   */
+  virtual auto GetPrefixIterator(const std::vector<Value> &prefix, Transaction *transaction)
+      -> std::unique_ptr<IndexScanIterator> {
+    (void)prefix;
+    (void)transaction;
+    throw NotImplementedException("index does not support prefix scans");
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Order Statistics
+  ///////////////////////////////////////////////////////////////////
+
+  /** @return Whether the index counts its entries per subtree, so that CountRange and GetRankIterator are cheap */
+  virtual auto HasSubtreeCounts() const -> bool { return false; }
+
+  /**
+   * Count the entries whose leading key column lies between the bounds. Entries with a NULL leading key column
+   * are only counted if there are no bounds at all.
+   * @param lower The lower end of the range, or none
+   * @param upper The upper end of the range, or none
+   * @param transaction The transaction context
+   * @return The number of entries in the range
+   */
+  virtual auto CountRange(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                          Transaction *transaction) -> size_t {
+    (void)lower;
+    (void)upper;
+    (void)transaction;
+    throw NotImplementedException("index does not support range counts");
+  }
+
+  /**
+   * Scan the entries of the index in key order, starting after the first rank entries.
+   * @param rank The number of entries before the cursor
+   * @param transaction The transaction context
+   * @return The cursor of the scan, past the last entry if the index holds no more than rank entries
+   */
+  virtual auto GetRankIterator(size_t rank, Transaction *transaction) -> std::unique_ptr<IndexScanIterator> {
+    (void)rank;
+    (void)transaction;
+    throw NotImplementedException("index does not support seeks by rank");
+  }
+
+  /**
+   * Scan every entry of the index in key order like GetScanIterator does, without the first offset entries of the
+   * scan. Needs subtree counts unless offset is zero.
+   * @param from_end Whether the cursor starts past the last entry, for a backward scan
+   * @param offset The number of entries the scan leaves out
+   * @param transaction The transaction context
+   * @return The cursor of the scan
+   */
+  auto GetOffsetScanIterator(bool from_end, size_t offset, Transaction *transaction)
+      -> std::unique_ptr<IndexScanIterator> {
+    if (offset == 0) {
+      return GetScanIterator(from_end);
+    }
+    if (!from_end) {
+      return GetRankIterator(offset, transaction);
+    }
+    // a backward scan starts past the last entry it reads
+    auto size = CountRange(std::nullopt, std::nullopt, transaction);
+    return GetRankIterator(size - std::min(offset, size), transaction);
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Range Scan
+  ///////////////////////////////////////////////////////////////////
+
+  /** @return Whether the index finds the start of a range directly, so that GetRangeIterator beats a full scan */
+  virtual auto HasRangeScans() const -> bool { return false; }
+
+  /**
+   * Scan the entries whose leading key column lies between the bounds, in key order. Entries with a NULL leading
+   * key column are only scanned if there are no bounds at all.
+   * @param lower The lower end of the range, or none
+   * @param upper The upper end of the range, or none
+   * @param transaction The transaction context
+   * @return The forward cursor of the scan
+   */
+  virtual auto GetRangeIterator(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                                Transaction *transaction) -> std::unique_ptr<IndexScanIterator> {
+    (void)lower;
+    (void)upper;
+    (void)transaction;
+    throw NotImplementedException("index does not support range scans");
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Rebuild
+  ///////////////////////////////////////////////////////////////////
+
+  /** @return Whether the index lives outside the buffer pool, and so has to be rebuilt from its table at startup */
+  virtual auto IsInMemory() const -> bool { return false; }
+
+  /**
+   * Replace the entries of the index with those of the tuples in the table. Must not run along with other
+   * operations on the index.
+   * @param table_heap The table the index is on
+   * @param tuple_schema The schema of the tuples of the table
+   * @param predicate The predicate of a partial index, which the tuples it holds satisfy, or nullptr
+   * @param transaction The transaction context
+   */
+  virtual void Rebuild(TableHeap *table_heap, const Schema &tuple_schema, const AbstractExpression *predicate,
+                       Transaction *transaction) {
+    (void)table_heap;
+    (void)tuple_schema;
+    (void)predicate;
+    (void)transaction;
+    throw NotImplementedException("index cannot be rebuilt");
+  }
+
+  /**
+   * @return Whether a partial index with the predicate holds the tuple, which an index without one always does. A
+   * predicate that is null for the tuple, like a filter, leaves it out.
+   */
+  static auto SatisfiesPredicate(const AbstractExpression *predicate, const Tuple &tuple, const Schema &tuple_schema)
+      -> bool {
+    if (predicate == nullptr) {
+      return true;
+    }
+    auto value = predicate->Evaluate(&tuple, tuple_schema);
+    return !value.IsNull() && value.GetAs<bool>();
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
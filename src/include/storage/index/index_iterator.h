@@ -13,8 +13,11 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
 #include "common/logger.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
@@ -27,27 +30,52 @@ class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
   IndexIterator(LeafPage *leaf, int index, BufferPoolManager *bpm);
+  // the iterator owns the pin of its leaf, so it can only be moved
+  IndexIterator(const IndexIterator &) = delete;
+  IndexIterator(IndexIterator &&other) noexcept;
+  auto operator=(const IndexIterator &) -> IndexIterator & = delete;
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator &;
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
 
+  /** @return whether the iterator is at the first pair of the tree, where operator-- may not go further */
+  auto IsBegin() -> bool;
+
   auto IsInvaildIndexIter() -> bool;
 
   auto operator*() -> const MappingType &;
 
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { return leaf_ == itr.leaf_ && index_ == itr.index_; }
+  auto operator--() -> IndexIterator &;
+
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return leaf_ == itr.leaf_ && index_ == itr.index_ && posting_idx_ == itr.posting_idx_;
+  }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { return leaf_ != itr.leaf_ || index_ != itr.index_; }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  protected:
   LeafPage *leaf_;
   int index_;
+  // position inside the posting chain of a duplicated key, 0 otherwise
+  size_t posting_idx_{0};
 
  private:
+  // move on to the next leaf that has pairs, unless the iterator is at the end of the tree
+  void SkipExhaustedLeaves();
+
+  // load the posting chain of the current slot, if it refers to one
+  void SyncPostings();
+
+  // unpin the leaf the iterator stands on
+  void Release();
+
   // add your own private member variables here
   BufferPoolManager *bpm_;
+  std::vector<ValueType> postings_;
+  MappingType current_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_key.h
+//
+// Identification: src/include/storage/index/index_key.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <numeric>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/index/generic_key.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Conversions between key tuples and the keys that ordered indexes store, shared by the index types. A key is
+ * normalized if KeyComparator compares bytes, see IsNormalizedKey.
+ */
+
+/** @return the index key of the key tuple */
+template <typename KeyType, typename KeyComparator>
+auto MakeIndexKey(const Tuple &key, const Schema &key_schema) -> KeyType {
+  KeyType index_key;
+  if constexpr (IsNormalizedKey<KeyComparator>::VALUE) {
+    index_key.SetFromKey(key, key_schema);
+  } else {
+    index_key.SetFromKey(key);
+  }
+  return index_key;
+}
+
+/** @return the key tuple that the index key was made from, the inverse of MakeIndexKey */
+template <typename KeyType, typename KeyComparator>
+auto IndexKeyToTuple(const KeyType &index_key, Schema *key_schema) -> Tuple {
+  std::vector<Value> values;
+  if constexpr (IsNormalizedKey<KeyComparator>::VALUE) {
+    values = index_key.ToValues(*key_schema);
+  } else {
+    values.reserve(key_schema->GetColumnCount());
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      values.push_back(index_key.ToValue(key_schema, i));
+    }
+  }
+  return {values, key_schema};
+}
+
+/**
+ * Set key to the leading key columns holding the prefix values, with the other columns zero.
+ * @return the length of the encoding of the prefix, or the size of the key if it is not normalized
+ * @throws NotImplementedException if a key that is not normalized cannot be set from the prefix alone
+ */
+template <typename KeyType, typename KeyComparator>
+auto MakeIndexPrefixKey(const std::vector<Value> &prefix, const Schema *key_schema, KeyType *key) -> size_t {
+  // the prefix values form a tuple of the leading key columns
+  std::vector<uint32_t> prefix_attrs(prefix.size());
+  std::iota(prefix_attrs.begin(), prefix_attrs.end(), 0);
+  auto prefix_schema = Schema::CopySchema(key_schema, prefix_attrs);
+  std::vector<Value> values;
+  values.reserve(prefix.size());
+  for (uint32_t i = 0; i < prefix.size(); i++) {
+    auto type = prefix_schema.GetColumn(i).GetType();
+    values.push_back(prefix[i].GetTypeId() == type ? prefix[i] : prefix[i].CastAs(type));
+  }
+  Tuple prefix_tuple(values, &prefix_schema);
+
+  if constexpr (IsNormalizedKey<KeyComparator>::VALUE) {
+    return key->SetFromKey(prefix_tuple, prefix_schema);
+  } else {
+    if (prefix.size() != key_schema->GetColumnCount()) {
+      throw NotImplementedException("key prefixes need a normalized index key");
+    }
+    *key = MakeIndexKey<KeyType, KeyComparator>(prefix_tuple, *key_schema);
+    return sizeof(KeyType);
+  }
+}
+
+/**
+ * @return whether the key starts with the prefix that MakeIndexPrefixKey encoded into prefix_key, in length bytes
+ * if the key is normalized
+ */
+template <typename KeyType, typename KeyComparator>
+auto IndexKeyHasPrefix(const KeyType &key, const KeyType &prefix_key, size_t length, const KeyComparator &comparator)
+    -> bool {
+  if constexpr (IsNormalizedKey<KeyComparator>::VALUE) {
+    // the encoding of the leading columns is a byte prefix of the keys, and the zero padding sorts first
+    (void)comparator;
+    return memcmp(reinterpret_cast<const char *>(&key), reinterpret_cast<const char *>(&prefix_key), length) == 0;
+  } else {
+    (void)length;
+    return comparator(key, prefix_key) == 0;
+  }
+}
+
+}  // namespace bustub
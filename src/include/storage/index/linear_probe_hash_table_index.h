@@ -19,6 +19,7 @@
 
 #include "container/disk/hash/linear_probe_hash_table.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/bloom_filter.h"
 #include "storage/index/index.h"
 
 namespace bustub {
@@ -39,9 +40,20 @@ class LinearProbeHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Keep a Bloom filter of the keys, which ScanKey asks before it probes the table. The index must be empty. */
+  void EnableBloomFilter(size_t expected_keys = BloomFilter::DEFAULT_EXPECTED_KEYS) {
+    bloom_filter_ = std::make_unique<BloomFilter>(expected_keys);
+  }
+
+  /** @return the Bloom filter of the index, nullptr if it has none */
+  auto GetBloomFilter() const -> BloomFilter * { return bloom_filter_.get(); }
+
  protected:
   // comparator for key
   KeyComparator comparator_;
+  // the hash of the keys in the Bloom filter
+  HashFunction<KeyType> hash_fn_;
+  std::unique_ptr<BloomFilter> bloom_filter_;
   // container
   LinearProbeHashTable<KeyType, ValueType, KeyComparator> container_;
 };
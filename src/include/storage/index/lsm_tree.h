@@ -0,0 +1,267 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree.h
+//
+// Identification: src/include/storage/index/lsm_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
+#include "container/hash/hash_function.h"
+#include "storage/page/b_plus_tree_page.h"
+#include "storage/page/lsm_run_page.h"
+
+namespace bustub {
+
+#define LSMTREE_TYPE LSMTree<KeyType, ValueType, KeyComparator>
+#define LSMRUN_TYPE LSMRun<KeyType, ValueType, KeyComparator>
+#define LSMTREE_ITERATOR_TYPE LSMTreeIterator<KeyType, ValueType, KeyComparator>
+
+/**
+ * An immutable sorted run of an LSM tree, in pages of the buffer pool. The
+ * first key of every page and a bloom filter over the keys stay in memory, so
+ * that a lookup reads no page of a run that cannot hold its key, and one or
+ * two pages of a run that can. The pages are freed with the run, once the
+ * tree and every iterator are done with it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMRun {
+  using Entry = LSMEntry<KeyType, ValueType>;
+  using RunPage = LSMRunPage<KeyType, ValueType>;
+
+ public:
+  /** Start a new run of up to max_size entries, which Append writes in order until Seal ends the run. */
+  LSMRun(BufferPoolManager *bpm, const KeyComparator &comparator, HashFunction<KeyType> hash_fn, size_t max_size);
+
+  LSMRun(const LSMRun &) = delete;
+  auto operator=(const LSMRun &) -> LSMRun & = delete;
+  ~LSMRun();
+
+  /** Add an entry after the others, it must sort after them. */
+  void Append(const Entry &entry);
+
+  /** Write out the last page, the run is complete. */
+  void Seal();
+
+  auto GetSize() const -> size_t { return size_; }
+
+  /** @return false if no entry of the run has key, true if one may have it */
+  auto MayContain(const KeyType &key) const -> bool;
+
+  /** @return the index of the first entry whose key is not less than key, the size if there is none */
+  auto LowerBound(const KeyType &key) const -> size_t;
+
+  /** Replace the entries in page with those of the run page that holds the entry at index. */
+  void ReadPage(size_t index, std::vector<Entry> *page) const;
+
+  /** The number of entries in every page but the last. */
+  static constexpr size_t PAGE_CAPACITY = RunPage::MAX_SIZE;
+
+ private:
+  auto BloomBit(uint64_t hash, size_t i) const -> size_t;
+
+  static constexpr size_t BLOOM_BITS_PER_KEY = 10;
+  static constexpr size_t BLOOM_HASH_COUNT = 6;
+
+  BufferPoolManager *bpm_;
+  KeyComparator comparator_;
+  // GetHash is not const, but keeps no state
+  mutable HashFunction<KeyType> hash_fn_;
+  size_t size_{0};
+  // the page Append writes to, pinned until the next page or Seal
+  Page *tail_page_{nullptr};
+  std::vector<page_id_t> page_ids_;
+  // the first key of every page
+  std::vector<KeyType> fence_keys_;
+  std::vector<uint64_t> bloom_;
+};
+
+/**
+ * Cursor over the entries of an LSM tree in key order, then in value order.
+ *
+ * It merges a copy of the memory table with the runs that were in the tree
+ * when it was made, newest first, and so does not see later changes. Of the
+ * entries with the same key and value, the newest one counts; a tombstone
+ * hides the older entries and is not shown itself, unless the cursor keeps
+ * tombstones for a compaction. A run is read a page at a time.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMTreeIterator {
+  using Entry = LSMEntry<KeyType, ValueType>;
+  using Run = LSMRun<KeyType, ValueType, KeyComparator>;
+
+ public:
+  /**
+   * @param memtable the entries of the memory table, sorted, or only those the scan may reach
+   * @param runs the runs, newest first
+   * @param key the key of the first entry, or nullptr to start at the first entry of the tree
+   * @param at_end whether the cursor starts past the last entry, for a backward scan
+   */
+  LSMTreeIterator(const KeyComparator &comparator, std::vector<Entry> &&memtable,
+                  std::vector<std::shared_ptr<const Run>> &&runs, const KeyType *key, bool at_end,
+                  bool keep_tombstones = false);
+
+  /** @return true if the cursor is past the last entry */
+  auto IsEnd() const -> bool { return current_source_ == NO_SOURCE; }
+
+  /** @return true if no entry comes before the one under the cursor */
+  auto IsBegin() -> bool;
+
+  /** @return whether the entry under the cursor is a tombstone, only if the cursor keeps them */
+  auto IsTombstone() -> bool { return EntryAt(current_source_, positions_[current_source_]).tombstone_; }
+
+  auto operator*() -> const MappingType &;
+
+  auto operator++() -> LSMTreeIterator &;
+
+  auto operator--() -> LSMTreeIterator &;
+
+ private:
+  /** The entries of the memory table or of a run, with the page of the run that was read last. */
+  struct Source {
+    std::shared_ptr<const Run> run_;
+    std::vector<Entry> entries_;
+    size_t size_;
+    // the index of the first entry in entries_, if they are a page of the run
+    size_t page_begin_;
+  };
+
+  static constexpr size_t NO_SOURCE = static_cast<size_t>(-1);
+
+  auto EntryAt(size_t source, size_t index) -> const Entry &;
+  auto Compare(const Entry &lhs, const Entry &rhs) const -> int;
+
+  // Settle on the smallest entry at the cursors that is shown.
+  void SettleForward();
+  // Move the cursor of every source that is at the current entry past it.
+  void StepPastCurrent();
+  // Move positions onto the last shown entry before them. @return its newest source, or NO_SOURCE if there is none
+  auto StepBackward(std::vector<size_t> *positions) -> size_t;
+
+  KeyComparator comparator_;
+  bool keep_tombstones_;
+  std::vector<Source> sources_;
+  // the index of the first entry of every source that is not less than the current entry
+  std::vector<size_t> positions_;
+  // the newest source that holds the current entry, NO_SOURCE past the last entry
+  size_t current_source_{NO_SOURCE};
+  // the positions of the previous entry and its source, once IsBegin looked for it
+  bool has_prev_{false};
+  std::vector<size_t> prev_positions_;
+  size_t prev_source_{NO_SOURCE};
+  MappingType current_;
+};
+
+/**
+ * Log-structured merge tree, a write-optimized index.
+ *
+ * Inserts and removes go into a sorted memory table; a remove leaves a
+ * tombstone. A full memory table is written out as a sorted run, page after
+ * page, so that a change costs a share of a sequential write instead of a
+ * random leaf write. Runs are tiered into levels: once a level holds fanout
+ * runs, they are merged into one run of the next level, and a merge into the
+ * oldest run drops its tombstones. A lookup reads the memory table and the
+ * runs from the newest to the oldest, skipping the runs whose bloom filter
+ * rules its key out.
+ *
+ * Keys may repeat, an entry is a key with a value, which every change names.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMTree {
+  using Entry = LSMEntry<KeyType, ValueType>;
+  using Run = LSMRun<KeyType, ValueType, KeyComparator>;
+
+ public:
+  static constexpr size_t DEFAULT_MEMTABLE_CAPACITY = 4096;
+  static constexpr size_t DEFAULT_FANOUT = 4;
+
+  /**
+   * @param memtable_capacity the number of entries in the memory table that makes it a run
+   * @param fanout the number of runs in a level that are merged into a run of the next level
+   */
+  LSMTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+          HashFunction<KeyType> hash_fn, size_t memtable_capacity = DEFAULT_MEMTABLE_CAPACITY,
+          size_t fanout = DEFAULT_FANOUT);
+
+  // Add the value to the values of key.
+  void Insert(const KeyType &key, const ValueType &value);
+
+  // Remove the value from the values of key.
+  void Remove(const KeyType &key, const ValueType &value);
+
+  // Append the values of key to result. Returns false if it has none.
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  // Iterators over the entries; in_range may tell the entries a forward scan from key stops before, so that they
+  // are not copied from the memory table.
+  auto Begin() -> LSMTREE_ITERATOR_TYPE;
+  auto Begin(const KeyType &key, const std::function<bool(const KeyType &)> &in_range = nullptr)
+      -> LSMTREE_ITERATOR_TYPE;
+  auto End() -> LSMTREE_ITERATOR_TYPE;
+
+  // Write the memory table out as a run, and merge the levels that are full.
+  void Flush();
+
+  // The number of runs in every level, from the newest level.
+  auto GetLevelSizes() -> std::vector<size_t>;
+
+ private:
+  void Put(const KeyType &key, const ValueType &value, bool tombstone);
+  // Write the memory table as a run, the caller holds the latch in write mode.
+  void FlushMemtable();
+  // Merge the levels that hold fanout runs, one after the other.
+  void Compact();
+  auto MakeIterator(const KeyType *key, bool at_end, const std::function<bool(const KeyType &)> &in_range)
+      -> LSMTREE_ITERATOR_TYPE;
+
+  /** Orders the entries of the memory table by key, then by value, and finds them by key alone. */
+  struct EntryLess {
+    using is_transparent = void;
+    KeyComparator comparator_;
+    auto operator()(const std::pair<KeyType, ValueType> &lhs, const std::pair<KeyType, ValueType> &rhs) const
+        -> bool {
+      int cmp = comparator_(lhs.first, rhs.first);
+      return cmp < 0 || (cmp == 0 && lhs.second.Get() < rhs.second.Get());
+    }
+    auto operator()(const std::pair<KeyType, ValueType> &lhs, const KeyType &rhs) const -> bool {
+      return comparator_(lhs.first, rhs) < 0;
+    }
+    auto operator()(const KeyType &lhs, const std::pair<KeyType, ValueType> &rhs) const -> bool {
+      return comparator_(lhs, rhs.first) < 0;
+    }
+  };
+
+  auto SnapshotRuns() -> std::vector<std::shared_ptr<const Run>>;
+
+  // member variable
+  std::string index_name_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  HashFunction<KeyType> hash_fn_;
+  size_t memtable_capacity_;
+  size_t fanout_;
+  // whether each entry of the memory table is a tombstone
+  std::map<std::pair<KeyType, ValueType>, bool, EntryLess> memtable_;
+  // the runs of every level, newest first; a level is newer than the levels after it
+  std::vector<std::vector<std::shared_ptr<const Run>>> levels_;
+  // guards the memory table and the levels, the runs themselves do not change
+  ReaderWriterLatch latch_;
+  // one compaction at a time, so that only Flush adds to the levels while one runs
+  std::mutex compaction_latch_;
+};
+
+}  // namespace bustub
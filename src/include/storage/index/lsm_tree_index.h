@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree_index.h
+//
+// Identification: src/include/storage/index/lsm_tree_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "container/hash/hash_function.h"
+#include "storage/index/index.h"
+#include "storage/index/lsm_tree.h"
+
+namespace bustub {
+
+#define LSMTREE_INDEX_TYPE LSMTreeIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * An index over an LSM tree, for tables that take many more inserts than lookups, see LSMTree. CREATE INDEX ...
+ * USING lsm builds one.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMTreeIndex : public Index {
+ public:
+  LSMTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+               const HashFunction<KeyType> &hash_fn);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  auto GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> override;
+
+  auto GetPrefixIterator(const std::vector<Value> &prefix, Transaction *transaction)
+      -> std::unique_ptr<IndexScanIterator> override;
+
+  /** Write the memory table out as a run, see LSMTree::Flush. */
+  void Flush() { container_.Flush(); }
+
+  /** @return the key tuple that the index key was made from */
+  auto KeyToTuple(const KeyType &index_key) const -> Tuple;
+
+ protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  LSMTree<KeyType, ValueType, KeyComparator> container_;
+};
+
+}  // namespace bustub
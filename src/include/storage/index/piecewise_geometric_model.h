@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// piecewise_geometric_model.h
+//
+// Identification: src/include/storage/index/piecewise_geometric_model.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define PGM_TYPE PiecewiseGeometricModel<KeyType, ValueType, KeyComparator>
+#define PGM_SNAPSHOT_TYPE PiecewiseGeometricModelSnapshot<KeyType, ValueType, KeyComparator>
+#define PGM_ITERATOR_TYPE PiecewiseGeometricModelIterator<KeyType, ValueType, KeyComparator>
+
+/**
+ * A line that predicts the positions of the keys from key_ on, up to the key of the next segment.
+ */
+struct PGMSegment {
+  uint64_t key_;
+  double slope_;
+  size_t position_;
+};
+
+/**
+ * The entries of a piecewise geometric model at one point in time, sorted by key and then by value, with the model
+ * over them. It does not change once built, so readers share it without latches.
+ *
+ * The model has levels of segments. The segments of the lowest level predict where a key is in the entries, off by
+ * at most EPSILON positions, and those of each level above predict which segment of the level below covers a key,
+ * off by at most RECURSIVE_EPSILON. The top level has a single segment. A lookup walks down the levels and searches
+ * around each prediction.
+ *
+ * The model sees the first 8 bytes of a key as a number, which for a key whose leading column is an integer is the
+ * integer itself (see GenericKey::SetFromKey), so tables of integer keys that are spread evenly need few segments.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class PiecewiseGeometricModelSnapshot {
+ public:
+  /** @param entries the entries, sorted by key and then by value */
+  explicit PiecewiseGeometricModelSnapshot(std::vector<MappingType> &&entries);
+
+  auto Size() const -> size_t { return entries_.size(); }
+
+  auto At(size_t position) const -> const MappingType & { return entries_[position]; }
+
+  /** @return the position of the first entry whose key is not less than key */
+  auto LowerBound(const KeyType &key) const -> size_t;
+
+  /** @return the position of the first entry that is not less than entry */
+  auto LowerBound(const MappingType &entry) const -> size_t;
+
+  /** @return the number of segments the model predicts the positions of the entries with */
+  auto GetSegmentCount() const -> size_t { return levels_.empty() ? 0 : levels_[0].size(); }
+
+  /** @return the bytes the entries and the model take up */
+  auto GetMemoryUsage() const -> size_t;
+
+  static auto CompareKeys(const KeyType &lhs, const KeyType &rhs) -> int;
+  static auto CompareEntries(const MappingType &lhs, const MappingType &rhs) -> int;
+
+  /** The most positions a prediction of the lowest level is off by. */
+  static constexpr size_t EPSILON = 32;
+  /** The most positions a prediction of the levels above is off by. */
+  static constexpr size_t RECURSIVE_EPSILON = 4;
+
+ private:
+  /** @return the number the model sees key as */
+  static auto ModelKey(const KeyType &key) -> uint64_t;
+
+  /** @return the position near which the first entry whose model key is not less than x is */
+  auto Predict(uint64_t x) const -> size_t;
+
+  std::vector<MappingType> entries_;
+  /** levels_[0] covers the entries, each level above covers the segments of the one below */
+  std::vector<std::vector<PGMSegment>> levels_;
+};
+
+/**
+ * Cursor over the entries of a snapshot of a piecewise geometric model, between a first and a last position. The
+ * snapshot stays the same however the model changes meanwhile.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class PiecewiseGeometricModelIterator {
+ public:
+  /**
+   * @param begin the position of the first entry of the scan
+   * @param end the position past the last entry of the scan
+   * @param position the position of the cursor
+   */
+  PiecewiseGeometricModelIterator(std::shared_ptr<const PGM_SNAPSHOT_TYPE> snapshot, size_t begin, size_t end,
+                                  size_t position)
+      : snapshot_(std::move(snapshot)), begin_(begin), end_(end), position_(position) {}
+
+  auto IsEnd() const -> bool { return position_ == end_; }
+
+  auto IsBegin() const -> bool { return position_ == begin_; }
+
+  auto operator*() -> const MappingType & { return snapshot_->At(position_); }
+
+  auto operator++() -> PiecewiseGeometricModelIterator & {
+    position_++;
+    return *this;
+  }
+
+  auto operator--() -> PiecewiseGeometricModelIterator & {
+    position_--;
+    return *this;
+  }
+
+ private:
+  std::shared_ptr<const PGM_SNAPSHOT_TYPE> snapshot_;
+  size_t begin_;
+  size_t end_;
+  size_t position_;
+};
+
+/**
+ * A learned index for tables that are loaded once and then mostly read, after the PGM-index of Ferragina and
+ * Vinciguerra: the entries are kept in one sorted array, and piecewise linear models over the keys, with a bounded
+ * error, take the place of the inner nodes of a tree.
+ *
+ * The array does not change in place. Writes are kept aside, in the sets of entries inserted and removed since the
+ * snapshot was built, and lookups of a key look there as well. Once there are too many of them, or a scan or a rank
+ * needs them in order, the snapshot is built again with them merged in.
+ *
+ * Keys must be normalized (see GenericKey::SetFromKey), so that their bytes sort like the keys themselves.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class PiecewiseGeometricModel {
+  static_assert(IsNormalizedKey<KeyComparator>::VALUE, "a piecewise geometric model needs keys that compare by bytes");
+
+ public:
+  PiecewiseGeometricModel();
+
+  // Add the value to the values of key. Returns false if key already has it.
+  auto Insert(const KeyType &key, const ValueType &value) -> bool;
+
+  // Remove the value from the values of key. Returns false if key does not have it.
+  auto Remove(const KeyType &key, const ValueType &value) -> bool;
+
+  // Append the values of key to result. Returns false if it has none.
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  // Replace the entries with the given ones.
+  void BulkLoad(std::vector<MappingType> &&entries);
+
+  // The entries as of now, with the writes kept aside merged in.
+  auto GetSnapshot() -> std::shared_ptr<const PGM_SNAPSHOT_TYPE>;
+
+  // The bytes the snapshot and the writes kept aside take up.
+  auto GetMemoryUsage() -> size_t;
+
+  /** The number of writes kept aside that makes a write build the snapshot again is the largest of MERGE_MIN and
+   * the size of the snapshot divided by MERGE_RATIO, so that rebuilds cost a constant per write. */
+  static constexpr size_t MERGE_MIN = 1024;
+  static constexpr size_t MERGE_RATIO = 8;
+
+ private:
+  struct EntryLess {
+    auto operator()(const MappingType &lhs, const MappingType &rhs) const -> bool {
+      return PGM_SNAPSHOT_TYPE::CompareEntries(lhs, rhs) < 0;
+    }
+  };
+
+  // Whether the snapshot has the entry, ignoring the writes kept aside.
+  auto InSnapshot(const MappingType &entry) const -> bool;
+  // Build the snapshot again with the writes kept aside, the caller holds latch_ for writing.
+  void Merge();
+  // Merge if there are too many writes kept aside.
+  void MaybeMerge();
+
+  std::shared_mutex latch_;
+  std::shared_ptr<const PGM_SNAPSHOT_TYPE> snapshot_;
+  std::set<MappingType, EntryLess> inserted_;
+  std::set<MappingType, EntryLess> removed_;
+};
+
+}  // namespace bustub
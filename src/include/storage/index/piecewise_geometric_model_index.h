@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// piecewise_geometric_model_index.h
+//
+// Identification: src/include/storage/index/piecewise_geometric_model_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "storage/index/index.h"
+#include "storage/index/piecewise_geometric_model.h"
+
+namespace bustub {
+
+#define PGM_INDEX_TYPE PiecewiseGeometricModelIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * A learned index for tables whose keys rarely change, see PiecewiseGeometricModel. CREATE INDEX ... USING learned
+ * builds one. The model is not kept in the buffer pool, so it is gone when the database stops, and Rebuild fits it
+ * to the table again. Scans read a snapshot of the entries, which knows the position of every entry, so ranges and
+ * ranks are found without walking the entries before them.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class PiecewiseGeometricModelIndex : public Index {
+ public:
+  explicit PiecewiseGeometricModelIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  auto GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> override;
+
+  auto GetPrefixIterator(const std::vector<Value> &prefix, Transaction *transaction)
+      -> std::unique_ptr<IndexScanIterator> override;
+
+  auto HasSubtreeCounts() const -> bool override { return true; }
+
+  auto CountRange(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                  Transaction *transaction) -> size_t override;
+
+  auto GetRankIterator(size_t rank, Transaction *transaction) -> std::unique_ptr<IndexScanIterator> override;
+
+  auto HasRangeScans() const -> bool override { return true; }
+
+  auto GetRangeIterator(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                        Transaction *transaction) -> std::unique_ptr<IndexScanIterator> override;
+
+  auto IsInMemory() const -> bool override { return true; }
+
+  void Rebuild(TableHeap *table_heap, const Schema &tuple_schema, const AbstractExpression *predicate,
+               Transaction *transaction) override;
+
+  /** @return the bytes the entries and the model take up */
+  auto GetMemoryUsage() -> size_t { return container_.GetMemoryUsage(); }
+
+  /** @return the key tuple that the index key was made from */
+  auto KeyToTuple(const KeyType &index_key) const -> Tuple;
+
+ protected:
+  /** @return the positions in snapshot of the first and past the last entry between the bounds */
+  auto RangePositions(const PGM_SNAPSHOT_TYPE &snapshot, const std::optional<IndexBound> &lower,
+                      const std::optional<IndexBound> &upper) const -> std::pair<size_t, size_t>;
+
+  /** @return the position in snapshot of the first entry whose leading key column is not below (or is above, if
+   * after) the bound */
+  auto BoundPosition(const PGM_SNAPSHOT_TYPE &snapshot, const IndexBound &bound, bool after) const -> size_t;
+
+  // container
+  PiecewiseGeometricModel<KeyType, ValueType, KeyComparator> container_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_index.h
+//
+// Identification: src/include/storage/index/trie_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "primer/p0_trie.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+/**
+ * An index over a trie of the strings of a VARCHAR column, for tables that fit in memory, see Trie. CREATE INDEX ...
+ * USING trie builds one. Besides lookups by key and scans in key order, it finds the entries whose strings start
+ * with a prefix by walking down to the node of the prefix, see ScanStringPrefix. Like the other in-memory indexes it
+ * is gone when the database stops, and Rebuild fills it from the table again.
+ *
+ * The trie holds a list of RIDs per key, so that keys can repeat.
+ */
+class TrieIndex : public Index {
+ public:
+  explicit TrieIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  auto GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> override;
+
+  auto GetPrefixIterator(const std::vector<Value> &prefix, Transaction *transaction)
+      -> std::unique_ptr<IndexScanIterator> override;
+
+  auto IsInMemory() const -> bool override { return true; }
+
+  void Rebuild(TableHeap *table_heap, const Schema &tuple_schema, const AbstractExpression *predicate,
+               Transaction *transaction) override;
+
+  /**
+   * Append the RIDs of the entries whose strings start with prefix, in key order.
+   * @param prefix The prefix of the strings, empty for every entry that is not NULL
+   * @param result The RIDs found
+   */
+  void ScanStringPrefix(const std::string &prefix, std::vector<RID> *result);
+
+  /**
+   * The RIDs of a key. Once it is left empty, the list is marked removed before it is taken out of the trie, and an
+   * insert that finds a removed list waits for a new one.
+   */
+  struct RIDList {
+    std::mutex latch_;
+    std::vector<RID> rids_;
+    bool removed_{false};
+  };
+  using Entry = std::pair<std::string, std::shared_ptr<RIDList>>;
+
+  /** @return the key of the trie that value is found by */
+  static auto EncodeKey(const Value &value) -> std::string;
+
+  /** @return the key tuple of a key of the trie */
+  auto KeyToTuple(const std::string &key) const -> Tuple;
+
+ private:
+  std::unique_ptr<Trie> trie_;
+};
+
+}  // namespace bustub
@@ -12,13 +12,15 @@
 
 #include <queue>
 
+#include "storage/page/b_plus_tree_key_store.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 28
+#define INTERNAL_PAGE_DATA_SIZE (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE)
+#define INTERNAL_PAGE_SIZE (BPlusTreeSlotCapacity<KeyType, ValueType>(INTERNAL_PAGE_DATA_SIZE))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -31,23 +33,63 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *  Wide keys (see IsCompressedKey) are kept in a BPlusTreeKeyStore after the
+ *  header instead, the same way as in leaf pages.
+ *
+ *  A page of a tree with subtree counts also keeps the number of values below
+ *  every child, as an array of uint32_t at the end of the page that starts at
+ *  CountsOffset (4) in the header and shifts along with the pairs:
+ *  ---------------------------------------------------------------------
+ * | HEADER | PAIRS ... | FREE | COUNT(0) | COUNT(1) | ... | COUNT(max) |
+ *  ---------------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            bool with_counts = false);
+
+  // the largest max size of a page that keeps subtree counts
+  static auto CountedCapacity() -> int;
 
   auto KeyAt(int index) const -> KeyType;
   void SetKeyAt(int index, const KeyType &key);
   auto ValueAt(int index) const -> ValueType;
+  auto ValueIndex(const ValueType &value) const -> int;
 
   auto SetPairAt(int index, const MappingType &pair) -> bool;
   auto DeletePair(const KeyType &key, KeyComparator &comparator) -> bool;
   void SetValueAt(int index, const ValueType &value);
   void ReplaceKey(const KeyType &old_key, const KeyType &new_key, KeyComparator &comparator);
+  auto CanReplaceKey(const KeyType &new_key) const -> bool;
+
+  // space management, only wide keys are limited by bytes rather than max size
+  auto IsSpaceLow() const -> bool;
+  auto IsUnderflow() const -> bool;
+  auto IsSafeToRemove() const -> bool;
+  auto CanMergeWith(const BPlusTreeInternalPage *other) const -> bool;
+  auto SplitIndex() const -> int;
+  void MoveRangeTo(int begin, BPlusTreeInternalPage *recipient);
+
+  // subtree counts, only kept if the page was initialized with them
+  auto HasChildCounts() const -> bool { return counts_offset_ != 0; }
+  auto ChildCountAt(int index) const -> uint32_t;
+  void SetChildCountAt(int index, uint32_t count);
+  auto TotalCount() const -> size_t;
 
  private:
+  using KeyStore = BPlusTreeKeyStore<KeyType, ValueType>;
+  auto Store() -> KeyStore * { return reinterpret_cast<KeyStore *>(array_); }
+  auto Store() const -> const KeyStore * { return reinterpret_cast<const KeyStore *>(array_); }
+  auto Counts() -> uint32_t * { return reinterpret_cast<uint32_t *>(reinterpret_cast<char *>(this) + counts_offset_); }
+  auto Counts() const -> const uint32_t * {
+    return reinterpret_cast<const uint32_t *>(reinterpret_cast<const char *>(this) + counts_offset_);
+  }
+
+  // byte offset of the subtree counts in the page, 0 if the page has none
+  uint32_t counts_offset_;
+
   // Flexible array member for page data.
   MappingType array_[1];
 };
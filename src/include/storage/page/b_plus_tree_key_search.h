@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_key_search.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+/**
+ * Whether the keys ordered by KeyComparator are fixed width integers. A leaf
+ * stores such keys apart from its values, as an array of IntType that sorts
+ * like the keys under a signed comparison, so that a search can compare many
+ * keys per instruction. Comparators of integer keys specialize this with
+ * ToInt/FromInt conversions.
+ */
+template <typename KeyType, typename KeyComparator>
+struct IntegerKeyLayout {
+  static constexpr bool ENABLED = false;
+  using IntType = int32_t;
+};
+
+/** @return the number of keys less than key in the sorted array keys[0, size), one key at a time */
+template <typename IntType>
+inline auto ScalarLowerBound(const IntType *keys, int size, IntType key) -> int {
+  int low = 0;
+  int high = size;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (keys[mid] < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/**
+ * The width of the window a SIMD search scans linearly, after a binary
+ * search narrowed the range down to it.
+ */
+static constexpr int KEY_SEARCH_WINDOW = 32;
+
+/**
+ * @return the number of keys less than key in the sorted array keys[0, size)
+ *
+ * A binary search narrows the range to KEY_SEARCH_WINDOW keys, which are then
+ * compared with the search key in vector registers (AVX2 when the build
+ * enables it, SSE otherwise); every lane that is less adds one to the result.
+ * Builds without the instructions use ScalarLowerBound.
+ */
+inline auto SimdLowerBound(const int32_t *keys, int size, int32_t key) -> int {
+#if defined(__SSE2__)
+  int low = 0;
+  int high = size;
+  while (high - low > KEY_SEARCH_WINDOW) {
+    int mid = low + (high - low) / 2;
+    if (keys[mid] < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  int i = low;
+#if defined(__AVX2__)
+  const __m256i needle8 = _mm256_set1_epi32(key);
+  for (; i + 8 <= high; i += 8) {
+    auto lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    auto less = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle8, lanes)));
+    if (less != 0xFF) {
+      return i + __builtin_popcount(less);
+    }
+  }
+#endif
+  const __m128i needle4 = _mm_set1_epi32(key);
+  for (; i + 4 <= high; i += 4) {
+    auto lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    auto less = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(needle4, lanes)));
+    if (less != 0xF) {
+      return i + __builtin_popcount(less);
+    }
+  }
+  return i + ScalarLowerBound(keys + i, high - i, key);
+#else
+  return ScalarLowerBound(keys, size, key);
+#endif
+}
+
+inline auto SimdLowerBound(const int64_t *keys, int size, int64_t key) -> int {
+#if defined(__SSE4_2__)
+  int low = 0;
+  int high = size;
+  while (high - low > KEY_SEARCH_WINDOW) {
+    int mid = low + (high - low) / 2;
+    if (keys[mid] < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  int i = low;
+#if defined(__AVX2__)
+  const __m256i needle4 = _mm256_set1_epi64x(key);
+  for (; i + 4 <= high; i += 4) {
+    auto lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    auto less = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle4, lanes)));
+    if (less != 0xF) {
+      return i + __builtin_popcount(less);
+    }
+  }
+#endif
+  const __m128i needle2 = _mm_set1_epi64x(key);
+  for (; i + 2 <= high; i += 2) {
+    auto lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    auto less = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(needle2, lanes)));
+    if (less != 0x3) {
+      return i + __builtin_popcount(less);
+    }
+  }
+  return i + ScalarLowerBound(keys + i, high - i, key);
+#else
+  return ScalarLowerBound(keys, size, key);
+#endif
+}
+
+}  // namespace bustub
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_key_store.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** Keys at least this wide are stored compressed in B+ tree pages, narrower keys keep the fixed array layout. */
+static constexpr size_t COMPRESSED_KEY_MIN_SIZE = 32;
+
+template <typename KeyType>
+constexpr auto IsCompressedKey() -> bool {
+  return sizeof(KeyType) >= COMPRESSED_KEY_MIN_SIZE;
+}
+
+/**
+ * Whether the keys ordered by KeyComparator may be cut after any byte and
+ * still sort between the keys they were cut from, which is what separator
+ * suffix truncation relies on. Byte-ordered comparators specialize this.
+ */
+template <typename KeyComparator>
+struct KeyTruncation {
+  static constexpr bool ENABLED = false;
+};
+
+/**
+ * Variable length storage of the keys of one B+ tree page, used instead of
+ * the fixed MappingType array for wide keys.
+ *
+ * Every key is stored without its trailing zero bytes, which is where the
+ * padding of a GenericKey lives. On top of that the page keeps one common
+ * prefix, and keys starting with it only store the bytes after it. A key
+ * that does not share the prefix is stored in full, so an insert never grows
+ * the other entries; the prefix is chosen again whenever the page is compacted.
+ *
+ * Store format (offsets are relative to the start of the store):
+ *  -----------------------------------------------------------------------
+ * | DataSize (2) | HeapBegin (2) | DeadBytes (2) | PrefixOffset (2) |
+ *  -----------------------------------------------------------------------
+ *  --------------------------------------------------------
+ * | PrefixLength (2) | Reserved (2) | SLOT(1) | SLOT(2) | ...
+ *  --------------------------------------------------------
+ *  -----------------------------------------------------------
+ * | ... FREE ... | KEY BYTES(n) | ... | KEY BYTES(1) | PREFIX |
+ *  -----------------------------------------------------------
+ *  A slot holds the value, the offset and the length of the key bytes, and
+ *  whether they follow the page prefix. The key bytes grow from the end.
+ */
+template <typename KeyType, typename ValueType>
+class BPlusTreeKeyStore {
+ public:
+  struct Slot {
+    ValueType value_;
+    uint16_t offset_;
+    uint16_t length_;
+  };
+
+  static constexpr size_t HEADER_SIZE = 12;
+  /** Space taken by an entry whose key shares nothing with the prefix and has no trailing zero. */
+  static constexpr size_t MAX_ENTRY_SIZE = sizeof(Slot) + sizeof(KeyType);
+
+  /** @return the largest number of entries a store of data_size bytes can hold */
+  static constexpr auto SlotCapacity(size_t data_size) -> int {
+    return static_cast<int>((data_size - HEADER_SIZE) / sizeof(Slot));
+  }
+
+  void Init(size_t data_size);
+
+  auto KeyAt(int index) const -> KeyType;
+  auto ValueAt(int index) const -> ValueType;
+  void SetValueAt(int index, const ValueType &value);
+
+  /**
+   * Insert key & value as entry index of a store holding size entries.
+   * @throws Exception if the key does not fit even after compaction
+   */
+  void Insert(int index, int size, const KeyType &key, const ValueType &value);
+  void Remove(int index, int size);
+
+  /** Append the entries [begin, size) to recipient, which holds recipient_size entries. */
+  void MoveRangeTo(int begin, int size, BPlusTreeKeyStore *recipient, int recipient_size);
+
+  /** Rewrite the key bytes without holes, keeping whichever prefix makes them smallest. */
+  void Compact(int size);
+
+  /** Bytes in use, counting the header, the slots, the prefix and the live key bytes. */
+  auto UsedSpace(int size) const -> size_t;
+  auto FreeSpace(int size) const -> size_t { return data_size_ - UsedSpace(size); }
+  /** Bytes the entries would take in a store whose prefix they do not share. */
+  auto RawSpace(int size) const -> size_t;
+  auto DataSize() const -> size_t { return data_size_; }
+
+  /** @return the entry splitting the store into two halves of about the same number of bytes */
+  auto SplitIndex(int size) const -> int;
+
+  /** @return the number of bytes of key left after dropping its trailing zeros */
+  static auto TrimmedLength(const KeyType &key) -> size_t;
+
+  /**
+   * @return the shortest zero padded prefix of rhs that still sorts after lhs
+   * in byte order, which is a valid separator for lhs < rhs
+   */
+  static auto ShortestSeparator(const KeyType &lhs, const KeyType &rhs) -> KeyType;
+
+ private:
+  static constexpr uint16_t PREFIXED_FLAG = 0x8000;
+
+  auto Slots() -> Slot * { return reinterpret_cast<Slot *>(reinterpret_cast<char *>(this) + HEADER_SIZE); }
+  auto Slots() const -> const Slot * {
+    return reinterpret_cast<const Slot *>(reinterpret_cast<const char *>(this) + HEADER_SIZE);
+  }
+  auto Bytes() -> char * { return reinterpret_cast<char *>(this); }
+  auto Bytes() const -> const char * { return reinterpret_cast<const char *>(this); }
+
+  /** Write the key bytes of key below the heap, return the slot length field. */
+  auto PushKey(const KeyType &key) -> uint16_t;
+  /** @return the slot length field key would get with the current prefix */
+  auto StoredLength(const KeyType &key) const -> uint16_t;
+  /** Rebuild the store from decoded entries, using the prefix at the start of prefix_key. */
+  void Rebuild(const KeyType *keys, const ValueType *values, int size, const KeyType &prefix_key, size_t prefix_length);
+
+  uint16_t data_size_;
+  uint16_t heap_begin_;
+  uint16_t dead_bytes_;
+  uint16_t prefix_offset_;
+  uint16_t prefix_length_;
+  uint16_t reserved_;
+};
+
+/**
+ * Number of slots of a B+ tree page holding data_size bytes of entries, used
+ * as the default max size of leaf and internal pages.
+ */
+template <typename KeyType, typename ValueType>
+constexpr auto BPlusTreeSlotCapacity(size_t data_size) -> int {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return BPlusTreeKeyStore<KeyType, ValueType>::SlotCapacity(data_size);
+  } else {
+    return static_cast<int>(data_size / sizeof(std::pair<KeyType, ValueType>));
+  }
+}
+
+}  // namespace bustub
@@ -14,31 +14,43 @@
 #include <vector>
 
 // #include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_key_search.h"
+#include "storage/page/b_plus_tree_key_store.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 32
+#define LEAF_PAGE_DATA_SIZE (BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE)
+#define LEAF_PAGE_SIZE (BPlusTreeSlotCapacity<KeyType, ValueType>(LEAF_PAGE_DATA_SIZE))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Every key occupies one slot; the record ids of a duplicated key live in
+ * a posting chain referenced by that slot (see b_plus_tree_posting_page.h).
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
+ *  Wide keys (see IsCompressedKey) are kept in a BPlusTreeKeyStore after the
+ *  header instead, and a page of them is full once its bytes run out rather
+ *  than when it reaches max size.
+ *  Integer keys (see IntegerKeyLayout) are kept as two arrays, which hold as
+ *  many entries as the pairs would, so that a search only reads keys:
+ *  ----------------------------------------------------------------------
+ * | HEADER | INT(1) | ... | INT(n) | (free) | RID(1) | ... | RID(n) | (free)
+ *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ----------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4)
+ *  ----------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -50,16 +62,45 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
   auto KeyAt(int index) const -> KeyType;
 
   auto ValueAt(int index) const -> ValueType;
+  void SetValueAt(int index, const ValueType &value);
   auto SetPairAt(int index, const MappingType &pair) -> bool;
   auto DeletePair(const KeyType &key, KeyComparator &comparator) -> bool;
-  auto PairAt(int index) -> MappingType &;
-  auto IsKeyExist(const KeyType &key, KeyComparator &comparator) const -> bool;
+  auto PairAt(int index) const -> MappingType;
+  auto KeyIndex(const KeyType &key, KeyComparator &comparator) const -> int;
+  auto KeyLowerBound(const KeyType &key, KeyComparator &comparator) const -> int;
+
+  // space management, only wide keys are limited by bytes rather than max size
+  auto IsSpaceLow() const -> bool;
+  auto IsUnderflow() const -> bool;
+  auto IsSafeToRemove() const -> bool;
+  auto CanMergeWith(const BPlusTreeLeafPage *other) const -> bool;
+  auto SplitIndex() const -> int;
+  void MoveRangeTo(int begin, BPlusTreeLeafPage *recipient);
 
  private:
+  using KeyStore = BPlusTreeKeyStore<KeyType, ValueType>;
+  auto Store() -> KeyStore * { return reinterpret_cast<KeyStore *>(array_); }
+  auto Store() const -> const KeyStore * { return reinterpret_cast<const KeyStore *>(array_); }
+
+  using IntLayout = IntegerKeyLayout<KeyType, KeyComparator>;
+  using IntType = typename IntLayout::IntType;
+  auto IntKeys() -> IntType * { return reinterpret_cast<IntType *>(array_); }
+  auto IntKeys() const -> const IntType * { return reinterpret_cast<const IntType *>(array_); }
+  auto IntValues() -> ValueType * {
+    return reinterpret_cast<ValueType *>(reinterpret_cast<char *>(array_) + LEAF_PAGE_SIZE * sizeof(IntType));
+  }
+  auto IntValues() const -> const ValueType * {
+    return reinterpret_cast<const ValueType *>(reinterpret_cast<const char *>(array_) +
+                                               LEAF_PAGE_SIZE * sizeof(IntType));
+  }
+
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
   // Flexible array member for page data.
   MappingType array_[1];
 };
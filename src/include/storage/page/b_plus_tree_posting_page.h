@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define POSTING_PAGE_HEADER_SIZE 20
+#define POSTING_PAGE_DATA_SIZE (BUSTUB_PAGE_SIZE - POSTING_PAGE_HEADER_SIZE)
+
+/**
+ * Overflow page holding the record ids of a duplicated key in a B+ tree leaf.
+ *
+ * The leaf keeps exactly one slot per distinct key. Once a key is inserted a
+ * second time, the value of that slot becomes a posting reference (see MakeRef)
+ * to the head of a chain of posting pages. Record ids are kept sorted across
+ * the whole chain, and every page stores its run as varint encoded deltas of
+ * RID::Get(), so neighbouring tuples of one table page cost a single byte each.
+ *
+ * Posting page format (size in byte, 20 bytes header):
+ *  ---------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | TailPageId (4) | Count (4) | Used (4) |
+ *  ---------------------------------------------------------------------
+ *  ---------------------------------------------------------
+ * | VARINT(RID(1)) | VARINT(RID(2) - RID(1)) | ... | FREE |
+ *  ---------------------------------------------------------
+ *  TailPageId is only maintained on the head page of a chain.
+ */
+class BPlusTreePostingPage {
+ public:
+  /** Slot number that marks a leaf value as a posting reference instead of a tuple. */
+  static constexpr uint32_t POSTING_SLOT = std::numeric_limits<uint32_t>::max();
+
+  void Init(page_id_t page_id);
+
+  auto GetPageId() const -> page_id_t { return page_id_; }
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+  auto GetTailPageId() const -> page_id_t { return tail_page_id_; }
+  void SetTailPageId(page_id_t tail_page_id) { tail_page_id_ = tail_page_id; }
+  auto GetCount() const -> int { return static_cast<int>(count_); }
+
+  /** @return the smallest record id stored in this page, the page must not be empty */
+  auto FirstRID() const -> RID;
+
+  /** Append the decoded record ids of this page to result. */
+  void Decode(std::vector<RID> *result) const;
+
+  /**
+   * Replace the content of this page with rids[begin, end), stopping at the first rid that does not fit.
+   * @return the number of rids actually stored
+   */
+  auto Encode(const std::vector<RID> &rids, size_t begin, size_t end) -> size_t;
+
+  /** Copy the run stored in other into this page, keeping this page's identity and chain links. */
+  void CopyRunFrom(const BPlusTreePostingPage &other);
+
+  /** @return the leaf value referring to the posting chain whose head page is head_page_id */
+  static auto MakeRef(page_id_t head_page_id) -> RID { return {head_page_id, POSTING_SLOT}; }
+
+  /** @return true if the leaf value is a posting reference rather than a tuple rid */
+  static auto IsRef(const RID &rid) -> bool { return rid.GetSlotNum() == POSTING_SLOT; }
+
+ private:
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  page_id_t tail_page_id_;
+  uint32_t count_;
+  uint32_t used_;
+  // Flexible array member for page data.
+  uint8_t data_[1];
+};
+
+/**
+ * Operations over a whole chain of posting pages. The caller must hold the
+ * latch of the leaf that refers to the chain, which serializes every access
+ * to the chain's pages.
+ */
+class BPlusTreePostingList {
+ public:
+  /** Build a new chain holding the two record ids, return its head page id. */
+  static auto Create(BufferPoolManager *bpm, const RID &first, const RID &second) -> page_id_t;
+
+  /** Insert rid into the chain, return false if it is already present. */
+  static auto Insert(BufferPoolManager *bpm, page_id_t head_page_id, const RID &rid) -> bool;
+
+  /** Remove rid from the chain, return false if it is not present. */
+  static auto Remove(BufferPoolManager *bpm, page_id_t head_page_id, const RID &rid) -> bool;
+
+  /**
+   * If the chain holds a single record id, free the chain and store that rid in last.
+   * @return true if the chain was collapsed
+   */
+  static auto TryCollapse(BufferPoolManager *bpm, page_id_t head_page_id, RID *last) -> bool;
+
+  /** Append every record id of the chain to result, in ascending order. */
+  static void Collect(BufferPoolManager *bpm, page_id_t head_page_id, std::vector<RID> *result);
+
+  /** @return the number of record ids in the chain, read from the page headers without decoding them */
+  static auto Count(BufferPoolManager *bpm, page_id_t head_page_id) -> size_t;
+
+  /** Free every page of the chain. */
+  static void Destroy(BufferPoolManager *bpm, page_id_t head_page_id);
+};
+
+}  // namespace bustub
@@ -25,14 +25,19 @@ namespace bustub {
  * non-unique keys.
  *
  * Bucket page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ *  -----------------------------------------------------------------------------------
+ * | OverflowPageId (4) | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  -----------------------------------------------------------------------------------
  *
  *  Here '+' means concatenation.
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ *  A full bucket whose entries cannot be told apart by more bits of their
+ *  hash, such as the values of one key, is continued in overflow pages. The
+ *  bucket in the directory is the head of the chain, and its latch covers the
+ *  whole chain.
+ *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -40,6 +45,21 @@ class HashTableBucketPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBucketPage() = delete;
 
+  /**
+   * Init method after creating a new bucket page, which is empty and has no overflow page
+   */
+  void Init();
+
+  /**
+   * @return the page id of the next page of the chain, INVALID_PAGE_ID if this is the last one
+   */
+  auto GetOverflowPageId() const -> page_id_t { return overflow_page_id_; }
+
+  /**
+   * @param overflow_page_id the page id of the next page of the chain
+   */
+  void SetOverflowPageId(page_id_t overflow_page_id) { overflow_page_id_ = overflow_page_id; }
+
   /**
    * Scan the bucket and collect values that have the matching key
    *
@@ -138,6 +158,7 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  page_id_t overflow_page_id_;
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
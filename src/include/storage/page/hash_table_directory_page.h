@@ -128,6 +128,11 @@ class HashTableDirectoryPage {
    */
   auto CanShrink() -> bool;
 
+  /**
+   * @return true if the directory has room to double, which it must to split a bucket of global depth
+   */
+  auto CanGrow() -> bool;
+
   /**
    * @return the current directory size
    */
@@ -165,6 +170,7 @@ class HashTableDirectoryPage {
    * Gets the high bit corresponding to the bucket's local depth.
    * This is not the same as the bucket index itself.  This method
    * is helpful for finding the pair, or "split image", of a bucket.
+   * A bucket of local depth 0 has no high bit, and no split image.
    *
    * @param bucket_idx bucket index to lookup
    * @return the high bit corresponding to the bucket's local depth
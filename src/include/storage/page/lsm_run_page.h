@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_run_page.h
+//
+// Identification: src/include/storage/page/lsm_run_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+#define LSM_RUN_PAGE_TYPE LSMRunPage<KeyType, ValueType>
+#define LSM_RUN_PAGE_HEADER_SIZE 8
+
+/** An entry of an LSM tree, which either adds its key and value to the index or, as a tombstone, removes them. */
+template <typename KeyType, typename ValueType>
+struct LSMEntry {
+  KeyType key_;
+  ValueType value_;
+  bool tombstone_;
+};
+
+/**
+ * One page of a sorted run of an LSM tree. A run is written once, page after
+ * page, and never changes until a compaction merges it away, so its pages
+ * are packed full, but for the last one.
+ *
+ * Run page format (entries are sorted by key, then by value):
+ *  ---------------------------------------------------------------
+ * | PageId (4) | Size (4) | ENTRY(1) | ENTRY(2) | ... | ENTRY(n) |
+ *  ---------------------------------------------------------------
+ *  Every entry is KEY + VALUE + TOMBSTONE, see LSMEntry.
+ */
+template <typename KeyType, typename ValueType>
+class LSMRunPage {
+ public:
+  /** The number of entries that fit in one page. */
+  static constexpr int MAX_SIZE =
+      static_cast<int>((BUSTUB_PAGE_SIZE - LSM_RUN_PAGE_HEADER_SIZE) / sizeof(LSMEntry<KeyType, ValueType>));
+
+  void Init(page_id_t page_id);
+
+  auto GetPageId() const -> page_id_t { return page_id_; }
+  auto GetSize() const -> int { return size_; }
+  auto IsFull() const -> bool { return size_ == MAX_SIZE; }
+
+  auto EntryAt(int index) const -> const LSMEntry<KeyType, ValueType> & { return array_[index]; }
+
+  /** Add entry after the others, the page must not be full and entry must sort after them. */
+  void Append(const LSMEntry<KeyType, ValueType> &entry);
+
+ private:
+  page_id_t page_id_;
+  int size_;
+  // Flexible array member for page data.
+  LSMEntry<KeyType, ValueType> array_[1];
+};
+
+}  // namespace bustub
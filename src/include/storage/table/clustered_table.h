@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clustered_table.h
+//
+// Identification: src/include/storage/table/clustered_table.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/index/index.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * ClusteredTable is an index-organized table: its tuples live in the leaves of the b+ tree of its primary key, ordered
+ * by it, instead of in table pages. The key of the tree is the primary key column followed by the other columns, so a
+ * scan of the tree reads whole rows in key order, and a range of the primary key is a run of neighbouring leaves.
+ *
+ * The primary key is one INTEGER column that is never NULL, and the rid of a row is its primary key, see
+ * PrimaryKeyRid. Secondary indexes, which store rids, store primary keys that way, and GetTuple looks the key up in
+ * the tree.
+ */
+class ClusteredTable : public TableHeap {
+ public:
+  /**
+   * Create a clustered table over an empty primary index.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @param primary_index the b+ tree index that stores the rows, owned by the catalog, whose key attributes are the
+   * primary key followed by the other columns in table order
+   * @param schema the schema of the table
+   */
+  ClusteredTable(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
+                 Index *primary_index, const Schema &schema);
+
+  /** Insert a row, which fails if its primary key is NULL or some row already has it. */
+  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool override;
+
+  /** Take the row out of the tree at once, it is kept aside until the transaction ends for a rollback. */
+  auto MarkDelete(const RID &rid, Transaction *txn) -> bool override;
+
+  /** Replace the row with one of the same primary key. */
+  auto UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool override;
+
+  /** Forget the row a committed delete kept aside, or take out the row of an aborted insert. */
+  void ApplyDelete(const RID &rid, Transaction *txn) override;
+
+  /** Put the row a delete kept aside back into the tree. */
+  void RollbackDelete(const RID &rid, Transaction *txn) override;
+
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool override;
+
+  auto Begin(Transaction *txn) -> TableIterator override;
+
+  /**
+   * @return the rid of the row with the primary key, in page 0. The slot is the key with its sign bit flipped, less
+   * one, which keeps the order of the keys and leaves out the largest slot that b+ trees use for posting chains;
+   * the smallest integer is NULL.
+   */
+  static auto PrimaryKeyRid(int32_t primary_key) -> RID {
+    return {0, (static_cast<uint32_t>(primary_key) ^ SIGN_BIT) - 1};
+  }
+
+  /** @return the primary key of the row with the rid, see PrimaryKeyRid */
+  static auto PrimaryKeyOf(const RID &rid) -> int32_t {
+    return static_cast<int32_t>((rid.GetSlotNum() + 1) ^ SIGN_BIT);
+  }
+
+ protected:
+  /** Seek past the primary key of the tuple, deletes under a scan may have moved the rows of its leaf. */
+  void Advance(Tuple *tuple, Transaction *txn) override;
+
+ private:
+  static constexpr uint32_t SIGN_BIT = 0x80000000;
+
+  /** @return the row held by an entry of the primary index, with the rid of its primary key */
+  auto RowFromKey(const Tuple &key) const -> Tuple;
+
+  /** @return the key of the row in the primary index */
+  auto KeyFromRow(const Tuple &row) const -> Tuple;
+
+  /** Read the row with the primary key of the rid. @return false if there is none */
+  auto FindRow(const RID &rid, Tuple *row, Transaction *txn) -> bool;
+
+  /** The index that stores the rows */
+  Index *primary_index_;
+  /** The schema of the table */
+  Schema schema_;
+  /** The position of each table column in the key of the primary index */
+  std::vector<uint32_t> key_positions_;
+  /** Makes the check for a duplicate primary key and the insert of the row one step */
+  std::mutex latch_;
+  /** The rows that uncommitted deletes took out, newest last, by rid */
+  std::unordered_map<RID, std::vector<Tuple>> deleted_;
+};
+
+}  // namespace bustub
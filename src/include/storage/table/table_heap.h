@@ -23,12 +23,15 @@ namespace bustub {
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * Its operations are virtual, so that tables that store their tuples another way, see ClusteredTable, can be used
+ * wherever a TableHeap is.
  */
 class TableHeap {
   friend class TableIterator;
 
  public:
-  ~TableHeap() = default;
+  virtual ~TableHeap() = default;
 
   /**
    * Create a table heap without a transaction. (open table)
@@ -57,7 +60,7 @@ class TableHeap {
    * @param txn the transaction performing the insert
    * @return true iff the insert is successful
    */
-  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+  virtual auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -65,7 +68,7 @@ class TableHeap {
    * @param txn transaction performing the delete
    * @return true iff the delete is successful (i.e the tuple exists)
    */
-  auto MarkDelete(const RID &rid, Transaction *txn) -> bool;  // for delete
+  virtual auto MarkDelete(const RID &rid, Transaction *txn) -> bool;  // for delete
 
   /**
    * if the new tuple is too large to fit in the old page, return false (will delete and insert)
@@ -74,21 +77,21 @@ class TableHeap {
    * @param txn transaction performing the update
    * @return true is update is successful.
    */
-  auto UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool;
+  virtual auto UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool;
 
   /**
    * Called on Commit/Abort to actually delete a tuple or rollback an insert.
    * @param rid rid of the tuple to delete
    * @param txn transaction performing the delete.
    */
-  void ApplyDelete(const RID &rid, Transaction *txn);
+  virtual void ApplyDelete(const RID &rid, Transaction *txn);
 
   /**
    * Called on abort to rollback a delete.
    * @param rid rid of the deleted tuple.
    * @param txn transaction performing the rollback
    */
-  void RollbackDelete(const RID &rid, Transaction *txn);
+  virtual void RollbackDelete(const RID &rid, Transaction *txn);
 
   /**
    * Read a tuple from the table.
@@ -97,10 +100,10 @@ class TableHeap {
    * @param txn transaction performing the read
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
+  virtual auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
 
   /** @return the begin iterator of this table */
-  auto Begin(Transaction *txn) -> TableIterator;
+  virtual auto Begin(Transaction *txn) -> TableIterator;
 
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
@@ -108,7 +111,22 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
- private:
+ protected:
+  /**
+   * Create a table without pages, for the subclasses that store their tuples elsewhere.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   */
+  TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager);
+
+  /**
+   * Move an iterator of this table to the next tuple, see TableIterator::operator++.
+   * @param[in,out] tuple the tuple under the iterator, which is replaced by the next one, or gets the rid of End()
+   * @param txn the transaction of the iterator
+   */
+  virtual void Advance(Tuple *tuple, Transaction *txn);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
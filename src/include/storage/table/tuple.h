@@ -30,6 +30,7 @@ namespace bustub {
 class Tuple {
   friend class TablePage;
   friend class TableHeap;
+  friend class ClusteredTable;
   friend class TableIterator;
 
  public:
@@ -0,0 +1,87 @@
+#include "optimizer/column_range.h"
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+
+namespace bustub {
+
+namespace {
+
+auto IsIntegerType(TypeId type) -> bool {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+}  // namespace
+
+auto CollectRange(const AbstractExpression &expr, ColumnRange *range) -> bool {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&expr); logic_expr != nullptr) {
+    return logic_expr->logic_type_ == LogicType::And && CollectRange(*logic_expr->children_[0], range) &&
+           CollectRange(*logic_expr->children_[1], range);
+  }
+  const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (cmp_expr == nullptr) {
+    return false;
+  }
+  auto comp_type = cmp_expr->comp_type_;
+  const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->children_[0].get());
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(cmp_expr->children_[1].get());
+  if (column_expr == nullptr && constant_expr == nullptr) {
+    // `constant op column` is `column op' constant` with the operator mirrored
+    column_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->children_[1].get());
+    constant_expr = dynamic_cast<const ConstantValueExpression *>(cmp_expr->children_[0].get());
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column_expr == nullptr || constant_expr == nullptr || constant_expr->val_.IsNull()) {
+    return false;
+  }
+  if (range->col_idx_.has_value() && *range->col_idx_ != column_expr->GetColIdx()) {
+    return false;
+  }
+  range->col_idx_ = column_expr->GetColIdx();
+  range->col_type_ = column_expr->GetReturnType();
+
+  // the bound is built in the type of the column, which an integer constant widens to
+  auto value_type = constant_expr->val_.GetTypeId();
+  if (value_type != range->col_type_ &&
+      !(IsIntegerType(value_type) && IsIntegerType(range->col_type_) && value_type < range->col_type_)) {
+    return false;
+  }
+  auto value = constant_expr->val_.CastAs(range->col_type_);
+
+  bool sets_lower = comp_type == ComparisonType::Equal || comp_type == ComparisonType::GreaterThan ||
+                    comp_type == ComparisonType::GreaterThanOrEqual;
+  bool sets_upper = comp_type == ComparisonType::Equal || comp_type == ComparisonType::LessThan ||
+                    comp_type == ComparisonType::LessThanOrEqual;
+  if ((!sets_lower && !sets_upper) || (sets_lower && range->lower_.has_value()) ||
+      (sets_upper && range->upper_.has_value())) {
+    return false;
+  }
+  bool inclusive = comp_type == ComparisonType::Equal || comp_type == ComparisonType::GreaterThanOrEqual ||
+                   comp_type == ComparisonType::LessThanOrEqual;
+  if (sets_lower) {
+    range->lower_ = IndexBound{value, inclusive};
+  }
+  if (sets_upper) {
+    range->upper_ = IndexBound{value, inclusive};
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/macros.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_count_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/column_range.h"
+#include "optimizer/index_predicate.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+auto Optimizer::OptimizeCountAsIndexCount(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeCountAsIndexCount(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Aggregation) {
+    return optimized_plan;
+  }
+  const auto &aggregation = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+  const auto &agg_types = aggregation.GetAggregateTypes();
+  if (!aggregation.GetGroupBys().empty() || agg_types.empty() ||
+      !std::all_of(agg_types.begin(), agg_types.end(),
+                   [](auto agg_type) { return agg_type == AggregationType::CountStarAggregate; })) {
+    return optimized_plan;
+  }
+
+  // the counted rows come from a sequential scan, with a filter in the scan or above it
+  BUSTUB_ENSURE(aggregation.children_.size() == 1, "Aggregation with multiple children?? That's weird!");
+  auto child_plan = aggregation.GetChildPlan();
+  AbstractExpressionRef predicate;
+  if (child_plan->GetType() == PlanType::Filter) {
+    const auto &filter = dynamic_cast<const FilterPlanNode &>(*child_plan);
+    predicate = filter.GetPredicate();
+    child_plan = filter.GetChildPlan();
+  }
+  if (child_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+  if (seq_scan.filter_predicate_ != nullptr) {
+    if (predicate != nullptr) {
+      return optimized_plan;
+    }
+    predicate = seq_scan.filter_predicate_;
+  }
+
+  // the predicate, less what the predicate of a partial index answers, must be a range of the leading key column
+  for (const auto *index_info : catalog_.GetTableIndexes(seq_scan.table_name_)) {
+    const auto &index = index_info->index_;
+    std::vector<AbstractExpressionRef> residual;
+    if (!index->HasSubtreeCounts() || !MatchIndexPredicate(predicate, index_info->predicate_, &residual)) {
+      continue;
+    }
+    ColumnRange range;
+    if (auto rest = MakeConjunction(residual); rest != nullptr && !CollectRange(*rest, &range)) {
+      continue;
+    }
+    if (range.col_idx_.has_value() && index->GetKeyAttrs()[0] != *range.col_idx_) {
+      continue;
+    }
+    return std::make_shared<IndexCountPlanNode>(aggregation.output_schema_, index_info->index_oid_, range.lower_,
+                                                range.upper_);
+  }
+  return optimized_plan;
+}
+
+}  // namespace bustub
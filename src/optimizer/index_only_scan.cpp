@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include "catalog/catalog.h"
+#include "catalog/schema.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/index_only_scan_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Rewrite the column references of expr, which refer to table columns, to the positions of the columns in the index
+ * key.
+ * @return the rewritten expression, or nullptr if expr reads a column that is not in the key
+ */
+auto RewriteExpressionForKey(const AbstractExpressionRef &expr, const std::vector<uint32_t> &key_attrs)
+    -> AbstractExpressionRef {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      column_value_expr != nullptr) {
+    auto key_attr = std::find(key_attrs.begin(), key_attrs.end(), column_value_expr->GetColIdx());
+    if (key_attr == key_attrs.end()) {
+      return nullptr;
+    }
+    return std::make_shared<ColumnValueExpression>(0, key_attr - key_attrs.begin(), expr->GetReturnType());
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    auto rewritten = RewriteExpressionForKey(child, key_attrs);
+    if (rewritten == nullptr) {
+      return nullptr;
+    }
+    children.emplace_back(std::move(rewritten));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  if (plan->GetType() == PlanType::Projection) {
+    const auto &projection = dynamic_cast<const ProjectionPlanNode &>(*plan);
+    BUSTUB_ENSURE(projection.children_.size() == 1, "Projection with multiple children?? That's weird!");
+    const auto &child_plan = projection.GetChildPlan();
+    if (child_plan->GetType() == PlanType::IndexScan &&
+        !dynamic_cast<const IndexScanPlanNode &>(*child_plan).HasRange()) {
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*child_plan);
+      const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+      const auto &key_attrs = index_info->index_->GetKeyAttrs();
+      // the projection reads the columns from the key tuples instead, if they are all in the key
+      std::vector<AbstractExpressionRef> exprs;
+      for (const auto &expr : projection.GetExpressions()) {
+        auto rewritten = RewriteExpressionForKey(expr, key_attrs);
+        if (rewritten == nullptr) {
+          return plan;
+        }
+        exprs.emplace_back(std::move(rewritten));
+      }
+      auto index_only_scan = std::make_shared<IndexOnlyScanPlanNode>(
+          std::make_shared<Schema>(index_info->key_schema_), index_scan.GetIndexOid(), index_scan.IsDescending(),
+          index_scan.GetOffset());
+      return std::make_shared<ProjectionPlanNode>(projection.output_schema_, std::move(exprs),
+                                                  std::move(index_only_scan));
+    }
+  }
+
+  // an index only scan reads every entry, scans of a range stay as they are
+  if (plan->GetType() == PlanType::IndexScan && !dynamic_cast<const IndexScanPlanNode &>(*plan).HasRange()) {
+    const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*plan);
+    const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+    const auto &key_attrs = index_info->index_->GetKeyAttrs();
+    const auto &columns = index_scan.OutputSchema().GetColumns();
+    std::vector<uint32_t> table_attrs(columns.size());
+    std::iota(table_attrs.begin(), table_attrs.end(), 0);
+    // a scan of every column is covered if the key holds all of them
+    if (!std::is_permutation(table_attrs.begin(), table_attrs.end(), key_attrs.begin(), key_attrs.end())) {
+      return plan;
+    }
+    auto index_only_scan = std::make_shared<IndexOnlyScanPlanNode>(std::make_shared<Schema>(index_info->key_schema_),
+                                                                   index_scan.GetIndexOid(), index_scan.IsDescending(),
+                                                                   index_scan.GetOffset());
+    if (key_attrs == table_attrs) {
+      index_only_scan->output_schema_ = index_scan.output_schema_;
+      return index_only_scan;
+    }
+    // the key holds the columns in another order, put them back in table order
+    std::vector<AbstractExpressionRef> exprs;
+    for (uint32_t col_idx = 0; col_idx < columns.size(); col_idx++) {
+      auto key_attr = std::find(key_attrs.begin(), key_attrs.end(), col_idx) - key_attrs.begin();
+      exprs.emplace_back(std::make_shared<ColumnValueExpression>(0, key_attr, columns[col_idx].GetType()));
+    }
+    return std::make_shared<ProjectionPlanNode>(index_scan.output_schema_, std::move(exprs),
+                                                std::move(index_only_scan));
+  }
+
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexOnlyScan(child));
+  }
+  return plan->CloneWithChildren(std::move(children));
+}
+
+}  // namespace bustub
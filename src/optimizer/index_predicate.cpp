@@ -0,0 +1,139 @@
+#include "optimizer/index_predicate.h"
+
+#include <typeinfo>
+
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "optimizer/column_range.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return whether a and b compute the same value from the same columns */
+auto SameExpression(const AbstractExpression &a, const AbstractExpression &b) -> bool {
+  if (typeid(a) != typeid(b) || a.GetReturnType() != b.GetReturnType() ||
+      a.GetChildren().size() != b.GetChildren().size()) {
+    return false;
+  }
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(&a); column_expr != nullptr) {
+    const auto &other = dynamic_cast<const ColumnValueExpression &>(b);
+    return column_expr->GetTupleIdx() == other.GetTupleIdx() && column_expr->GetColIdx() == other.GetColIdx();
+  }
+  if (const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(&a); constant_expr != nullptr) {
+    const auto &value = constant_expr->val_;
+    const auto &other = dynamic_cast<const ConstantValueExpression &>(b).val_;
+    return value.GetTypeId() == other.GetTypeId() && value.IsNull() == other.IsNull() &&
+           (value.IsNull() || value.CompareEquals(other) == CmpBool::CmpTrue);
+  }
+  if (const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(&a);
+      cmp_expr != nullptr && cmp_expr->comp_type_ != dynamic_cast<const ComparisonExpression &>(b).comp_type_) {
+    return false;
+  }
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&a);
+      logic_expr != nullptr && logic_expr->logic_type_ != dynamic_cast<const LogicExpression &>(b).logic_type_) {
+    return false;
+  }
+  if (const auto *arithmetic_expr = dynamic_cast<const ArithmeticExpression *>(&a);
+      arithmetic_expr != nullptr &&
+      arithmetic_expr->compute_type_ != dynamic_cast<const ArithmeticExpression &>(b).compute_type_) {
+    return false;
+  }
+  for (size_t i = 0; i < a.GetChildren().size(); i++) {
+    if (!SameExpression(*a.GetChildAt(i), *b.GetChildAt(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** @return whether every value of inner is in outer, both ranges of the same column */
+auto RangeContains(const ColumnRange &outer, const ColumnRange &inner) -> bool {
+  if (outer.lower_.has_value()) {
+    if (!inner.lower_.has_value()) {
+      return false;
+    }
+    const auto &[outer_value, outer_inclusive] = *outer.lower_;
+    const auto &[inner_value, inner_inclusive] = *inner.lower_;
+    if (inner_value.CompareGreaterThan(outer_value) != CmpBool::CmpTrue &&
+        (inner_value.CompareEquals(outer_value) != CmpBool::CmpTrue || (inner_inclusive && !outer_inclusive))) {
+      return false;
+    }
+  }
+  if (outer.upper_.has_value()) {
+    if (!inner.upper_.has_value()) {
+      return false;
+    }
+    const auto &[outer_value, outer_inclusive] = *outer.upper_;
+    const auto &[inner_value, inner_inclusive] = *inner.upper_;
+    if (inner_value.CompareLessThan(outer_value) != CmpBool::CmpTrue &&
+        (inner_value.CompareEquals(outer_value) != CmpBool::CmpTrue || (inner_inclusive && !outer_inclusive))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+void CollectConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    CollectConjuncts(logic_expr->GetChildAt(0), conjuncts);
+    CollectConjuncts(logic_expr->GetChildAt(1), conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+auto MakeConjunction(const std::vector<AbstractExpressionRef> &conjuncts) -> AbstractExpressionRef {
+  AbstractExpressionRef conjunction;
+  for (const auto &conjunct : conjuncts) {
+    conjunction = conjunction == nullptr ? conjunct
+                                         : std::make_shared<LogicExpression>(conjunction, conjunct, LogicType::And);
+  }
+  return conjunction;
+}
+
+auto MatchIndexPredicate(const AbstractExpressionRef &predicate, const AbstractExpressionRef &index_predicate,
+                         std::vector<AbstractExpressionRef> *residual) -> bool {
+  std::vector<AbstractExpressionRef> conjuncts;
+  if (predicate != nullptr) {
+    CollectConjuncts(predicate, &conjuncts);
+  }
+  std::vector<AbstractExpressionRef> index_conjuncts;
+  if (index_predicate != nullptr) {
+    CollectConjuncts(index_predicate, &index_conjuncts);
+  }
+
+  // a conjunct of the scan that is one of the index holds for every tuple of the index, so the scan need not check
+  // it; one that is a narrower range still has to be checked
+  std::vector<bool> answered(conjuncts.size(), false);
+  for (const auto &index_conjunct : index_conjuncts) {
+    ColumnRange index_range;
+    bool is_range = CollectRange(*index_conjunct, &index_range);
+    bool implied = false;
+    for (size_t i = 0; i < conjuncts.size() && !implied; i++) {
+      if (SameExpression(*conjuncts[i], *index_conjunct)) {
+        answered[i] = true;
+        implied = true;
+      } else if (ColumnRange range; is_range && CollectRange(*conjuncts[i], &range)) {
+        implied = range.col_idx_ == index_range.col_idx_ && RangeContains(index_range, range);
+      }
+    }
+    if (!implied) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < conjuncts.size(); i++) {
+    if (!answered[i]) {
+      residual->push_back(conjuncts[i]);
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
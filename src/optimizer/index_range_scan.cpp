@@ -0,0 +1,113 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/column_range.h"
+#include "optimizer/index_predicate.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return whether the range holds a single value, which makes its scan a lookup of the key */
+auto IsPointRange(const ColumnRange &range) -> bool {
+  return range.lower_.has_value() && range.upper_.has_value() && range.lower_->inclusive_ && range.upper_->inclusive_ &&
+         range.lower_->value_.CompareEquals(range.upper_->value_) == CmpBool::CmpTrue;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterScanAsIndexRangeScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterScanAsIndexRangeScan(child));
+  }
+  AbstractPlanNodeRef optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // a sequential scan with a filter in the scan or above it
+  AbstractExpressionRef predicate;
+  AbstractPlanNodeRef scan_plan = optimized_plan;
+  if (scan_plan->GetType() == PlanType::Filter) {
+    const auto &filter = dynamic_cast<const FilterPlanNode &>(*scan_plan);
+    predicate = filter.GetPredicate();
+    scan_plan = filter.GetChildPlan();
+  }
+  if (scan_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*scan_plan);
+  if (seq_scan.filter_predicate_ != nullptr) {
+    if (predicate != nullptr) {
+      return optimized_plan;
+    }
+    predicate = seq_scan.filter_predicate_;
+  }
+
+  if (predicate == nullptr) {
+    return optimized_plan;
+  }
+  const auto &indexes = catalog_.GetTableIndexes(seq_scan.table_name_);
+
+  // the range scan of an index of every tuple replaces the filter, so the predicate must be a range of one column and
+  // nothing else
+  ColumnRange range;
+  if (CollectRange(*predicate, &range)) {
+    // a range of one value is a lookup of the key, which an index of that one column with point lookups answers best
+    for (const auto *index_info : indexes) {
+      const auto &index = index_info->index_;
+      if (index_info->predicate_ == nullptr && IsPointRange(range) && index->HasPointLookups() &&
+          index->GetKeyAttrs().size() == 1 && index->GetKeyAttrs()[0] == *range.col_idx_) {
+        return std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, index_info->index_oid_, false, 0,
+                                                   range.lower_, range.upper_);
+      }
+    }
+    for (const auto *index_info : indexes) {
+      const auto &index = index_info->index_;
+      if (index_info->predicate_ != nullptr || !index->HasRangeScans() || index->GetKeyAttrs()[0] != *range.col_idx_) {
+        continue;
+      }
+      return std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, index_info->index_oid_, false, 0,
+                                                 range.lower_, range.upper_);
+    }
+  }
+
+  // a partial index holds the tuples the scan reads if the predicate implies the one of the index; the comparisons of
+  // the leading key column left over bound the scan of an index that seeks to a range or looks up keys, a filter above
+  // the scan checks the rest
+  for (const auto *index_info : indexes) {
+    const auto &index = index_info->index_;
+    std::vector<AbstractExpressionRef> residual;
+    if (index_info->predicate_ == nullptr || !MatchIndexPredicate(predicate, index_info->predicate_, &residual)) {
+      continue;
+    }
+    ColumnRange key_range;
+    key_range.col_idx_ = index->GetKeyAttrs()[0];
+    std::vector<AbstractExpressionRef> rest;
+    for (const auto &conjunct : residual) {
+      if (ColumnRange narrowed = key_range;
+          (index->HasRangeScans() || !index->HasOrderedScans()) && CollectRange(*conjunct, &narrowed)) {
+        key_range = std::move(narrowed);
+      } else {
+        rest.push_back(conjunct);
+      }
+    }
+    if (!index->HasOrderedScans() && (!IsPointRange(key_range) || index->GetKeyAttrs().size() != 1)) {
+      continue;
+    }
+    AbstractPlanNodeRef index_scan = std::make_shared<IndexScanPlanNode>(
+        seq_scan.output_schema_, index_info->index_oid_, false, 0, key_range.lower_, key_range.upper_);
+    if (rest.empty()) {
+      return index_scan;
+    }
+    return std::make_shared<FilterPlanNode>(seq_scan.output_schema_, MakeConjunction(rest), std::move(index_scan));
+  }
+  return optimized_plan;
+}
+
+}  // namespace bustub
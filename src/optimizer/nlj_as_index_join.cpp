@@ -2,6 +2,8 @@
 #include <memory>
 #include <optional>
 #include <tuple>
+#include <utility>
+#include <vector>
 #include "catalog/column.h"
 #include "catalog/schema.h"
 #include "common/exception.h"
@@ -9,6 +11,7 @@
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/hash_join_plan.h"
@@ -21,17 +24,70 @@
 
 namespace bustub {
 
-auto Optimizer::MatchIndex(const std::string &table_name, uint32_t index_key_idx)
-    -> std::optional<std::tuple<index_oid_t, std::string>> {
-  const auto key_attrs = std::vector{index_key_idx};
+auto Optimizer::MatchIndex(const std::string &table_name, const std::vector<uint32_t> &key_columns)
+    -> std::optional<std::tuple<index_oid_t, std::string, std::vector<uint32_t>>> {
+  std::optional<std::tuple<index_oid_t, std::string, std::vector<uint32_t>>> result = std::nullopt;
+  size_t result_key_size = 0;
+  bool result_point_lookups = false;
   for (const auto *index_info : catalog_.GetTableIndexes(table_name)) {
-    if (key_attrs == index_info->index_->GetKeyAttrs()) {
-      return std::make_optional(std::make_tuple(index_info->index_oid_, index_info->name_));
+    // the lookups read every tuple of the inner table, which a partial index does not hold
+    if (index_info->predicate_ != nullptr) {
+      continue;
     }
+    // the columns must be the leading columns of the index key, in any order
+    const auto &key_attrs = index_info->index_->GetKeyAttrs();
+    if (key_attrs.size() < key_columns.size() ||
+        !std::is_permutation(key_columns.begin(), key_columns.end(), key_attrs.begin())) {
+      continue;
+    }
+    // an index without key order only finds whole keys
+    if (!index_info->index_->HasOrderedScans() && key_attrs.size() != key_columns.size()) {
+      continue;
+    }
+    // prefer the index with the fewest columns, which skips the fewest entries per lookup, then the one with the
+    // cheapest lookups
+    if (result == std::nullopt || key_attrs.size() < result_key_size ||
+        (key_attrs.size() == result_key_size && index_info->index_->HasPointLookups() && !result_point_lookups)) {
+      result = std::make_optional(std::make_tuple(index_info->index_oid_, index_info->name_, key_attrs));
+      result_key_size = key_attrs.size();
+      result_point_lookups = index_info->index_->HasPointLookups();
+    }
+  }
+  return result;
+}
+
+namespace {
+
+/**
+ * Collect the column equalities of a conjunction as pairs of (outer column expression, inner column index).
+ * @return false if a conjunct is not an equality between a column of each side
+ */
+auto CollectJoinKeys(const AbstractExpression &expr,
+                     std::vector<std::pair<AbstractExpressionRef, uint32_t>> *keys) -> bool {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&expr); logic_expr != nullptr) {
+    return logic_expr->logic_type_ == LogicType::And && CollectJoinKeys(*logic_expr->children_[0], keys) &&
+           CollectJoinKeys(*logic_expr->children_[1], keys);
+  }
+  const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (cmp_expr == nullptr || cmp_expr->comp_type_ != ComparisonType::Equal) {
+    return false;
   }
-  return std::nullopt;
+  const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->children_[0].get());
+  const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->children_[1].get());
+  if (left_expr == nullptr || right_expr == nullptr || left_expr->GetTupleIdx() == right_expr->GetTupleIdx()) {
+    return false;
+  }
+  if (left_expr->GetTupleIdx() == 1) {
+    std::swap(left_expr, right_expr);
+  }
+  // the outer expression is evaluated on the outer tuple alone, so it reads tuple 0
+  auto outer_expr = std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType());
+  keys->emplace_back(std::move(outer_expr), right_expr->GetColIdx());
+  return true;
 }
 
+}  // namespace
+
 auto Optimizer::OptimizeNLJAsIndexJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
@@ -43,47 +99,40 @@ auto Optimizer::OptimizeNLJAsIndexJoin(const AbstractPlanNodeRef &plan) -> Abstr
     const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*optimized_plan);
     // Has exactly two children
     BUSTUB_ENSURE(nlj_plan.children_.size() == 2, "NLJ should have exactly 2 children.");
-    // Check if expr is equal condition where one is for the left table, and one is for the right table.
-    if (const auto *expr = dynamic_cast<const ComparisonExpression *>(&nlj_plan.Predicate()); expr != nullptr) {
-      if (expr->comp_type_ == ComparisonType::Equal) {
-        if (const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
-            left_expr != nullptr) {
-          if (const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[1].get());
-              right_expr != nullptr) {
-            // Ensure both exprs have tuple_id == 0
-            auto left_expr_tuple_0 =
-                std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType());
-            auto right_expr_tuple_0 =
-                std::make_shared<ColumnValueExpression>(0, right_expr->GetColIdx(), right_expr->GetReturnType());
-            // Now it's in form of <column_expr> = <column_expr>. Let's match an index for them.
+    // Ensure right child is table scan
+    if (nlj_plan.GetRightPlan()->GetType() != PlanType::SeqScan) {
+      return optimized_plan;
+    }
+    const auto &right_seq_scan = dynamic_cast<const SeqScanPlanNode &>(*nlj_plan.GetRightPlan());
+
+    // Check if expr is a conjunction of equal conditions where one side is for the left table, and one is for the
+    // right table. The index join evaluates no other predicate, so every conjunct must be answered by the index.
+    std::vector<std::pair<AbstractExpressionRef, uint32_t>> keys;
+    if (!CollectJoinKeys(nlj_plan.Predicate(), &keys)) {
+      return optimized_plan;
+    }
+    std::vector<uint32_t> key_columns;
+    for (const auto &[outer_expr, inner_col_idx] : keys) {
+      if (std::find(key_columns.begin(), key_columns.end(), inner_col_idx) != key_columns.end()) {
+        return optimized_plan;
+      }
+      key_columns.push_back(inner_col_idx);
+    }
 
-            // Ensure right child is table scan
-            if (nlj_plan.GetRightPlan()->GetType() == PlanType::SeqScan) {
-              const auto &right_seq_scan = dynamic_cast<const SeqScanPlanNode &>(*nlj_plan.GetRightPlan());
-              if (left_expr->GetTupleIdx() == 0 && right_expr->GetTupleIdx() == 1) {
-                if (auto index = MatchIndex(right_seq_scan.table_name_, right_expr->GetColIdx());
-                    index != std::nullopt) {
-                  auto [index_oid, index_name] = *index;
-                  return std::make_shared<NestedIndexJoinPlanNode>(
-                      nlj_plan.output_schema_, nlj_plan.GetLeftPlan(), std::move(left_expr_tuple_0),
-                      right_seq_scan.GetTableOid(), index_oid, std::move(index_name), right_seq_scan.table_name_,
-                      right_seq_scan.output_schema_, nlj_plan.GetJoinType());
-                }
-              }
-              if (left_expr->GetTupleIdx() == 1 && right_expr->GetTupleIdx() == 0) {
-                if (auto index = MatchIndex(right_seq_scan.table_name_, left_expr->GetColIdx());
-                    index != std::nullopt) {
-                  auto [index_oid, index_name] = *index;
-                  return std::make_shared<NestedIndexJoinPlanNode>(
-                      nlj_plan.output_schema_, nlj_plan.GetLeftPlan(), std::move(right_expr_tuple_0),
-                      right_seq_scan.GetTableOid(), index_oid, std::move(index_name), right_seq_scan.table_name_,
-                      right_seq_scan.output_schema_, nlj_plan.GetJoinType());
-                }
-              }
-            }
-          }
-        }
+    // Now it's in form of <column_expr> = <column_expr> [AND ...]. Let's match an index for them.
+    if (auto index = MatchIndex(right_seq_scan.table_name_, key_columns); index != std::nullopt) {
+      auto [index_oid, index_name, key_attrs] = *index;
+      // order the key predicates like the leading index key columns
+      std::vector<AbstractExpressionRef> key_predicates;
+      for (size_t i = 0; i < keys.size(); i++) {
+        auto col_idx = key_attrs[i];
+        auto key = std::find_if(keys.begin(), keys.end(), [col_idx](const auto &k) { return k.second == col_idx; });
+        key_predicates.push_back(key->first);
       }
+      return std::make_shared<NestedIndexJoinPlanNode>(
+          nlj_plan.output_schema_, nlj_plan.GetLeftPlan(), std::move(key_predicates), right_seq_scan.GetTableOid(),
+          index_oid, std::move(index_name), right_seq_scan.table_name_, right_seq_scan.output_schema_,
+          nlj_plan.GetJoinType());
     }
   }
 
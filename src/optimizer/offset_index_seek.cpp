@@ -0,0 +1,78 @@
+#include <memory>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/macros.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/index_only_scan_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * @return a copy of the index scan that seeks past offset entries, or nullptr if plan is no counted index scan of
+ * every entry
+ */
+auto SeekPastOffset(const Catalog &catalog, const AbstractPlanNodeRef &plan, size_t offset) -> AbstractPlanNodeRef {
+  if (plan->GetType() == PlanType::IndexScan) {
+    const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*plan);
+    if (index_scan.HasRange() || !catalog.GetIndex(index_scan.GetIndexOid())->index_->HasSubtreeCounts()) {
+      return nullptr;
+    }
+    return std::make_shared<IndexScanPlanNode>(index_scan.output_schema_, index_scan.GetIndexOid(),
+                                               index_scan.IsDescending(), index_scan.GetOffset() + offset);
+  }
+  if (plan->GetType() == PlanType::IndexOnlyScan) {
+    const auto &index_scan = dynamic_cast<const IndexOnlyScanPlanNode &>(*plan);
+    if (!catalog.GetIndex(index_scan.GetIndexOid())->index_->HasSubtreeCounts()) {
+      return nullptr;
+    }
+    return std::make_shared<IndexOnlyScanPlanNode>(index_scan.output_schema_, index_scan.GetIndexOid(),
+                                                   index_scan.IsDescending(), index_scan.GetOffset() + offset);
+  }
+  if (plan->GetType() == PlanType::Projection) {
+    // a projection maps tuples one to one, the offset applies below it as well
+    const auto &projection = dynamic_cast<const ProjectionPlanNode &>(*plan);
+    BUSTUB_ENSURE(projection.children_.size() == 1, "Projection with multiple children?? That's weird!");
+    auto child = SeekPastOffset(catalog, projection.GetChildPlan(), offset);
+    if (child == nullptr) {
+      return nullptr;
+    }
+    return projection.CloneWithChildren({std::move(child)});
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeOffsetAsIndexSeek(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeOffsetAsIndexSeek(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() == PlanType::Limit) {
+    const auto &limit_plan = dynamic_cast<const LimitPlanNode &>(*optimized_plan);
+    BUSTUB_ENSURE(limit_plan.children_.size() == 1, "Limit should have exactly 1 children.");
+    if (limit_plan.GetOffset() == 0) {
+      return optimized_plan;
+    }
+    auto seek = SeekPastOffset(catalog_, limit_plan.GetChildPlan(), limit_plan.GetOffset());
+    if (seek == nullptr) {
+      return optimized_plan;
+    }
+    if (limit_plan.GetLimit() == LimitPlanNode::NO_LIMIT) {
+      return seek;
+    }
+    return std::make_shared<LimitPlanNode>(limit_plan.output_schema_, std::move(seek), limit_plan.GetLimit());
+  }
+  return optimized_plan;
+}
+
+}  // namespace bustub
@@ -14,6 +14,10 @@ auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanN
   p = OptimizeNLJAsIndexJoin(p);
   // p = OptimizeNLJAsHashJoin(p);  // Enable this rule after you have implemented hash join.
   p = OptimizeOrderByAsIndexScan(p);
+  p = OptimizeIndexOnlyScan(p);
+  p = OptimizeOffsetAsIndexSeek(p);
+  p = OptimizeCountAsIndexCount(p);
+  p = OptimizeFilterScanAsIndexRangeScan(p);
   p = OptimizeSortLimitAsTopN(p);
   return p;
 }
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "binder/bound_order_by.h"
 #include "catalog/catalog.h"
@@ -21,6 +22,34 @@
 
 namespace bustub {
 
+namespace {
+
+/** @return an index scan of the sequential scan's table that yields the order by columns in order, or nullptr */
+auto MatchOrderByIndex(const Catalog &catalog, const SeqScanPlanNode &seq_scan,
+                       const std::vector<uint32_t> &order_by_column_ids, bool descending)
+    -> std::shared_ptr<IndexScanPlanNode> {
+  if (seq_scan.filter_predicate_ != nullptr) {
+    return nullptr;
+  }
+  const auto *table_info = catalog.GetTable(seq_scan.GetTableOid());
+  const auto indices = catalog.GetTableIndexes(table_info->name_);
+
+  for (const auto *index : indices) {
+    // the index key sorts by the order by columns if they are its leading columns, and the index keeps its order and
+    // holds every tuple
+    const auto &key_attrs = index->index_->GetKeyAttrs();
+    if (index->predicate_ == nullptr && index->index_->HasOrderedScans() &&
+        key_attrs.size() >= order_by_column_ids.size() &&
+        std::equal(order_by_column_ids.begin(), order_by_column_ids.end(), key_attrs.begin())) {
+      // Index matched, return index scan instead
+      return std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, index->index_oid_, descending);
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
@@ -32,41 +61,57 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
     const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*optimized_plan);
     const auto &order_bys = sort_plan.GetOrderBy();
 
-    // Has exactly one order by column
-    if (order_bys.size() != 1) {
-      return optimized_plan;
-    }
-
-    // Order type is asc or default
-    const auto &[order_type, expr] = order_bys[0];
-    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+    // Order types are all asc/default or all desc; a desc order scans the index backwards
+    if (order_bys.empty()) {
       return optimized_plan;
     }
-
-    // Order expression is a column value expression
-    const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
-    if (column_value_expr == nullptr) {
-      return optimized_plan;
+    bool descending = order_bys[0].first == OrderByType::DESC;
+    std::vector<uint32_t> order_by_column_ids;
+    for (const auto &[order_type, expr] : order_bys) {
+      if (order_type == OrderByType::INVALID || (order_type == OrderByType::DESC) != descending) {
+        return optimized_plan;
+      }
+      // Order expression is a column value expression
+      const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
+      if (column_value_expr == nullptr) {
+        return optimized_plan;
+      }
+      order_by_column_ids.push_back(column_value_expr->GetColIdx());
     }
 
-    auto order_by_column_id = column_value_expr->GetColIdx();
-
     // Has exactly one child
     BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
     const auto &child_plan = optimized_plan->children_[0];
 
+    // A projection below the sort is kept above the index scan, if the order by columns are plain table columns
+    if (child_plan->GetType() == PlanType::Projection) {
+      const auto &projection = dynamic_cast<const ProjectionPlanNode &>(*child_plan);
+      BUSTUB_ENSURE(projection.children_.size() == 1, "Projection with multiple children?? That's weird!");
+      if (projection.GetChildPlan()->GetType() != PlanType::SeqScan) {
+        return optimized_plan;
+      }
+      for (auto &column_id : order_by_column_ids) {
+        const auto *column_value_expr =
+            dynamic_cast<const ColumnValueExpression *>(projection.GetExpressions()[column_id].get());
+        if (column_value_expr == nullptr) {
+          return optimized_plan;
+        }
+        column_id = column_value_expr->GetColIdx();
+      }
+      const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*projection.GetChildPlan());
+      auto index_scan = MatchOrderByIndex(catalog_, seq_scan, order_by_column_ids, descending);
+      if (index_scan == nullptr) {
+        return optimized_plan;
+      }
+      return projection.CloneWithChildren({index_scan});
+    }
+
     if (child_plan->GetType() == PlanType::SeqScan) {
       const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
-      const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
-      const auto indices = catalog_.GetTableIndexes(table_info->name_);
-
-      for (const auto *index : indices) {
-        const auto &columns = index->key_schema_.GetColumns();
-        if (columns.size() == 1 &&
-            columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
-          // Index matched, return index scan instead
-          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
-        }
+      auto index_scan = MatchOrderByIndex(catalog_, seq_scan, order_by_column_ids, descending);
+      if (index_scan != nullptr) {
+        index_scan->output_schema_ = optimized_plan->output_schema_;
+        return index_scan;
       }
     }
   }
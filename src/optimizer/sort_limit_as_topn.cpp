@@ -19,12 +19,20 @@ auto Optimizer::OptimizeSortLimitAsTopN(const AbstractPlanNodeRef &plan) -> Abst
     BUSTUB_ENSURE(limit_plan.children_.size() == 1, "Limit should have exactly 1 children.");
 
     const auto &child_plan = optimized_plan->children_[0];
-    if (child_plan->GetType() == PlanType::Sort) {
+    if (child_plan->GetType() == PlanType::Sort && limit_plan.GetLimit() != LimitPlanNode::NO_LIMIT) {
       const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*child_plan);
       BUSTUB_ENSURE(child_plan->GetChildren().size() == 1, "Sort should have exactly 1 children.");
 
-      return std::make_shared<TopNPlanNode>(limit_plan.output_schema_, sort_plan.GetChildPlan(), sort_plan.GetOrderBy(),
-                                            limit_plan.GetLimit());
+      if (limit_plan.GetOffset() == 0) {
+        return std::make_shared<TopNPlanNode>(limit_plan.output_schema_, sort_plan.GetChildPlan(),
+                                              sort_plan.GetOrderBy(), limit_plan.GetLimit());
+      }
+      // the tuples before the offset are among the top ones too, the limit skips them
+      auto n = limit_plan.GetLimit() + limit_plan.GetOffset();
+      auto topn = std::make_shared<TopNPlanNode>(limit_plan.output_schema_, sort_plan.GetChildPlan(),
+                                                 sort_plan.GetOrderBy(), n);
+      return std::make_shared<LimitPlanNode>(limit_plan.output_schema_, std::move(topn), limit_plan.GetLimit(),
+                                             limit_plan.GetOffset());
     }
   }
   return optimized_plan;
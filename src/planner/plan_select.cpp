@@ -145,11 +145,9 @@ auto Planner::PlanSelect(const SelectStatement &statement) -> AbstractPlanNodeRe
       }
     }
 
-    if (offset != std::nullopt) {
-      throw NotImplementedException("OFFSET clause is not supported yet.");
-    }
-
-    plan = std::make_shared<LimitPlanNode>(std::make_shared<Schema>(plan->OutputSchema()), plan, *limit);
+    // OFFSET alone passes on every tuple after the offset
+    plan = std::make_shared<LimitPlanNode>(std::make_shared<Schema>(plan->OutputSchema()), plan,
+                                           limit.value_or(LimitPlanNode::NO_LIMIT), offset.value_or(0));
   }
 
   return plan;
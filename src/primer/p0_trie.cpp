@@ -1,9 +1,207 @@
-#include "primer/p0_trie.h"
-
-// This is a placeholder file for clang-tidy check.
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
 //
-// With this file, we can fire run_clang_tidy.py to check `p0_trie.h`,
-// as it will filter out all header files and won't check header-only code.
+// p0_trie.cpp
 //
-// This file is not part of the submission. All of the modifications should
-// be done in `src/include/primer/p0_trie.h`.
+// Identification: src/primer/p0_trie.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "primer/p0_trie.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+namespace {
+
+/** @return the capacity of the next larger layout */
+auto GrownCapacity(uint16_t capacity) -> uint16_t {
+  switch (capacity) {
+    case 0:
+      return 4;
+    case 4:
+      return 16;
+    case 16:
+      return 48;
+    default:
+      return 256;
+  }
+}
+
+/** @return the capacity of the next smaller layout if size children fit it with room to spare, else capacity */
+auto ShrunkCapacity(uint16_t capacity, uint16_t size) -> uint16_t {
+  if (size == 0) {
+    return 0;
+  }
+  switch (capacity) {
+    case 16:
+      return size < 4 ? 4 : capacity;
+    case 48:
+      return size < 13 ? 16 : capacity;
+    case 256:
+      return size < 38 ? 48 : capacity;
+    default:
+      return capacity;
+  }
+}
+
+}  // namespace
+
+TrieChildren::TrieChildren(TrieChildren &&other) noexcept = default;
+
+auto TrieChildren::operator=(TrieChildren &&other) noexcept -> TrieChildren & = default;
+
+TrieChildren::~TrieChildren() = default;
+
+auto TrieChildren::Find(char key_char) const -> std::unique_ptr<TrieNode> * {
+  auto byte = static_cast<uint8_t>(key_char);
+  auto *slots = const_cast<std::unique_ptr<TrieNode> *>(slots_.data());  // NOLINT
+  if (capacity_ <= 16) {
+    for (uint16_t i = 0; i < size_; i++) {
+      if (keys_[i] == byte) {
+        return &slots[i];
+      }
+    }
+    return nullptr;
+  }
+  if (capacity_ == 48) {
+    auto slot = (*index_)[byte];
+    return slot == 0 ? nullptr : &slots[slot - 1];
+  }
+  return slots[byte] == nullptr ? nullptr : &slots[byte];
+}
+
+auto TrieChildren::Add(char key_char, std::unique_ptr<TrieNode> &&child) -> std::unique_ptr<TrieNode> * {
+  if (size_ == capacity_) {
+    Resize(GrownCapacity(capacity_));
+  }
+  auto byte = static_cast<uint8_t>(key_char);
+  size_++;
+  if (capacity_ <= 16) {
+    // shift the larger key chars up to keep them sorted
+    uint16_t pos = size_ - 1;
+    for (; pos > 0 && keys_[pos - 1] > byte; pos--) {
+      keys_[pos] = keys_[pos - 1];
+      slots_[pos] = std::move(slots_[pos - 1]);
+    }
+    keys_[pos] = byte;
+    slots_[pos] = std::move(child);
+    return &slots_[pos];
+  }
+  if (capacity_ == 48) {
+    (*index_)[byte] = size_;
+    slots_[size_ - 1] = std::move(child);
+    return &slots_[size_ - 1];
+  }
+  slots_[byte] = std::move(child);
+  return &slots_[byte];
+}
+
+void TrieChildren::Remove(char key_char) {
+  auto byte = static_cast<uint8_t>(key_char);
+  if (capacity_ <= 16) {
+    auto *end = keys_.begin() + size_;
+    auto *pos = std::find(keys_.begin(), end, byte);
+    if (pos == end) {
+      return;
+    }
+    for (auto i = static_cast<uint16_t>(pos - keys_.begin()); i + 1 < size_; i++) {
+      keys_[i] = keys_[i + 1];
+      slots_[i] = std::move(slots_[i + 1]);
+    }
+    slots_[size_ - 1].reset();
+  } else if (capacity_ == 48) {
+    auto slot = (*index_)[byte];
+    if (slot == 0) {
+      return;
+    }
+    // the last slot takes the place of the removed one
+    (*index_)[byte] = 0;
+    slots_[slot - 1] = std::move(slots_[size_ - 1]);
+    if (slot != size_) {
+      (*index_)[static_cast<uint8_t>(slots_[slot - 1]->GetKeyChar())] = slot;
+    }
+  } else {
+    if (slots_[byte] == nullptr) {
+      return;
+    }
+    slots_[byte].reset();
+  }
+  size_--;
+  if (auto capacity = ShrunkCapacity(capacity_, size_); capacity != capacity_) {
+    Resize(capacity);
+  }
+}
+
+auto TrieChildren::Next(int from) const -> std::unique_ptr<TrieNode> * {
+  auto *slots = const_cast<std::unique_ptr<TrieNode> *>(slots_.data());  // NOLINT
+  if (capacity_ <= 16) {
+    for (uint16_t i = 0; i < size_; i++) {
+      if (keys_[i] >= from) {
+        return &slots[i];
+      }
+    }
+    return nullptr;
+  }
+  for (int byte = from; byte <= UINT8_MAX; byte++) {
+    if (capacity_ == 48 && (*index_)[byte] != 0) {
+      return &slots[(*index_)[byte] - 1];
+    }
+    if (capacity_ == 256 && slots[byte] != nullptr) {
+      return &slots[byte];
+    }
+  }
+  return nullptr;
+}
+
+auto TrieChildren::Prev(int to) const -> std::unique_ptr<TrieNode> * {
+  auto *slots = const_cast<std::unique_ptr<TrieNode> *>(slots_.data());  // NOLINT
+  if (capacity_ <= 16) {
+    for (uint16_t i = size_; i > 0; i--) {
+      if (keys_[i - 1] <= to) {
+        return &slots[i - 1];
+      }
+    }
+    return nullptr;
+  }
+  for (int byte = to; byte >= 0; byte--) {
+    if (capacity_ == 48 && (*index_)[byte] != 0) {
+      return &slots[(*index_)[byte] - 1];
+    }
+    if (capacity_ == 256 && slots[byte] != nullptr) {
+      return &slots[byte];
+    }
+  }
+  return nullptr;
+}
+
+void TrieChildren::Resize(uint16_t capacity) {
+  std::vector<std::unique_ptr<TrieNode>> children;
+  children.reserve(size_);
+  // the key chars come in order, so the next child is looked up from the char after the moved one
+  for (auto *child = Next(0); child != nullptr;) {
+    int key_char = static_cast<uint8_t>((*child)->GetKeyChar());
+    children.push_back(std::move(*child));
+    child = key_char == UINT8_MAX ? nullptr : Next(key_char + 1);
+  }
+
+  capacity_ = capacity;
+  size_ = 0;
+  slots_.clear();
+  slots_.resize(capacity);
+  index_.reset();
+  if (capacity == 48) {
+    index_ = std::make_unique<std::array<uint8_t, 256>>();
+    index_->fill(0);
+  }
+  for (auto &child : children) {
+    char key_char = child->GetKeyChar();
+    Add(key_char, std::move(child));
+  }
+}
+
+}  // namespace bustub
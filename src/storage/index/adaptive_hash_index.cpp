@@ -0,0 +1,75 @@
+#include "storage/index/adaptive_hash_index.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+AdaptiveHashIndex::AdaptiveHashIndex(size_t capacity, uint32_t hot_threshold)
+    : hot_threshold_(std::max<uint32_t>(hot_threshold, 1)), partitions_(NUM_PARTITIONS) {
+  auto entries_per_partition = std::max<size_t>(capacity / NUM_PARTITIONS, 1);
+  for (auto &partition : partitions_) {
+    partition.entries_.resize(entries_per_partition);
+  }
+}
+
+auto AdaptiveHashIndex::BucketOf(uint64_t hash) -> std::pair<Partition *, Entry *> {
+  // the high bits pick the partition and the low bits the bucket in it
+  auto *partition = &partitions_[(hash >> 32) % NUM_PARTITIONS];
+  return {partition, &partition->entries_[hash % partition->entries_.size()]};
+}
+
+auto AdaptiveHashIndex::Lookup(uint64_t hash) -> std::optional<std::pair<page_id_t, int>> {
+  auto [partition, entry] = BucketOf(hash);
+  std::scoped_lock lock(partition->latch_);
+  if (entry->hash_ == hash) {
+    entry->lookups_ = std::min(entry->lookups_ + 1, hot_threshold_);
+    if (entry->page_id_ != INVALID_PAGE_ID) {
+      return std::make_pair(entry->page_id_, entry->slot_);
+    }
+    return std::nullopt;
+  }
+  // another key holds the bucket, it has to be looked up as often as this one to keep it
+  if (entry->lookups_ > 0) {
+    entry->lookups_--;
+  } else {
+    *entry = Entry{hash, INVALID_PAGE_ID, -1, 1};
+  }
+  return std::nullopt;
+}
+
+auto AdaptiveHashIndex::IsCached(uint64_t hash, page_id_t page_id) -> bool {
+  auto [partition, entry] = BucketOf(hash);
+  std::scoped_lock lock(partition->latch_);
+  return entry->hash_ == hash && entry->page_id_ == page_id;
+}
+
+void AdaptiveHashIndex::Record(uint64_t hash, page_id_t page_id, int slot) {
+  auto [partition, entry] = BucketOf(hash);
+  std::scoped_lock lock(partition->latch_);
+  if (entry->hash_ == hash && entry->lookups_ >= hot_threshold_) {
+    entry->page_id_ = page_id;
+    entry->slot_ = slot;
+  }
+}
+
+void AdaptiveHashIndex::Forget(uint64_t hash, page_id_t page_id) {
+  auto [partition, entry] = BucketOf(hash);
+  std::scoped_lock lock(partition->latch_);
+  if (entry->hash_ == hash && entry->page_id_ == page_id) {
+    entry->page_id_ = INVALID_PAGE_ID;
+  }
+}
+
+void AdaptiveHashIndex::InvalidatePage(page_id_t page_id) {
+  // the keys stay hot, the next lookup of each caches its new leaf
+  for (auto &partition : partitions_) {
+    std::scoped_lock lock(partition.latch_);
+    for (auto &entry : partition.entries_) {
+      if (entry.page_id_ == page_id) {
+        entry.page_id_ = INVALID_PAGE_ID;
+      }
+    }
+  }
+}
+
+}  // namespace bustub
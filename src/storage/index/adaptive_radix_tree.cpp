@@ -0,0 +1,1155 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.cpp
+//
+// Identification: src/storage/index/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/adaptive_radix_tree.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * NODES
+ *****************************************************************************/
+enum class ARTNodeType : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+
+/**
+ * The header of every inner node. Optimistic readers read the fields while a
+ * writer may change them, so every field is atomic; a read is only used once
+ * the version shows that no writer came in between.
+ */
+template <size_t KeyLength>
+struct ARTNode {
+  explicit ARTNode(ARTNodeType type) : type_(type) {}
+
+  /** Read the version if the node is neither locked nor replaced. @return false if the reader has to start over */
+  auto ReadLock(uint64_t *version) const -> bool {
+    *version = version_.load();
+    if ((*version & LOCKED) != 0) {
+      std::this_thread::yield();
+    }
+    return (*version & (LOCKED | OBSOLETE)) == 0;
+  }
+
+  /** @return true if the node did not change since it was at version */
+  auto Validate(uint64_t version) const -> bool { return version_.load() == version; }
+
+  /** Lock the node if it is still at version. @return false if it changed, and the writer has to start over */
+  auto Upgrade(uint64_t version) -> bool { return version_.compare_exchange_strong(version, version + LOCKED); }
+
+  void WriteUnlock() { version_.fetch_add(LOCKED); }
+
+  /** Unlock a node that was unlinked from the tree, readers that still find it start over. */
+  void WriteUnlockObsolete() { version_.fetch_add(LOCKED + OBSOLETE); }
+
+  static constexpr uint64_t OBSOLETE = 1;
+  static constexpr uint64_t LOCKED = 2;
+
+  // the count of changes, above the locked and the obsolete bits
+  std::atomic<uint64_t> version_{0};
+  const ARTNodeType type_;
+  std::atomic<uint16_t> count_{0};
+  std::atomic<uint32_t> prefix_length_{0};
+  // the bytes every key below the node shares, after those of the path to it
+  std::array<std::atomic<uint8_t>, KeyLength> prefix_{};
+};
+
+/** Node4 and Node16, the key bytes of the children in order. */
+template <size_t KeyLength, size_t Capacity>
+struct ARTSortedNode : public ARTNode<KeyLength> {
+  ARTSortedNode() : ARTNode<KeyLength>(Capacity == 4 ? ARTNodeType::NODE4 : ARTNodeType::NODE16) {}
+
+  std::array<std::atomic<uint8_t>, Capacity> keys_{};
+  std::array<std::atomic<uintptr_t>, Capacity> children_{};
+};
+
+template <size_t KeyLength>
+using ARTNode4 = ARTSortedNode<KeyLength, 4>;
+template <size_t KeyLength>
+using ARTNode16 = ARTSortedNode<KeyLength, 16>;
+
+/** Node48, a slot per key byte that points into 48 children. */
+template <size_t KeyLength>
+struct ARTNode48 : public ARTNode<KeyLength> {
+  ARTNode48() : ARTNode<KeyLength>(ARTNodeType::NODE48) {}
+
+  // the slot of the child of every key byte plus one, zero if it has none
+  std::array<std::atomic<uint8_t>, 256> child_index_{};
+  std::array<std::atomic<uintptr_t>, 48> children_{};
+};
+
+/** Node256, a child per key byte. */
+template <size_t KeyLength>
+struct ARTNode256 : public ARTNode<KeyLength> {
+  ARTNode256() : ARTNode<KeyLength>(ARTNodeType::NODE256) {}
+
+  std::array<std::atomic<uintptr_t>, 256> children_{};
+};
+
+/** A leaf never changes, a new one replaces it. */
+template <size_t KeyLength>
+struct ARTLeaf {
+  std::array<uint8_t, KeyLength> key_;
+};
+
+namespace {
+
+constexpr uintptr_t LEAF_TAG = 1;
+
+inline auto IsLeaf(uintptr_t child) -> bool { return (child & LEAF_TAG) != 0; }
+
+template <size_t L>
+auto AsLeaf(uintptr_t child) -> ARTLeaf<L> * {
+  return reinterpret_cast<ARTLeaf<L> *>(child & ~LEAF_TAG);
+}
+
+template <size_t L>
+auto AsNode(uintptr_t child) -> ARTNode<L> * {
+  return reinterpret_cast<ARTNode<L> *>(child);
+}
+
+template <size_t L>
+auto LeafChild(ARTLeaf<L> *leaf) -> uintptr_t {
+  return reinterpret_cast<uintptr_t>(leaf) | LEAF_TAG;
+}
+
+template <size_t L>
+auto NodeChild(ARTNode<L> *node) -> uintptr_t {
+  return reinterpret_cast<uintptr_t>(node);
+}
+
+template <size_t L>
+auto MakeLeaf(const std::array<uint8_t, L> &key) -> uintptr_t {
+  return LeafChild(new ARTLeaf<L>{key});
+}
+
+constexpr auto Capacity(ARTNodeType type) -> size_t {
+  switch (type) {
+    case ARTNodeType::NODE4:
+      return 4;
+    case ARTNodeType::NODE16:
+      return 16;
+    case ARTNodeType::NODE48:
+      return 48;
+    case ARTNodeType::NODE256:
+      break;
+  }
+  return 256;
+}
+
+/** A node shrinks to the next smaller type once it holds fewer children than this, see TryRemove. */
+constexpr auto MinCount(ARTNodeType type) -> size_t {
+  switch (type) {
+    case ARTNodeType::NODE4:
+      return 2;
+    case ARTNodeType::NODE16:
+      return 4;
+    case ARTNodeType::NODE48:
+      return 13;
+    case ARTNodeType::NODE256:
+      break;
+  }
+  return 38;
+}
+
+template <size_t L>
+auto NewNode(ARTNodeType type) -> ARTNode<L> * {
+  switch (type) {
+    case ARTNodeType::NODE4:
+      return new ARTNode4<L>();
+    case ARTNodeType::NODE16:
+      return new ARTNode16<L>();
+    case ARTNodeType::NODE48:
+      return new ARTNode48<L>();
+    case ARTNodeType::NODE256:
+      break;
+  }
+  return new ARTNode256<L>();
+}
+
+template <size_t L>
+void Free(uintptr_t child) {
+  if (IsLeaf(child)) {
+    delete AsLeaf<L>(child);
+    return;
+  }
+  auto *node = AsNode<L>(child);
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+      delete static_cast<ARTNode4<L> *>(node);
+      break;
+    case ARTNodeType::NODE16:
+      delete static_cast<ARTNode16<L> *>(node);
+      break;
+    case ARTNodeType::NODE48:
+      delete static_cast<ARTNode48<L> *>(node);
+      break;
+    case ARTNodeType::NODE256:
+      delete static_cast<ARTNode256<L> *>(node);
+      break;
+  }
+}
+
+/** Copy the prefix of node into prefix. @return its length, no more than the key has left after depth */
+template <size_t L>
+auto ReadPrefix(const ARTNode<L> *node, size_t depth, std::array<uint8_t, L> *prefix) -> size_t {
+  // a torn read may see any length, the version check after it throws it away
+  size_t length = std::min<size_t>(node->prefix_length_.load(), L - depth - 1);
+  for (size_t i = 0; i < length; i++) {
+    (*prefix)[i] = node->prefix_[i].load();
+  }
+  return length;
+}
+
+template <size_t L>
+void SetPrefix(ARTNode<L> *node, const uint8_t *prefix, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    node->prefix_[i].store(prefix[i]);
+  }
+  node->prefix_length_.store(static_cast<uint32_t>(length));
+}
+
+/** @return the child of the key byte, 0 if there is none */
+template <size_t L>
+auto GetChild(const ARTNode<L> *node, uint8_t byte) -> uintptr_t {
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+    case ARTNodeType::NODE16: {
+      auto find = [byte](const auto *sorted) -> uintptr_t {
+        size_t count = std::min<size_t>(sorted->count_.load(), sorted->keys_.size());
+        for (size_t i = 0; i < count; i++) {
+          if (sorted->keys_[i].load() == byte) {
+            return sorted->children_[i].load();
+          }
+        }
+        return 0;
+      };
+      return node->type_ == ARTNodeType::NODE4 ? find(static_cast<const ARTNode4<L> *>(node))
+                                               : find(static_cast<const ARTNode16<L> *>(node));
+    }
+    case ARTNodeType::NODE48: {
+      const auto *node48 = static_cast<const ARTNode48<L> *>(node);
+      size_t slot = node48->child_index_[byte].load();
+      return slot == 0 ? 0 : node48->children_[slot - 1].load();
+    }
+    case ARTNodeType::NODE256:
+      break;
+  }
+  return static_cast<const ARTNode256<L> *>(node)->children_[byte].load();
+}
+
+/** @return the child of the smallest key byte from from on, and that byte, 0 if there is none */
+template <size_t L>
+auto FindNext(const ARTNode<L> *node, int from, uint8_t *byte) -> uintptr_t {
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+    case ARTNodeType::NODE16: {
+      auto find = [from, byte](const auto *sorted) -> uintptr_t {
+        size_t count = std::min<size_t>(sorted->count_.load(), sorted->keys_.size());
+        for (size_t i = 0; i < count; i++) {
+          uint8_t key = sorted->keys_[i].load();
+          if (key >= from) {
+            *byte = key;
+            return sorted->children_[i].load();
+          }
+        }
+        return 0;
+      };
+      return node->type_ == ARTNodeType::NODE4 ? find(static_cast<const ARTNode4<L> *>(node))
+                                               : find(static_cast<const ARTNode16<L> *>(node));
+    }
+    case ARTNodeType::NODE48: {
+      const auto *node48 = static_cast<const ARTNode48<L> *>(node);
+      for (int key = from; key < 256; key++) {
+        size_t slot = node48->child_index_[key].load();
+        if (slot != 0) {
+          *byte = static_cast<uint8_t>(key);
+          return node48->children_[slot - 1].load();
+        }
+      }
+      return 0;
+    }
+    case ARTNodeType::NODE256:
+      break;
+  }
+  const auto *node256 = static_cast<const ARTNode256<L> *>(node);
+  for (int key = from; key < 256; key++) {
+    uintptr_t child = node256->children_[key].load();
+    if (child != 0) {
+      *byte = static_cast<uint8_t>(key);
+      return child;
+    }
+  }
+  return 0;
+}
+
+/** @return the child of the largest key byte up to to, and that byte, 0 if there is none */
+template <size_t L>
+auto FindPrev(const ARTNode<L> *node, int to, uint8_t *byte) -> uintptr_t {
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+    case ARTNodeType::NODE16: {
+      auto find = [to, byte](const auto *sorted) -> uintptr_t {
+        size_t count = std::min<size_t>(sorted->count_.load(), sorted->keys_.size());
+        for (size_t i = count; i > 0; i--) {
+          uint8_t key = sorted->keys_[i - 1].load();
+          if (key <= to) {
+            *byte = key;
+            return sorted->children_[i - 1].load();
+          }
+        }
+        return 0;
+      };
+      return node->type_ == ARTNodeType::NODE4 ? find(static_cast<const ARTNode4<L> *>(node))
+                                               : find(static_cast<const ARTNode16<L> *>(node));
+    }
+    case ARTNodeType::NODE48: {
+      const auto *node48 = static_cast<const ARTNode48<L> *>(node);
+      for (int key = to; key >= 0; key--) {
+        size_t slot = node48->child_index_[key].load();
+        if (slot != 0) {
+          *byte = static_cast<uint8_t>(key);
+          return node48->children_[slot - 1].load();
+        }
+      }
+      return 0;
+    }
+    case ARTNodeType::NODE256:
+      break;
+  }
+  const auto *node256 = static_cast<const ARTNode256<L> *>(node);
+  for (int key = to; key >= 0; key--) {
+    uintptr_t child = node256->children_[key].load();
+    if (child != 0) {
+      *byte = static_cast<uint8_t>(key);
+      return child;
+    }
+  }
+  return 0;
+}
+
+/*
+ * The changes below run under the lock of the node, or on a node that is not
+ * in the tree yet.
+ */
+
+/** Add the child of a key byte the node has no child for, the node is not full. */
+template <size_t L>
+void AddChild(ARTNode<L> *node, uint8_t byte, uintptr_t child) {
+  size_t count = node->count_.load();
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+    case ARTNodeType::NODE16: {
+      auto add = [count, byte, child](auto *sorted) {
+        size_t pos = 0;
+        while (pos < count && sorted->keys_[pos].load() < byte) {
+          pos++;
+        }
+        for (size_t i = count; i > pos; i--) {
+          sorted->keys_[i].store(sorted->keys_[i - 1].load());
+          sorted->children_[i].store(sorted->children_[i - 1].load());
+        }
+        sorted->keys_[pos].store(byte);
+        sorted->children_[pos].store(child);
+      };
+      if (node->type_ == ARTNodeType::NODE4) {
+        add(static_cast<ARTNode4<L> *>(node));
+      } else {
+        add(static_cast<ARTNode16<L> *>(node));
+      }
+      break;
+    }
+    case ARTNodeType::NODE48: {
+      auto *node48 = static_cast<ARTNode48<L> *>(node);
+      size_t slot = 0;
+      while (node48->children_[slot].load() != 0) {
+        slot++;
+      }
+      node48->children_[slot].store(child);
+      node48->child_index_[byte].store(static_cast<uint8_t>(slot + 1));
+      break;
+    }
+    case ARTNodeType::NODE256:
+      static_cast<ARTNode256<L> *>(node)->children_[byte].store(child);
+      break;
+  }
+  node->count_.store(static_cast<uint16_t>(count + 1));
+}
+
+/** Replace the child of a key byte the node has a child for. */
+template <size_t L>
+void ChangeChild(ARTNode<L> *node, uint8_t byte, uintptr_t child) {
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+    case ARTNodeType::NODE16: {
+      auto change = [byte, child](auto *sorted) {
+        size_t count = sorted->count_.load();
+        for (size_t i = 0; i < count; i++) {
+          if (sorted->keys_[i].load() == byte) {
+            sorted->children_[i].store(child);
+            return;
+          }
+        }
+      };
+      if (node->type_ == ARTNodeType::NODE4) {
+        change(static_cast<ARTNode4<L> *>(node));
+      } else {
+        change(static_cast<ARTNode16<L> *>(node));
+      }
+      break;
+    }
+    case ARTNodeType::NODE48: {
+      auto *node48 = static_cast<ARTNode48<L> *>(node);
+      node48->children_[node48->child_index_[byte].load() - 1].store(child);
+      break;
+    }
+    case ARTNodeType::NODE256:
+      static_cast<ARTNode256<L> *>(node)->children_[byte].store(child);
+      break;
+  }
+}
+
+/** Remove the child of a key byte the node has a child for. */
+template <size_t L>
+void RemoveChild(ARTNode<L> *node, uint8_t byte) {
+  size_t count = node->count_.load();
+  switch (node->type_) {
+    case ARTNodeType::NODE4:
+    case ARTNodeType::NODE16: {
+      auto remove = [count, byte](auto *sorted) {
+        size_t pos = 0;
+        while (sorted->keys_[pos].load() != byte) {
+          pos++;
+        }
+        for (size_t i = pos + 1; i < count; i++) {
+          sorted->keys_[i - 1].store(sorted->keys_[i].load());
+          sorted->children_[i - 1].store(sorted->children_[i].load());
+        }
+        sorted->children_[count - 1].store(0);
+      };
+      if (node->type_ == ARTNodeType::NODE4) {
+        remove(static_cast<ARTNode4<L> *>(node));
+      } else {
+        remove(static_cast<ARTNode16<L> *>(node));
+      }
+      break;
+    }
+    case ARTNodeType::NODE48: {
+      auto *node48 = static_cast<ARTNode48<L> *>(node);
+      node48->children_[node48->child_index_[byte].load() - 1].store(0);
+      node48->child_index_[byte].store(0);
+      break;
+    }
+    case ARTNodeType::NODE256:
+      static_cast<ARTNode256<L> *>(node)->children_[byte].store(0);
+      break;
+  }
+  node->count_.store(static_cast<uint16_t>(count - 1));
+}
+
+/** @return a new node of the given type with the prefix and the children of node */
+template <size_t L>
+auto CopyNode(const ARTNode<L> *node, ARTNodeType type) -> ARTNode<L> * {
+  auto *copy = NewNode<L>(type);
+  size_t length = node->prefix_length_.load();
+  for (size_t i = 0; i < length; i++) {
+    copy->prefix_[i].store(node->prefix_[i].load());
+  }
+  copy->prefix_length_.store(static_cast<uint32_t>(length));
+  uint8_t byte;
+  for (int from = 0; from < 256; from = byte + 1) {
+    uintptr_t child = FindNext(node, from, &byte);
+    if (child == 0) {
+      break;
+    }
+    AddChild(copy, byte, child);
+  }
+  return copy;
+}
+
+}  // namespace
+
+/*****************************************************************************
+ * ITERATOR
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+ART_ITERATOR_TYPE::AdaptiveRadixTreeIterator(ART_TYPE *tree, std::vector<MappingType> &&batch, size_t index,
+                                             const KeyType &stop_key, size_t stop_length)
+    : tree_(tree), batch_(std::move(batch)), index_(index), stop_key_(stop_key), stop_length_(stop_length) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_ITERATOR_TYPE::IsBegin() -> bool {
+  if (index_ > 0) {
+    return false;
+  }
+  std::vector<MappingType> before;
+  if (batch_.empty()) {
+    tree_->ScanBackward(nullptr, 1, &before);
+  } else {
+    auto first = ART_TYPE::EncodeKey(batch_.front().first, batch_.front().second);
+    tree_->ScanBackward(&first, 1, &before);
+  }
+  return before.empty();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_ITERATOR_TYPE::operator++() -> AdaptiveRadixTreeIterator & {
+  index_++;
+  if (index_ == batch_.size()) {
+    // past the last entry the cursor stays on the batch, so that it can step back
+    std::vector<MappingType> next;
+    auto last = ART_TYPE::EncodeKey(batch_.back().first, batch_.back().second);
+    tree_->ScanForward(&last, false, reinterpret_cast<const uint8_t *>(&stop_key_), stop_length_, BATCH_SIZE, &next);
+    if (!next.empty()) {
+      batch_ = std::move(next);
+      index_ = 0;
+    }
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_ITERATOR_TYPE::operator--() -> AdaptiveRadixTreeIterator & {
+  if (index_ > 0) {
+    index_--;
+    return *this;
+  }
+  std::vector<MappingType> prev;
+  if (batch_.empty()) {
+    tree_->ScanBackward(nullptr, BATCH_SIZE, &prev);
+  } else {
+    auto first = ART_TYPE::EncodeKey(batch_.front().first, batch_.front().second);
+    tree_->ScanBackward(&first, BATCH_SIZE, &prev);
+  }
+  if (!prev.empty()) {
+    std::reverse(prev.begin(), prev.end());
+    batch_ = std::move(prev);
+    index_ = batch_.size() - 1;
+  }
+  return *this;
+}
+
+/*****************************************************************************
+ * TREE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+ART_TYPE::AdaptiveRadixTree() : root_(NewNode<KEY_LENGTH>(ARTNodeType::NODE256)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+ART_TYPE::~AdaptiveRadixTree() {
+  FreeSubtree(NodeChild(root_));
+  for (auto &retired : retired_) {
+    for (auto child : retired) {
+      Free<KEY_LENGTH>(child);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::EncodeKey(const KeyType &key, const ValueType &value) -> Key {
+  Key art_key;
+  memcpy(art_key.data(), &key, sizeof(KeyType));
+  // big endian with the sign bit flipped, so that the values sort by their bytes
+  auto bits = static_cast<uint64_t>(value.Get()) ^ (uint64_t{1} << 63);
+  for (size_t i = 0; i < sizeof(int64_t); i++) {
+    art_key[sizeof(KeyType) + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+  }
+  return art_key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::DecodeKey(const Key &key) -> MappingType {
+  MappingType entry;
+  memcpy(&entry.first, key.data(), sizeof(KeyType));
+  uint64_t bits = 0;
+  for (size_t i = 0; i < sizeof(int64_t); i++) {
+    bits = (bits << 8) | key[sizeof(KeyType) + i];
+  }
+  entry.second = ValueType(static_cast<int64_t>(bits ^ (uint64_t{1} << 63)));
+  return entry;
+}
+
+/*****************************************************************************
+ * EPOCHS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+ART_TYPE::EpochGuard::EpochGuard(AdaptiveRadixTree *tree) : tree_(tree) {
+  while (true) {
+    epoch_ = tree_->epoch_.load();
+    tree_->active_[epoch_ & 1].fetch_add(1);
+    // the epoch may have moved on before the operation was counted in it
+    if (tree_->epoch_.load() == epoch_) {
+      return;
+    }
+    tree_->active_[epoch_ & 1].fetch_sub(1);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ART_TYPE::EpochGuard::~EpochGuard() { tree_->active_[epoch_ & 1].fetch_sub(1); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_TYPE::Retire(Child child) {
+  std::scoped_lock lock(retire_latch_);
+  retired_[epoch_.load() & 1].push_back(child);
+  if (retired_[0].size() + retired_[1].size() >= RECLAIM_BATCH) {
+    TryReclaim();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_TYPE::TryReclaim() {
+  // operations only run in the current epoch and the one before, so once none runs in the one before, no operation
+  // can hold what was retired in it, and the epoch may move on
+  auto epoch = epoch_.load();
+  if (active_[(epoch + 1) & 1].load() != 0) {
+    return;
+  }
+  auto &retired = retired_[(epoch + 1) & 1];
+  for (auto child : retired) {
+    Free<KEY_LENGTH>(child);
+  }
+  retired.clear();
+  epoch_.store(epoch + 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_TYPE::FreeSubtree(Child child) {
+  if (!IsLeaf(child)) {
+    auto *node = AsNode<KEY_LENGTH>(child);
+    uint8_t byte;
+    for (int from = 0; from < 256; from = byte + 1) {
+      auto grandchild = FindNext(node, from, &byte);
+      if (grandchild == 0) {
+        break;
+      }
+      FreeSubtree(grandchild);
+    }
+  }
+  Free<KEY_LENGTH>(child);
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::Insert(const KeyType &key, const ValueType &value) -> bool {
+  auto art_key = EncodeKey(key, value);
+  EpochGuard guard(this);
+  while (true) {
+    auto inserted = TryInsert(art_key);
+    if (inserted.has_value()) {
+      return *inserted;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::TryInsert(const Key &key) -> std::optional<bool> {
+  // the root is a node256 without prefix, it never splits, grows or shrinks, so every other node has a parent
+  Node *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  Node *node = root_;
+  uint64_t version;
+  if (!node->ReadLock(&version)) {
+    return std::nullopt;
+  }
+  size_t depth = 0;
+  Key prefix;
+  while (true) {
+    size_t prefix_length = ReadPrefix(node, depth, &prefix);
+    size_t shared = 0;
+    while (shared < prefix_length && prefix[shared] == key[depth + shared]) {
+      shared++;
+    }
+    if (!node->Validate(version)) {
+      return std::nullopt;
+    }
+    if (shared < prefix_length) {
+      // the key leaves the prefix, a new node takes the bytes before and branches where it does
+      if (!parent->Upgrade(parent_version)) {
+        return std::nullopt;
+      }
+      if (!node->Upgrade(version)) {
+        parent->WriteUnlock();
+        return std::nullopt;
+      }
+      auto *split = NewNode<KEY_LENGTH>(ARTNodeType::NODE4);
+      SetPrefix(split, prefix.data(), shared);
+      AddChild(split, key[depth + shared], MakeLeaf(key));
+      AddChild(split, prefix[shared], NodeChild(node));
+      SetPrefix(node, prefix.data() + shared + 1, prefix_length - shared - 1);
+      ChangeChild(parent, parent_byte, NodeChild(split));
+      node->WriteUnlock();
+      parent->WriteUnlock();
+      return true;
+    }
+    depth += prefix_length;
+
+    uint8_t byte = key[depth];
+    Child child = GetChild(node, byte);
+    bool full = node->count_.load() == Capacity(node->type_);
+    if (!node->Validate(version)) {
+      return std::nullopt;
+    }
+
+    if (child == 0) {
+      if (!full) {
+        if (!node->Upgrade(version)) {
+          return std::nullopt;
+        }
+        AddChild(node, byte, MakeLeaf(key));
+        node->WriteUnlock();
+        return true;
+      }
+      // a full node is replaced by a copy of the next larger type
+      if (!parent->Upgrade(parent_version)) {
+        return std::nullopt;
+      }
+      if (!node->Upgrade(version)) {
+        parent->WriteUnlock();
+        return std::nullopt;
+      }
+      auto *grown = CopyNode(node, static_cast<ARTNodeType>(static_cast<uint8_t>(node->type_) + 1));
+      AddChild(grown, byte, MakeLeaf(key));
+      ChangeChild(parent, parent_byte, NodeChild(grown));
+      node->WriteUnlockObsolete();
+      parent->WriteUnlock();
+      Retire(NodeChild(node));
+      return true;
+    }
+
+    if (IsLeaf(child)) {
+      // the leaf shares the bytes up to the key byte, a new node takes those both keys share after it
+      const auto &leaf_key = AsLeaf<KEY_LENGTH>(child)->key_;
+      if (leaf_key == key) {
+        return false;
+      }
+      size_t next_depth = depth + 1;
+      shared = 0;
+      while (leaf_key[next_depth + shared] == key[next_depth + shared]) {
+        shared++;
+      }
+      if (!node->Upgrade(version)) {
+        return std::nullopt;
+      }
+      auto *split = NewNode<KEY_LENGTH>(ARTNodeType::NODE4);
+      SetPrefix(split, key.data() + next_depth, shared);
+      AddChild(split, key[next_depth + shared], MakeLeaf(key));
+      AddChild(split, leaf_key[next_depth + shared], child);
+      ChangeChild(node, byte, NodeChild(split));
+      node->WriteUnlock();
+      return true;
+    }
+
+    // the version of the child is read before that of its parent is checked, so that a child that was moved or
+    // changed in between is caught
+    auto *next = AsNode<KEY_LENGTH>(child);
+    uint64_t next_version;
+    if (!next->ReadLock(&next_version) || !node->Validate(version)) {
+      return std::nullopt;
+    }
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = next;
+    version = next_version;
+    depth++;
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::Remove(const KeyType &key, const ValueType &value) -> bool {
+  auto art_key = EncodeKey(key, value);
+  EpochGuard guard(this);
+  while (true) {
+    auto removed = TryRemove(art_key);
+    if (removed.has_value()) {
+      return *removed;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::TryRemove(const Key &key) -> std::optional<bool> {
+  Node *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  Node *node = root_;
+  uint64_t version;
+  if (!node->ReadLock(&version)) {
+    return std::nullopt;
+  }
+  size_t depth = 0;
+  Key prefix;
+  while (true) {
+    size_t prefix_length = ReadPrefix(node, depth, &prefix);
+    bool matches = std::equal(prefix.begin(), prefix.begin() + prefix_length, key.begin() + depth);
+    if (!node->Validate(version)) {
+      return std::nullopt;
+    }
+    if (!matches) {
+      return false;
+    }
+    depth += prefix_length;
+
+    uint8_t byte = key[depth];
+    Child child = GetChild(node, byte);
+    size_t count = node->count_.load();
+    if (!node->Validate(version)) {
+      return std::nullopt;
+    }
+    if (child == 0) {
+      return false;
+    }
+
+    if (IsLeaf(child)) {
+      if (AsLeaf<KEY_LENGTH>(child)->key_ != key) {
+        return false;
+      }
+      if (node == root_ || count > MinCount(node->type_)) {
+        if (!node->Upgrade(version)) {
+          return std::nullopt;
+        }
+        RemoveChild(node, byte);
+        node->WriteUnlock();
+        Retire(child);
+        return true;
+      }
+
+      if (!parent->Upgrade(parent_version)) {
+        return std::nullopt;
+      }
+      if (!node->Upgrade(version)) {
+        parent->WriteUnlock();
+        return std::nullopt;
+      }
+      RemoveChild(node, byte);
+      if (node->type_ != ARTNodeType::NODE4) {
+        // the node shrinks to a copy of the next smaller type
+        auto *shrunk = CopyNode(node, static_cast<ARTNodeType>(static_cast<uint8_t>(node->type_) - 1));
+        ChangeChild(parent, parent_byte, NodeChild(shrunk));
+      } else {
+        // a node4 with one child left is replaced by that child, which takes the prefix of the node
+        uint8_t other_byte;
+        Child other = FindNext(node, 0, &other_byte);
+        if (!IsLeaf(other)) {
+          auto *other_node = AsNode<KEY_LENGTH>(other);
+          uint64_t other_version;
+          if (!other_node->ReadLock(&other_version) || !other_node->Upgrade(other_version)) {
+            // put the leaf back, nothing changed
+            AddChild(node, byte, child);
+            node->WriteUnlock();
+            parent->WriteUnlock();
+            return std::nullopt;
+          }
+          Key merged;
+          std::copy(prefix.begin(), prefix.begin() + prefix_length, merged.begin());
+          merged[prefix_length] = other_byte;
+          Key other_prefix;
+          size_t other_length = ReadPrefix(other_node, depth + 1, &other_prefix);
+          std::copy(other_prefix.begin(), other_prefix.begin() + other_length, merged.begin() + prefix_length + 1);
+          SetPrefix(other_node, merged.data(), prefix_length + 1 + other_length);
+          other_node->WriteUnlock();
+        }
+        ChangeChild(parent, parent_byte, other);
+      }
+      node->WriteUnlockObsolete();
+      parent->WriteUnlock();
+      Retire(NodeChild(node));
+      Retire(child);
+      return true;
+    }
+
+    auto *next = AsNode<KEY_LENGTH>(child);
+    uint64_t next_version;
+    if (!next->ReadLock(&next_version) || !node->Validate(version)) {
+      return std::nullopt;
+    }
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = next;
+    version = next_version;
+    depth++;
+  }
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool {
+  // the entries of the key start at the key with the smallest value bytes
+  Key from{};
+  memcpy(from.data(), &key, sizeof(KeyType));
+  std::vector<MappingType> entries;
+  ScanForward(&from, true, from.data(), sizeof(KeyType), std::numeric_limits<size_t>::max(), &entries);
+  for (const auto &entry : entries) {
+    result->push_back(entry.second);
+  }
+  return !entries.empty();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_TYPE::ScanForward(const Key *bound, bool inclusive, const uint8_t *stop, size_t stop_length, size_t limit,
+                           std::vector<MappingType> *out) {
+  EpochGuard guard(this);
+  size_t found = out->size();
+  Key resume;
+  while (ScanForwardFrom(root_, nullptr, 0, 0, bound, inclusive, stop, stop_length, limit, out) ==
+         ScanState::RESTART) {
+    // the entries found so far stay, the scan goes on after the last of them
+    if (out->size() > found) {
+      resume = EncodeKey(out->back().first, out->back().second);
+      bound = &resume;
+      inclusive = false;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::ScanForwardFrom(Node *node, const Node *parent, uint64_t parent_version, size_t depth,
+                               const Key *bound, bool inclusive, const uint8_t *stop, size_t stop_length,
+                               size_t limit, std::vector<MappingType> *out) -> ScanState {
+  uint64_t version;
+  if (!node->ReadLock(&version) || (parent != nullptr && !parent->Validate(parent_version))) {
+    return ScanState::RESTART;
+  }
+  Key prefix;
+  size_t prefix_length = ReadPrefix(node, depth, &prefix);
+  if (!node->Validate(version)) {
+    return ScanState::RESTART;
+  }
+  if (bound != nullptr) {
+    int cmp = memcmp(prefix.data(), bound->data() + depth, prefix_length);
+    if (cmp < 0) {
+      return ScanState::CONTINUE;
+    }
+    if (cmp > 0) {
+      bound = nullptr;
+    }
+  }
+  // every key below is past the bound, it is past the stop bytes if they are not its prefix
+  if (bound == nullptr && depth < stop_length &&
+      memcmp(prefix.data(), stop + depth, std::min(prefix_length, stop_length - depth)) != 0) {
+    return ScanState::FULL;
+  }
+  depth += prefix_length;
+
+  uint8_t byte;
+  for (int from = bound == nullptr ? 0 : (*bound)[depth]; from < 256; from = byte + 1) {
+    Child child = FindNext(node, from, &byte);
+    if (!node->Validate(version)) {
+      return ScanState::RESTART;
+    }
+    if (child == 0) {
+      break;
+    }
+    const Key *child_bound = bound != nullptr && byte == (*bound)[depth] ? bound : nullptr;
+    if (child_bound == nullptr && depth < stop_length && byte != stop[depth]) {
+      return ScanState::FULL;
+    }
+    if (IsLeaf(child)) {
+      const auto &leaf_key = AsLeaf<KEY_LENGTH>(child)->key_;
+      int cmp = child_bound == nullptr ? 1 : memcmp(leaf_key.data(), bound->data(), KEY_LENGTH);
+      if (cmp < 0 || (cmp == 0 && !inclusive)) {
+        continue;
+      }
+      if (stop_length > 0 && memcmp(leaf_key.data(), stop, stop_length) != 0) {
+        return ScanState::FULL;
+      }
+      out->push_back(DecodeKey(leaf_key));
+      if (out->size() >= limit) {
+        return ScanState::FULL;
+      }
+      continue;
+    }
+    auto state = ScanForwardFrom(AsNode<KEY_LENGTH>(child), node, version, depth + 1, child_bound, inclusive, stop,
+                                 stop_length, limit, out);
+    if (state != ScanState::CONTINUE) {
+      return state;
+    }
+  }
+  return ScanState::CONTINUE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_TYPE::ScanBackward(const Key *bound, size_t limit, std::vector<MappingType> *out) {
+  EpochGuard guard(this);
+  size_t found = out->size();
+  Key resume;
+  while (ScanBackwardFrom(root_, nullptr, 0, 0, bound, limit, out) == ScanState::RESTART) {
+    if (out->size() > found) {
+      resume = EncodeKey(out->back().first, out->back().second);
+      bound = &resume;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::ScanBackwardFrom(Node *node, const Node *parent, uint64_t parent_version, size_t depth,
+                                const Key *bound, size_t limit, std::vector<MappingType> *out) -> ScanState {
+  uint64_t version;
+  if (!node->ReadLock(&version) || (parent != nullptr && !parent->Validate(parent_version))) {
+    return ScanState::RESTART;
+  }
+  Key prefix;
+  size_t prefix_length = ReadPrefix(node, depth, &prefix);
+  if (!node->Validate(version)) {
+    return ScanState::RESTART;
+  }
+  if (bound != nullptr) {
+    int cmp = memcmp(prefix.data(), bound->data() + depth, prefix_length);
+    if (cmp > 0) {
+      return ScanState::CONTINUE;
+    }
+    if (cmp < 0) {
+      bound = nullptr;
+    }
+  }
+  depth += prefix_length;
+
+  uint8_t byte;
+  for (int to = bound == nullptr ? 255 : (*bound)[depth]; to >= 0; to = byte - 1) {
+    Child child = FindPrev(node, to, &byte);
+    if (!node->Validate(version)) {
+      return ScanState::RESTART;
+    }
+    if (child == 0) {
+      break;
+    }
+    const Key *child_bound = bound != nullptr && byte == (*bound)[depth] ? bound : nullptr;
+    if (IsLeaf(child)) {
+      const auto &leaf_key = AsLeaf<KEY_LENGTH>(child)->key_;
+      if (child_bound != nullptr && memcmp(leaf_key.data(), bound->data(), KEY_LENGTH) >= 0) {
+        continue;
+      }
+      out->push_back(DecodeKey(leaf_key));
+      if (out->size() >= limit) {
+        return ScanState::FULL;
+      }
+      continue;
+    }
+    auto state = ScanBackwardFrom(AsNode<KEY_LENGTH>(child), node, version, depth + 1, child_bound, limit, out);
+    if (state != ScanState::CONTINUE) {
+      return state;
+    }
+  }
+  return ScanState::CONTINUE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::Begin() -> ART_ITERATOR_TYPE {
+  std::vector<MappingType> batch;
+  ScanForward(nullptr, true, nullptr, 0, ART_ITERATOR_TYPE::BATCH_SIZE, &batch);
+  return ART_ITERATOR_TYPE(this, std::move(batch), 0, KeyType{}, 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::Begin(const KeyType &key, size_t prefix_length) -> ART_ITERATOR_TYPE {
+  Key from{};
+  memcpy(from.data(), &key, sizeof(KeyType));
+  std::vector<MappingType> batch;
+  ScanForward(&from, true, from.data(), prefix_length, ART_ITERATOR_TYPE::BATCH_SIZE, &batch);
+  return ART_ITERATOR_TYPE(this, std::move(batch), 0, key, prefix_length);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_TYPE::End() -> ART_ITERATOR_TYPE { return ART_ITERATOR_TYPE(this, {}, 0, KeyType{}, 0); }
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void ART_TYPE::BulkLoad(std::vector<MappingType> &&entries) {
+  FreeSubtree(NodeChild(root_));
+  root_ = NewNode<KEY_LENGTH>(ARTNodeType::NODE256);
+
+  std::vector<Key> keys;
+  keys.reserve(entries.size());
+  for (const auto &entry : entries) {
+    keys.push_back(EncodeKey(entry.first, entry.second));
+  }
+  entries.clear();
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  std::vector<Leaf *> leaves;
+  leaves.reserve(keys.size());
+  for (const auto &key : keys) {
+    leaves.push_back(new Leaf{key});
+  }
+  BuildChildren(root_, leaves, 0, leaves.size(), 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_TYPE::BuildChildren(Node *node, const std::vector<Leaf *> &leaves, size_t begin, size_t end,
+                             size_t depth) {
+  size_t group_end;
+  for (size_t group = begin; group < end; group = group_end) {
+    uint8_t byte = leaves[group]->key_[depth];
+    group_end = group + 1;
+    while (group_end < end && leaves[group_end]->key_[depth] == byte) {
+      group_end++;
+    }
+    if (group_end - group == 1) {
+      AddChild(node, byte, LeafChild(leaves[group]));
+      continue;
+    }
+
+    // the keys are sorted, so the bytes the first and the last key of the group share are shared by all of them
+    size_t child_depth = depth + 1;
+    const auto &first = leaves[group]->key_;
+    const auto &last = leaves[group_end - 1]->key_;
+    size_t shared = 0;
+    while (first[child_depth + shared] == last[child_depth + shared]) {
+      shared++;
+    }
+    size_t branches = 0;
+    for (size_t i = group; i < group_end; i++) {
+      if (i == group || leaves[i]->key_[child_depth + shared] != leaves[i - 1]->key_[child_depth + shared]) {
+        branches++;
+      }
+    }
+    auto type = ARTNodeType::NODE4;
+    while (Capacity(type) < branches) {
+      type = static_cast<ARTNodeType>(static_cast<uint8_t>(type) + 1);
+    }
+    auto *child = NewNode<KEY_LENGTH>(type);
+    SetPrefix(child, first.data() + child_depth, shared);
+    BuildChildren(child, leaves, group, group_end, child_depth + shared);
+    AddChild(node, byte, NodeChild(child));
+  }
+}
+
+template class AdaptiveRadixTreeIterator<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class AdaptiveRadixTreeIterator<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class AdaptiveRadixTreeIterator<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class AdaptiveRadixTreeIterator<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class AdaptiveRadixTreeIterator<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+template class AdaptiveRadixTree<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class AdaptiveRadixTree<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class AdaptiveRadixTree<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class AdaptiveRadixTree<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class AdaptiveRadixTree<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+}  // namespace bustub
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_index.cpp
+//
+// Identification: src/storage/index/adaptive_radix_tree_index.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/adaptive_radix_tree_index.h"
+
+#include "storage/index/index_key.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Cursor over an adaptive radix tree that hides its key type.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class AdaptiveRadixTreeScanIterator : public IndexScanIterator {
+ public:
+  AdaptiveRadixTreeScanIterator(const ART_INDEX_TYPE *index, ART_ITERATOR_TYPE &&iter)
+      : index_(index), iter_(std::move(iter)) {}
+
+  auto IsEnd() -> bool override { return iter_.IsEnd(); }
+
+  auto IsBegin() -> bool override { return iter_.IsBegin(); }
+
+  auto GetRID() -> RID override { return (*iter_).second; }
+
+  auto GetKey() -> Tuple override { return index_->KeyToTuple((*iter_).first); }
+
+  void Next() override { ++iter_; }
+
+  void Prev() override { --iter_; }
+
+ private:
+  const ART_INDEX_TYPE *index_;
+  ART_ITERATOR_TYPE iter_;
+};
+
+}  // namespace
+
+INDEX_TEMPLATE_ARGUMENTS
+ART_INDEX_TYPE::AdaptiveRadixTreeIndex(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  container_.Insert(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  container_.Remove(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction * /*transaction*/) {
+  container_.GetValue(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), result);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_INDEX_TYPE::GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> {
+  return std::make_unique<AdaptiveRadixTreeScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, from_end ? container_.End() : container_.Begin());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_INDEX_TYPE::GetPrefixIterator(const std::vector<Value> &prefix, Transaction * /*transaction*/)
+    -> std::unique_ptr<IndexScanIterator> {
+  if (prefix.empty()) {
+    return GetScanIterator(false);
+  }
+  // the tree stops the scan at the first key that does not start with the bytes of the prefix
+  KeyType begin_key;
+  auto length = MakeIndexPrefixKey<KeyType, KeyComparator>(prefix, GetKeySchema(), &begin_key);
+  return std::make_unique<AdaptiveRadixTreeScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, container_.Begin(begin_key, length));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::Rebuild(TableHeap *table_heap, const Schema &tuple_schema, const AbstractExpression *predicate,
+                             Transaction *transaction) {
+  std::vector<MappingType> entries;
+  for (auto tuple = table_heap->Begin(transaction); tuple != table_heap->End(); ++tuple) {
+    if (!SatisfiesPredicate(predicate, *tuple, tuple_schema)) {
+      continue;
+    }
+    auto key = tuple->KeyFromTuple(tuple_schema, *GetKeySchema(), GetKeyAttrs());
+    entries.emplace_back(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), tuple->GetRid());
+  }
+  container_.BulkLoad(std::move(entries));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto ART_INDEX_TYPE::KeyToTuple(const KeyType &index_key) const -> Tuple {
+  return IndexKeyToTuple<KeyType, KeyComparator>(index_key, GetKeySchema());
+}
+
+template class AdaptiveRadixTreeIndex<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class AdaptiveRadixTreeIndex<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class AdaptiveRadixTreeIndex<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class AdaptiveRadixTreeIndex<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class AdaptiveRadixTreeIndex<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+}  // namespace bustub
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <iterator>
+#include <optional>
 #include <string>
 
 #include "common/exception.h"
@@ -17,6 +20,24 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
       internal_max_size_(internal_max_size),
       root_page_id_(INVALID_PAGE_ID) {}
 
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  if (merger_thread_ != nullptr) {
+    {
+      std::scoped_lock lock(merger_latch_);
+      enable_merger_ = false;
+    }
+    merger_cv_.notify_all();
+    merger_thread_->join();
+    delete merger_thread_;
+  }
+  if (compaction_thread_ != nullptr) {
+    enable_compaction_ = false;
+    compaction_thread_->join();
+    delete compaction_thread_;
+  }
+}
+
 /*
  * Helper function to decide whether current b+tree is empty
  */
@@ -26,20 +47,47 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_P
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
- * This method is used for point query
+ * Return all the values that associated with input key
+ * This method is used for point query, a key that the Bloom filter rules out
+ * returns right away, a hot key skips the descent through the adaptive hash
+ * index, and the deferred changes of key are merged first
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  bool found = false;
-  auto *leaf_page = GetLeaf(key, OperateType::Find, transaction);
+  if (!MayContain(key)) {
+    return false;
+  }
+  MergeBufferedChanges(key);
+  if (IsEmpty()) {
+    return false;
+  }
+  uint64_t hash = 0;
+  int index = -1;
+  Page *leaf_page = nullptr;
+  if (adaptive_hash_ != nullptr) {
+    hash = hash_fn_.GetHash(key);
+    leaf_page = GetLeafFromHash(key, hash, &index);
+  }
+  if (leaf_page == nullptr) {
+    leaf_page = GetLeaf(key, OperateType::Find, transaction);
+    if (leaf_page == nullptr) {
+      return false;
+    }
+    index = reinterpret_cast<LeafPage *>(leaf_page->GetData())->KeyIndex(key, comparator_);
+    if (adaptive_hash_ != nullptr && index != -1) {
+      adaptive_hash_->Record(hash, leaf_page->GetPageId(), index);
+    }
+  }
   auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
-  for (int i = 0; i < leaf->GetSize(); i++) {
-    if (comparator_(key, leaf->KeyAt(i)) == 0) {
-      result->push_back(leaf->ValueAt(i));
-      found = true;
-      break;
+  bool found = index != -1;
+  if (found) {
+    auto value = leaf->ValueAt(index);
+    if (BPlusTreePostingPage::IsRef(value)) {
+      // the leaf latch protects the posting chain
+      BPlusTreePostingList::Collect(buffer_pool_manager_, value.GetPageId(), result);
+    } else {
+      result->push_back(value);
     }
   }
   leaf_page->RUnlatch();
@@ -70,12 +118,18 @@ void BPLUSTREE_TYPE::MakeRoot(const KeyType &key, const ValueType &value) {
   root_page_id_ = new_root_page_id;
   new_root->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_);
   InsertLeaf(new_root, key, value);
+  rightmost_leaf_page_id_ = root_page_id_;
   UpdateRootPageId(0);
   buffer_pool_manager_->UnpinPage(new_root->GetPageId(), true);
 }
 
+/*
+ * Split the full leaf1 in two. An append to the right-most leaf only moves the
+ * new key, so that sequential keys leave packed leaves behind them instead of
+ * half empty ones.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::InsertInFillNode(LeafPage *leaf1, Transaction *transaction) {
+void BPLUSTREE_TYPE::InsertInFillNode(LeafPage *leaf1, bool is_append, Transaction *transaction) {
   page_id_t new_node_id;
   auto new_page = buffer_pool_manager_->NewPage(&new_node_id);
   new_page->WLatch();
@@ -85,108 +139,188 @@ void BPLUSTREE_TYPE::InsertInFillNode(LeafPage *leaf1, Transaction *transaction)
   leaf2->Init(new_node_id, leaf1->GetParentPageId(), leaf_max_size_);
 
   // splite
+  InvalidateHashedLeaf(leaf1->GetPageId());
   leaf2->SetNextPageId(leaf1->GetNextPageId());
+  leaf2->SetPrevPageId(leaf1->GetPageId());
   leaf1->SetNextPageId(leaf2->GetPageId());
-  // move to leaf2
-  for (int i = leaf1->GetSize() / 2; i < leaf1->GetSize(); ++i) {
-    leaf2->SetPairAt(leaf2->GetSize(), {leaf1->KeyAt(i), leaf1->ValueAt(i)});
+  LinkNextLeafBack(leaf2);
+  if (leaf2->GetNextPageId() == INVALID_PAGE_ID) {
+    rightmost_leaf_page_id_ = leaf2->GetPageId();
   }
-  int increase_size = leaf1->GetSize() - leaf1->GetSize() / 2;
-  leaf1->IncreaseSize(-increase_size);
+  // move to leaf2
+  leaf1->MoveRangeTo(is_append ? leaf1->GetSize() - 1 : leaf1->SplitIndex(), leaf2);
 
-  // update parent
+  // update parent, any key between the two halves separates them
   KeyType first_key = leaf2->KeyAt(0);
+  if constexpr (KeyTruncation<KeyComparator>::ENABLED && IsCompressedKey<KeyType>()) {
+    first_key = BPlusTreeKeyStore<KeyType, ValueType>::ShortestSeparator(leaf1->KeyAt(leaf1->GetSize() - 1), first_key);
+  }
   RID rid(leaf2->GetPageId(), leaf2->GetPageId() & 0xFFFFFFFF);
   BPlusTree::InsertParent(reinterpret_cast<BPlusTreePage *>(leaf1), reinterpret_cast<BPlusTreePage *>(leaf2), first_key,
-                          rid, transaction);
+                          rid, is_append, transaction);
+}
+
+/*
+ * Append key & value to the cached right-most leaf without descending from the
+ * root. Only applies while key is greater than every key in the tree and the
+ * leaf has room; the caller holds the root latch, which keeps splits and merges
+ * from changing the right edge meanwhile.
+ * @return: false if the insert has to take the regular path
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryAppend(const KeyType &key, const ValueType &value) -> bool {
+  // an append skips the internal pages, whose subtree counts would go stale
+  if (subtree_counts_ || rightmost_leaf_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto *page = buffer_pool_manager_->FetchPage(rightmost_leaf_page_id_);
+  page->WLatch();
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  bool is_appended = leaf->GetNextPageId() == INVALID_PAGE_ID && leaf->GetSize() > 0 &&
+                     IsSafe(leaf, OperateType::Insert) && comparator_(key, leaf->KeyAt(leaf->GetSize() - 1)) > 0;
+  if (is_appended) {
+    leaf->SetPairAt(leaf->GetSize(), MappingType(key, value));
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_appended);
+  return is_appended;
 }
 
 /*
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
- * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * entry, otherwise insert into leaf page. A key that already exists keeps its
+ * slot and the value is added to the key's posting chain instead.
+ * @return: false if the exact key & value pair is already in the tree,
+ * otherwise return true. A deferred insert returns true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
+  // the filter learns the key before readers can find it in the tree, or in the change buffer
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->Insert(hash_fn_.GetHash(key));
+  }
+  if (BufferChange(ChangeType::Insert, key, value)) {
+    return true;
+  }
   root_page_id_latch_.WLock();
   if (IsEmpty()) {
     MakeRoot(key, value);
     root_page_id_latch_.WUnlock();
     return true;
   }
+  if (TryAppend(key, value)) {
+    root_page_id_latch_.WUnlock();
+    return true;
+  }
 
   auto *leaf1_page = GetLeaf(key, OperateType::Insert, transaction);
   auto *leaf1 = reinterpret_cast<LeafPage *>(leaf1_page->GetData());
-  bool leaf1_is_full = leaf1->GetSize() + 1 == leaf_max_size_;
-  bool is_duplicate_key = leaf1->IsKeyExist(key, comparator_);
+  if (leaf1->GetNextPageId() == INVALID_PAGE_ID) {
+    rightmost_leaf_page_id_ = leaf1->GetPageId();
+  }
+  bool leaf1_is_full = leaf1->GetSize() + 1 == leaf_max_size_ || leaf1->IsSpaceLow();
+  int duplicate_index = leaf1->KeyIndex(key, comparator_);
 
-  if (is_duplicate_key) {
+  if (duplicate_index != -1) {
     root_page_id_latch_.WUnlock();
+    bool is_inserted = InsertDuplicate(leaf1, duplicate_index, value);
+    if (is_inserted) {
+      AddPathCount(transaction, 1);
+    }
     ReleaseResourcesd(transaction);
-    return false;
+    return is_inserted;
   }
 
   if (!leaf1_is_full) {
     root_page_id_latch_.WUnlock();
     InsertLeaf(leaf1, key, value);
+    AddPathCount(transaction, 1);
     ReleaseResourcesd(transaction);
     return true;
   }
 
   InsertLeaf(leaf1, key, value);
-  InsertInFillNode(leaf1, transaction);
+  AddPathCount(transaction, 1);
+  bool is_append =
+      leaf1->GetNextPageId() == INVALID_PAGE_ID && comparator_(key, leaf1->KeyAt(leaf1->GetSize() - 1)) == 0;
+  InsertInFillNode(leaf1, is_append, transaction);
   ReleaseResourcesd(transaction);
   return true;
 }
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertLeaf(LeafPage *leaf, const KeyType &key, const ValueType &value) {
-  // leaf is empty or key < first key in leaf
-  if (leaf->GetSize() == 0 || comparator_(key, leaf->KeyAt(0)) == -1) {
-    leaf->SetPairAt(0, MappingType(key, value));
-    return;
+  // the key is not in the leaf yet, so it goes before the first greater key
+  leaf->SetPairAt(leaf->KeyLowerBound(key, comparator_), MappingType(key, value));
+}
+/*
+ * Add value to the key stored at index of leaf. The first duplicate turns the
+ * leaf slot into a posting reference, later ones go to the posting chain.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertDuplicate(LeafPage *leaf, int index, const ValueType &value) -> bool {
+  auto existing = leaf->ValueAt(index);
+  if (BPlusTreePostingPage::IsRef(existing)) {
+    return BPlusTreePostingList::Insert(buffer_pool_manager_, existing.GetPageId(), value);
   }
-
-  for (int i = 1; i < leaf->GetSize(); i++) {
-    bool is_key_less_than = comparator_(key, leaf->KeyAt(i)) == -1;
-    if (is_key_less_than) {
-      leaf->SetPairAt(i, MappingType(key, value));
-      return;
-    }
+  if (existing == value) {
+    return false;
   }
-  // key > last key in leaf
-  leaf->SetPairAt(leaf->GetSize(), MappingType(key, value));
+  auto head_page_id = BPlusTreePostingList::Create(buffer_pool_manager_, existing, value);
+  leaf->SetValueAt(index, BPlusTreePostingPage::MakeRef(head_page_id));
+  return true;
 }
+/*
+ * Insert the separator key and the page id in value, of a page split off its
+ * left neighbour, into internal
+ */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertInternal(InternalPage *internal, const KeyType &key, const ValueType &value) {
   int value_int = value.GetSlotNum();
-  // internal is no key or key < first key in internal
-  if (internal->GetSize() == 1 || comparator_(key, internal->KeyAt(1)) == -1) {
-    internal->SetPairAt(1, std::make_pair(key, value_int));
-    return;
+  // fist key is invalid, so the new key goes before the first greater key from index 1 on
+  int index = 1;
+  while (index < internal->GetSize() && comparator_(key, internal->KeyAt(index)) != -1) {
+    index++;
   }
-  // fist key is invalid and index 1 compared,so start at 2
-  for (int i = 2; i < internal->GetSize(); i++) {
-    // key < it->first
-    bool is_key_less_than = comparator_(key, internal->KeyAt(i)) == -1;
-    if (is_key_less_than) {
-      internal->SetPairAt(i, std::make_pair(key, value_int));
-      return;
-    }
+  internal->SetPairAt(index, std::make_pair(key, value_int));
+  if (subtree_counts_) {
+    // the count of the left neighbour still covers both halves
+    auto *child_page = buffer_pool_manager_->FetchPage(value_int);
+    auto count = SubtreeCount(reinterpret_cast<BPlusTreePage *>(child_page->GetData()));
+    buffer_pool_manager_->UnpinPage(value_int, false);
+    internal->SetChildCountAt(index, count);
+    internal->SetChildCountAt(index - 1, internal->ChildCountAt(index - 1) - count);
   }
-  // key > last key in internal
-  // fist key is invalid so size+1
-  internal->SetPairAt(internal->GetSize(), std::make_pair(key, value_int));
 }
 
+/*
+ * Descend to the leaf of key. A lookup takes the root latch only until the
+ * root page is latched, so that a writer cannot replace the root in between.
+ * @return : the latched and pinned leaf, nullptr if a lookup finds the tree
+ * empty
+ */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetLeaf(const KeyType &key, OperateType operator_type, Transaction *transaction) -> Page * {
+  if (operator_type == OperateType::Find) {
+    root_page_id_latch_.RLock();
+    if (IsEmpty()) {
+      root_page_id_latch_.RUnlock();
+      return nullptr;
+    }
+  }
   auto curr_page = buffer_pool_manager_->FetchPage(root_page_id_);
   auto curr_node = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
 
   if (operator_type == OperateType::Find) {
     curr_page->RLatch();
+    root_page_id_latch_.RUnlock();
+  } else if (operator_type == OperateType::LazyDelete) {
+    // a lazy delete reads its way down and only writes the leaf
+    if (curr_node->IsLeafPage()) {
+      curr_page->WLatch();
+    } else {
+      curr_page->RLatch();
+    }
   } else {
     curr_page->WLatch();
     transaction->AddIntoPageSet(curr_page);
@@ -199,8 +333,12 @@ auto BPLUSTREE_TYPE::GetLeaf(const KeyType &key, OperateType operator_type, Tran
     auto child_page = buffer_pool_manager_->BufferPoolManager::FetchPage(next_page_id);
     auto child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
 
-    if (operator_type == OperateType::Find) {
-      child_page->RLatch();
+    if (operator_type == OperateType::Find || operator_type == OperateType::LazyDelete) {
+      if (operator_type == OperateType::LazyDelete && child_node->IsLeafPage()) {
+        child_page->WLatch();
+      } else {
+        child_page->RLatch();
+      }
       curr_page->RUnlatch();
       buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
     } else {
@@ -216,38 +354,46 @@ auto BPLUSTREE_TYPE::GetLeaf(const KeyType &key, OperateType operator_type, Tran
   }
   return curr_page;
 }
+/*
+ * @return the index of the child of internal whose subtree holds key
+ */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetNextPageIdForFind(InternalPage *internal, const KeyType &key) const -> page_id_t {
-  page_id_t next_page_id;
-  bool found = false;
+auto BPLUSTREE_TYPE::ChildIndexForFind(InternalPage *internal, const KeyType &key) const -> int {
   // find key <= input_kay
   for (int i = 1; i < internal->GetSize(); i++) {
     bool is_key_less_than = comparator_(key, internal->KeyAt(i)) == -1;
     if (is_key_less_than) {
-      // is key == input_kay?
-      next_page_id = comparator_(key, internal->KeyAt(i)) == 0 ? internal->ValueAt(i) : internal->ValueAt(i - 1);
-      found = true;
-      break;
+      return i - 1;
     }
   }
-  next_page_id = !found ? (internal->ValueAt(internal->GetSize() - 1)) : next_page_id;
-  return next_page_id;
+  return internal->GetSize() - 1;
+}
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetNextPageIdForFind(InternalPage *internal, const KeyType &key) const -> page_id_t {
+  return internal->ValueAt(ChildIndexForFind(internal, key));
 }
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, OperateType op) -> bool {
+  if (subtree_counts_ && (op == OperateType::Insert || op == OperateType::Delete)) {
+    // every count on the path changes, so a writer keeps the whole path
+    return false;
+  }
   int add_num = node->IsLeafPage() ? -1 : 0;
   if (op == OperateType::Insert) {
-    return node->GetSize() < node->GetMaxSize() + add_num;
+    bool is_space_low = node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsSpaceLow()
+                                           : reinterpret_cast<InternalPage *>(node)->IsSpaceLow();
+    return node->GetSize() < node->GetMaxSize() + add_num && !is_space_low;
   }
   if (node->IsRootPage()) {
     return node->GetSize() >= 2;
   }
-  return node->GetSize() > node->GetMinSize();
+  return node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsSafeToRemove()
+                            : reinterpret_cast<InternalPage *>(node)->IsSafeToRemove();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertParent(BPlusTreePage *page1, BPlusTreePage *page2, const KeyType &key,
-                                  const ValueType &value, Transaction *transaction) {
+                                  const ValueType &value, bool is_append, Transaction *transaction) {
   if (page1->IsRootPage()) {
     RenewRoot(page1, page2, key);
     return;
@@ -255,10 +401,10 @@ void BPLUSTREE_TYPE::InsertParent(BPlusTreePage *page1, BPlusTreePage *page2, co
 
   auto *parent = reinterpret_cast<InternalPage *>(
       buffer_pool_manager_->BufferPoolManager::FetchPage(page1->GetParentPageId())->GetData());
-  bool is_parent_full = parent->GetSize() == parent->GetMaxSize();
+  bool is_parent_full = parent->GetSize() == parent->GetMaxSize() || parent->IsSpaceLow();
 
   if (is_parent_full) {
-    InsertInFillParent(parent, key, value, transaction);
+    InsertInFillParent(parent, key, value, is_append, transaction);
     buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
     return;
   }
@@ -271,13 +417,17 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::RenewRoot(BPlusTreePage *page1, BPlusTreePage *page2, const KeyType &key) {
   page_id_t root_page_id;
   auto new_root = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(&root_page_id)->GetData());
-  new_root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+  new_root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_, subtree_counts_);
 
   // Insert page1,key,page2 into new root
   KeyType invalid_key;
   invalid_key.SetFromInteger(-1);
   new_root->SetPairAt(0, std::make_pair(invalid_key, page1->GetPageId()));
   new_root->SetPairAt(1, std::make_pair(key, page2->GetPageId()));
+  if (subtree_counts_) {
+    new_root->SetChildCountAt(0, SubtreeCount(page1));
+    new_root->SetChildCountAt(1, SubtreeCount(page2));
+  }
   page1->SetParentPageId(root_page_id);
   page2->SetParentPageId(root_page_id);
   root_page_id_ = root_page_id;
@@ -288,31 +438,30 @@ void BPLUSTREE_TYPE::RenewRoot(BPlusTreePage *page1, BPlusTreePage *page2, const
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertInFillParent(InternalPage *parent, const KeyType &key, const ValueType &value,
-                                        Transaction *transaction) {
+                                        bool is_append, Transaction *transaction) {
   page_id_t parent_page_prime_id;
   auto parent_prime_page = buffer_pool_manager_->NewPage(&parent_page_prime_id);
   auto parent_prime = reinterpret_cast<InternalPage *>(parent_prime_page->GetData());
-  parent_prime->Init(parent_page_prime_id, parent->GetParentPageId(), internal_max_size_);
+  parent_prime->Init(parent_page_prime_id, parent->GetParentPageId(), internal_max_size_, subtree_counts_);
 
   // split
   InsertInternal(parent, key, value);
-  auto half_index = parent->GetSize() / 2;
+  // an append went to the right-most child, parent_prime starts with that child and its left neighbour
+  auto half_index = is_append ? std::max(parent->GetSize() - 2, 1) : parent->SplitIndex();
   auto k_prime = parent->KeyAt(half_index);
   for (int i = half_index; i < parent->GetSize(); ++i) {
     // change parent page id
     auto move_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(parent->ValueAt(i))->GetData());
     move_page->SetParentPageId(parent_prime->GetPageId());
     buffer_pool_manager_->UnpinPage(move_page->GetPageId(), true);
-    //  move to parent_prime
-    parent_prime->SetPairAt(parent_prime->GetSize(), {parent->KeyAt(i), parent->ValueAt(i)});
   }
-  int increase_size = parent->GetSize() - half_index;
-  parent->IncreaseSize(-increase_size);
+  //  move to parent_prime
+  parent->MoveRangeTo(half_index, parent_prime);
   // end split
 
   RID rid(parent_page_prime_id, parent_page_prime_id & 0xFFFFFFFF);
 
-  InsertParent(parent, parent_prime, k_prime, rid, transaction);
+  InsertParent(parent, parent_prime, k_prime, rid, is_append, transaction);
   buffer_pool_manager_->UnpinPage(parent_prime->GetPageId(), true);
 }
 
@@ -328,19 +477,141 @@ void BPLUSTREE_TYPE::InsertInFillParent(InternalPage *parent, const KeyType &key
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  if (BufferChange(ChangeType::RemoveKey, key, ValueType())) {
+    return;
+  }
+  if (lazy_delete_) {
+    auto *leaf_page = GetLeafForLazyDelete(key);
+    if (leaf_page == nullptr) {
+      return;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    int index = leaf->KeyIndex(key, comparator_);
+    if (index != -1) {
+      if (BPlusTreePostingPage::IsRef(leaf->ValueAt(index))) {
+        BPlusTreePostingList::Destroy(buffer_pool_manager_, leaf->ValueAt(index).GetPageId());
+      }
+      leaf->DeletePair(key, comparator_);
+    }
+    leaf_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), index != -1);
+    return;
+  }
   root_page_id_latch_.WLock();
   if (this->IsEmpty()) {
     root_page_id_latch_.WUnlock();
     return;
   }
   auto *leaf_page = BPlusTree::GetLeaf(key, OperateType::Delete, transaction);
-  BPlusTree::RemoveEntry(reinterpret_cast<LeafPage *>(leaf_page), key, transaction);
+  auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  if (index != -1 && subtree_counts_) {
+    AddPathCount(transaction, -static_cast<int64_t>(ValueCount(leaf->ValueAt(index))));
+  }
+  if (index != -1 && BPlusTreePostingPage::IsRef(leaf->ValueAt(index))) {
+    BPlusTreePostingList::Destroy(buffer_pool_manager_, leaf->ValueAt(index).GetPageId());
+  }
+  BPlusTree::RemoveEntry(leaf, key, transaction);
+  if (!transaction->GetDeletedPageSet()->empty()) {
+    // a merge may free the cached right-most leaf
+    rightmost_leaf_page_id_ = INVALID_PAGE_ID;
+  }
+  root_page_id_latch_.WUnlock();
+  ReleaseResourcesd(transaction);
+}
+
+/*
+ * Delete the key & value pair, other values of a duplicated key stay in the
+ * tree. The key leaves the tree together with its last value.
+ * @return : false if the pair is not in the tree; a deferred remove returns
+ * true
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
+  if (BufferChange(ChangeType::Remove, key, value)) {
+    return true;
+  }
+  bool is_last = false;
+  if (lazy_delete_) {
+    auto *leaf_page = GetLeafForLazyDelete(key);
+    if (leaf_page == nullptr) {
+      return false;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    int index = leaf->KeyIndex(key, comparator_);
+    bool is_removed = index != -1 && RemoveDuplicate(leaf, index, value, &is_last);
+    if (is_last) {
+      leaf->DeletePair(key, comparator_);
+    }
+    leaf_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), is_removed);
+    return is_removed;
+  }
+  root_page_id_latch_.WLock();
+  if (this->IsEmpty()) {
+    root_page_id_latch_.WUnlock();
+    return false;
+  }
+  auto *leaf_page = BPlusTree::GetLeaf(key, OperateType::Delete, transaction);
+  auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  bool is_removed = index != -1 && RemoveDuplicate(leaf, index, value, &is_last);
+  if (is_removed) {
+    AddPathCount(transaction, -1);
+  }
+  if (is_last) {
+    BPlusTree::RemoveEntry(leaf, key, transaction);
+  }
+  if (!transaction->GetDeletedPageSet()->empty()) {
+    rightmost_leaf_page_id_ = INVALID_PAGE_ID;
+  }
   root_page_id_latch_.WUnlock();
   ReleaseResourcesd(transaction);
+  return is_removed;
+}
+
+/*
+ * Remove value from the slot at index of leaf, or from the posting chain the
+ * slot refers to. A chain left with one value turns back into a plain slot.
+ * @return : false if the value is not stored at index; *is_last tells whether
+ * the key has to leave the leaf with it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveDuplicate(LeafPage *leaf, int index, const ValueType &value, bool *is_last) -> bool {
+  auto existing = leaf->ValueAt(index);
+  if (!BPlusTreePostingPage::IsRef(existing)) {
+    *is_last = existing == value;
+    return *is_last;
+  }
+  bool is_removed = BPlusTreePostingList::Remove(buffer_pool_manager_, existing.GetPageId(), value);
+  ValueType last;
+  if (is_removed && BPlusTreePostingList::TryCollapse(buffer_pool_manager_, existing.GetPageId(), &last)) {
+    leaf->SetValueAt(index, last);
+  }
+  return is_removed;
 }
+
+/*
+ * Find the leaf a lazy remove works on. The root latch is only held for the
+ * way down, which read latches the internal pages.
+ * @return : the write latched and pinned leaf, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetLeafForLazyDelete(const KeyType &key) -> Page * {
+  root_page_id_latch_.RLock();
+  if (IsEmpty()) {
+    root_page_id_latch_.RUnlock();
+    return nullptr;
+  }
+  auto *leaf_page = GetLeaf(key, OperateType::LazyDelete);
+  root_page_id_latch_.RUnlock();
+  return leaf_page;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::RemoveRoot(BPlusTreePage *node, Transaction *transaction) {
   if (node->IsLeafPage() && node->GetSize() == 0) {
+    InvalidateHashedLeaf(node->GetPageId());
     root_page_id_ = INVALID_PAGE_ID;
     UpdateRootPageId(0);
     transaction->AddIntoDeletedPageSet(node->GetPageId());
@@ -362,14 +633,15 @@ void BPLUSTREE_TYPE::RemoveEntry(P *node, const KeyType &key, Transaction *trans
     return;
   }
 
-  bool is_key_enough = node->GetSize() >= node->GetMinSize();
+  bool is_key_enough = !node->IsUnderflow();
   if (is_key_enough) {
     return;
   }
 
   auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
   int sibling_idx = GetSiblingIdx(parent, node->GetPageId());
-  bool is_i_plus_before_i = parent->ValueAt(sibling_idx) < node->GetPageId();
+  // the sibling is the left neighbour unless node is the first child
+  bool is_i_plus_before_i = parent->ValueAt(0) != node->GetPageId();
   auto sibling_page = buffer_pool_manager_->FetchPage(parent->ValueAt(sibling_idx));
   auto *node_plus = reinterpret_cast<BPlusTreePage *>(sibling_page->GetData());
   auto key_plus = parent->KeyAt(is_i_plus_before_i ? sibling_idx + 1 : sibling_idx);
@@ -377,12 +649,17 @@ void BPLUSTREE_TYPE::RemoveEntry(P *node, const KeyType &key, Transaction *trans
   sibling_page->WLatch();
   page_set->push_back(sibling_page);
 
-  bool is_able_to_coalesce = node_plus->GetSize() + node->GetSize() <= node->GetMaxSize();
+  bool is_able_to_coalesce = node->CanMergeWith(reinterpret_cast<P *>(node_plus));
 
   if (is_able_to_coalesce) {
     Coalesce(is_i_plus_before_i, node, node_plus, key_plus, transaction);
   } else {
-    Redistribute(node, node_plus, parent, is_i_plus_before_i, key_plus);
+    // a wide separator may not fit the parent, the node then stays underfull
+    auto *sibling = reinterpret_cast<P *>(node_plus);
+    auto new_key_plus = sibling->KeyAt(is_i_plus_before_i ? sibling->GetSize() - 1 : 1);
+    if (parent->CanReplaceKey(new_key_plus)) {
+      Redistribute(node, node_plus, parent, is_i_plus_before_i, key_plus);
+    }
   }
   buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
 }
@@ -416,16 +693,33 @@ auto BPLUSTREE_TYPE::GetSiblingIdx(InternalPage *parent_page, int page_id) -> in
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::CoalesceLeafPages(LeafPage *node, LeafPage *sibling_page) {
-  for (int i = 0; i < node->GetSize(); i++) {
-    sibling_page->SetPairAt(sibling_page->GetSize(), {node->KeyAt(i), node->ValueAt(i)});
-  }
-  node->SetSize(0);
+  InvalidateHashedLeaf(node->GetPageId());
+  node->MoveRangeTo(0, sibling_page);
   sibling_page->SetNextPageId(node->GetNextPageId());
+  LinkNextLeafBack(sibling_page);
+}
+
+/*
+ * Point the prev page id of the leaf after leaf back to it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LinkNextLeafBack(LeafPage *leaf) {
+  if (leaf->GetNextPageId() == INVALID_PAGE_ID) {
+    return;
+  }
+  auto *next_page = buffer_pool_manager_->FetchPage(leaf->GetNextPageId());
+  next_page->WLatch();
+  reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(leaf->GetPageId());
+  next_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page->GetPageId(), true);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::CoalesceInternalPages(InternalPage *node, InternalPage *sibling_page, const KeyType &key_plus) {
   sibling_page->SetPairAt(sibling_page->GetSize(), {key_plus, node->ValueAt(0)});
+  if (subtree_counts_) {
+    sibling_page->SetChildCountAt(sibling_page->GetSize() - 1, node->ChildCountAt(0));
+  }
 
   auto child = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(node->ValueAt(0))->GetData());
   child->SetParentPageId(sibling_page->GetPageId());
@@ -433,6 +727,9 @@ void BPLUSTREE_TYPE::CoalesceInternalPages(InternalPage *node, InternalPage *sib
 
   for (int i = 1; i < node->GetSize(); i++) {
     sibling_page->SetPairAt(sibling_page->GetSize(), {node->KeyAt(i), node->ValueAt(i)});
+    if (subtree_counts_) {
+      sibling_page->SetChildCountAt(sibling_page->GetSize() - 1, node->ChildCountAt(i));
+    }
     auto child = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(node->ValueAt(i))->GetData());
     child->SetParentPageId(sibling_page->GetPageId());
     buffer_pool_manager_->UnpinPage(child->GetPageId(), true);
@@ -455,6 +752,11 @@ void BPLUSTREE_TYPE::Coalesce(bool is_sibling_brother, BPlusTreePage *node, BPlu
   }
 
   auto parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
+  if (subtree_counts_) {
+    // node is the right one of the two, its values now count for its left sibling
+    auto index = parent->ValueIndex(node->GetPageId());
+    parent->SetChildCountAt(index - 1, parent->ChildCountAt(index - 1) + parent->ChildCountAt(index));
+  }
   RemoveEntry(parent, key_plus, transaction);
 
   // Delete node
@@ -482,13 +784,14 @@ auto BPLUSTREE_TYPE::RedistributeLeafPages(LeafPage *node, LeafPage *sibling_pag
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::RedistributeInternalPages(InternalPage *node, InternalPage *sibling_page, bool is_i_plus_before_i)
-    -> KeyType {
+auto BPLUSTREE_TYPE::RedistributeInternalPages(InternalPage *node, InternalPage *sibling_page, bool is_i_plus_before_i,
+                                               const KeyType &key_plus) -> KeyType {
   KeyType temp_key;
   int temp_value;
 
+  auto index = is_i_plus_before_i ? sibling_page->GetSize() - 1 : 0;
+  uint32_t count = subtree_counts_ ? sibling_page->ChildCountAt(index) : 0;
   if (is_i_plus_before_i) {
-    auto index = sibling_page->GetSize() - 1;
     temp_key = sibling_page->KeyAt(index);
     temp_value = sibling_page->ValueAt(index);
     auto child_node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(temp_value)->GetData());
@@ -496,7 +799,12 @@ auto BPLUSTREE_TYPE::RedistributeInternalPages(InternalPage *node, InternalPage
     buffer_pool_manager_->UnpinPage(child_node->GetPageId(), true);
 
     sibling_page->DeletePair(temp_key, comparator_);
+    // the separator from the parent comes down in front of the old first child
+    node->SetKeyAt(0, key_plus);
     node->SetPairAt(0, {temp_key, temp_value});
+    if (subtree_counts_) {
+      node->SetChildCountAt(0, count);
+    }
   } else {
     temp_key = sibling_page->KeyAt(0);
     temp_value = sibling_page->ValueAt(0);
@@ -505,7 +813,10 @@ auto BPLUSTREE_TYPE::RedistributeInternalPages(InternalPage *node, InternalPage
     buffer_pool_manager_->UnpinPage(child_node->GetPageId(), true);
 
     sibling_page->DeletePair(temp_key, comparator_);
-    node->SetPairAt(node->GetSize(), {temp_key, temp_value});
+    node->SetPairAt(node->GetSize(), {key_plus, temp_value});
+    if (subtree_counts_) {
+      node->SetChildCountAt(node->GetSize() - 1, count);
+    }
     temp_key = sibling_page->KeyAt(0);
   }
   return temp_key;
@@ -515,15 +826,310 @@ void BPLUSTREE_TYPE::Redistribute(BPlusTreePage *node, BPlusTreePage *sib_node,
                                   bool is_i_plus_before_i, KeyType key_plus) {
   KeyType temp_key;
 
+  if (subtree_counts_) {
+    // one entry moves from the sibling to node, and so do the values below it
+    auto index = is_i_plus_before_i ? sib_node->GetSize() - 1 : 0;
+    auto moved = sib_node->IsLeafPage() ? ValueCount(reinterpret_cast<LeafPage *>(sib_node)->ValueAt(index))
+                                        : reinterpret_cast<InternalPage *>(sib_node)->ChildCountAt(index);
+    auto node_index = parent->ValueIndex(node->GetPageId());
+    auto sibling_index = parent->ValueIndex(sib_node->GetPageId());
+    parent->SetChildCountAt(node_index, parent->ChildCountAt(node_index) + moved);
+    parent->SetChildCountAt(sibling_index, parent->ChildCountAt(sibling_index) - moved);
+  }
+
   if (node->IsLeafPage()) {
     temp_key = RedistributeLeafPages(reinterpret_cast<LeafPage *>(node), reinterpret_cast<LeafPage *>(sib_node),
                                      is_i_plus_before_i);
   } else {
     temp_key = RedistributeInternalPages(reinterpret_cast<InternalPage *>(node),
-                                         reinterpret_cast<InternalPage *>(sib_node), is_i_plus_before_i);
+                                         reinterpret_cast<InternalPage *>(sib_node), is_i_plus_before_i, key_plus);
   }
   parent->ReplaceKey(key_plus, temp_key, comparator_);
 }
+/*****************************************************************************
+ * COMPACTION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::EnableLazyDelete(std::chrono::milliseconds compaction_interval) {
+  if (subtree_counts_) {
+    throw Exception(ExceptionType::INVALID, "lazy deletes cannot keep subtree counts");
+  }
+  lazy_delete_ = true;
+  if (compaction_interval.count() > 0 && compaction_thread_ == nullptr) {
+    enable_compaction_ = true;
+    compaction_thread_ = new std::thread(&BPlusTree::RunCompaction, this, compaction_interval);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RunCompaction(std::chrono::milliseconds interval) {
+  while (enable_compaction_) {
+    std::this_thread::sleep_for(interval);
+    if (!enable_compaction_) {
+      break;
+    }
+    Compact();
+  }
+}
+
+/*
+ * Walk the tree and merge every pair of neighbouring siblings of which one is
+ * underfull and whose entries fit one page, then drop the root levels left
+ * with a single child. The root latch keeps inserts and other compactions
+ * out; the pages are write latched top down, so that reads and lazy removes
+ * wait for the subtree being compacted. Merged pages are freed at the end.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Compact() {
+  root_page_id_latch_.WLock();
+  if (IsEmpty()) {
+    root_page_id_latch_.WUnlock();
+    return;
+  }
+  std::vector<page_id_t> deleted;
+  auto old_root_page_id = root_page_id_;
+  auto *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
+  root_page->WLatch();
+  auto *root = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
+  if (!root->IsLeafPage()) {
+    CompactInternal(reinterpret_cast<InternalPage *>(root), &deleted);
+  }
+  while (!root->IsLeafPage() && root->GetSize() == 1) {
+    auto *child_page = buffer_pool_manager_->FetchPage(reinterpret_cast<InternalPage *>(root)->ValueAt(0));
+    child_page->WLatch();
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    child->SetParentPageId(INVALID_PAGE_ID);
+    root_page_id_ = child->GetPageId();
+    deleted.push_back(root->GetPageId());
+    root_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(root->GetPageId(), true);
+    root_page = child_page;
+    root = child;
+  }
+  if (root->IsLeafPage() && root->GetSize() == 0) {
+    InvalidateHashedLeaf(root->GetPageId());
+    root_page_id_ = INVALID_PAGE_ID;
+    deleted.push_back(root->GetPageId());
+  }
+  if (root_page_id_ != old_root_page_id) {
+    UpdateRootPageId(0);
+  }
+  if (!deleted.empty()) {
+    rightmost_leaf_page_id_ = INVALID_PAGE_ID;
+  }
+  root_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(root->GetPageId(), true);
+  root_page_id_latch_.WUnlock();
+  for (auto page_id : deleted) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+/*
+ * Compact the subtrees of the write latched node first, then merge its
+ * children pairwise from the left.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CompactInternal(InternalPage *node, std::vector<page_id_t> *deleted) {
+  for (int i = 0; i < node->GetSize(); i++) {
+    auto *child_page = buffer_pool_manager_->FetchPage(node->ValueAt(i));
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    bool is_internal = !child->IsLeafPage();
+    if (is_internal) {
+      child_page->WLatch();
+      CompactInternal(reinterpret_cast<InternalPage *>(child), deleted);
+      child_page->WUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(child_page->GetPageId(), is_internal);
+  }
+
+  int i = 0;
+  while (i + 1 < node->GetSize()) {
+    auto *left_page = buffer_pool_manager_->FetchPage(node->ValueAt(i));
+    auto *right_page = buffer_pool_manager_->FetchPage(node->ValueAt(i + 1));
+    left_page->WLatch();
+    right_page->WLatch();
+    auto *left = reinterpret_cast<BPlusTreePage *>(left_page->GetData());
+    bool is_merged = MergeSparseSiblings(node, i + 1, left, reinterpret_cast<BPlusTreePage *>(right_page->GetData()));
+    if (is_merged && !left->IsLeafPage()) {
+      // the children of right now sit next to those of left and may merge in turn
+      CompactInternal(reinterpret_cast<InternalPage *>(left), deleted);
+    }
+    auto right_page_id = right_page->GetPageId();
+    right_page->WUnlatch();
+    left_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(left_page->GetPageId(), is_merged);
+    buffer_pool_manager_->UnpinPage(right_page_id, is_merged);
+    if (is_merged) {
+      // the merged node may take its next sibling as well
+      deleted->push_back(right_page_id);
+    } else {
+      i++;
+    }
+  }
+}
+
+/*
+ * Move right, the child at index of parent, into its left sibling if one of
+ * them is underfull and the other has room for it. A merged leaf stays below
+ * the size that makes the next insert split it.
+ * @return : whether right was merged and left parent
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MergeSparseSiblings(InternalPage *parent, int index, BPlusTreePage *left, BPlusTreePage *right)
+    -> bool {
+  auto key_plus = parent->KeyAt(index);
+  if (left->IsLeafPage()) {
+    auto *left_leaf = reinterpret_cast<LeafPage *>(left);
+    auto *right_leaf = reinterpret_cast<LeafPage *>(right);
+    bool is_sparse = left_leaf->IsUnderflow() || right_leaf->IsUnderflow();
+    bool is_fit = left->GetSize() + right->GetSize() + 1 < leaf_max_size_ && left_leaf->CanMergeWith(right_leaf);
+    if (!is_sparse || !is_fit) {
+      return false;
+    }
+    CoalesceLeafPages(right_leaf, left_leaf);
+  } else {
+    auto *left_internal = reinterpret_cast<InternalPage *>(left);
+    auto *right_internal = reinterpret_cast<InternalPage *>(right);
+    bool is_sparse = left_internal->IsUnderflow() || right_internal->IsUnderflow();
+    if (!is_sparse || !left_internal->CanMergeWith(right_internal)) {
+      return false;
+    }
+    CoalesceInternalPages(right_internal, left_internal, key_plus);
+  }
+  parent->DeletePair(key_plus, comparator_);
+  return true;
+}
+/*****************************************************************************
+ * SUBTREE COUNTS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::EnableSubtreeCounts() {
+  if (lazy_delete_) {
+    throw Exception(ExceptionType::INVALID, "lazy deletes cannot keep subtree counts");
+  }
+  if (!IsEmpty()) {
+    throw Exception(ExceptionType::INVALID, "subtree counts must be enabled on an empty tree");
+  }
+  subtree_counts_ = true;
+  internal_max_size_ = std::min(internal_max_size_, InternalPage::CountedCapacity());
+}
+
+/*
+ * @return the number of values a leaf slot holds, more than one for a
+ * posting reference
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ValueCount(const ValueType &value) -> size_t {
+  if (BPlusTreePostingPage::IsRef(value)) {
+    return BPlusTreePostingList::Count(buffer_pool_manager_, value.GetPageId());
+  }
+  return 1;
+}
+
+/*
+ * @return the number of values below node, which the caller keeps pinned
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::SubtreeCount(BPlusTreePage *node) -> size_t {
+  if (!node->IsLeafPage()) {
+    return reinterpret_cast<InternalPage *>(node)->TotalCount();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(node);
+  size_t count = 0;
+  for (int i = 0; i < leaf->GetSize(); i++) {
+    count += ValueCount(leaf->ValueAt(i));
+  }
+  return count;
+}
+
+/*
+ * Add delta to the count of every child on the way from the root to the
+ * leaf, which a writer of a tree with subtree counts keeps in its page set
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AddPathCount(Transaction *transaction, int64_t delta) {
+  if (!subtree_counts_) {
+    return;
+  }
+  auto page_set = transaction->GetPageSet();
+  for (size_t i = 0; i + 1 < page_set->size(); i++) {
+    auto *internal = reinterpret_cast<InternalPage *>((*page_set)[i]->GetData());
+    auto index = internal->ValueIndex((*page_set)[i + 1]->GetPageId());
+    internal->SetChildCountAt(index, internal->ChildCountAt(index) + delta);
+  }
+}
+
+/*
+ * @return the read latched and pinned root page, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchRootForRead() -> Page * {
+  if (!subtree_counts_) {
+    throw Exception(ExceptionType::INVALID, "the tree keeps no subtree counts");
+  }
+  root_page_id_latch_.RLock();
+  if (IsEmpty()) {
+    root_page_id_latch_.RUnlock();
+    return nullptr;
+  }
+  auto *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
+  root_page->RLatch();
+  root_page_id_latch_.RUnlock();
+  return root_page;
+}
+
+/*
+ * Descend to the leaf of key like a lookup does, adding up the counts of the
+ * children left of the path, then the values before key in the leaf
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Rank(const KeyType &key, bool inclusive) -> size_t {
+  MergeChangeBuffer();
+  auto *page = FetchRootForRead();
+  if (page == nullptr) {
+    return 0;
+  }
+  size_t rank = 0;
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    int index = ChildIndexForFind(internal, key);
+    for (int i = 0; i < index; i++) {
+      rank += internal->ChildCountAt(i);
+    }
+    auto *child_page = buffer_pool_manager_->FetchPage(internal->ValueAt(index));
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(node);
+  int end = leaf->KeyLowerBound(key, comparator_);
+  if (inclusive && end < leaf->GetSize() && comparator_(leaf->KeyAt(end), key) == 0) {
+    end++;
+  }
+  for (int i = 0; i < end; i++) {
+    rank += ValueCount(leaf->ValueAt(i));
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return rank;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Size() -> size_t {
+  MergeChangeBuffer();
+  auto *page = FetchRootForRead();
+  if (page == nullptr) {
+    return 0;
+  }
+  auto size = SubtreeCount(reinterpret_cast<BPlusTreePage *>(page->GetData()));
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return size;
+}
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
@@ -534,6 +1140,7 @@ void BPLUSTREE_TYPE::Redistribute(BPlusTreePage *node, BPlusTreePage *sib_node,
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
+  MergeChangeBuffer();
   if (IsEmpty()) {
     return INDEXITERATOR_TYPE(nullptr, -1, nullptr);
   }
@@ -552,26 +1159,394 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
- * first, then construct index iterator
+ * first, then construct index iterator positioned at the first pair whose key
+ * is not less than the input key
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  MergeChangeBuffer();
   if (IsEmpty()) {
     return INDEXITERATOR_TYPE(nullptr, -1, nullptr);
   }
-  auto leaf_page = BPlusTree::GetLeaf(key, OperateType::Find, nullptr);
-  auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  uint64_t hash = 0;
   int index = -1;
-  for (int i = 0; i < leaf->GetSize(); i++) {
-    if (comparator_(key, leaf->KeyAt(i)) == 0) {
-      index = i;
-      break;
+  Page *leaf_page = nullptr;
+  if (adaptive_hash_ != nullptr) {
+    hash = hash_fn_.GetHash(key);
+    leaf_page = GetLeafFromHash(key, hash, &index);
+  }
+  auto *leaf = leaf_page != nullptr ? reinterpret_cast<LeafPage *>(leaf_page->GetData()) : nullptr;
+  if (leaf_page == nullptr) {
+    leaf_page = BPlusTree::GetLeaf(key, OperateType::Find, nullptr);
+    if (leaf_page == nullptr) {
+      return INDEXITERATOR_TYPE(nullptr, -1, nullptr);
+    }
+    leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    index = leaf->KeyLowerBound(key, comparator_);
+    if (adaptive_hash_ != nullptr && index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0) {
+      adaptive_hash_->Record(hash, leaf->GetPageId(), index);
     }
   }
+  // the iterator keeps the pin but not the latch, like the other iterators
+  leaf_page->RUnlatch();
+  auto next_page_id = leaf->GetNextPageId();
+  if (index == leaf->GetSize() && next_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    leaf = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
+    index = 0;
+  }
   return INDEXITERATOR_TYPE(leaf, index, buffer_pool_manager_);
 }
 
+/*
+ * Input parameter is a rank, follow the child whose subtree holds the value
+ * of that rank on every level, then construct index iterator positioned at
+ * that value, which may be inside a posting chain. A rank past the last value
+ * gives the end iterator.
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BeginAtRank(size_t rank) -> INDEXITERATOR_TYPE {
+  MergeChangeBuffer();
+  auto *page = FetchRootForRead();
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE(nullptr, -1, nullptr);
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    int index = 0;
+    while (index + 1 < internal->GetSize() && rank >= internal->ChildCountAt(index)) {
+      rank -= internal->ChildCountAt(index);
+      index++;
+    }
+    auto *child_page = buffer_pool_manager_->FetchPage(internal->ValueAt(index));
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(node);
+  int index = 0;
+  while (index < leaf->GetSize()) {
+    auto count = ValueCount(leaf->ValueAt(index));
+    if (rank < count) {
+      break;
+    }
+    rank -= count;
+    index++;
+  }
+  // the rest of the rank steps into the posting chain of the slot at index
+  auto steps = index < leaf->GetSize() ? rank : 0;
+  // the iterator keeps the pin but not the latch, like the other iterators
+  page->RUnlatch();
+  INDEXITERATOR_TYPE iter(leaf, index, buffer_pool_manager_);
+  for (; steps > 0; steps--) {
+    ++iter;
+  }
+  return iter;
+}
+
+/*****************************************************************************
+ * ADAPTIVE HASH INDEX
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::EnableAdaptiveHash(size_t capacity, uint32_t hot_threshold) {
+  adaptive_hash_ = std::make_unique<AdaptiveHashIndex>(capacity, hot_threshold);
+}
+
+/*
+ * Find the leaf of key through the adaptive hash index instead of descending
+ * from the root. Splits and merges drop the entries of a leaf under its write
+ * latch, so the cached leaf holds key if the entry is still there once the
+ * leaf is read latched; the slot is searched again if the leaf changed since.
+ * @return : the read latched and pinned leaf, with the slot of key in *index,
+ * nullptr if the hash index has no leaf of key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetLeafFromHash(const KeyType &key, uint64_t hash, int *index) -> Page * {
+  auto cached = adaptive_hash_->Lookup(hash);
+  if (!cached.has_value()) {
+    return nullptr;
+  }
+  auto [page_id, slot] = *cached;
+  auto *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  page->RLatch();
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  *index = -1;
+  if (adaptive_hash_->IsCached(hash, page_id) && leaf->IsLeafPage()) {
+    bool is_at_slot = slot < leaf->GetSize() && comparator_(leaf->KeyAt(slot), key) == 0;
+    *index = is_at_slot ? slot : leaf->KeyIndex(key, comparator_);
+  }
+  if (*index == -1) {
+    // the key left the leaf, or the entry is stale, the lookup descends from the root
+    adaptive_hash_->Forget(hash, page_id);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return nullptr;
+  }
+  if (*index != slot) {
+    adaptive_hash_->Record(hash, page_id, *index);
+  }
+  adaptive_hash_->CountHit();
+  return page;
+}
+
+/*****************************************************************************
+ * BLOOM FILTER
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::EnableBloomFilter(size_t expected_keys) {
+  bloom_filter_ = std::make_unique<BloomFilter>(expected_keys);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RebuildBloomFilter() {
+  if (bloom_filter_ == nullptr) {
+    return;
+  }
+  // a key with several values comes up once per value, next to each other
+  std::vector<uint64_t> hashes;
+  std::optional<KeyType> last_key;
+  for (auto iter = Begin(); !iter.IsInvaildIndexIter() && !iter.IsEnd(); ++iter) {
+    const auto &key = (*iter).first;
+    if (!last_key.has_value() || comparator_(*last_key, key) != 0) {
+      hashes.push_back(hash_fn_.GetHash(key));
+      last_key = key;
+    }
+  }
+  bloom_filter_->Clear(hashes.size());
+  for (auto hash : hashes) {
+    bloom_filter_->Insert(hash);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MayContain(const KeyType &key) -> bool {
+  return bloom_filter_ == nullptr || bloom_filter_->MayContain(hash_fn_.GetHash(key));
+}
+
+/*
+ * Drop the adaptive hash entries of the leaf, which the caller holds write
+ * latched before it splits, merges or frees the leaf
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InvalidateHashedLeaf(page_id_t page_id) {
+  if (adaptive_hash_ != nullptr) {
+    adaptive_hash_->InvalidatePage(page_id);
+  }
+}
+
+/*****************************************************************************
+ * CHANGE BUFFER
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::EnableChangeBuffer(size_t capacity, std::chrono::milliseconds merge_interval) {
+  change_buffer_capacity_ = std::max<size_t>(capacity, 1);
+  if (merge_interval.count() > 0 && merger_thread_ == nullptr) {
+    enable_merger_ = true;
+    merger_thread_ = new std::thread(&BPlusTree::RunMerger, this, merge_interval);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RunMerger(std::chrono::milliseconds interval) {
+  // the destructor wakes the merger up, instead of waiting for the interval to pass
+  std::unique_lock lock(merger_latch_);
+  while (!merger_cv_.wait_for(lock, interval, [this] { return !enable_merger_; })) {
+    lock.unlock();
+    MergeChangeBuffer();
+    lock.lock();
+  }
+}
+
+/*
+ * Defer the change of key if a page on its way down is not in the buffer
+ * pool, or if earlier changes of key are deferred still, which it has to
+ * follow. A buffer that fills up is merged right away.
+ * @return : false if the change has to be applied now
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BufferChange(ChangeType type, const KeyType &key, const ValueType &value) -> bool {
+  if (change_buffer_capacity_ == 0 || merging_thread_ == std::this_thread::get_id()) {
+    return false;
+  }
+  auto hash = hash_fn_.GetHash(key);
+  change_merge_latch_.RLock();
+  bool is_pending = false;
+  {
+    std::scoped_lock lock(buffered_changes_latch_);
+    auto bucket = buffered_changes_.find(hash);
+    is_pending = bucket != buffered_changes_.end() &&
+                 std::any_of(bucket->second.begin(), bucket->second.end(),
+                             [&](const auto &change) { return comparator_(change.key_, key) == 0; });
+  }
+  if (!is_pending && IsPathResident(key)) {
+    change_merge_latch_.RUnlock();
+    return false;
+  }
+  {
+    std::scoped_lock lock(buffered_changes_latch_);
+    buffered_changes_[hash].push_back(BufferedChange{type, key, value});
+  }
+  bool is_full = ++buffered_change_count_ >= change_buffer_capacity_;
+  change_merge_latch_.RUnlock();
+  if (is_full) {
+    MergeChangeBuffer();
+  }
+  return true;
+}
+
+/*
+ * Descend to the leaf of key like a lookup does, without reading the pages
+ * that are not in the buffer pool
+ * @return : false if a page on the way is not in the buffer pool
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsPathResident(const KeyType &key) -> bool {
+  root_page_id_latch_.RLock();
+  if (IsEmpty()) {
+    root_page_id_latch_.RUnlock();
+    return true;
+  }
+  if (!buffer_pool_manager_->IsPageResident(root_page_id_)) {
+    root_page_id_latch_.RUnlock();
+    return false;
+  }
+  auto *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  page->RLatch();
+  root_page_id_latch_.RUnlock();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  bool is_resident = true;
+  while (!node->IsLeafPage()) {
+    auto child_page_id = GetNextPageIdForFind(reinterpret_cast<InternalPage *>(node), key);
+    if (!buffer_pool_manager_->IsPageResident(child_page_id)) {
+      is_resident = false;
+      break;
+    }
+    auto *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return is_resident;
+}
+
+/*
+ * Apply the deferred changes, sorted by key so that they reach the leaves one
+ * after the other instead of at random. The sort is stable, the changes of a
+ * key keep their order.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MergeChangeBuffer() {
+  if (buffered_change_count_ == 0) {
+    WaitForMerge();
+    return;
+  }
+  change_merge_latch_.WLock();
+  merging_thread_ = std::this_thread::get_id();
+  std::vector<BufferedChange> changes;
+  {
+    std::scoped_lock lock(buffered_changes_latch_);
+    for (auto &[hash, bucket] : buffered_changes_) {
+      std::move(bucket.begin(), bucket.end(), std::back_inserter(changes));
+    }
+    buffered_changes_.clear();
+    buffered_change_count_ = 0;
+  }
+  std::stable_sort(changes.begin(), changes.end(),
+                   [this](const auto &a, const auto &b) { return comparator_(a.key_, b.key_) < 0; });
+  ApplyChanges(changes);
+  merging_thread_ = INVALID_THREAD_ID;
+  change_merge_latch_.WUnlock();
+}
+
+/*
+ * Apply the deferred changes of key only, before a lookup of key reads its leaf
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MergeBufferedChanges(const KeyType &key) {
+  if (buffered_change_count_ == 0) {
+    WaitForMerge();
+    return;
+  }
+  auto hash = hash_fn_.GetHash(key);
+  auto is_key = [&](const auto &change) { return comparator_(change.key_, key) == 0; };
+  bool is_pending = false;
+  {
+    std::scoped_lock lock(buffered_changes_latch_);
+    auto bucket = buffered_changes_.find(hash);
+    is_pending = bucket != buffered_changes_.end() && std::any_of(bucket->second.begin(), bucket->second.end(), is_key);
+  }
+  if (!is_pending) {
+    WaitForMerge();
+    return;
+  }
+  change_merge_latch_.WLock();
+  merging_thread_ = std::this_thread::get_id();
+  std::vector<BufferedChange> changes;
+  {
+    std::scoped_lock lock(buffered_changes_latch_);
+    auto bucket = buffered_changes_.find(hash);
+    if (bucket != buffered_changes_.end()) {
+      auto &others = bucket->second;
+      std::copy_if(others.begin(), others.end(), std::back_inserter(changes), is_key);
+      others.erase(std::remove_if(others.begin(), others.end(), is_key), others.end());
+      if (others.empty()) {
+        buffered_changes_.erase(bucket);
+      }
+      buffered_change_count_ -= changes.size();
+    }
+  }
+  ApplyChanges(changes);
+  merging_thread_ = INVALID_THREAD_ID;
+  change_merge_latch_.WUnlock();
+}
+
+/*
+ * Wait for a merge in flight. Its changes have left the buffer already, but
+ * may not have reached the leaves yet.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::WaitForMerge() {
+  auto merging_thread = merging_thread_.load();
+  if (merging_thread != INVALID_THREAD_ID && merging_thread != std::this_thread::get_id()) {
+    change_merge_latch_.RLock();
+    change_merge_latch_.RUnlock();
+  }
+}
+
+/*
+ * Apply changes to the tree, the caller holds the merge latch and is the
+ * merging thread, whose changes are not deferred again
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ApplyChanges(const std::vector<BufferedChange> &changes) {
+  Transaction transaction(INVALID_TXN_ID);
+  for (const auto &change : changes) {
+    switch (change.type_) {
+      case ChangeType::Insert:
+        Insert(change.key_, change.value_, &transaction);
+        break;
+      case ChangeType::Remove:
+        Remove(change.key_, change.value_, &transaction);
+        break;
+      case ChangeType::RemoveKey:
+        Remove(change.key_, &transaction);
+        break;
+    }
+  }
+}
+
 /*
  * Input parameter is void, construct an index iterator representing the end
  * of the key/value pair in the leaf node
@@ -579,6 +1554,10 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
+  MergeChangeBuffer();
+  if (IsEmpty()) {
+    return INDEXITERATOR_TYPE(nullptr, -1, nullptr);
+  }
   auto node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
   while (!node->IsLeafPage()) {
     auto internal = reinterpret_cast<InternalPage *>(node);
@@ -822,4 +1801,10 @@ template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class BPlusTree<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class BPlusTree<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class BPlusTree<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class BPlusTree<GenericKey<64>, RID, MemcmpComparator<64>>;
+
 }  // namespace bustub
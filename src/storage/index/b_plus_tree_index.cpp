@@ -9,9 +9,68 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <functional>
+
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/index_key.h"
+#include "type/value_factory.h"
 
 namespace bustub {
+
+namespace {
+
+/**
+ * Cursor over a b+ tree that hides its key type. A bounded cursor ends at the first key out of its range.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeScanIterator : public IndexScanIterator {
+ public:
+  BPlusTreeScanIterator(const BPLUSTREE_INDEX_TYPE *index, INDEXITERATOR_TYPE &&iter,
+                        std::function<bool(const KeyType &)> in_range)
+      : index_(index), iter_(std::move(iter)), in_range_(std::move(in_range)) {}
+
+  auto IsEnd() -> bool override {
+    if (iter_.IsInvaildIndexIter() || iter_.IsEnd()) {
+      return true;
+    }
+    return in_range_ && !in_range_((*iter_).first);
+  }
+
+  auto IsBegin() -> bool override { return iter_.IsBegin(); }
+
+  auto GetRID() -> RID override { return (*iter_).second; }
+
+  auto GetKey() -> Tuple override { return index_->KeyToTuple((*iter_).first); }
+
+  void Next() override { ++iter_; }
+
+  void Prev() override { --iter_; }
+
+ private:
+  const BPLUSTREE_INDEX_TYPE *index_;
+  INDEXITERATOR_TYPE iter_;
+  std::function<bool(const KeyType &)> in_range_;
+};
+
+/**
+ * Cursor over no entries, for a probe that the Bloom filter ruled out.
+ */
+class EmptyScanIterator : public IndexScanIterator {
+ public:
+  auto IsEnd() -> bool override { return true; }
+
+  auto IsBegin() -> bool override { return true; }
+
+  auto GetRID() -> RID override { throw Exception(ExceptionType::OUT_OF_RANGE, "the scan has no entries"); }
+
+  auto GetKey() -> Tuple override { throw Exception(ExceptionType::OUT_OF_RANGE, "the scan has no entries"); }
+
+  void Next() override {}
+
+  void Prev() override {}
+};
+
+}  // namespace
 /*
  * Constructor
  */
@@ -24,8 +83,7 @@ BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata,
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = MakeKey(key);
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -33,20 +91,136 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
-  container_.Remove(index_key, transaction);
+  KeyType index_key = MakeKey(key);
+  // only the given rid leaves the index, other tuples with the same key stay
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = MakeKey(key);
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> {
+  return std::make_unique<BPlusTreeScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, from_end ? container_.End() : container_.Begin(), nullptr);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetPrefixIterator(const std::vector<Value> &prefix, Transaction * /*transaction*/)
+    -> std::unique_ptr<IndexScanIterator> {
+  if (prefix.empty()) {
+    return GetScanIterator(false);
+  }
+  KeyType begin_key;
+  auto length = MakePrefixKey(prefix, &begin_key);
+  // a prefix of every key column is a whole key, which the Bloom filter may rule out without a descent
+  if (prefix.size() == GetKeySchema()->GetColumnCount() && !container_.MayContain(begin_key)) {
+    return std::make_unique<EmptyScanIterator>();
+  }
+  std::function<bool(const KeyType &)> in_range = [begin_key, length, comparator = comparator_](const KeyType &key) {
+    return IndexKeyHasPrefix(key, begin_key, length, comparator);
+  };
+  return std::make_unique<BPlusTreeScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, container_.Begin(begin_key), std::move(in_range));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::CountRange(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                                      Transaction * /*transaction*/) -> size_t {
+  if (!lower.has_value() && !upper.has_value()) {
+    return container_.Size();
+  }
+  // NULL is the smallest value of every type, a range without a lower end starts past it
+  auto null = ValueFactory::GetNullValueByType(GetKeySchema()->GetColumn(0).GetType());
+  auto begin = lower.has_value() ? BoundRank(*lower, !lower->inclusive_) : BoundRank({null, false}, true);
+  auto end = upper.has_value() ? BoundRank(*upper, upper->inclusive_) : container_.Size();
+  return end > begin ? end - begin : 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRankIterator(size_t rank, Transaction * /*transaction*/)
+    -> std::unique_ptr<IndexScanIterator> {
+  return std::make_unique<BPlusTreeScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, container_.BeginAtRank(rank), nullptr);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRangeIterator(const std::optional<IndexBound> &lower,
+                                            const std::optional<IndexBound> &upper, Transaction * /*transaction*/)
+    -> std::unique_ptr<IndexScanIterator> {
+  if (!lower.has_value() && !upper.has_value()) {
+    return GetScanIterator(false);
+  }
+  if constexpr (IsNormalizedKey<KeyComparator>::VALUE) {
+    // NULL is the smallest value of every type, a range without a lower end starts past it
+    auto null = ValueFactory::GetNullValueByType(GetKeySchema()->GetColumn(0).GetType());
+    KeyType begin_key;
+    if (!BoundKey(lower.value_or(IndexBound{null, false}), !lower.has_value() || !lower->inclusive_, &begin_key)) {
+      return std::make_unique<EmptyScanIterator>();
+    }
+    // the scan ends at the first key at or past the upper end, unless no key is
+    std::function<bool(const KeyType &)> in_range;
+    if (KeyType end_key; upper.has_value() && BoundKey(*upper, upper->inclusive_, &end_key)) {
+      in_range = [end_key, comparator = comparator_](const KeyType &key) { return comparator(key, end_key) < 0; };
+    }
+    return std::make_unique<BPlusTreeScanIterator<KeyType, ValueType, KeyComparator>>(
+        this, container_.Begin(begin_key), std::move(in_range));
+  } else {
+    throw NotImplementedException("a range scan of a b+ tree needs normalized keys");
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BoundRank(const IndexBound &bound, bool after) -> size_t {
+  KeyType key;
+  if constexpr (IsNormalizedKey<KeyComparator>::VALUE) {
+    if (!BoundKey(bound, after, &key)) {
+      return container_.Size();
+    }
+    return container_.Rank(key);
+  } else {
+    MakePrefixKey({bound.value_}, &key);
+    return container_.Rank(key, after);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BoundKey(const IndexBound &bound, bool after, KeyType *key) const -> bool {
+  auto length = MakePrefixKey({bound.value_}, key);
+  if (after) {
+    // the first key past every key that starts with the encoding is the encoding plus one, in byte order
+    auto *bytes = reinterpret_cast<uint8_t *>(key->data_);
+    while (length > 0 && bytes[length - 1] == 0xFF) {
+      bytes[--length] = 0;
+    }
+    if (length == 0) {
+      return false;
+    }
+    bytes[length - 1]++;
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::MakePrefixKey(const std::vector<Value> &prefix, KeyType *key) const -> size_t {
+  return MakeIndexPrefixKey<KeyType, KeyComparator>(prefix, GetKeySchema(), key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::MakeKey(const Tuple &key) const -> KeyType {
+  return MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::KeyToTuple(const KeyType &index_key) const -> Tuple {
+  return IndexKeyToTuple<KeyType, KeyComparator>(index_key, GetKeySchema());
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
@@ -62,4 +236,10 @@ template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTreeIndex<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class BPlusTreeIndex<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class BPlusTreeIndex<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class BPlusTreeIndex<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class BPlusTreeIndex<GenericKey<64>, RID, MemcmpComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,100 @@
+#include "storage/index/bloom_filter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace bustub {
+
+namespace {
+
+/** @return the mask of the probe-th bit that the key with the hash sets in a block of 512 bits, split in words */
+inline auto ProbeBit(uint64_t hash, size_t probe) -> std::pair<size_t, uint64_t> {
+  // double hashing over the low half of the hash, the high half picks the block
+  auto h1 = static_cast<uint32_t>(hash);
+  auto h2 = static_cast<uint32_t>((hash * 0x9E3779B97F4A7C15ULL) >> 32) | 1;
+  auto bit = (h1 + probe * h2) & 511;
+  return {bit >> 6, uint64_t{1} << (bit & 63)};
+}
+
+}  // namespace
+
+BloomFilter::BloomFilter(size_t expected_keys) { Clear(expected_keys); }
+
+auto BloomFilter::MakeLayer(size_t capacity) -> std::unique_ptr<Layer> {
+  auto layer = std::make_unique<Layer>();
+  layer->capacity_ = std::max<size_t>(capacity, 1);
+  layer->num_blocks_ = (layer->capacity_ * BITS_PER_KEY + WORDS_PER_BLOCK * 64 - 1) / (WORDS_PER_BLOCK * 64);
+  // value initialized, so every bit starts out clear
+  layer->blocks_ = std::make_unique<Block[]>(layer->num_blocks_);
+  return layer;
+}
+
+auto BloomFilter::BlockOf(const Layer &layer, uint64_t hash) -> Block & {
+  // the high half of the hash scaled to the number of blocks, without a division
+  return layer.blocks_[((hash >> 32) * layer.num_blocks_) >> 32];
+}
+
+void BloomFilter::Insert(uint64_t hash) {
+  auto *layer = layers_[num_layers_.load(std::memory_order_acquire) - 1].get();
+  if (layer->keys_.fetch_add(1, std::memory_order_relaxed) >= layer->capacity_) {
+    // the layer is full, the first writer to see it adds a layer twice as large
+    std::scoped_lock lock(grow_latch_);
+    auto num_layers = num_layers_.load(std::memory_order_relaxed);
+    if (layers_[num_layers - 1].get() == layer && num_layers < MAX_LAYERS) {
+      layers_[num_layers] = MakeLayer(layer->capacity_ * 2);
+      num_layers_.store(num_layers + 1, std::memory_order_release);
+    }
+    layer = layers_[num_layers_.load(std::memory_order_relaxed) - 1].get();
+    layer->keys_.fetch_add(1, std::memory_order_relaxed);
+  }
+  auto &block = BlockOf(*layer, hash);
+  for (size_t probe = 0; probe < NUM_PROBES; probe++) {
+    auto [word, mask] = ProbeBit(hash, probe);
+    block.words_[word].fetch_or(mask, std::memory_order_release);
+  }
+}
+
+auto BloomFilter::MayContain(uint64_t hash) -> bool {
+  auto num_layers = num_layers_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_layers; i++) {
+    auto &block = BlockOf(*layers_[i], hash);
+    bool found = true;
+    for (size_t probe = 0; probe < NUM_PROBES && found; probe++) {
+      auto [word, mask] = ProbeBit(hash, probe);
+      found = (block.words_[word].load(std::memory_order_acquire) & mask) != 0;
+    }
+    if (found) {
+      return true;
+    }
+  }
+  skips_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void BloomFilter::Clear(size_t expected_keys) {
+  for (auto &layer : layers_) {
+    layer.reset();
+  }
+  layers_[0] = MakeLayer(expected_keys);
+  num_layers_ = 1;
+}
+
+auto BloomFilter::GetKeyCount() const -> size_t {
+  size_t keys = 0;
+  for (size_t i = 0; i < num_layers_; i++) {
+    // a writer that found its layer full counts itself there as well as in the next one
+    keys += std::min(layers_[i]->keys_.load(), i + 1 < num_layers_ ? layers_[i]->capacity_ : SIZE_MAX);
+  }
+  return keys;
+}
+
+auto BloomFilter::GetMemoryUsage() const -> size_t {
+  size_t bytes = 0;
+  for (size_t i = 0; i < num_layers_; i++) {
+    bytes += layers_[i]->num_blocks_ * sizeof(Block);
+  }
+  return bytes;
+}
+
+}  // namespace bustub
@@ -1,8 +1,38 @@
 #include <vector>
 
 #include "storage/index/extendible_hash_table_index.h"
+#include "storage/index/index_key.h"
 
 namespace bustub {
+
+namespace {
+
+/**
+ * Cursor over the entries of one key, which a hash table returns at once and in no particular order.
+ */
+class HashTableScanIterator : public IndexScanIterator {
+ public:
+  HashTableScanIterator(std::vector<RID> &&rids, Tuple key) : rids_(std::move(rids)), key_(std::move(key)) {}
+
+  auto IsEnd() -> bool override { return index_ == rids_.size(); }
+
+  auto IsBegin() -> bool override { return index_ == 0; }
+
+  auto GetRID() -> RID override { return rids_[index_]; }
+
+  auto GetKey() -> Tuple override { return key_; }
+
+  void Next() override { index_++; }
+
+  void Prev() override { index_--; }
+
+ private:
+  std::vector<RID> rids_;
+  Tuple key_;
+  size_t index_{0};
+};
+
+}  // namespace
 /*
  * Constructor
  */
@@ -12,22 +42,24 @@ HASH_TABLE_INDEX_TYPE::ExtendibleHashTableIndex(std::unique_ptr<IndexMetadata> &
                                                 const HashFunction<KeyType> &hash_fn)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
+      hash_fn_(hash_fn),
       container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn) {}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  auto index_key = MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema());
 
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->Insert(hash_fn_.GetHash(index_key));
+  }
   container_.Insert(transaction, index_key, rid);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  auto index_key = MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema());
 
   container_.Remove(transaction, index_key, rid);
 }
@@ -35,15 +67,54 @@ void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  auto index_key = MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema());
 
+  // a key that the filter rules out is not in the table, the probe ends before it reads a bucket
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(hash_fn_.GetHash(index_key))) {
+    return;
+  }
   container_.GetValue(transaction, index_key, result);
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_INDEX_TYPE::GetPrefixIterator(const std::vector<Value> &prefix, Transaction *transaction)
+    -> std::unique_ptr<IndexScanIterator> {
+  if (prefix.size() != GetKeySchema()->GetColumnCount()) {
+    throw NotImplementedException("a hash index only finds whole keys");
+  }
+  std::vector<Value> values;
+  values.reserve(prefix.size());
+  for (uint32_t i = 0; i < prefix.size(); i++) {
+    auto type = GetKeySchema()->GetColumn(i).GetType();
+    values.push_back(prefix[i].GetTypeId() == type ? prefix[i] : prefix[i].CastAs(type));
+  }
+  Tuple key(values, GetKeySchema());
+  std::vector<RID> rids;
+  ScanKey(key, &rids, transaction);
+  return std::make_unique<HashTableScanIterator>(std::move(rids), std::move(key));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_INDEX_TYPE::GetRangeIterator(const std::optional<IndexBound> &lower,
+                                             const std::optional<IndexBound> &upper, Transaction *transaction)
+    -> std::unique_ptr<IndexScanIterator> {
+  if (GetKeySchema()->GetColumnCount() != 1 || !lower.has_value() || !upper.has_value() || !lower->inclusive_ ||
+      !upper->inclusive_ || lower->value_.CompareEquals(upper->value_) != CmpBool::CmpTrue) {
+    throw NotImplementedException("a hash index only finds whole keys");
+  }
+  return GetPrefixIterator({lower->value_}, transaction);
+}
+
 template class ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class ExtendibleHashTableIndex<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class ExtendibleHashTableIndex<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class ExtendibleHashTableIndex<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class ExtendibleHashTableIndex<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class ExtendibleHashTableIndex<GenericKey<64>, RID, MemcmpComparator<64>>;
+
 }  // namespace bustub
@@ -2,6 +2,7 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
 #include "common/logger.h"
 #include "storage/index/index_iterator.h"
@@ -14,10 +15,47 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(LeafPage *leaf, int index, BufferPoolManager *bpm)
-    : leaf_(leaf), index_(index), bpm_(bpm) {}
+    : leaf_(leaf), index_(index), bpm_(bpm) {
+  SkipExhaustedLeaves();
+  SyncPostings();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : leaf_(other.leaf_),
+      index_(other.index_),
+      posting_idx_(other.posting_idx_),
+      bpm_(other.bpm_),
+      postings_(std::move(other.postings_)),
+      current_(other.current_) {
+  other.leaf_ = nullptr;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator(){};  // NOLINT
+auto INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept -> INDEXITERATOR_TYPE & {
+  if (this != &other) {
+    Release();
+    leaf_ = other.leaf_;
+    index_ = other.index_;
+    posting_idx_ = other.posting_idx_;
+    bpm_ = other.bpm_;
+    postings_ = std::move(other.postings_);
+    current_ = other.current_;
+    other.leaf_ = nullptr;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }  // NOLINT
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (leaf_ != nullptr && bpm_ != nullptr) {
+    bpm_->UnpinPage(leaf_->GetPageId(), false);
+  }
+  leaf_ = nullptr;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool {
@@ -25,32 +63,116 @@ auto INDEXITERATOR_TYPE::IsEnd() -> bool {
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsInvaildIndexIter() -> bool {
-  return leaf_ == nullptr || index_ < 0 || index_ > leaf_->GetSize();
+auto INDEXITERATOR_TYPE::IsBegin() -> bool {
+  if (leaf_ == nullptr) {
+    return true;
+  }
+  if (index_ > 0 || posting_idx_ > 0) {
+    return false;
+  }
+  // the leaves before this one may all be empty
+  auto prev_page_id = leaf_->GetPrevPageId();
+  while (prev_page_id != INVALID_PAGE_ID) {
+    auto *prev = reinterpret_cast<LeafPage *>(bpm_->FetchPage(prev_page_id)->GetData());
+    bool is_empty = prev->GetSize() == 0;
+    auto page_id = prev_page_id;
+    prev_page_id = prev->GetPrevPageId();
+    bpm_->UnpinPage(page_id, false);
+    if (!is_empty) {
+      return false;
+    }
+  }
+  return true;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return leaf_->PairAt(index_); }
+auto INDEXITERATOR_TYPE::IsInvaildIndexIter() -> bool {
+  return leaf_ == nullptr || index_ < 0 || index_ > leaf_->GetSize();
+}
 
+/*
+ * Move past the end of a leaf to the first pair of the next one, stepping
+ * over the empty leaves that lazy removes leave behind. Only the last leaf of
+ * the tree keeps the iterator at its end.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-  auto next_page_id = leaf_->GetNextPageId();
-  if (index_ + 1 >= leaf_->GetSize()) {
-    if (next_page_id == INVALID_PAGE_ID) {
-      if (index_ == leaf_->GetSize()) {
-        throw Exception("index out of range");
-      }
-      index_++;
-      return *this;
-    }
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (leaf_ != nullptr && index_ >= leaf_->GetSize() && leaf_->GetNextPageId() != INVALID_PAGE_ID) {
+    auto next_page_id = leaf_->GetNextPageId();
     if (!bpm_->UnpinPage(leaf_->GetPageId(), false)) {
       LOG_DEBUG("unpin page failed");
     }
     leaf_ = reinterpret_cast<LeafPage *>(bpm_->FetchPage(next_page_id)->GetData());
     index_ = 0;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SyncPostings() {
+  postings_.clear();
+  posting_idx_ = 0;
+  if (IsInvaildIndexIter() || index_ == leaf_->GetSize()) {
+    return;
+  }
+  auto value = leaf_->ValueAt(index_);
+  if (BPlusTreePostingPage::IsRef(value)) {
+    BPlusTreePostingList::Collect(bpm_, value.GetPageId(), &postings_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  if (postings_.empty()) {
+    current_ = leaf_->PairAt(index_);
+  } else {
+    current_ = std::make_pair(leaf_->KeyAt(index_), postings_[posting_idx_]);
+  }
+  return current_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  // a duplicated key yields one pair per value before moving to the next slot
+  if (posting_idx_ + 1 < postings_.size()) {
+    posting_idx_++;
     return *this;
   }
+  if (IsEnd()) {
+    throw Exception("index out of range");
+  }
   index_++;
+  SkipExhaustedLeaves();
+  SyncPostings();
+  return *this;
+}
+
+/*
+ * Step back to the previous pair, following the prev page id of the leaf
+ * when the current one is exhausted. Decrementing the end iterator yields
+ * the last pair.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator--() -> INDEXITERATOR_TYPE & {
+  if (posting_idx_ > 0) {
+    posting_idx_--;
+    return *this;
+  }
+  // empty leaves have nothing to step back to, so keep going
+  while (index_ <= 0) {
+    auto prev_page_id = leaf_->GetPrevPageId();
+    if (prev_page_id == INVALID_PAGE_ID) {
+      throw Exception("index out of range");
+    }
+    if (!bpm_->UnpinPage(leaf_->GetPageId(), false)) {
+      LOG_DEBUG("unpin page failed");
+    }
+    leaf_ = reinterpret_cast<LeafPage *>(bpm_->FetchPage(prev_page_id)->GetData());
+    index_ = leaf_->GetSize();
+  }
+  index_--;
+  SyncPostings();
+  // a duplicated key is entered from its last value
+  posting_idx_ = postings_.empty() ? 0 : postings_.size() - 1;
   return *this;
 }
 
@@ -64,4 +186,14 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<GenericKey<4>, RID, MemcmpComparator<4>>;
+
+template class IndexIterator<GenericKey<8>, RID, MemcmpComparator<8>>;
+
+template class IndexIterator<GenericKey<16>, RID, MemcmpComparator<16>>;
+
+template class IndexIterator<GenericKey<32>, RID, MemcmpComparator<32>>;
+
+template class IndexIterator<GenericKey<64>, RID, MemcmpComparator<64>>;
+
 }  // namespace bustub
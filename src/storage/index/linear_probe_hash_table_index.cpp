@@ -12,6 +12,7 @@ HASH_TABLE_INDEX_TYPE::LinearProbeHashTableIndex(std::unique_ptr<IndexMetadata>
                                                  const HashFunction<KeyType> &hash_fn)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
+      hash_fn_(hash_fn),
       container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, num_buckets, hash_fn) {}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -20,6 +21,9 @@ void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *
   KeyType index_key;
   index_key.SetFromKey(key);
 
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->Insert(hash_fn_.GetHash(index_key));
+  }
   container_.Insert(transaction, index_key, rid);
 }
 
@@ -38,6 +42,10 @@ void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result,
   KeyType index_key;
   index_key.SetFromKey(key);
 
+  // a key that the filter rules out is not in the table, the probe ends before it reads a bucket
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(hash_fn_.GetHash(index_key))) {
+    return;
+  }
   container_.GetValue(transaction, index_key, result);
 }
 template class LinearProbeHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
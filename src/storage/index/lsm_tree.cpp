@@ -0,0 +1,513 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree.cpp
+//
+// Identification: src/storage/index/lsm_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/lsm_tree.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * RUN
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+LSMRUN_TYPE::LSMRun(BufferPoolManager *bpm, const KeyComparator &comparator, HashFunction<KeyType> hash_fn,
+                    size_t max_size)
+    : bpm_(bpm), comparator_(comparator), hash_fn_(hash_fn) {
+  bloom_.resize((std::max<size_t>(max_size, 1) * BLOOM_BITS_PER_KEY + 63) / 64);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSMRUN_TYPE::~LSMRun() {
+  Seal();
+  for (auto page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMRUN_TYPE::Append(const Entry &entry) {
+  auto *page = tail_page_ == nullptr ? nullptr : reinterpret_cast<RunPage *>(tail_page_->GetData());
+  if (page == nullptr || page->IsFull()) {
+    Seal();
+    page_id_t page_id;
+    tail_page_ = bpm_->NewPage(&page_id);
+    if (tail_page_ == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame is free for a page of the run");
+    }
+    page = reinterpret_cast<RunPage *>(tail_page_->GetData());
+    page->Init(page_id);
+    page_ids_.push_back(page_id);
+    fence_keys_.push_back(entry.key_);
+  }
+  page->Append(entry);
+  size_++;
+
+  auto hash = hash_fn_.GetHash(entry.key_);
+  for (size_t i = 0; i < BLOOM_HASH_COUNT; i++) {
+    auto bit = BloomBit(hash, i);
+    bloom_[bit / 64] |= uint64_t{1} << (bit % 64);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMRUN_TYPE::Seal() {
+  if (tail_page_ != nullptr) {
+    bpm_->UnpinPage(tail_page_->GetPageId(), true);
+    tail_page_ = nullptr;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMRUN_TYPE::BloomBit(uint64_t hash, size_t i) const -> size_t {
+  // double hashing, the second hash is odd so that the probes do not repeat early
+  uint64_t step = (hash >> 32) | 1;
+  return static_cast<size_t>((hash + i * step) % (bloom_.size() * 64));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMRUN_TYPE::MayContain(const KeyType &key) const -> bool {
+  auto hash = hash_fn_.GetHash(key);
+  for (size_t i = 0; i < BLOOM_HASH_COUNT; i++) {
+    auto bit = BloomBit(hash, i);
+    if ((bloom_[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMRUN_TYPE::LowerBound(const KeyType &key) const -> size_t {
+  // the first page whose first key is not less than key, the entries of key may start on the page before
+  auto fence = std::lower_bound(fence_keys_.begin(), fence_keys_.end(), key,
+                                [this](const KeyType &lhs, const KeyType &rhs) { return comparator_(lhs, rhs) < 0; });
+  if (fence == fence_keys_.begin()) {
+    return 0;
+  }
+  auto page_index = static_cast<size_t>(fence - fence_keys_.begin()) - 1;
+  std::vector<Entry> page;
+  ReadPage(page_index * PAGE_CAPACITY, &page);
+  auto entry = std::lower_bound(page.begin(), page.end(), key, [this](const Entry &lhs, const KeyType &rhs) {
+    return comparator_(lhs.key_, rhs) < 0;
+  });
+  return page_index * PAGE_CAPACITY + static_cast<size_t>(entry - page.begin());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMRUN_TYPE::ReadPage(size_t index, std::vector<Entry> *page) const {
+  BUSTUB_ASSERT(tail_page_ == nullptr, "the run is not sealed");
+  auto page_id = page_ids_[index / PAGE_CAPACITY];
+  auto *raw_page = bpm_->FetchPage(page_id);
+  if (raw_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame is free for a page of the run");
+  }
+  auto *run_page = reinterpret_cast<const RunPage *>(raw_page->GetData());
+  page->clear();
+  page->reserve(run_page->GetSize());
+  for (int i = 0; i < run_page->GetSize(); i++) {
+    page->push_back(run_page->EntryAt(i));
+  }
+  bpm_->UnpinPage(page_id, false);
+}
+
+/*****************************************************************************
+ * ITERATOR
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_ITERATOR_TYPE::LSMTreeIterator(const KeyComparator &comparator, std::vector<Entry> &&memtable,
+                                       std::vector<std::shared_ptr<const Run>> &&runs, const KeyType *key,
+                                       bool at_end, bool keep_tombstones)
+    : comparator_(comparator), keep_tombstones_(keep_tombstones) {
+  sources_.reserve(runs.size() + 1);
+  auto memtable_size = memtable.size();
+  sources_.push_back({nullptr, std::move(memtable), memtable_size, 0});
+  for (auto &run : runs) {
+    auto size = run->GetSize();
+    sources_.push_back({std::move(run), {}, size, 0});
+  }
+
+  positions_.resize(sources_.size(), 0);
+  for (size_t i = 0; i < sources_.size(); i++) {
+    auto &source = sources_[i];
+    if (at_end) {
+      positions_[i] = source.size_;
+    } else if (key != nullptr && source.run_ == nullptr) {
+      positions_[i] = std::lower_bound(source.entries_.begin(), source.entries_.end(), *key,
+                                       [this](const Entry &lhs, const KeyType &rhs) {
+                                         return comparator_(lhs.key_, rhs) < 0;
+                                       }) -
+                      source.entries_.begin();
+    } else if (key != nullptr) {
+      positions_[i] = source.run_->LowerBound(*key);
+    }
+  }
+  if (!at_end) {
+    SettleForward();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_ITERATOR_TYPE::EntryAt(size_t source, size_t index) -> const Entry & {
+  auto &src = sources_[source];
+  if (src.run_ != nullptr && (index < src.page_begin_ || index >= src.page_begin_ + src.entries_.size())) {
+    src.run_->ReadPage(index, &src.entries_);
+    src.page_begin_ = index - index % Run::PAGE_CAPACITY;
+  }
+  return src.entries_[index - src.page_begin_];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_ITERATOR_TYPE::Compare(const Entry &lhs, const Entry &rhs) const -> int {
+  int cmp = comparator_(lhs.key_, rhs.key_);
+  if (cmp != 0) {
+    return cmp;
+  }
+  auto lhs_value = lhs.value_.Get();
+  auto rhs_value = rhs.value_.Get();
+  return lhs_value < rhs_value ? -1 : (lhs_value > rhs_value ? 1 : 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_ITERATOR_TYPE::SettleForward() {
+  has_prev_ = false;
+  while (true) {
+    // the smallest entry, ties go to the newest source
+    current_source_ = NO_SOURCE;
+    for (size_t i = 0; i < sources_.size(); i++) {
+      if (positions_[i] == sources_[i].size_) {
+        continue;
+      }
+      if (current_source_ == NO_SOURCE ||
+          Compare(EntryAt(i, positions_[i]), EntryAt(current_source_, positions_[current_source_])) < 0) {
+        current_source_ = i;
+      }
+    }
+    if (current_source_ == NO_SOURCE || keep_tombstones_ ||
+        !EntryAt(current_source_, positions_[current_source_]).tombstone_) {
+      return;
+    }
+    StepPastCurrent();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_ITERATOR_TYPE::StepPastCurrent() {
+  auto current = EntryAt(current_source_, positions_[current_source_]);
+  for (size_t i = 0; i < sources_.size(); i++) {
+    if (positions_[i] < sources_[i].size_ && Compare(EntryAt(i, positions_[i]), current) == 0) {
+      positions_[i]++;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_ITERATOR_TYPE::StepBackward(std::vector<size_t> *positions) -> size_t {
+  while (true) {
+    // the largest entry before the positions, ties go to the newest source
+    size_t newest = NO_SOURCE;
+    Entry target;
+    for (size_t i = 0; i < sources_.size(); i++) {
+      if ((*positions)[i] == 0) {
+        continue;
+      }
+      const auto &entry = EntryAt(i, (*positions)[i] - 1);
+      if (newest == NO_SOURCE || Compare(entry, target) > 0) {
+        newest = i;
+        target = entry;
+      }
+    }
+    if (newest == NO_SOURCE) {
+      return NO_SOURCE;
+    }
+    for (size_t i = 0; i < sources_.size(); i++) {
+      if ((*positions)[i] > 0 && Compare(EntryAt(i, (*positions)[i] - 1), target) == 0) {
+        (*positions)[i]--;
+      }
+    }
+    if (keep_tombstones_ || !target.tombstone_) {
+      return newest;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_ITERATOR_TYPE::IsBegin() -> bool {
+  if (!has_prev_) {
+    prev_positions_ = positions_;
+    prev_source_ = StepBackward(&prev_positions_);
+    has_prev_ = true;
+  }
+  return prev_source_ == NO_SOURCE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_ITERATOR_TYPE::operator*() -> const MappingType & {
+  const auto &entry = EntryAt(current_source_, positions_[current_source_]);
+  current_ = {entry.key_, entry.value_};
+  return current_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_ITERATOR_TYPE::operator++() -> LSMTreeIterator & {
+  if (!IsEnd()) {
+    StepPastCurrent();
+    SettleForward();
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_ITERATOR_TYPE::operator--() -> LSMTreeIterator & {
+  if (!IsBegin()) {
+    positions_ = std::move(prev_positions_);
+    current_source_ = prev_source_;
+    has_prev_ = false;
+  }
+  return *this;
+}
+
+/*****************************************************************************
+ * LSM TREE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::LSMTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                      HashFunction<KeyType> hash_fn, size_t memtable_capacity, size_t fanout)
+    : index_name_(std::move(name)),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      hash_fn_(hash_fn),
+      memtable_capacity_(memtable_capacity),
+      fanout_(std::max<size_t>(fanout, 2)),
+      memtable_(EntryLess{comparator}) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Insert(const KeyType &key, const ValueType &value) { Put(key, value, false); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Remove(const KeyType &key, const ValueType &value) { Put(key, value, true); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Put(const KeyType &key, const ValueType &value, bool tombstone) {
+  latch_.WLock();
+  // a later change of the same entry replaces the earlier one
+  memtable_[{key, value}] = tombstone;
+  bool full = memtable_.size() >= memtable_capacity_;
+  if (full) {
+    FlushMemtable();
+  }
+  latch_.WUnlock();
+  if (full) {
+    Compact();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool {
+  // the newest entry of a value decides whether the key has it
+  std::unordered_set<int64_t> decided;
+  bool found = false;
+  auto visit = [&](const ValueType &value, bool tombstone) {
+    if (!decided.insert(value.Get()).second) {
+      return;
+    }
+    if (!tombstone) {
+      result->push_back(value);
+      found = true;
+    }
+  };
+
+  latch_.RLock();
+  for (auto iter = memtable_.lower_bound(key); iter != memtable_.end() && comparator_(iter->first.first, key) == 0;
+       ++iter) {
+    visit(iter->first.second, iter->second);
+  }
+  auto runs = SnapshotRuns();
+  latch_.RUnlock();
+
+  std::vector<Entry> page;
+  for (const auto &run : runs) {
+    if (!run->MayContain(key)) {
+      continue;
+    }
+    size_t page_begin = 0;
+    page.clear();
+    for (auto index = run->LowerBound(key); index < run->GetSize(); index++) {
+      if (index >= page_begin + page.size()) {
+        run->ReadPage(index, &page);
+        page_begin = index - index % Run::PAGE_CAPACITY;
+      }
+      const auto &entry = page[index - page_begin];
+      if (comparator_(entry.key_, key) != 0) {
+        break;
+      }
+      visit(entry.value_, entry.tombstone_);
+    }
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Begin() -> LSMTREE_ITERATOR_TYPE { return MakeIterator(nullptr, false, nullptr); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Begin(const KeyType &key, const std::function<bool(const KeyType &)> &in_range)
+    -> LSMTREE_ITERATOR_TYPE {
+  return MakeIterator(&key, false, in_range);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::End() -> LSMTREE_ITERATOR_TYPE { return MakeIterator(nullptr, true, nullptr); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::MakeIterator(const KeyType *key, bool at_end, const std::function<bool(const KeyType &)> &in_range)
+    -> LSMTREE_ITERATOR_TYPE {
+  std::vector<Entry> memtable;
+  latch_.RLock();
+  // a bounded scan only copies the entries of the memory table it may reach
+  auto iter = key != nullptr && in_range ? memtable_.lower_bound(*key) : memtable_.begin();
+  for (; iter != memtable_.end() && (!in_range || in_range(iter->first.first)); ++iter) {
+    memtable.push_back({iter->first.first, iter->first.second, iter->second});
+  }
+  auto runs = SnapshotRuns();
+  latch_.RUnlock();
+  return LSMTREE_ITERATOR_TYPE(comparator_, std::move(memtable), std::move(runs), key, at_end);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::SnapshotRuns() -> std::vector<std::shared_ptr<const Run>> {
+  std::vector<std::shared_ptr<const Run>> runs;
+  for (const auto &level : levels_) {
+    runs.insert(runs.end(), level.begin(), level.end());
+  }
+  return runs;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Flush() {
+  latch_.WLock();
+  FlushMemtable();
+  latch_.WUnlock();
+  Compact();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::FlushMemtable() {
+  if (memtable_.empty()) {
+    return;
+  }
+  auto run = std::make_shared<Run>(buffer_pool_manager_, comparator_, hash_fn_, memtable_.size());
+  for (const auto &[entry, tombstone] : memtable_) {
+    run->Append({entry.first, entry.second, tombstone});
+  }
+  run->Seal();
+  if (levels_.empty()) {
+    levels_.emplace_back();
+  }
+  levels_[0].insert(levels_[0].begin(), std::move(run));
+  memtable_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Compact() {
+  std::scoped_lock lock(compaction_latch_);
+  for (size_t level = 0;; level++) {
+    latch_.RLock();
+    if (level == levels_.size()) {
+      latch_.RUnlock();
+      return;
+    }
+    if (levels_[level].size() < fanout_) {
+      latch_.RUnlock();
+      continue;
+    }
+    // flushes only add newer runs to the front of the first level, so the inputs stay at the back of theirs
+    auto inputs = levels_[level];
+    // the merged run is the oldest if no level after this one has runs, and then needs no tombstones
+    bool is_oldest = std::all_of(levels_.begin() + level + 1, levels_.end(),
+                                 [](const auto &older_level) { return older_level.empty(); });
+    latch_.RUnlock();
+
+    size_t max_size = 0;
+    for (const auto &input : inputs) {
+      max_size += input->GetSize();
+    }
+    auto run = std::make_shared<Run>(buffer_pool_manager_, comparator_, hash_fn_, max_size);
+    auto input_count = inputs.size();
+    LSMTREE_ITERATOR_TYPE iter(comparator_, {}, std::move(inputs), nullptr, false, !is_oldest);
+    for (; !iter.IsEnd(); ++iter) {
+      const auto &[key, value] = *iter;
+      run->Append({key, value, !is_oldest && iter.IsTombstone()});
+    }
+    run->Seal();
+
+    latch_.WLock();
+    levels_[level].resize(levels_[level].size() - input_count);
+    if (run->GetSize() > 0) {
+      if (level + 1 == levels_.size()) {
+        levels_.emplace_back();
+      }
+      levels_[level + 1].insert(levels_[level + 1].begin(), std::move(run));
+    }
+    latch_.WUnlock();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::GetLevelSizes() -> std::vector<size_t> {
+  std::vector<size_t> sizes;
+  latch_.RLock();
+  for (const auto &level : levels_) {
+    sizes.push_back(level.size());
+  }
+  latch_.RUnlock();
+  return sizes;
+}
+
+template class LSMRun<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMRun<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMRun<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMRun<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMRun<GenericKey<64>, RID, GenericComparator<64>>;
+template class LSMRun<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class LSMRun<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class LSMRun<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class LSMRun<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class LSMRun<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+template class LSMTreeIterator<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMTreeIterator<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMTreeIterator<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMTreeIterator<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMTreeIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class LSMTreeIterator<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class LSMTreeIterator<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class LSMTreeIterator<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class LSMTreeIterator<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class LSMTreeIterator<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+template class LSMTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class LSMTree<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class LSMTree<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class LSMTree<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class LSMTree<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class LSMTree<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+}  // namespace bustub
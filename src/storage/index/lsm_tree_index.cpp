@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree_index.cpp
+//
+// Identification: src/storage/index/lsm_tree_index.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/lsm_tree_index.h"
+
+#include <functional>
+
+#include "storage/index/index_key.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Cursor over an LSM tree that hides its key type. A bounded cursor ends at the first key out of its range.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMTreeScanIterator : public IndexScanIterator {
+ public:
+  LSMTreeScanIterator(const LSMTREE_INDEX_TYPE *index, LSMTREE_ITERATOR_TYPE &&iter,
+                      std::function<bool(const KeyType &)> in_range)
+      : index_(index), iter_(std::move(iter)), in_range_(std::move(in_range)) {}
+
+  auto IsEnd() -> bool override { return iter_.IsEnd() || (in_range_ && !in_range_((*iter_).first)); }
+
+  auto IsBegin() -> bool override { return iter_.IsBegin(); }
+
+  auto GetRID() -> RID override { return (*iter_).second; }
+
+  auto GetKey() -> Tuple override { return index_->KeyToTuple((*iter_).first); }
+
+  void Next() override { ++iter_; }
+
+  void Prev() override { --iter_; }
+
+ private:
+  const LSMTREE_INDEX_TYPE *index_;
+  LSMTREE_ITERATOR_TYPE iter_;
+  std::function<bool(const KeyType &)> in_range_;
+};
+
+}  // namespace
+
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_INDEX_TYPE::LSMTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                 const HashFunction<KeyType> &hash_fn)
+    : Index(std::move(metadata)),
+      comparator_(GetMetadata()->GetKeySchema()),
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  container_.Insert(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  container_.Remove(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction * /*transaction*/) {
+  container_.GetValue(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), result);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_INDEX_TYPE::GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> {
+  return std::make_unique<LSMTreeScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, from_end ? container_.End() : container_.Begin(), nullptr);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_INDEX_TYPE::GetPrefixIterator(const std::vector<Value> &prefix, Transaction * /*transaction*/)
+    -> std::unique_ptr<IndexScanIterator> {
+  if (prefix.empty()) {
+    return GetScanIterator(false);
+  }
+  KeyType begin_key;
+  auto length = MakeIndexPrefixKey<KeyType, KeyComparator>(prefix, GetKeySchema(), &begin_key);
+  std::function<bool(const KeyType &)> in_range = [begin_key, length, comparator = comparator_](const KeyType &key) {
+    return IndexKeyHasPrefix(key, begin_key, length, comparator);
+  };
+  auto iter = container_.Begin(begin_key, in_range);
+  return std::make_unique<LSMTreeScanIterator<KeyType, ValueType, KeyComparator>>(this, std::move(iter),
+                                                                                  std::move(in_range));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_INDEX_TYPE::KeyToTuple(const KeyType &index_key) const -> Tuple {
+  return IndexKeyToTuple<KeyType, KeyComparator>(index_key, GetKeySchema());
+}
+
+template class LSMTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class LSMTreeIndex<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class LSMTreeIndex<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class LSMTreeIndex<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class LSMTreeIndex<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class LSMTreeIndex<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+}  // namespace bustub
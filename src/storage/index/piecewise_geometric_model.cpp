@@ -0,0 +1,336 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// piecewise_geometric_model.cpp
+//
+// Identification: src/storage/index/piecewise_geometric_model.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/piecewise_geometric_model.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>  // NOLINT
+#include <utility>
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Fit segments to points whose x grow strictly, so that every segment predicts the y of its points off by at most
+ * epsilon. A segment keeps the range of slopes that all its points allow, from its first point, and ends at the
+ * first point that leaves the range empty.
+ */
+auto FitSegments(const std::vector<std::pair<uint64_t, size_t>> &points, double epsilon) -> std::vector<PGMSegment> {
+  std::vector<PGMSegment> segments;
+  size_t i = 0;
+  while (i < points.size()) {
+    auto [x0, y0] = points[i];
+    double low = 0;
+    double high = std::numeric_limits<double>::infinity();
+    size_t j = i + 1;
+    for (; j < points.size(); j++) {
+      auto dx = static_cast<double>(points[j].first - x0);
+      auto dy = static_cast<double>(points[j].second - y0);
+      double new_low = std::max(low, (dy - epsilon) / dx);
+      double new_high = std::min(high, (dy + epsilon) / dx);
+      if (new_low > new_high) {
+        break;
+      }
+      low = new_low;
+      high = new_high;
+    }
+    double slope = j == i + 1 ? 0 : (low + high) / 2;
+    segments.push_back({x0, slope, y0});
+    i = j;
+  }
+  return segments;
+}
+
+/** @return the position that segment predicts for x, within [0, size) */
+auto PredictWith(const PGMSegment &segment, uint64_t x, size_t size) -> size_t {
+  if (x <= segment.key_) {
+    return std::min(segment.position_, size - 1);
+  }
+  double position = static_cast<double>(segment.position_) + segment.slope_ * static_cast<double>(x - segment.key_);
+  if (position <= 0) {
+    return 0;
+  }
+  return std::min(static_cast<size_t>(position), size - 1);
+}
+
+/**
+ * @return the first position in [0, size) at which before is false, searching outwards from guess. before is true
+ * up to some position and false from there on.
+ */
+template <typename Before>
+auto SearchAround(size_t size, size_t guess, Before before) -> size_t {
+  size_t low;
+  size_t high;
+  if (guess < size && before(guess)) {
+    // the answer is past guess, double the step until it is passed
+    low = guess + 1;
+    size_t step = 1;
+    while (low + step - 1 < size && before(low + step - 1)) {
+      low += step;
+      step *= 2;
+    }
+    high = std::min(low + step - 1, size);
+  } else {
+    high = std::min(guess, size);
+    size_t step = 1;
+    while (high >= step && !before(high - step)) {
+      high -= step;
+      step *= 2;
+    }
+    low = high >= step ? high - step + 1 : 0;
+  }
+  // before holds below low and fails from high on
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (before(mid)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+}  // namespace
+
+/*****************************************************************************
+ * SNAPSHOT
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+PGM_SNAPSHOT_TYPE::PiecewiseGeometricModelSnapshot(std::vector<MappingType> &&entries) : entries_(std::move(entries)) {
+  // the lowest level maps the first entry of each model key to its position
+  std::vector<std::pair<uint64_t, size_t>> points;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    auto x = ModelKey(entries_[i].first);
+    if (points.empty() || points.back().first != x) {
+      points.emplace_back(x, i);
+    }
+  }
+  if (points.empty()) {
+    return;
+  }
+  levels_.push_back(FitSegments(points, EPSILON));
+  // every segment but the last covers two points at least, so each level is at most half as large as the one below
+  while (levels_.back().size() > 1) {
+    points.clear();
+    for (size_t i = 0; i < levels_.back().size(); i++) {
+      points.emplace_back(levels_.back()[i].key_, i);
+    }
+    levels_.push_back(FitSegments(points, RECURSIVE_EPSILON));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_SNAPSHOT_TYPE::ModelKey(const KeyType &key) -> uint64_t {
+  const auto *bytes = reinterpret_cast<const uint8_t *>(key.data_);
+  uint64_t x = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    x = (x << 8) | (i < sizeof(KeyType) ? bytes[i] : 0);
+  }
+  return x;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_SNAPSHOT_TYPE::CompareKeys(const KeyType &lhs, const KeyType &rhs) -> int {
+  return memcmp(lhs.data_, rhs.data_, sizeof(KeyType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_SNAPSHOT_TYPE::CompareEntries(const MappingType &lhs, const MappingType &rhs) -> int {
+  auto cmp = CompareKeys(lhs.first, rhs.first);
+  if (cmp != 0) {
+    return cmp;
+  }
+  auto lhs_value = lhs.second.Get();
+  auto rhs_value = rhs.second.Get();
+  return lhs_value < rhs_value ? -1 : (lhs_value > rhs_value ? 1 : 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_SNAPSHOT_TYPE::Predict(uint64_t x) const -> size_t {
+  // walk down from the single segment of the top level, the segment of a level that covers x is the last one whose
+  // key is not above x
+  size_t segment = 0;
+  for (size_t level = levels_.size() - 1; level > 0; level--) {
+    const auto &below = levels_[level - 1];
+    auto guess = PredictWith(levels_[level][segment], x, below.size());
+    auto after = SearchAround(below.size(), guess, [&](size_t i) { return below[i].key_ <= x; });
+    segment = after == 0 ? 0 : after - 1;
+  }
+  return PredictWith(levels_[0][segment], x, entries_.size());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_SNAPSHOT_TYPE::LowerBound(const KeyType &key) const -> size_t {
+  if (entries_.empty()) {
+    return 0;
+  }
+  return SearchAround(entries_.size(), Predict(ModelKey(key)),
+                      [&](size_t i) { return CompareKeys(entries_[i].first, key) < 0; });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_SNAPSHOT_TYPE::LowerBound(const MappingType &entry) const -> size_t {
+  if (entries_.empty()) {
+    return 0;
+  }
+  return SearchAround(entries_.size(), Predict(ModelKey(entry.first)),
+                      [&](size_t i) { return CompareEntries(entries_[i], entry) < 0; });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_SNAPSHOT_TYPE::GetMemoryUsage() const -> size_t {
+  size_t bytes = sizeof(*this) + entries_.capacity() * sizeof(MappingType);
+  for (const auto &level : levels_) {
+    bytes += level.capacity() * sizeof(PGMSegment);
+  }
+  return bytes;
+}
+
+/*****************************************************************************
+ * MODEL
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+PGM_TYPE::PiecewiseGeometricModel() : snapshot_(std::make_shared<PGM_SNAPSHOT_TYPE>(std::vector<MappingType>{})) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_TYPE::InSnapshot(const MappingType &entry) const -> bool {
+  auto position = snapshot_->LowerBound(entry);
+  return position < snapshot_->Size() && PGM_SNAPSHOT_TYPE::CompareEntries(snapshot_->At(position), entry) == 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_TYPE::Insert(const KeyType &key, const ValueType &value) -> bool {
+  std::unique_lock lock(latch_);
+  MappingType entry{key, value};
+  if (removed_.erase(entry) == 0) {
+    if (InSnapshot(entry) || !inserted_.insert(entry).second) {
+      return false;
+    }
+  }
+  MaybeMerge();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_TYPE::Remove(const KeyType &key, const ValueType &value) -> bool {
+  std::unique_lock lock(latch_);
+  MappingType entry{key, value};
+  if (inserted_.erase(entry) == 0) {
+    if (!InSnapshot(entry) || !removed_.insert(entry).second) {
+      return false;
+    }
+  }
+  MaybeMerge();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) -> bool {
+  std::shared_lock lock(latch_);
+  auto size = result->size();
+  for (auto position = snapshot_->LowerBound(key);
+       position < snapshot_->Size() && PGM_SNAPSHOT_TYPE::CompareKeys(snapshot_->At(position).first, key) == 0;
+       position++) {
+    if (removed_.empty() || removed_.count(snapshot_->At(position)) == 0) {
+      result->push_back(snapshot_->At(position).second);
+    }
+  }
+  // the inserted entries of key come after every entry of a smaller key
+  for (auto iter = inserted_.lower_bound({key, ValueType{}});
+       iter != inserted_.end() && PGM_SNAPSHOT_TYPE::CompareKeys(iter->first, key) == 0; ++iter) {
+    result->push_back(iter->second);
+  }
+  return result->size() > size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void PGM_TYPE::BulkLoad(std::vector<MappingType> &&entries) {
+  std::sort(entries.begin(), entries.end(), EntryLess());
+  entries.erase(std::unique(entries.begin(), entries.end(),
+                            [](const auto &lhs, const auto &rhs) {
+                              return PGM_SNAPSHOT_TYPE::CompareEntries(lhs, rhs) == 0;
+                            }),
+                entries.end());
+  std::unique_lock lock(latch_);
+  snapshot_ = std::make_shared<PGM_SNAPSHOT_TYPE>(std::move(entries));
+  inserted_.clear();
+  removed_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_TYPE::GetSnapshot() -> std::shared_ptr<const PGM_SNAPSHOT_TYPE> {
+  {
+    std::shared_lock lock(latch_);
+    if (inserted_.empty() && removed_.empty()) {
+      return snapshot_;
+    }
+  }
+  std::unique_lock lock(latch_);
+  Merge();
+  return snapshot_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_TYPE::GetMemoryUsage() -> size_t {
+  std::shared_lock lock(latch_);
+  // a node of a red-black tree holds the entry, three pointers and its color
+  constexpr size_t set_node_size = sizeof(MappingType) + 4 * sizeof(void *);
+  return snapshot_->GetMemoryUsage() + (inserted_.size() + removed_.size()) * set_node_size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void PGM_TYPE::Merge() {
+  if (inserted_.empty() && removed_.empty()) {
+    return;
+  }
+  std::vector<MappingType> entries;
+  entries.reserve(snapshot_->Size() + inserted_.size() - removed_.size());
+  auto inserted = inserted_.begin();
+  for (size_t position = 0; position < snapshot_->Size(); position++) {
+    const auto &entry = snapshot_->At(position);
+    for (; inserted != inserted_.end() && PGM_SNAPSHOT_TYPE::CompareEntries(*inserted, entry) < 0; ++inserted) {
+      entries.push_back(*inserted);
+    }
+    if (removed_.count(entry) == 0) {
+      entries.push_back(entry);
+    }
+  }
+  entries.insert(entries.end(), inserted, inserted_.end());
+  snapshot_ = std::make_shared<PGM_SNAPSHOT_TYPE>(std::move(entries));
+  inserted_.clear();
+  removed_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void PGM_TYPE::MaybeMerge() {
+  if (inserted_.size() + removed_.size() > std::max(MERGE_MIN, snapshot_->Size() / MERGE_RATIO)) {
+    Merge();
+  }
+}
+
+template class PiecewiseGeometricModelSnapshot<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class PiecewiseGeometricModelSnapshot<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class PiecewiseGeometricModelSnapshot<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class PiecewiseGeometricModelSnapshot<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class PiecewiseGeometricModelSnapshot<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+template class PiecewiseGeometricModel<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class PiecewiseGeometricModel<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class PiecewiseGeometricModel<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class PiecewiseGeometricModel<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class PiecewiseGeometricModel<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+}  // namespace bustub
@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// piecewise_geometric_model_index.cpp
+//
+// Identification: src/storage/index/piecewise_geometric_model_index.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/piecewise_geometric_model_index.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "storage/index/index_key.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Cursor over a snapshot of a piecewise geometric model that hides its key type.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class PiecewiseGeometricModelScanIterator : public IndexScanIterator {
+ public:
+  PiecewiseGeometricModelScanIterator(const PGM_INDEX_TYPE *index, PGM_ITERATOR_TYPE &&iter)
+      : index_(index), iter_(std::move(iter)) {}
+
+  auto IsEnd() -> bool override { return iter_.IsEnd(); }
+
+  auto IsBegin() -> bool override { return iter_.IsBegin(); }
+
+  auto GetRID() -> RID override { return (*iter_).second; }
+
+  auto GetKey() -> Tuple override { return index_->KeyToTuple((*iter_).first); }
+
+  void Next() override { ++iter_; }
+
+  void Prev() override { --iter_; }
+
+ private:
+  const PGM_INDEX_TYPE *index_;
+  PGM_ITERATOR_TYPE iter_;
+};
+
+}  // namespace
+
+INDEX_TEMPLATE_ARGUMENTS
+PGM_INDEX_TYPE::PiecewiseGeometricModelIndex(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void PGM_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  container_.Insert(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void PGM_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  container_.Remove(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void PGM_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction * /*transaction*/) {
+  container_.GetValue(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), result);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_INDEX_TYPE::GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> {
+  auto snapshot = container_.GetSnapshot();
+  auto size = snapshot->Size();
+  return std::make_unique<PiecewiseGeometricModelScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, PGM_ITERATOR_TYPE(std::move(snapshot), 0, size, from_end ? size : 0));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_INDEX_TYPE::GetPrefixIterator(const std::vector<Value> &prefix, Transaction * /*transaction*/)
+    -> std::unique_ptr<IndexScanIterator> {
+  if (prefix.empty()) {
+    return GetScanIterator(false);
+  }
+  // the keys that start with the encoding of the prefix lie between the encoding and the encoding plus one
+  auto snapshot = container_.GetSnapshot();
+  KeyType key;
+  auto length = MakeIndexPrefixKey<KeyType, KeyComparator>(prefix, GetKeySchema(), &key);
+  auto begin = snapshot->LowerBound(key);
+  auto *bytes = reinterpret_cast<uint8_t *>(key.data_);
+  while (length > 0 && bytes[length - 1] == 0xFF) {
+    bytes[--length] = 0;
+  }
+  size_t end = snapshot->Size();
+  if (length > 0) {
+    bytes[length - 1]++;
+    end = snapshot->LowerBound(key);
+  }
+  return std::make_unique<PiecewiseGeometricModelScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, PGM_ITERATOR_TYPE(std::move(snapshot), begin, end, begin));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_INDEX_TYPE::CountRange(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                                Transaction * /*transaction*/) -> size_t {
+  auto snapshot = container_.GetSnapshot();
+  auto [begin, end] = RangePositions(*snapshot, lower, upper);
+  return end - begin;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_INDEX_TYPE::GetRankIterator(size_t rank, Transaction * /*transaction*/)
+    -> std::unique_ptr<IndexScanIterator> {
+  auto snapshot = container_.GetSnapshot();
+  auto size = snapshot->Size();
+  return std::make_unique<PiecewiseGeometricModelScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, PGM_ITERATOR_TYPE(std::move(snapshot), 0, size, std::min(rank, size)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_INDEX_TYPE::GetRangeIterator(const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper,
+                                      Transaction * /*transaction*/) -> std::unique_ptr<IndexScanIterator> {
+  auto snapshot = container_.GetSnapshot();
+  auto [begin, end] = RangePositions(*snapshot, lower, upper);
+  return std::make_unique<PiecewiseGeometricModelScanIterator<KeyType, ValueType, KeyComparator>>(
+      this, PGM_ITERATOR_TYPE(std::move(snapshot), begin, end, begin));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_INDEX_TYPE::RangePositions(const PGM_SNAPSHOT_TYPE &snapshot, const std::optional<IndexBound> &lower,
+                                    const std::optional<IndexBound> &upper) const -> std::pair<size_t, size_t> {
+  if (!lower.has_value() && !upper.has_value()) {
+    return {0, snapshot.Size()};
+  }
+  // NULL is the smallest value of every type, a range without a lower end starts past it
+  auto null = ValueFactory::GetNullValueByType(GetKeySchema()->GetColumn(0).GetType());
+  auto begin = lower.has_value() ? BoundPosition(snapshot, *lower, !lower->inclusive_)
+                                 : BoundPosition(snapshot, {null, false}, true);
+  auto end = upper.has_value() ? BoundPosition(snapshot, *upper, upper->inclusive_) : snapshot.Size();
+  return {begin, std::max(begin, end)};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_INDEX_TYPE::BoundPosition(const PGM_SNAPSHOT_TYPE &snapshot, const IndexBound &bound, bool after) const
+    -> size_t {
+  KeyType key;
+  auto length = MakeIndexPrefixKey<KeyType, KeyComparator>({bound.value_}, GetKeySchema(), &key);
+  if (after) {
+    // the first key past every key that starts with the encoding is the encoding plus one, in byte order
+    auto *bytes = reinterpret_cast<uint8_t *>(key.data_);
+    while (length > 0 && bytes[length - 1] == 0xFF) {
+      bytes[--length] = 0;
+    }
+    if (length == 0) {
+      return snapshot.Size();
+    }
+    bytes[length - 1]++;
+  }
+  return snapshot.LowerBound(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void PGM_INDEX_TYPE::Rebuild(TableHeap *table_heap, const Schema &tuple_schema, const AbstractExpression *predicate,
+                             Transaction *transaction) {
+  std::vector<MappingType> entries;
+  for (auto tuple = table_heap->Begin(transaction); tuple != table_heap->End(); ++tuple) {
+    if (!SatisfiesPredicate(predicate, *tuple, tuple_schema)) {
+      continue;
+    }
+    auto key = tuple->KeyFromTuple(tuple_schema, *GetKeySchema(), GetKeyAttrs());
+    entries.emplace_back(MakeIndexKey<KeyType, KeyComparator>(key, *GetKeySchema()), tuple->GetRid());
+  }
+  container_.BulkLoad(std::move(entries));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto PGM_INDEX_TYPE::KeyToTuple(const KeyType &index_key) const -> Tuple {
+  return IndexKeyToTuple<KeyType, KeyComparator>(index_key, GetKeySchema());
+}
+
+template class PiecewiseGeometricModelIndex<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class PiecewiseGeometricModelIndex<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class PiecewiseGeometricModelIndex<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class PiecewiseGeometricModelIndex<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class PiecewiseGeometricModelIndex<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+}  // namespace bustub
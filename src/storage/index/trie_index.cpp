@@ -0,0 +1,253 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_index.cpp
+//
+// Identification: src/storage/index/trie_index.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/trie_index.h"
+
+#include <algorithm>
+
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** The first byte of the key of a NULL, and of any other string, so that NULLs come first. */
+constexpr char NULL_TAG = '\x00';
+constexpr char STRING_TAG = '\x01';
+
+/**
+ * Cursor over the entries of a trie index whose keys start with a prefix, or
+ * whose key is the prefix if exact.
+ *
+ * Like the cursor of an adaptive radix tree, it holds no node of the trie: it
+ * copies the entries of up to BATCH_SIZE keys at a time, and reads the next
+ * ones after the last key it has.
+ */
+class TrieScanIterator : public IndexScanIterator {
+ public:
+  TrieScanIterator(const TrieIndex *index, Trie *trie, std::string prefix, bool exact, bool from_end)
+      : index_(index), trie_(trie), prefix_(std::move(prefix)), exact_(exact) {
+    if (!from_end) {
+      Read(nullptr, true, &batch_);
+    }
+  }
+
+  auto IsEnd() -> bool override { return index_in_batch_ == batch_.size(); }
+
+  auto IsBegin() -> bool override {
+    if (index_in_batch_ > 0) {
+      return false;
+    }
+    std::vector<std::pair<std::string, RID>> before;
+    Read(batch_.empty() ? nullptr : &batch_.front().first, false, &before);
+    return before.empty();
+  }
+
+  auto GetRID() -> RID override { return batch_[index_in_batch_].second; }
+
+  auto GetKey() -> Tuple override { return index_->KeyToTuple(batch_[index_in_batch_].first); }
+
+  void Next() override {
+    index_in_batch_++;
+    if (index_in_batch_ == batch_.size()) {
+      // past the last entry the cursor stays on the batch, so that it can step back
+      std::vector<std::pair<std::string, RID>> next;
+      Read(&batch_.back().first, true, &next);
+      if (!next.empty()) {
+        batch_ = std::move(next);
+        index_in_batch_ = 0;
+      }
+    }
+  }
+
+  void Prev() override {
+    if (index_in_batch_ > 0) {
+      index_in_batch_--;
+      return;
+    }
+    std::vector<std::pair<std::string, RID>> prev;
+    Read(batch_.empty() ? nullptr : &batch_.front().first, false, &prev);
+    if (!prev.empty()) {
+      batch_ = std::move(prev);
+      index_in_batch_ = batch_.size() - 1;
+    }
+  }
+
+  /** The number of keys the cursor copies the entries of at a time. */
+  static constexpr size_t BATCH_SIZE = 64;
+
+ private:
+  /** Read the entries of the keys after bound, or before it if not forward, sorted in key order. */
+  void Read(const std::string *bound, bool forward, std::vector<std::pair<std::string, RID>> *out) {
+    if (exact_) {
+      // the entries of a single key are read at once, none come before or after them
+      bool found;
+      auto list = trie_->GetValue<std::shared_ptr<TrieIndex::RIDList>>(prefix_, &found);
+      if (found && bound == nullptr) {
+        std::scoped_lock lock(list->latch_);
+        for (auto rid : list->rids_) {
+          out->emplace_back(prefix_, rid);
+        }
+      }
+      return;
+    }
+    std::string last;
+    std::vector<TrieIndex::Entry> entries;
+    // keys whose lists were all emptied meanwhile are skipped
+    while (out->empty()) {
+      entries.clear();
+      if (forward) {
+        trie_->ScanForward(prefix_, bound, BATCH_SIZE, &entries);
+      } else {
+        trie_->ScanBackward(prefix_, bound, BATCH_SIZE, &entries);
+        std::reverse(entries.begin(), entries.end());
+      }
+      for (const auto &[key, list] : entries) {
+        std::scoped_lock lock(list->latch_);
+        for (auto rid : list->rids_) {
+          out->emplace_back(key, rid);
+        }
+      }
+      if (entries.size() < BATCH_SIZE) {
+        break;
+      }
+      last = forward ? entries.back().first : entries.front().first;
+      bound = &last;
+    }
+  }
+
+  const TrieIndex *index_;
+  Trie *trie_;
+  std::string prefix_;
+  bool exact_;
+  std::vector<std::pair<std::string, RID>> batch_;
+  size_t index_in_batch_{0};
+};
+
+}  // namespace
+
+TrieIndex::TrieIndex(std::unique_ptr<IndexMetadata> &&metadata)
+    : Index(std::move(metadata)), trie_(std::make_unique<Trie>()) {
+  const auto &columns = GetKeySchema()->GetColumns();
+  if (columns.size() != 1 || columns[0].GetType() != TypeId::VARCHAR) {
+    throw NotImplementedException("a trie index needs a single varchar key column");
+  }
+}
+
+auto TrieIndex::EncodeKey(const Value &value) -> std::string {
+  if (value.IsNull()) {
+    return std::string(1, NULL_TAG);
+  }
+  std::string key(1, STRING_TAG);
+  // the length of a varchar counts its terminator
+  key.append(value.GetData(), value.GetLength() - 1);
+  return key;
+}
+
+auto TrieIndex::KeyToTuple(const std::string &key) const -> Tuple {
+  std::vector<Value> values;
+  if (key[0] == NULL_TAG) {
+    values.emplace_back(TypeId::VARCHAR, nullptr, 0, false);
+  } else {
+    values.emplace_back(ValueFactory::GetVarcharValue(key.substr(1)));
+  }
+  return Tuple(values, GetKeySchema());
+}
+
+void TrieIndex::InsertEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  auto trie_key = EncodeKey(key.GetValue(GetKeySchema(), 0));
+  while (true) {
+    bool found;
+    auto list = trie_->GetValue<std::shared_ptr<RIDList>>(trie_key, &found);
+    if (!found) {
+      list = std::make_shared<RIDList>();
+      list->rids_.push_back(rid);
+      if (trie_->Insert(trie_key, list)) {
+        return;
+      }
+      continue;
+    }
+    std::scoped_lock lock(list->latch_);
+    if (list->removed_) {
+      // the list is on its way out of the trie
+      continue;
+    }
+    if (std::find(list->rids_.begin(), list->rids_.end(), rid) == list->rids_.end()) {
+      list->rids_.push_back(rid);
+    }
+    return;
+  }
+}
+
+void TrieIndex::DeleteEntry(const Tuple &key, RID rid, Transaction * /*transaction*/) {
+  auto trie_key = EncodeKey(key.GetValue(GetKeySchema(), 0));
+  bool found;
+  auto list = trie_->GetValue<std::shared_ptr<RIDList>>(trie_key, &found);
+  if (!found) {
+    return;
+  }
+  {
+    std::scoped_lock lock(list->latch_);
+    auto pos = std::find(list->rids_.begin(), list->rids_.end(), rid);
+    if (list->removed_ || pos == list->rids_.end()) {
+      return;
+    }
+    list->rids_.erase(pos);
+    if (!list->rids_.empty()) {
+      return;
+    }
+    list->removed_ = true;
+  }
+  trie_->Remove(trie_key);
+}
+
+void TrieIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction * /*transaction*/) {
+  bool found;
+  auto list = trie_->GetValue<std::shared_ptr<RIDList>>(EncodeKey(key.GetValue(GetKeySchema(), 0)), &found);
+  if (found) {
+    std::scoped_lock lock(list->latch_);
+    result->insert(result->end(), list->rids_.begin(), list->rids_.end());
+  }
+}
+
+void TrieIndex::ScanStringPrefix(const std::string &prefix, std::vector<RID> *result) {
+  for (TrieScanIterator iter(this, trie_.get(), STRING_TAG + prefix, false, false); !iter.IsEnd(); iter.Next()) {
+    result->push_back(iter.GetRID());
+  }
+}
+
+auto TrieIndex::GetScanIterator(bool from_end) -> std::unique_ptr<IndexScanIterator> {
+  return std::make_unique<TrieScanIterator>(this, trie_.get(), "", false, from_end);
+}
+
+auto TrieIndex::GetPrefixIterator(const std::vector<Value> &prefix, Transaction * /*transaction*/)
+    -> std::unique_ptr<IndexScanIterator> {
+  if (prefix.empty()) {
+    return GetScanIterator(false);
+  }
+  // the key has a single column, so the prefix is a whole key
+  return std::make_unique<TrieScanIterator>(this, trie_.get(), EncodeKey(prefix[0]), true, false);
+}
+
+void TrieIndex::Rebuild(TableHeap *table_heap, const Schema &tuple_schema, const AbstractExpression *predicate,
+                        Transaction *transaction) {
+  trie_ = std::make_unique<Trie>();
+  for (auto tuple = table_heap->Begin(transaction); tuple != table_heap->End(); ++tuple) {
+    if (!SatisfiesPredicate(predicate, *tuple, tuple_schema)) {
+      continue;
+    }
+    InsertEntry(tuple->KeyFromTuple(tuple_schema, *GetKeySchema(), GetKeyAttrs()), tuple->GetRid(), transaction);
+  }
+}
+
+}  // namespace bustub
@@ -9,11 +9,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <sstream>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -26,13 +29,33 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool with_counts) {
   SetPageId(page_id);
   SetParentPageId(parent_id);
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetMaxSize(max_size);
   SetSize(0);
   SetLSN(INVALID_LSN);
+  // a page overflows by one pair before it splits, so there is a count for that pair too
+  counts_offset_ = with_counts ? BUSTUB_PAGE_SIZE - (max_size + 1) * sizeof(uint32_t) : 0;
+  if constexpr (IsCompressedKey<KeyType>()) {
+    Store()->Init(with_counts ? counts_offset_ - INTERNAL_PAGE_HEADER_SIZE : INTERNAL_PAGE_DATA_SIZE);
+  }
+}
+
+/*
+ * The pairs of a page with subtree counts share the page with max size + 1
+ * counts, and the page holds max size + 1 pairs before it splits.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CountedCapacity() -> int {
+  int capacity = INTERNAL_PAGE_SIZE;
+  while (capacity > 0 &&
+         BPlusTreeSlotCapacity<KeyType, ValueType>(INTERNAL_PAGE_DATA_SIZE - (capacity + 1) * sizeof(uint32_t)) <
+             capacity + 1) {
+    capacity--;
+  }
+  return capacity;
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
@@ -44,7 +67,11 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
     LOG_DEBUG("KeyAt: index %d out of range %d", index, this->GetSize() - 1);
   }
   // key where index 0 is invild
-  return array_[index].first;
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return Store()->KeyAt(index);
+  } else {
+    return array_[index].first;
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -52,7 +79,14 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
   if (index < 0 || index > this->GetSize()) {
     LOG_DEBUG("SetKeyAt: index %d out of range %d", index, this->GetSize());
   }
-  array_[index].first = key;
+  if constexpr (IsCompressedKey<KeyType>()) {
+    // the new key may need a different number of bytes, so the entry is written again
+    auto value = Store()->ValueAt(index);
+    Store()->Remove(index, this->GetSize());
+    Store()->Insert(index, this->GetSize() - 1, key, value);
+  } else {
+    array_[index].first = key;
+  }
 }
 
 /*
@@ -64,7 +98,25 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   if (index < 0 || index > this->GetSize()) {
     LOG_DEBUG("ValueAt: index %d out of range %d", index, this->GetSize());
   }
-  return array_[index].second;
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return Store()->ValueAt(index);
+  } else {
+    return array_[index].second;
+  }
+}
+
+/*
+ * Helper method to find the array index of the child pointer equal to input
+ * "value", -1 if the page has no such child
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -72,7 +124,11 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &valu
   if (index < 0 || index > this->GetSize()) {
     LOG_DEBUG("SetValueAt: index %d out of range %d", index, this->GetSize());
   }
-  array_[index].second = value;
+  if constexpr (IsCompressedKey<KeyType>()) {
+    Store()->SetValueAt(index, value);
+  } else {
+    array_[index].second = value;
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -80,10 +136,19 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetPairAt(int index, const MappingType &pai
   if (index < 0 || index > this->GetSize()) {
     return false;
   }
-  for (int i = this->GetSize(); i > index; i--) {
-    array_[i] = array_[i - 1];
+  if constexpr (IsCompressedKey<KeyType>()) {
+    Store()->Insert(index, this->GetSize(), pair.first, pair.second);
+  } else {
+    for (int i = this->GetSize(); i > index; i--) {
+      array_[i] = array_[i - 1];
+    }
+    array_[index] = pair;
+  }
+  if (HasChildCounts()) {
+    auto *counts = Counts();
+    std::copy_backward(counts + index, counts + GetSize(), counts + GetSize() + 1);
+    counts[index] = 0;
   }
-  array_[index] = pair;
   this->IncreaseSize(1);
   return true;
 }
@@ -92,9 +157,16 @@ INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::DeletePair(const KeyType &key, KeyComparator &comparator) -> bool {
   // array_[0] is invalid key , pointer
   for (int i = 0; i < this->GetSize(); i++) {
-    if (comparator(array_[i].first, key) == 0) {
-      for (int j = i; j < this->GetSize() - 1; j++) {
-        array_[j] = array_[j + 1];
+    if (comparator(KeyAt(i), key) == 0) {
+      if constexpr (IsCompressedKey<KeyType>()) {
+        Store()->Remove(i, this->GetSize());
+      } else {
+        for (int j = i; j < this->GetSize() - 1; j++) {
+          array_[j] = array_[j + 1];
+        }
+      }
+      if (HasChildCounts()) {
+        std::copy(Counts() + i + 1, Counts() + GetSize(), Counts() + i);
       }
       this->IncreaseSize(-1);
       return true;
@@ -114,10 +186,133 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::ReplaceKey(const KeyType &old_key, const Ke
   }
 }
 
+/*
+ * Whether any key can be replaced by new_key and still leave room for the
+ * insert that may split this page. Always true for fixed layout pages.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanReplaceKey(const KeyType &new_key) const -> bool {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    // at worst the new key shares nothing with the prefix while the old one did
+    auto growth = KeyStore::TrimmedLength(new_key);
+    return Store()->FreeSpace(GetSize()) >= KeyStore::MAX_ENTRY_SIZE + growth;
+  } else {
+    return true;
+  }
+}
+
+/*****************************************************************************
+ * SPACE MANAGEMENT
+ *****************************************************************************/
+/*
+ * Same rules as the leaf pages, see BPlusTreeLeafPage::IsSpaceLow.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSpaceLow() const -> bool {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return Store()->FreeSpace(GetSize()) < 2 * KeyStore::MAX_ENTRY_SIZE;
+  } else {
+    return false;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderflow() const -> bool {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return GetSize() < GetMinSize() && Store()->UsedSpace(GetSize()) * 2 < Store()->DataSize();
+  } else {
+    return GetSize() < GetMinSize();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSafeToRemove() const -> bool {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return GetSize() > GetMinSize() ||
+           Store()->UsedSpace(GetSize()) * 2 >= Store()->DataSize() + 2 * KeyStore::MAX_ENTRY_SIZE;
+  } else {
+    return GetSize() > GetMinSize();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMergeWith(const BPlusTreeInternalPage *other) const -> bool {
+  bool size_fits = GetSize() + other->GetSize() <= GetMaxSize();
+  if constexpr (IsCompressedKey<KeyType>()) {
+    // the moved keys may lose their prefix, and the separator pulled down from
+    // the parent replaces the invalid first key, so count them at full length
+    auto limit = Store()->DataSize() - 2 * KeyStore::MAX_ENTRY_SIZE;
+    return size_fits && Store()->UsedSpace(GetSize()) + other->Store()->RawSpace(other->GetSize()) <= limit &&
+           other->Store()->UsedSpace(other->GetSize()) + Store()->RawSpace(GetSize()) <= limit;
+  } else {
+    return size_fits;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SplitIndex() const -> int {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return Store()->SplitIndex(GetSize());
+  } else {
+    return GetSize() / 2;
+  }
+}
+
+/*
+ * Append the pairs from begin to the end of this page to recipient, the
+ * caller takes care of the parent page id of the moved children
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveRangeTo(int begin, BPlusTreeInternalPage *recipient) {
+  int recipient_size = recipient->GetSize();
+  if constexpr (IsCompressedKey<KeyType>()) {
+    Store()->MoveRangeTo(begin, GetSize(), recipient->Store(), recipient->GetSize());
+    recipient->IncreaseSize(GetSize() - begin);
+  } else {
+    for (int i = begin; i < GetSize(); i++) {
+      recipient->SetPairAt(recipient->GetSize(), array_[i]);
+    }
+  }
+  if (HasChildCounts()) {
+    std::copy(Counts() + begin, Counts() + GetSize(), recipient->Counts() + recipient_size);
+  }
+  SetSize(begin);
+}
+
+/*****************************************************************************
+ * SUBTREE COUNTS
+ *****************************************************************************/
+/*
+ * The number of values in the subtree of the child at index
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ChildCountAt(int index) const -> uint32_t {
+  BUSTUB_ASSERT(HasChildCounts(), "page has no subtree counts");
+  return Counts()[index];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetChildCountAt(int index, uint32_t count) {
+  BUSTUB_ASSERT(HasChildCounts(), "page has no subtree counts");
+  Counts()[index] = count;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::TotalCount() const -> size_t {
+  BUSTUB_ASSERT(HasChildCounts(), "page has no subtree counts");
+  return std::accumulate(Counts(), Counts() + GetSize(), static_cast<size_t>(0));
+}
+
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
 template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, MemcmpComparator<4>>;
+template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, MemcmpComparator<8>>;
+template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, MemcmpComparator<16>>;
+template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, MemcmpComparator<32>>;
+template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, MemcmpComparator<64>>;
 }  // namespace bustub
@@ -0,0 +1,277 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_key_store.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_key_store.h"
+
+namespace bustub {
+
+#define KEY_STORE_TYPE BPlusTreeKeyStore<KeyType, ValueType>
+#define KEY_STORE_TEMPLATE_ARGUMENTS template <typename KeyType, typename ValueType>
+
+namespace {
+
+template <typename KeyType>
+auto KeyBytes(const KeyType &key) -> const char * {
+  return reinterpret_cast<const char *>(&key);
+}
+
+/** @return the number of leading bytes lhs and rhs have in common */
+template <typename KeyType>
+auto CommonLength(const KeyType &lhs, const KeyType &rhs) -> size_t {
+  size_t len = 0;
+  while (len < sizeof(KeyType) && KeyBytes(lhs)[len] == KeyBytes(rhs)[len]) {
+    len++;
+  }
+  return len;
+}
+
+}  // namespace
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+void KEY_STORE_TYPE::Init(size_t data_size) {
+  static_assert(HEADER_SIZE % alignof(Slot) == 0, "slots must be aligned");
+  static_assert(sizeof(KeyType) < PREFIXED_FLAG, "key length must fit the slot length field");
+  data_size_ = static_cast<uint16_t>(data_size);
+  heap_begin_ = data_size_;
+  dead_bytes_ = 0;
+  prefix_offset_ = data_size_;
+  prefix_length_ = 0;
+  reserved_ = 0;
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+auto KEY_STORE_TYPE::TrimmedLength(const KeyType &key) -> size_t {
+  size_t len = sizeof(KeyType);
+  while (len > 0 && KeyBytes(key)[len - 1] == 0) {
+    len--;
+  }
+  return len;
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+auto KEY_STORE_TYPE::ShortestSeparator(const KeyType &lhs, const KeyType &rhs) -> KeyType {
+  size_t len = std::min(CommonLength(lhs, rhs) + 1, sizeof(KeyType));
+  KeyType separator;
+  memset(&separator, 0, sizeof(KeyType));
+  memcpy(&separator, &rhs, len);
+  return separator;
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+auto KEY_STORE_TYPE::KeyAt(int index) const -> KeyType {
+  const auto &slot = Slots()[index];
+  auto len = slot.length_ & ~PREFIXED_FLAG;
+  KeyType key;
+  memset(&key, 0, sizeof(KeyType));
+  auto *dst = reinterpret_cast<char *>(&key);
+  if ((slot.length_ & PREFIXED_FLAG) != 0) {
+    memcpy(dst, Bytes() + prefix_offset_, prefix_length_);
+    dst += prefix_length_;
+  }
+  memcpy(dst, Bytes() + slot.offset_, len);
+  return key;
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+auto KEY_STORE_TYPE::ValueAt(int index) const -> ValueType {
+  return Slots()[index].value_;
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+void KEY_STORE_TYPE::SetValueAt(int index, const ValueType &value) {
+  Slots()[index].value_ = value;
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+auto KEY_STORE_TYPE::UsedSpace(int size) const -> size_t {
+  return HEADER_SIZE + size * sizeof(Slot) + (data_size_ - heap_begin_) - dead_bytes_;
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+auto KEY_STORE_TYPE::RawSpace(int size) const -> size_t {
+  size_t raw = 0;
+  for (int i = 0; i < size; i++) {
+    raw += sizeof(Slot) + TrimmedLength(KeyAt(i));
+  }
+  return raw;
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+auto KEY_STORE_TYPE::SplitIndex(int size) const -> int {
+  size_t total = 0;
+  for (int i = 0; i < size; i++) {
+    total += sizeof(Slot) + (Slots()[i].length_ & ~PREFIXED_FLAG);
+  }
+  size_t left = 0;
+  int index = 0;
+  while (index < size && left * 2 < total) {
+    left += sizeof(Slot) + (Slots()[index].length_ & ~PREFIXED_FLAG);
+    index++;
+  }
+  return std::clamp(index, 1, std::max(size - 1, 1));
+}
+
+/*****************************************************************************
+ * ENTRY MODIFICATION
+ *****************************************************************************/
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+auto KEY_STORE_TYPE::StoredLength(const KeyType &key) const -> uint16_t {
+  auto len = TrimmedLength(key);
+  if (prefix_length_ > 0 && memcmp(KeyBytes(key), Bytes() + prefix_offset_, prefix_length_) == 0) {
+    return static_cast<uint16_t>(std::max<size_t>(len, prefix_length_) - prefix_length_) | PREFIXED_FLAG;
+  }
+  return static_cast<uint16_t>(len);
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+auto KEY_STORE_TYPE::PushKey(const KeyType &key) -> uint16_t {
+  auto length = StoredLength(key);
+  auto len = length & ~PREFIXED_FLAG;
+  auto skip = (length & PREFIXED_FLAG) != 0 ? prefix_length_ : 0;
+  heap_begin_ -= len;
+  memcpy(Bytes() + heap_begin_, KeyBytes(key) + skip, len);
+  return length;
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+void KEY_STORE_TYPE::Insert(int index, int size, const KeyType &key, const ValueType &value) {
+  auto need = [&]() { return sizeof(Slot) + (StoredLength(key) & ~PREFIXED_FLAG); };
+  auto contiguous = [&]() -> size_t { return heap_begin_ - HEADER_SIZE - size * sizeof(Slot); };
+  if (contiguous() < need()) {
+    Compact(size);
+    if (contiguous() < need()) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "b+ tree page has no room for the key");
+    }
+  }
+  auto *slots = Slots();
+  memmove(slots + index + 1, slots + index, (size - index) * sizeof(Slot));
+  auto length = PushKey(key);
+  slots[index] = {value, heap_begin_, length};
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+void KEY_STORE_TYPE::Remove(int index, int size) {
+  auto *slots = Slots();
+  dead_bytes_ += slots[index].length_ & ~PREFIXED_FLAG;
+  memmove(slots + index, slots + index + 1, (size - index - 1) * sizeof(Slot));
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+void KEY_STORE_TYPE::MoveRangeTo(int begin, int size, BPlusTreeKeyStore *recipient, int recipient_size) {
+  if (recipient_size == 0) {
+    // A split: the moved keys keep the prefix they already share, so they fit the empty recipient as they are.
+    recipient->heap_begin_ = recipient->data_size_ - prefix_length_;
+    recipient->dead_bytes_ = 0;
+    memcpy(recipient->Bytes() + recipient->heap_begin_, Bytes() + prefix_offset_, prefix_length_);
+    recipient->prefix_offset_ = recipient->heap_begin_;
+    recipient->prefix_length_ = prefix_length_;
+    for (int i = begin; i < size; i++) {
+      const auto &slot = Slots()[i];
+      auto len = slot.length_ & ~PREFIXED_FLAG;
+      recipient->heap_begin_ -= len;
+      memcpy(recipient->Bytes() + recipient->heap_begin_, Bytes() + slot.offset_, len);
+      recipient->Slots()[i - begin] = {slot.value_, recipient->heap_begin_, slot.length_};
+    }
+  } else {
+    for (int i = begin; i < size; i++) {
+      recipient->Insert(recipient_size + i - begin, recipient_size + i - begin, KeyAt(i), ValueAt(i));
+    }
+  }
+  recipient->Compact(recipient_size + size - begin);
+  Compact(begin);
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+void KEY_STORE_TYPE::Rebuild(const KeyType *keys, const ValueType *values, int size, const KeyType &prefix_key,
+                             size_t prefix_length) {
+  heap_begin_ = data_size_;
+  dead_bytes_ = 0;
+  heap_begin_ -= prefix_length;
+  memcpy(Bytes() + heap_begin_, KeyBytes(prefix_key), prefix_length);
+  prefix_offset_ = heap_begin_;
+  prefix_length_ = static_cast<uint16_t>(prefix_length);
+  for (int i = 0; i < size; i++) {
+    auto length = PushKey(keys[i]);
+    Slots()[i] = {values[i], heap_begin_, length};
+  }
+}
+
+KEY_STORE_TEMPLATE_ARGUMENTS
+void KEY_STORE_TYPE::Compact(int size) {
+  std::vector<KeyType> keys;
+  std::vector<ValueType> values;
+  keys.reserve(size);
+  values.reserve(size);
+  for (int i = 0; i < size; i++) {
+    keys.push_back(KeyAt(i));
+    values.push_back(ValueAt(i));
+  }
+
+  // Candidate prefixes: the current one, the one of the keys that use it, and the one of all keys.
+  // Keeping the current prefix is always possible, so compaction never makes the store larger.
+  KeyType current;
+  memset(&current, 0, sizeof(KeyType));
+  memcpy(&current, Bytes() + prefix_offset_, prefix_length_);
+  std::vector<std::pair<KeyType, size_t>> candidates{{current, prefix_length_}};
+  if (size > 0) {
+    size_t all_length = sizeof(KeyType);
+    size_t prefixed_length = sizeof(KeyType);
+    int prefixed_first = -1;
+    for (int i = 0; i < size; i++) {
+      all_length = std::min(all_length, CommonLength(keys[0], keys[i]));
+      if ((Slots()[i].length_ & PREFIXED_FLAG) != 0) {
+        prefixed_first = prefixed_first == -1 ? i : prefixed_first;
+        prefixed_length = std::min(prefixed_length, CommonLength(keys[prefixed_first], keys[i]));
+      }
+    }
+    candidates.emplace_back(keys[0], std::min(all_length, TrimmedLength(keys[0])));
+    if (prefixed_first != -1) {
+      candidates.emplace_back(keys[prefixed_first], std::min(prefixed_length, TrimmedLength(keys[prefixed_first])));
+    }
+  }
+
+  size_t best = 0;
+  size_t best_cost = SIZE_MAX;
+  for (size_t c = 0; c < candidates.size(); c++) {
+    const auto &[prefix_key, prefix_length] = candidates[c];
+    size_t cost = prefix_length;
+    for (int i = 0; i < size; i++) {
+      auto len = TrimmedLength(keys[i]);
+      bool shares = memcmp(KeyBytes(keys[i]), KeyBytes(prefix_key), prefix_length) == 0;
+      cost += shares ? std::max(len, prefix_length) - prefix_length : len;
+    }
+    if (cost < best_cost) {
+      best = c;
+      best_cost = cost;
+    }
+  }
+  // keys and values were copied out, so the rebuild may overwrite the old heap
+  auto prefix = candidates[best];
+  Rebuild(keys.data(), values.data(), size, prefix.first, prefix.second);
+}
+
+template class BPlusTreeKeyStore<GenericKey<32>, RID>;
+template class BPlusTreeKeyStore<GenericKey<64>, RID>;
+template class BPlusTreeKeyStore<GenericKey<32>, page_id_t>;
+template class BPlusTreeKeyStore<GenericKey<64>, page_id_t>;
+
+}  // namespace bustub
@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
 #include <sstream>
 
 #include "common/exception.h"
@@ -25,7 +26,7 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent_page id, set
- * next page id and set max size
+ * next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
@@ -36,6 +37,13 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, in
   SetSize(0);
   SetLSN(INVALID_LSN);
   next_page_id_ = INVALID_PAGE_ID;
+  prev_page_id_ = INVALID_PAGE_ID;
+  if constexpr (IsCompressedKey<KeyType>()) {
+    Store()->Init(LEAF_PAGE_DATA_SIZE);
+  } else if constexpr (IntLayout::ENABLED) {
+    static_assert(LEAF_PAGE_SIZE * (sizeof(IntType) + sizeof(ValueType)) <= LEAF_PAGE_DATA_SIZE,
+                  "both arrays must fit the page");
+  }
 }
 
 /**
@@ -47,6 +55,15 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return nex
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+/**
+ * Helper methods to set/get prev page id
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -56,7 +73,13 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   if (index < 0 || index > this->GetSize() - 1) {
     LOG_DEBUG("KeyAt: index %d out of range %d page: %d", index, this->GetSize() - 1, this->GetPageId());
   }
-  return array_[index].first;
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return Store()->KeyAt(index);
+  } else if constexpr (IntLayout::ENABLED) {
+    return IntLayout::FromInt(IntKeys()[index]);
+  } else {
+    return array_[index].first;
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -64,10 +87,20 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::SetPairAt(int index, const MappingType &pair) -
   if (index < 0 || index > this->GetSize()) {
     return false;
   }
-  for (int i = this->GetSize(); i > index; i--) {
-    array_[i] = array_[i - 1];
+  if constexpr (IsCompressedKey<KeyType>()) {
+    Store()->Insert(index, this->GetSize(), pair.first, pair.second);
+  } else if constexpr (IntLayout::ENABLED) {
+    int moved = this->GetSize() - index;
+    memmove(IntKeys() + index + 1, IntKeys() + index, moved * sizeof(IntType));
+    memmove(IntValues() + index + 1, IntValues() + index, moved * sizeof(ValueType));
+    IntKeys()[index] = IntLayout::ToInt(pair.first);
+    IntValues()[index] = pair.second;
+  } else {
+    for (int i = this->GetSize(); i > index; i--) {
+      array_[i] = array_[i - 1];
+    }
+    array_[index] = pair;
   }
-  array_[index] = pair;
   this->IncreaseSize(1);
   return true;
 }
@@ -77,43 +110,186 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   if (index < 0 || index > this->GetSize() - 1) {
     LOG_DEBUG("KeyAt: index %d out of range %d", index, this->GetSize() - 1);
   }
-  return array_[index].second;
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return Store()->ValueAt(index);
+  } else if constexpr (IntLayout::ENABLED) {
+    return IntValues()[index];
+  } else {
+    return array_[index].second;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  if (index < 0 || index > this->GetSize() - 1) {
+    LOG_DEBUG("SetValueAt: index %d out of range %d", index, this->GetSize() - 1);
+  }
+  if constexpr (IsCompressedKey<KeyType>()) {
+    Store()->SetValueAt(index, value);
+  } else if constexpr (IntLayout::ENABLED) {
+    IntValues()[index] = value;
+  } else {
+    array_[index].second = value;
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::DeletePair(const KeyType &key, KeyComparator &comparator) -> bool {
-  for (int i = 0; i < this->GetSize(); i++) {
-    if (comparator(array_[i].first, key) == 0) {
-      for (int j = i; j < this->GetSize() - 1; j++) {
-        array_[j] = array_[j + 1];
-      }
-      this->IncreaseSize(-1);
-      return true;
+  int index = KeyIndex(key, comparator);
+  if (index == -1) {
+    return false;
+  }
+  if constexpr (IsCompressedKey<KeyType>()) {
+    Store()->Remove(index, this->GetSize());
+  } else if constexpr (IntLayout::ENABLED) {
+    int moved = this->GetSize() - index - 1;
+    memmove(IntKeys() + index, IntKeys() + index + 1, moved * sizeof(IntType));
+    memmove(IntValues() + index, IntValues() + index + 1, moved * sizeof(ValueType));
+  } else {
+    for (int j = index; j < this->GetSize() - 1; j++) {
+      array_[j] = array_[j + 1];
     }
   }
-  return false;
+  this->IncreaseSize(-1);
+  return true;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::PairAt(int index) -> MappingType & {
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::PairAt(int index) const -> MappingType {
   if (index < 0 || index > this->GetSize() - 1) {
     LOG_DEBUG("KeyAt: index %d out of range %d", index, this->GetSize() - 1);
   }
-  return array_[index];
+  return {KeyAt(index), ValueAt(index)};
+}
+
+/*
+ * Helper method to find the array offset of input key
+ * @return : -1 if the key is not in this page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, KeyComparator &comparator) const -> int {
+  int index = KeyLowerBound(key, comparator);
+  if (index < this->GetSize() && comparator(key, this->KeyAt(index)) == 0) {
+    return index;
+  }
+  return -1;
 }
 
+/*
+ * Helper method to find the offset of the first key that is not less than
+ * input key, which is where the key is or would be inserted. Integer keys are
+ * compared many at a time, see SimdLowerBound.
+ * @return : the size of this page if every key is less
+ */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsKeyExist(const KeyType &key, KeyComparator &comparator) const -> bool {
-  for (int i = 0; i < this->GetSize(); i++) {
-    if (comparator(key, this->KeyAt(i)) == 0) {
-      return true;
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyLowerBound(const KeyType &key, KeyComparator &comparator) const -> int {
+  if constexpr (IntLayout::ENABLED) {
+    return SimdLowerBound(IntKeys(), this->GetSize(), IntLayout::ToInt(key));
+  } else {
+    int low = 0;
+    int high = this->GetSize();
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      if (comparator(this->KeyAt(mid), key) == -1) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
     }
+    return low;
   }
-  return false;
 }
+
+/*****************************************************************************
+ * SPACE MANAGEMENT
+ *****************************************************************************/
+/*
+ * Wide keys take as many bytes as they need, so their pages are split when
+ * the free space may not hold two more entries (the insert that triggers the
+ * split must still fit). A page of them underflows once both its size and
+ * its bytes are below half. Fixed layout pages only look at their size.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsSpaceLow() const -> bool {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return Store()->FreeSpace(this->GetSize()) < 2 * KeyStore::MAX_ENTRY_SIZE;
+  } else {
+    return false;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsUnderflow() const -> bool {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return this->GetSize() < this->GetMinSize() && Store()->UsedSpace(this->GetSize()) * 2 < Store()->DataSize();
+  } else {
+    return this->GetSize() < this->GetMinSize();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsSafeToRemove() const -> bool {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return this->GetSize() > this->GetMinSize() ||
+           Store()->UsedSpace(this->GetSize()) * 2 >= Store()->DataSize() + 2 * KeyStore::MAX_ENTRY_SIZE;
+  } else {
+    return this->GetSize() > this->GetMinSize();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CanMergeWith(const BPlusTreeLeafPage *other) const -> bool {
+  // a leaf splits when it reaches its max size, so the merged leaf has to stay below it
+  bool size_fits = this->GetSize() + other->GetSize() < this->GetMaxSize();
+  if constexpr (IsCompressedKey<KeyType>()) {
+    // the moved keys may lose their prefix, so count them at their full length
+    auto limit = Store()->DataSize() - 2 * KeyStore::MAX_ENTRY_SIZE;
+    return size_fits && Store()->UsedSpace(this->GetSize()) + other->Store()->RawSpace(other->GetSize()) <= limit &&
+           other->Store()->UsedSpace(other->GetSize()) + Store()->RawSpace(this->GetSize()) <= limit;
+  } else {
+    return size_fits;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::SplitIndex() const -> int {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    return Store()->SplitIndex(this->GetSize());
+  } else {
+    return this->GetSize() / 2;
+  }
+}
+
+/*
+ * Append the pairs from begin to the end of this page to recipient
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveRangeTo(int begin, BPlusTreeLeafPage *recipient) {
+  if constexpr (IsCompressedKey<KeyType>()) {
+    Store()->MoveRangeTo(begin, this->GetSize(), recipient->Store(), recipient->GetSize());
+    recipient->IncreaseSize(this->GetSize() - begin);
+  } else if constexpr (IntLayout::ENABLED) {
+    int moved = this->GetSize() - begin;
+    memcpy(recipient->IntKeys() + recipient->GetSize(), IntKeys() + begin, moved * sizeof(IntType));
+    memcpy(recipient->IntValues() + recipient->GetSize(), IntValues() + begin, moved * sizeof(ValueType));
+    recipient->IncreaseSize(moved);
+  } else {
+    for (int i = begin; i < this->GetSize(); i++) {
+      recipient->SetPairAt(recipient->GetSize(), array_[i]);
+    }
+  }
+  this->SetSize(begin);
+}
+
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTreeLeafPage<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class BPlusTreeLeafPage<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class BPlusTreeLeafPage<GenericKey<64>, RID, MemcmpComparator<64>>;
 }  // namespace bustub
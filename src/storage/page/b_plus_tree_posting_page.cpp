@@ -0,0 +1,309 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+namespace {
+
+auto VarintLength(uint64_t value) -> uint32_t {
+  uint32_t len = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    len++;
+  }
+  return len;
+}
+
+auto PutVarint(uint8_t *buf, uint64_t value) -> uint32_t {
+  uint32_t len = 0;
+  while (value >= 0x80) {
+    buf[len++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  buf[len++] = static_cast<uint8_t>(value);
+  return len;
+}
+
+auto GetVarint(const uint8_t *buf, uint64_t *value) -> uint32_t {
+  uint32_t len = 0;
+  uint32_t shift = 0;
+  *value = 0;
+  while (true) {
+    uint8_t byte = buf[len++];
+    *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return len;
+    }
+    shift += 7;
+  }
+}
+
+auto RIDLess(const RID &lhs, const RID &rhs) -> bool { return lhs.Get() < rhs.Get(); }
+
+auto AsPosting(Page *page) -> BPlusTreePostingPage * { return reinterpret_cast<BPlusTreePostingPage *>(page->GetData()); }
+
+}  // namespace
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+void BPlusTreePostingPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  tail_page_id_ = page_id;
+  count_ = 0;
+  used_ = 0;
+}
+
+auto BPlusTreePostingPage::FirstRID() const -> RID {
+  uint64_t value;
+  GetVarint(data_, &value);
+  return RID(static_cast<int64_t>(value));
+}
+
+void BPlusTreePostingPage::Decode(std::vector<RID> *result) const {
+  uint32_t offset = 0;
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < count_; i++) {
+    uint64_t delta;
+    offset += GetVarint(data_ + offset, &delta);
+    value += delta;
+    result->emplace_back(static_cast<int64_t>(value));
+  }
+}
+
+auto BPlusTreePostingPage::Encode(const std::vector<RID> &rids, size_t begin, size_t end) -> size_t {
+  count_ = 0;
+  used_ = 0;
+  uint64_t prev = 0;
+  for (size_t i = begin; i < end; i++) {
+    auto value = static_cast<uint64_t>(rids[i].Get());
+    auto delta = value - prev;
+    if (used_ + VarintLength(delta) > POSTING_PAGE_DATA_SIZE) {
+      break;
+    }
+    used_ += PutVarint(data_ + used_, delta);
+    prev = value;
+    count_++;
+  }
+  return count_;
+}
+
+void BPlusTreePostingPage::CopyRunFrom(const BPlusTreePostingPage &other) {
+  count_ = other.count_;
+  used_ = other.used_;
+  memcpy(data_, other.data_, used_);
+}
+
+/*****************************************************************************
+ * CHAIN OPERATIONS
+ *****************************************************************************/
+
+auto BPlusTreePostingList::Create(BufferPoolManager *bpm, const RID &first, const RID &second) -> page_id_t {
+  page_id_t head_page_id;
+  auto *head_page = bpm->NewPage(&head_page_id);
+  if (head_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate posting page");
+  }
+  auto *head = AsPosting(head_page);
+  head->Init(head_page_id);
+  std::vector<RID> rids{first, second};
+  std::sort(rids.begin(), rids.end(), RIDLess);
+  head->Encode(rids, 0, rids.size());
+  bpm->UnpinPage(head_page_id, true);
+  return head_page_id;
+}
+
+auto BPlusTreePostingList::Insert(BufferPoolManager *bpm, page_id_t head_page_id, const RID &rid) -> bool {
+  auto *head = AsPosting(bpm->FetchPage(head_page_id));
+
+  // Heap inserts mostly arrive in rid order, so try the tail page before walking the chain.
+  auto *target = head;
+  if (head->GetTailPageId() != head_page_id) {
+    auto *tail = AsPosting(bpm->FetchPage(head->GetTailPageId()));
+    if (!RIDLess(rid, tail->FirstRID())) {
+      target = tail;
+    } else {
+      bpm->UnpinPage(tail->GetPageId(), false);
+      while (target->GetNextPageId() != INVALID_PAGE_ID) {
+        auto *next = AsPosting(bpm->FetchPage(target->GetNextPageId()));
+        if (RIDLess(rid, next->FirstRID())) {
+          bpm->UnpinPage(next->GetPageId(), false);
+          break;
+        }
+        if (target != head) {
+          bpm->UnpinPage(target->GetPageId(), false);
+        }
+        target = next;
+      }
+    }
+  }
+
+  std::vector<RID> rids;
+  target->Decode(&rids);
+  auto pos = std::lower_bound(rids.begin(), rids.end(), rid, RIDLess);
+  if (pos != rids.end() && *pos == rid) {
+    if (target != head) {
+      bpm->UnpinPage(target->GetPageId(), false);
+    }
+    bpm->UnpinPage(head_page_id, false);
+    return false;
+  }
+  rids.insert(pos, rid);
+
+  // Keep the page fully packed and spill whatever no longer fits into fresh pages after it.
+  auto *prev = target;
+  size_t stored = target->Encode(rids, 0, rids.size());
+  while (stored < rids.size()) {
+    page_id_t new_page_id;
+    auto *new_page = bpm->NewPage(&new_page_id);
+    if (new_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate posting page");
+    }
+    auto *spill = AsPosting(new_page);
+    spill->Init(new_page_id);
+    stored += spill->Encode(rids, stored, rids.size());
+    spill->SetNextPageId(prev->GetNextPageId());
+    prev->SetNextPageId(new_page_id);
+    if (head->GetTailPageId() == prev->GetPageId()) {
+      head->SetTailPageId(new_page_id);
+    }
+    if (prev != target) {
+      bpm->UnpinPage(prev->GetPageId(), true);
+    }
+    prev = spill;
+  }
+  if (prev != target) {
+    bpm->UnpinPage(prev->GetPageId(), true);
+  }
+  if (target != head) {
+    bpm->UnpinPage(target->GetPageId(), true);
+  }
+  bpm->UnpinPage(head_page_id, true);
+  return true;
+}
+
+auto BPlusTreePostingList::Remove(BufferPoolManager *bpm, page_id_t head_page_id, const RID &rid) -> bool {
+  auto *head = AsPosting(bpm->FetchPage(head_page_id));
+
+  // Find the page whose run covers rid, remembering its predecessor for unlinking.
+  BPlusTreePostingPage *prev = nullptr;
+  auto *target = head;
+  while (target->GetNextPageId() != INVALID_PAGE_ID) {
+    auto *next = AsPosting(bpm->FetchPage(target->GetNextPageId()));
+    if (RIDLess(rid, next->FirstRID())) {
+      bpm->UnpinPage(next->GetPageId(), false);
+      break;
+    }
+    if (prev != nullptr && prev != head) {
+      bpm->UnpinPage(prev->GetPageId(), false);
+    }
+    prev = target;
+    target = next;
+  }
+
+  std::vector<RID> rids;
+  target->Decode(&rids);
+  auto pos = std::lower_bound(rids.begin(), rids.end(), rid, RIDLess);
+  bool found = pos != rids.end() && *pos == rid;
+  page_id_t freed_page_id = INVALID_PAGE_ID;
+  if (found) {
+    rids.erase(pos);
+    target->Encode(rids, 0, rids.size());
+    if (rids.empty() && target != head) {
+      prev->SetNextPageId(target->GetNextPageId());
+      if (head->GetTailPageId() == target->GetPageId()) {
+        head->SetTailPageId(prev->GetPageId());
+      }
+      freed_page_id = target->GetPageId();
+    } else if (rids.empty() && head->GetNextPageId() != INVALID_PAGE_ID) {
+      // The head page must stay put because the leaf refers to it, pull the second page into it instead.
+      auto *next = AsPosting(bpm->FetchPage(head->GetNextPageId()));
+      head->CopyRunFrom(*next);
+      head->SetNextPageId(next->GetNextPageId());
+      if (head->GetTailPageId() == next->GetPageId()) {
+        head->SetTailPageId(head_page_id);
+      }
+      freed_page_id = next->GetPageId();
+      bpm->UnpinPage(freed_page_id, false);
+    }
+  }
+
+  if (prev != nullptr && prev != head) {
+    bpm->UnpinPage(prev->GetPageId(), found);
+  }
+  if (target != head) {
+    bpm->UnpinPage(target->GetPageId(), found);
+  }
+  bpm->UnpinPage(head_page_id, found);
+  if (freed_page_id != INVALID_PAGE_ID) {
+    bpm->DeletePage(freed_page_id);
+  }
+  return found;
+}
+
+auto BPlusTreePostingList::TryCollapse(BufferPoolManager *bpm, page_id_t head_page_id, RID *last) -> bool {
+  auto *head = AsPosting(bpm->FetchPage(head_page_id));
+  bool collapse = head->GetNextPageId() == INVALID_PAGE_ID && head->GetCount() == 1;
+  if (collapse) {
+    *last = head->FirstRID();
+  }
+  bpm->UnpinPage(head_page_id, false);
+  if (collapse) {
+    bpm->DeletePage(head_page_id);
+  }
+  return collapse;
+}
+
+void BPlusTreePostingList::Collect(BufferPoolManager *bpm, page_id_t head_page_id, std::vector<RID> *result) {
+  auto page_id = head_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = AsPosting(bpm->FetchPage(page_id));
+    page->Decode(result);
+    auto next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+auto BPlusTreePostingList::Count(BufferPoolManager *bpm, page_id_t head_page_id) -> size_t {
+  size_t count = 0;
+  auto page_id = head_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = AsPosting(bpm->FetchPage(page_id));
+    count += page->GetCount();
+    auto next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return count;
+}
+
+void BPlusTreePostingList::Destroy(BufferPoolManager *bpm, page_id_t head_page_id) {
+  auto page_id = head_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = AsPosting(bpm->FetchPage(page_id));
+    auto next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,37 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_run_page.cpp
+//
+// Identification: src/storage/page/lsm_run_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/lsm_run_page.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType>
+void LSM_RUN_PAGE_TYPE::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  size_ = 0;
+}
+
+template <typename KeyType, typename ValueType>
+void LSM_RUN_PAGE_TYPE::Append(const LSMEntry<KeyType, ValueType> &entry) {
+  BUSTUB_ASSERT(size_ < MAX_SIZE, "run page is full");
+  array_[size_++] = entry;
+}
+
+template class LSMRunPage<GenericKey<4>, RID>;
+template class LSMRunPage<GenericKey<8>, RID>;
+template class LSMRunPage<GenericKey<16>, RID>;
+template class LSMRunPage<GenericKey<32>, RID>;
+template class LSMRunPage<GenericKey<64>, RID>;
+
+}  // namespace bustub
@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clustered_table.cpp
+//
+// Identification: src/storage/table/clustered_table.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/clustered_table.h"
+
+#include "concurrency/transaction.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+ClusteredTable::ClusteredTable(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
+                               LogManager *log_manager, Index *primary_index, const Schema &schema)
+    : TableHeap(buffer_pool_manager, lock_manager, log_manager),
+      primary_index_(primary_index),
+      schema_(schema),
+      key_positions_(schema.GetColumnCount()) {
+  const auto &key_attrs = primary_index_->GetKeyAttrs();
+  BUSTUB_ASSERT(key_attrs.size() == schema_.GetColumnCount(), "the primary index must hold every column");
+  for (uint32_t i = 0; i < key_attrs.size(); i++) {
+    key_positions_[key_attrs[i]] = i;
+  }
+}
+
+auto ClusteredTable::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
+  auto primary_key = tuple.GetValue(&schema_, primary_index_->GetKeyAttrs()[0]);
+  if (primary_key.IsNull()) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  *rid = PrimaryKeyRid(primary_key.GetAs<int32_t>());
+
+  std::scoped_lock lock(latch_);
+  if (!primary_index_->GetPrefixIterator({primary_key}, txn)->IsEnd()) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  primary_index_->InsertEntry(KeyFromRow(tuple), *rid, txn);
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  return true;
+}
+
+auto ClusteredTable::MarkDelete(const RID &rid, Transaction *txn) -> bool {
+  std::scoped_lock lock(latch_);
+  Tuple row;
+  if (!FindRow(rid, &row, txn)) {
+    return false;
+  }
+  // the row leaves the tree at once like the entries of the secondary indexes, so scans of the tree in the same
+  // transaction do not see it
+  primary_index_->DeleteEntry(KeyFromRow(row), rid, txn);
+  deleted_[rid].push_back(std::move(row));
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+  return true;
+}
+
+auto ClusteredTable::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool {
+  auto primary_key = tuple.GetValue(&schema_, primary_index_->GetKeyAttrs()[0]);
+  if (primary_key.IsNull() || !(PrimaryKeyRid(primary_key.GetAs<int32_t>()) == rid)) {
+    return false;
+  }
+  std::scoped_lock lock(latch_);
+  Tuple old_row;
+  if (!FindRow(rid, &old_row, txn)) {
+    return false;
+  }
+  primary_index_->DeleteEntry(KeyFromRow(old_row), rid, txn);
+  primary_index_->InsertEntry(KeyFromRow(tuple), rid, txn);
+  // Update the transaction's write set.
+  if (txn->GetState() != TransactionState::ABORTED) {
+    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_row, this);
+  }
+  return true;
+}
+
+void ClusteredTable::ApplyDelete(const RID &rid, Transaction *txn) {
+  std::scoped_lock lock(latch_);
+  // an abort rolls back an insert with ApplyDelete, a commit applies a delete
+  if (txn->GetState() == TransactionState::ABORTED) {
+    Tuple row;
+    if (FindRow(rid, &row, txn)) {
+      primary_index_->DeleteEntry(KeyFromRow(row), rid, txn);
+    }
+    return;
+  }
+  auto rows = deleted_.find(rid);
+  BUSTUB_ASSERT(rows != deleted_.end(), "Couldn't find the deleted row of that RID.");
+  rows->second.pop_back();
+  if (rows->second.empty()) {
+    deleted_.erase(rows);
+  }
+}
+
+void ClusteredTable::RollbackDelete(const RID &rid, Transaction *txn) {
+  std::scoped_lock lock(latch_);
+  auto rows = deleted_.find(rid);
+  BUSTUB_ASSERT(rows != deleted_.end(), "Couldn't find the deleted row of that RID.");
+  primary_index_->InsertEntry(KeyFromRow(rows->second.back()), rid, txn);
+  rows->second.pop_back();
+  if (rows->second.empty()) {
+    deleted_.erase(rows);
+  }
+}
+
+auto ClusteredTable::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool /*acquire_read_lock*/) -> bool {
+  return FindRow(rid, tuple, txn);
+}
+
+auto ClusteredTable::Begin(Transaction *txn) -> TableIterator {
+  auto cursor = primary_index_->GetScanIterator(false);
+  if (cursor->IsEnd()) {
+    return End();
+  }
+  return {this, cursor->GetRID(), txn};
+}
+
+void ClusteredTable::Advance(Tuple *tuple, Transaction *txn) {
+  auto primary_key = ValueFactory::GetIntegerValue(PrimaryKeyOf(tuple->rid_));
+  auto cursor = primary_index_->GetRangeIterator(IndexBound{primary_key, false}, std::nullopt, txn);
+  if (cursor->IsEnd()) {
+    tuple->rid_ = RID(INVALID_PAGE_ID, 0);
+    return;
+  }
+  *tuple = RowFromKey(cursor->GetKey());
+}
+
+auto ClusteredTable::RowFromKey(const Tuple &key) const -> Tuple {
+  const auto *key_schema = primary_index_->GetKeySchema();
+  std::vector<Value> values;
+  values.reserve(key_positions_.size());
+  for (auto position : key_positions_) {
+    values.push_back(key.GetValue(key_schema, position));
+  }
+  Tuple row{values, &schema_};
+  row.rid_ = PrimaryKeyRid(key.GetValue(key_schema, 0).GetAs<int32_t>());
+  return row;
+}
+
+auto ClusteredTable::KeyFromRow(const Tuple &row) const -> Tuple {
+  Tuple copy = row;
+  return copy.KeyFromTuple(schema_, *primary_index_->GetKeySchema(), primary_index_->GetKeyAttrs());
+}
+
+auto ClusteredTable::FindRow(const RID &rid, Tuple *row, Transaction *txn) -> bool {
+  if (rid.GetPageId() != 0) {
+    return false;
+  }
+  auto primary_key = ValueFactory::GetIntegerValue(PrimaryKeyOf(rid));
+  auto cursor = primary_index_->GetPrefixIterator({primary_key}, txn);
+  if (cursor->IsEnd()) {
+    return false;
+  }
+  *row = RowFromKey(cursor->GetKey());
+  return true;
+}
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #include <cassert>
 
+#include "common/exception.h"
 #include "common/logger.h"
 #include "fmt/format.h"
 #include "storage/table/table_heap.h"
@@ -36,6 +37,12 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
+TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      first_page_id_(INVALID_PAGE_ID) {}
+
 auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
   if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
@@ -198,4 +205,39 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
 
 auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0), nullptr}; }
 
+void TableHeap::Advance(Tuple *tuple, Transaction *txn) {
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(tuple->rid_.GetPageId()));
+  BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
+
+  cur_page->RLatch();
+  RID next_tuple_rid;
+  if (!cur_page->GetNextTupleRid(tuple->rid_,
+                                 &next_tuple_rid)) {  // end of this page
+    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(cur_page->GetNextPageId()));
+      cur_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+      cur_page = next_page;
+      cur_page->RLatch();
+      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+        break;
+      }
+    }
+  }
+  tuple->rid_ = next_tuple_rid;
+
+  if (tuple->rid_.GetPageId() != INVALID_PAGE_ID) {
+    // DO NOT ACQUIRE READ LOCK twice in a single thread otherwise it may deadlock.
+    // See https://users.rust-lang.org/t/how-bad-is-the-potential-deadlock-mentioned-in-rwlocks-document/67234
+    if (!GetTuple(tuple->rid_, tuple, txn, false)) {
+      cur_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+      throw bustub::Exception("read non-existing tuple");
+    }
+  }
+  // release until copy the tuple
+  cur_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+}
+
 }  // namespace bustub
@@ -18,6 +18,9 @@
 #include "catalog/catalog.h"
 #include "catalog/table_generator.h"
 #include "execution/executor_context.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
 #include "gtest/gtest.h"
 #include "type/value_factory.h"
 
@@ -688,4 +691,152 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   remove("catalog_test.log");
 }
 
+TEST(CatalogTest, PartialIndexTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  Schema table_schema{std::vector<Column>{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}}};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, table_schema);
+  auto insert = [&](int32_t a, int32_t b) {
+    RID rid;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(b)}, &table_schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  };
+  for (int32_t a = 0; a < 100; a++) {
+    insert(a, a % 4);
+  }
+
+  // the indexes hold the rows where B > 1, and neither those where it is not nor where it is NULL
+  auto predicate = std::make_shared<ComparisonExpression>(
+      std::make_shared<ColumnValueExpression>(0, 1, TypeId::INTEGER),
+      std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(1)), ComparisonType::GreaterThan);
+  Schema key_schema{std::vector<Column>{{"A", TypeId::INTEGER}}};
+  std::vector<IndexInfo *> indexes;
+  for (auto index_type : {IndexType::BPlusTree, IndexType::AdaptiveRadixTree}) {
+    auto index_name = index_type == IndexType::BPlusTree ? "btree" : "art";
+    indexes.push_back(catalog->CreateIndex<GenericKey<4>, RID, MemcmpComparator<4>>(
+        txn.get(), index_name, table_name, table_schema, key_schema, {0}, 4, HashFunction<GenericKey<4>>{}, false,
+        true, true, index_type, false, predicate));
+  }
+  std::vector<Value> null_values{ValueFactory::GetIntegerValue(0), ValueFactory::GetNullValueByType(TypeId::INTEGER)};
+  Tuple null_tuple{null_values, &table_schema};
+  auto count = [&](IndexInfo *index_info) {
+    size_t entries = 0;
+    for (auto iter = index_info->index_->GetScanIterator(false); !iter->IsEnd(); iter->Next()) {
+      entries++;
+    }
+    return entries;
+  };
+  for (auto *index_info : indexes) {
+    ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+    EXPECT_FALSE(index_info->Covers(null_tuple, table_schema));
+    EXPECT_EQ(count(index_info), 50);
+    std::vector<RID> results;
+    index_info->index_->ScanKey(Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(42)}, &key_schema}, &results,
+                                txn.get());
+    EXPECT_EQ(results.size(), 1);
+    results.clear();
+    index_info->index_->ScanKey(Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(41)}, &key_schema}, &results,
+                                txn.get());
+    EXPECT_TRUE(results.empty());
+  }
+
+  // an in-memory index is filled from the table again with the same predicate
+  for (int32_t a = 100; a < 108; a++) {
+    insert(a, a % 4);
+  }
+  catalog->RebuildInMemoryIndexes(txn.get());
+  EXPECT_EQ(count(indexes[1]), 54);
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+TEST(CatalogTest, ClusteredTableTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  // the primary key is the second column, the key of the primary index puts it first
+  const std::string table_name{"foobar"};
+  Schema table_schema{std::vector<Column>{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}}};
+  auto *table_info =
+      catalog->CreateClusteredTable<GenericKey<8>, RID, MemcmpComparator<8>>(txn.get(), table_name, table_schema, 1, 8);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  auto *table = table_info->table_.get();
+  auto insert = [&](int32_t a, int32_t b) {
+    RID rid;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(b)}, &table_schema};
+    return table->InsertTuple(tuple, &rid, txn.get()) && rid == ClusteredTable::PrimaryKeyRid(b);
+  };
+  for (int32_t b = 99; b >= -100; b--) {
+    ASSERT_TRUE(insert(b * 10, b));
+  }
+  EXPECT_FALSE(insert(0, 42));
+  txn->SetState(TransactionState::GROWING);
+  auto indexes = catalog->GetTableIndexes(table_name);
+  ASSERT_EQ(indexes.size(), 1);
+  EXPECT_EQ(indexes[0]->name_, "foobar_pkey");
+  EXPECT_TRUE(indexes[0]->clustered_);
+
+  // a scan of the table reads the rows in primary key order
+  int32_t expected = -100;
+  for (auto iter = table->Begin(txn.get()); iter != table->End(); ++iter) {
+    EXPECT_EQ(iter->GetValue(&table_schema, 1).GetAs<int32_t>(), expected);
+    EXPECT_EQ(iter->GetValue(&table_schema, 0).GetAs<int32_t>(), expected * 10);
+    EXPECT_EQ(iter->GetRid(), ClusteredTable::PrimaryKeyRid(expected));
+    expected++;
+  }
+  EXPECT_EQ(expected, 100);
+
+  // a range of the primary key is a seek into the tree
+  size_t in_range = 0;
+  for (auto iter = indexes[0]->index_->GetRangeIterator(IndexBound{ValueFactory::GetIntegerValue(-3), false},
+                                                        IndexBound{ValueFactory::GetIntegerValue(5), true}, txn.get());
+       !iter->IsEnd(); iter->Next()) {
+    EXPECT_EQ(iter->GetRID(), ClusteredTable::PrimaryKeyRid(-2 + static_cast<int32_t>(in_range)));
+    in_range++;
+  }
+  EXPECT_EQ(in_range, 8);
+
+  // a delete takes the row out until it is rolled back, or for good when it is applied
+  Tuple tuple;
+  auto rid = ClusteredTable::PrimaryKeyRid(7);
+  ASSERT_TRUE(table->MarkDelete(rid, txn.get()));
+  EXPECT_FALSE(table->GetTuple(rid, &tuple, txn.get()));
+  table->RollbackDelete(rid, txn.get());
+  ASSERT_TRUE(table->GetTuple(rid, &tuple, txn.get()));
+  EXPECT_EQ(tuple.GetValue(&table_schema, 0).GetAs<int32_t>(), 70);
+  ASSERT_TRUE(table->MarkDelete(rid, txn.get()));
+  table->ApplyDelete(rid, txn.get());
+  EXPECT_FALSE(table->GetTuple(rid, &tuple, txn.get()));
+  EXPECT_TRUE(insert(7, 7));
+
+  // an aborted insert is taken out again
+  ASSERT_TRUE(insert(1000, 100));
+  txn->SetState(TransactionState::ABORTED);
+  table->ApplyDelete(ClusteredTable::PrimaryKeyRid(100), txn.get());
+  txn->SetState(TransactionState::GROWING);
+  EXPECT_FALSE(table->GetTuple(ClusteredTable::PrimaryKeyRid(100), &tuple, txn.get()));
+
+  // a secondary index stores primary keys as rids, which find the rows
+  Schema key_schema{std::vector<Column>{{"A", TypeId::INTEGER}}};
+  auto *index_info = catalog->CreateIndex<GenericKey<4>, RID, MemcmpComparator<4>>(
+      txn.get(), "secondary", table_name, table_schema, key_schema, {0}, 4, HashFunction<GenericKey<4>>{});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  std::vector<RID> results;
+  index_info->index_->ScanKey(Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(7)}, &key_schema}, &results,
+                              txn.get());
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_TRUE(table->GetTuple(results[0], &tuple, txn.get()));
+  EXPECT_EQ(tuple.GetValue(&table_schema, 1).GetAs<int32_t>(), 7);
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 }  // namespace bustub
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <random>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -24,7 +26,7 @@ namespace bustub {
 // NOLINTNEXTLINE
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
   DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
@@ -117,4 +119,137 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, GrowShrinkTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // far more pairs than a bucket holds, so the buckets split and the directory grows
+  const int n = 20000;
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 3);
+  for (int key = 0; key < n; key++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, key, &res)) << key;
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(key, res[0]);
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 7, 7));
+
+  // the buckets of removed pairs merge, and the directory shrinks back to the one bucket
+  for (auto key : keys) {
+    if (key % 2 == 0) {
+      EXPECT_TRUE(ht.Remove(nullptr, key, key));
+    }
+  }
+  ht.VerifyIntegrity();
+  for (int key = 0; key < n; key++) {
+    std::vector<int> res;
+    EXPECT_EQ(ht.GetValue(nullptr, key, &res), key % 2 == 1) << key;
+  }
+  for (auto key : keys) {
+    EXPECT_EQ(ht.Remove(nullptr, key, key), key % 2 == 1);
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, OverflowTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // the values of one key share their hash, no split tells them apart, so they fill overflow pages of their bucket
+  const int n = 3000;
+  for (int i = 0; i < n; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, 1, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i + 2, i));
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 1, n - 1));
+  ht.VerifyIntegrity();
+  std::vector<int> res;
+  EXPECT_TRUE(ht.GetValue(nullptr, 1, &res));
+  std::sort(res.begin(), res.end());
+  ASSERT_EQ(n, res.size());
+  for (int i = 0; i < n; i++) {
+    EXPECT_EQ(i, res[i]);
+  }
+
+  // removing the values frees the overflow pages, the other keys are kept
+  for (int i = 0; i < n; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, 1, i));
+  }
+  EXPECT_FALSE(ht.Remove(nullptr, 1, 0));
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 1, &res));
+  for (int i = 0; i < n; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i + 2, &res)) << i;
+    EXPECT_EQ(i, res[0]);
+  }
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentInsertRemoveTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // writers insert disjoint keys and remove half of them, splitting and merging buckets under each other's lookups
+  const int per_thread = 5000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<int> res;
+      for (int i = 0; i < per_thread; i++) {
+        int key = i * 4 + t;
+        EXPECT_TRUE(ht.Insert(nullptr, key, key));
+        res.clear();
+        EXPECT_TRUE(ht.GetValue(nullptr, key, &res));
+        if (i % 2 == 1) {
+          EXPECT_TRUE(ht.Remove(nullptr, key - 4, key - 4));
+          res.clear();
+          EXPECT_FALSE(ht.GetValue(nullptr, key - 4, &res));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+
+  // only the keys of odd i are left
+  for (int key = 0; key < per_thread * 4; key++) {
+    std::vector<int> res;
+    EXPECT_EQ(ht.GetValue(nullptr, key, &res), (key / 4) % 2 == 1) << key;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
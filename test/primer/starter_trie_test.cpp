@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <bitset>
 #include <functional>
 #include <numeric>
@@ -41,7 +42,7 @@ std::vector<std::string> GenerateNRandomString(int n) {
   return rand_strs;
 }
 
-TEST(StarterTest, DISABLED_TrieNodeInsertTest) {
+TEST(StarterTest, TrieNodeInsertTest) {
   // Test Insert
   //  When same key is inserted twice, insert should return nullptr
   // When inserted key and unique_ptr's key does not match, return nullptr
@@ -60,7 +61,7 @@ TEST(StarterTest, DISABLED_TrieNodeInsertTest) {
   EXPECT_EQ((*child_node)->GetKeyChar(), 'c');
 }
 
-TEST(StarterTest, DISABLED_TrieNodeRemoveTest) {
+TEST(StarterTest, TrieNodeRemoveTest) {
   auto t = TrieNode('a');
   __attribute__((unused)) auto child_node = t.InsertChildNode('b', std::make_unique<TrieNode>('b'));
   child_node = t.InsertChildNode('c', std::make_unique<TrieNode>('c'));
@@ -78,7 +79,7 @@ TEST(StarterTest, DISABLED_TrieNodeRemoveTest) {
   EXPECT_EQ(child_node, nullptr);
 }
 
-TEST(StarterTest, DISABLED_TrieInsertTest) {
+TEST(StarterTest, TrieInsertTest) {
   {
     Trie trie;
     trie.Insert<std::string>("abc", "d");
@@ -129,7 +130,7 @@ TEST(StarterTest, DISABLED_TrieInsertTest) {
   }
 }
 
-TEST(StarterTrieTest, DISABLED_RemoveTest) {
+TEST(StarterTrieTest, RemoveTest) {
   {
     Trie trie;
     bool success = trie.Insert<int>("a", 5);
@@ -162,7 +163,7 @@ TEST(StarterTrieTest, DISABLED_RemoveTest) {
   }
 }
 
-TEST(StarterTrieTest, DISABLED_ConcurrentTest1) {
+TEST(StarterTrieTest, ConcurrentTest1) {
   Trie trie;
   constexpr int num_words = 1000;
   constexpr int num_bits = 10;
@@ -199,4 +200,120 @@ TEST(StarterTrieTest, DISABLED_ConcurrentTest1) {
   threads.clear();
 }
 
+TEST(StarterTrieTest, NodeLayoutTest) {
+  // a node grows through every layout and shrinks back, and keeps its children in key char order
+  auto t = TrieNode('a');
+  std::vector<int> key_chars(256);
+  std::iota(key_chars.begin(), key_chars.end(), 0);
+  std::shuffle(key_chars.begin(), key_chars.end(), std::mt19937(15445));
+  for (auto key_char : key_chars) {
+    auto c = static_cast<char>(key_char);
+    auto child = t.InsertChildNode(c, std::make_unique<TrieNode>(c));
+    ASSERT_NE(child, nullptr);
+    EXPECT_EQ((*child)->GetKeyChar(), static_cast<char>(key_char));
+  }
+  EXPECT_EQ(t.GetChildCount(), 256);
+  for (auto key_char : key_chars) {
+    if (key_char % 7 != 0) {
+      t.RemoveChildNode(static_cast<char>(key_char));
+    }
+    EXPECT_EQ(t.HasChild(static_cast<char>(key_char)), key_char % 7 == 0);
+  }
+  EXPECT_EQ(t.GetChildCount(), 37);
+  for (int key_char = 0; key_char < 256; key_char++) {
+    auto child = t.GetChildNode(static_cast<char>(key_char));
+    ASSERT_EQ(child != nullptr, key_char % 7 == 0);
+  }
+  for (auto key_char : key_chars) {
+    t.RemoveChildNode(static_cast<char>(key_char));
+  }
+  EXPECT_EQ(t.HasChildren(), false);
+}
+
+TEST(StarterTrieTest, ScanTest) {
+  Trie trie;
+  std::vector<std::string> keys{"a", "ab", "abc", "abd", "b", "ba", "\xff", "\xff\x01"};
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_TRUE(trie.Insert<int>(keys[i], static_cast<int>(i)));
+  }
+  // a key of another type is skipped
+  EXPECT_TRUE(trie.Insert<std::string>("abe", "e"));
+
+  std::vector<std::pair<std::string, int>> entries;
+  trie.ScanForward<int>("", nullptr, SIZE_MAX, &entries);
+  ASSERT_EQ(entries.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(entries[i].first, keys[i]);
+    EXPECT_EQ(entries[i].second, static_cast<int>(i));
+  }
+
+  // the keys that start with a prefix, a batch at a time in both directions
+  std::vector<std::pair<std::string, int>> forward;
+  while (true) {
+    auto size = forward.size();
+    trie.ScanForward<int>("ab", forward.empty() ? nullptr : &forward.back().first, size + 2, &forward);
+    if (forward.size() == size) {
+      break;
+    }
+  }
+  std::vector<std::pair<std::string, int>> backward;
+  while (true) {
+    auto size = backward.size();
+    trie.ScanBackward<int>("ab", backward.empty() ? nullptr : &backward.back().first, size + 2, &backward);
+    if (backward.size() == size) {
+      break;
+    }
+  }
+  std::vector<std::pair<std::string, int>> expected{{"ab", 1}, {"abc", 2}, {"abd", 3}};
+  EXPECT_EQ(forward, expected);
+  std::reverse(backward.begin(), backward.end());
+  EXPECT_EQ(backward, expected);
+
+  entries.clear();
+  trie.ScanForward<int>("c", nullptr, SIZE_MAX, &entries);
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST(StarterTrieTest, ConcurrentInsertRemoveTest) {
+  Trie trie;
+  constexpr int num_keys = 2000;
+  auto make_key = [](int i) { return std::to_string(i * 7919 % 10007); };
+
+  // writers insert and remove keys that share prefixes with each other's, while readers look up and scan
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = t; i < num_keys; i += 4) {
+        EXPECT_TRUE(trie.Insert<int>(make_key(i), i));
+        if (i % 8 >= 4) {
+          EXPECT_TRUE(trie.Remove(make_key(i - 4)));
+        }
+      }
+    });
+  }
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&]() {
+      for (int round = 0; round < 20; round++) {
+        std::vector<std::pair<std::string, int>> entries;
+        trie.ScanForward<int>("", nullptr, SIZE_MAX, &entries);
+        EXPECT_TRUE(std::is_sorted(entries.begin(), entries.end()));
+        bool success;
+        trie.GetValue<int>(make_key(round), &success);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_keys; i++) {
+    bool success;
+    auto value = trie.GetValue<int>(make_key(i), &success);
+    EXPECT_EQ(success, i % 8 >= 4) << i;
+    if (success) {
+      EXPECT_EQ(value, i);
+    }
+  }
+}
+
 }  // namespace bustub
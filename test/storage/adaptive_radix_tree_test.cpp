@@ -0,0 +1,255 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_test.cpp
+//
+// Identification: test/storage/adaptive_radix_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/index/adaptive_radix_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using ARTType = AdaptiveRadixTree<GenericKey<8>, RID, MemcmpComparator<8>>;
+
+/** @return the normalized key of a bigint */
+auto MakeBigintKey(int64_t value, const Schema &key_schema) -> GenericKey<8> {
+  GenericKey<8> key;
+  std::vector<Value> values{ValueFactory::GetBigIntValue(value)};
+  key.SetFromKey(Tuple(values, &key_schema), key_schema);
+  return key;
+}
+
+auto KeyValue(const GenericKey<8> &key, const Schema &key_schema) -> int64_t {
+  return key.ToValues(key_schema)[0].GetAs<int64_t>();
+}
+
+/** @return the keys and slot numbers of the entries of tree, in key order */
+auto ScanEntries(ARTType *tree, const Schema &key_schema) -> std::vector<std::pair<int64_t, int64_t>> {
+  std::vector<std::pair<int64_t, int64_t>> entries;
+  for (auto iter = tree->Begin(); !iter.IsEnd(); ++iter) {
+    entries.emplace_back(KeyValue((*iter).first, key_schema), (*iter).second.GetSlotNum());
+  }
+  return entries;
+}
+
+TEST(AdaptiveRadixTreeTests, InsertRemoveTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  ARTType tree;
+  std::vector<RID> rids;
+
+  // keys from dense ones, whose last bytes fill node256s, to sparse ones that share only their first bytes
+  std::vector<int64_t> keys;
+  for (int64_t i = -1000; i < 1000; i++) {
+    keys.push_back(i);
+  }
+  std::mt19937_64 gen(15445);
+  for (int i = 0; i < 2000; i++) {
+    keys.push_back(static_cast<int64_t>(gen() >> 1) * (i % 2 == 0 ? 1 : -1));
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  auto shuffled = keys;
+  std::shuffle(shuffled.begin(), shuffled.end(), gen);
+
+  // every even key has a second value
+  for (auto key : shuffled) {
+    auto index_key = MakeBigintKey(key, *key_schema);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, 1)));
+    if (key % 2 == 0) {
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, 2)));
+    }
+    EXPECT_FALSE(tree.Insert(index_key, RID(0, 1)));
+  }
+  std::vector<std::pair<int64_t, int64_t>> expected;
+  for (auto key : keys) {
+    expected.emplace_back(key, 1);
+    if (key % 2 == 0) {
+      expected.emplace_back(key, 2);
+    }
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(MakeBigintKey(key, *key_schema), &rids)) << key;
+    ASSERT_EQ(rids.size(), key % 2 == 0 ? 2 : 1) << key;
+  }
+  rids.clear();
+  EXPECT_FALSE(tree.GetValue(MakeBigintKey(1000, *key_schema), &rids));
+  EXPECT_EQ(ScanEntries(&tree, *key_schema), expected);
+
+  // a backward scan from the end, and a scan from a key that is not in the tree
+  std::vector<std::pair<int64_t, int64_t>> backward;
+  auto iter = tree.End();
+  while (!iter.IsBegin()) {
+    --iter;
+    backward.emplace_back(KeyValue((*iter).first, *key_schema), (*iter).second.GetSlotNum());
+  }
+  std::reverse(backward.begin(), backward.end());
+  EXPECT_EQ(backward, expected);
+  auto from_key = tree.Begin(MakeBigintKey(1000, *key_schema));
+  ASSERT_FALSE(from_key.IsEnd());
+  EXPECT_EQ(KeyValue((*from_key).first, *key_schema), *std::upper_bound(keys.begin(), keys.end(), 1000));
+
+  // a scan of the keys whose first seven bytes are those of 256, which are 256 to 511
+  std::vector<int64_t> prefix_keys;
+  for (auto prefix_iter = tree.Begin(MakeBigintKey(256, *key_schema), 7); !prefix_iter.IsEnd(); ++prefix_iter) {
+    prefix_keys.push_back(KeyValue((*prefix_iter).first, *key_schema));
+  }
+  EXPECT_EQ(prefix_keys.size(), 256 + 128);
+  EXPECT_EQ(prefix_keys.front(), 256);
+  EXPECT_EQ(prefix_keys.back(), 511);
+
+  // remove the first values of every third key and both values of every fifth key, so that nodes shrink and merge
+  for (auto key : shuffled) {
+    auto index_key = MakeBigintKey(key, *key_schema);
+    if (key % 3 == 0) {
+      EXPECT_TRUE(tree.Remove(index_key, RID(0, 1)));
+    }
+    if (key % 5 == 0) {
+      EXPECT_EQ(tree.Remove(index_key, RID(0, 1)), key % 3 != 0);
+      EXPECT_TRUE(tree.Remove(index_key, RID(0, 2)) || key % 2 != 0);
+    }
+  }
+  expected.clear();
+  for (auto key : keys) {
+    if (key % 3 != 0 && key % 5 != 0) {
+      expected.emplace_back(key, 1);
+    }
+    if (key % 2 == 0 && key % 5 != 0) {
+      expected.emplace_back(key, 2);
+    }
+  }
+  EXPECT_EQ(ScanEntries(&tree, *key_schema), expected);
+
+  // the same entries, loaded at once
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  for (auto [key, slot] : expected) {
+    entries.emplace_back(MakeBigintKey(key, *key_schema), RID(0, slot));
+  }
+  std::shuffle(entries.begin(), entries.end(), gen);
+  ARTType loaded;
+  loaded.BulkLoad(std::move(entries));
+  EXPECT_EQ(ScanEntries(&loaded, *key_schema), expected);
+
+  // once every entry is removed, neither scan direction finds one
+  for (auto key : keys) {
+    auto index_key = MakeBigintKey(key, *key_schema);
+    tree.Remove(index_key, RID(0, 1));
+    tree.Remove(index_key, RID(0, 2));
+  }
+  EXPECT_TRUE(tree.Begin().IsEnd());
+  EXPECT_TRUE(tree.End().IsBegin());
+}
+
+TEST(AdaptiveRadixTreeTests, ConcurrentInsertScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  ARTType tree;
+
+  // writers insert and remove disjoint keys while readers look them up and scan
+  const int64_t per_thread = 5000;
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<RID> rids;
+      for (int64_t i = 0; i < per_thread; i++) {
+        auto index_key = MakeBigintKey(i * 4 + t, *key_schema);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, i * 4 + t)));
+        rids.clear();
+        EXPECT_TRUE(tree.GetValue(index_key, &rids));
+        if (i % 2 == 1) {
+          index_key = MakeBigintKey((i - 1) * 4 + t, *key_schema);
+          EXPECT_TRUE(tree.Remove(index_key, RID(0, (i - 1) * 4 + t)));
+          rids.clear();
+          EXPECT_FALSE(tree.GetValue(index_key, &rids));
+        }
+      }
+    });
+  }
+  for (int64_t t = 0; t < 2; t++) {
+    threads.emplace_back([&]() {
+      for (int round = 0; round < 20; round++) {
+        auto entries = ScanEntries(&tree, *key_schema);
+        EXPECT_TRUE(std::is_sorted(entries.begin(), entries.end()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // only the keys of odd i are left
+  std::vector<std::pair<int64_t, int64_t>> expected;
+  for (int64_t key = 0; key < per_thread * 4; key++) {
+    if ((key / 4) % 2 == 1) {
+      expected.emplace_back(key, key);
+    }
+  }
+  EXPECT_EQ(ScanEntries(&tree, *key_schema), expected);
+}
+
+TEST(AdaptiveRadixTreeTests, RebuildTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  Transaction txn(0);
+  {
+    Catalog catalog(bpm, nullptr, nullptr);
+    Schema schema({Column("a", TypeId::BIGINT), Column("b", TypeId::INTEGER)});
+    auto *table_info = catalog.CreateTable(&txn, "t", schema);
+    auto insert = [&](int64_t a) {
+      RID rid;
+      std::vector<Value> values{ValueFactory::GetBigIntValue(a), ValueFactory::GetIntegerValue(0)};
+      ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+    };
+    for (int64_t a = 0; a < 100; a++) {
+      insert(a);
+    }
+
+    // the index is filled from the table when it is made
+    auto key_schema = Schema::CopySchema(&schema, {0});
+    auto *index_info = catalog.CreateIndex<GenericKey<8>, RID, MemcmpComparator<8>>(
+        &txn, "t_a", "t", schema, key_schema, {0}, 8, HashFunction<GenericKey<8>>(), false, true, true,
+        IndexType::AdaptiveRadixTree);
+    ASSERT_TRUE(index_info->index_->IsInMemory());
+    auto count = [&]() {
+      size_t entries = 0;
+      for (auto iter = index_info->index_->GetScanIterator(false); !iter->IsEnd(); iter->Next()) {
+        entries++;
+      }
+      return entries;
+    };
+    EXPECT_EQ(count(), 100);
+
+    // tuples that were not indexed, as if the index was lost when the database stopped, are found after a rebuild
+    for (int64_t a = 100; a < 150; a++) {
+      insert(a);
+    }
+    EXPECT_EQ(count(), 100);
+    catalog.RebuildInMemoryIndexes(&txn);
+    EXPECT_EQ(count(), 150);
+    std::vector<RID> rids;
+    std::vector<Value> key_values{ValueFactory::GetBigIntValue(120)};
+    index_info->index_->ScanKey(Tuple(key_values, &key_schema), &rids, &txn);
+    EXPECT_EQ(rids.size(), 1);
+  }
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
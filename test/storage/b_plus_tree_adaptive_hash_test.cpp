@@ -0,0 +1,195 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_adaptive_hash_test.cpp
+//
+// Identification: test/storage/b_plus_tree_adaptive_hash_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using HashedTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+TEST(BPlusTreeTests, AdaptiveHashTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so the cached leaves split and merge under the hash index
+  HashedTree tree("foo_pk", bpm, comparator, 5, 4);
+  tree.EnableAdaptiveHash(64, 2);
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  const int64_t n = 300;
+  std::vector<int64_t> keys(n);
+  for (int64_t i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+
+  auto check = [&](auto present) {
+    for (int64_t key = 0; key < n; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_EQ(tree.GetValue(index_key, &rids), present(key)) << key;
+      if (present(key)) {
+        ASSERT_EQ(rids.size(), 1);
+        ASSERT_EQ(rids[0].GetSlotNum(), key);
+        auto iter = tree.Begin(index_key);
+        ASSERT_FALSE(iter.IsEnd());
+        ASSERT_EQ((*iter).second.GetSlotNum(), key);
+      }
+    }
+  };
+
+  // a few hot keys are looked up over and over, and then answered from the hash index
+  for (int round = 0; round < 10; round++) {
+    for (int64_t key = 0; key < 20; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+  }
+  EXPECT_GT(tree.GetAdaptiveHash()->GetHitCount(), 0);
+  check([](int64_t /*key*/) { return true; });
+  check([](int64_t /*key*/) { return true; });
+
+  // the inserts split the cached leaves, the removes shift the slots and merge the leaves
+  for (int64_t key = n; key < 2 * n; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+  for (int64_t key = n; key < 2 * n; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  check([](int64_t /*key*/) { return true; });
+  for (auto key : keys) {
+    if (key % 3 == 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  check([](int64_t key) { return key % 3 != 0; });
+  check([](int64_t key) { return key % 3 != 0; });
+
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  check([](int64_t /*key*/) { return false; });
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ConcurrentAdaptiveHashTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  {
+    HashedTree tree("foo_pk", bpm, comparator, 5, 4);
+    tree.EnableAdaptiveHash(64, 2);
+
+    // the even keys stay in the tree and are read over and over, while writers churn the odd keys around them
+    const int64_t n = 400;
+    Transaction setup(0);
+    GenericKey<8> setup_key;
+    for (int64_t key = 0; key < n; key += 2) {
+      setup_key.SetFromInteger(key);
+      tree.Insert(setup_key, RID(0, key), &setup);
+    }
+
+    std::vector<std::thread> threads;
+    for (int64_t t = 0; t < 2; t++) {
+      threads.emplace_back([&, t]() {
+        GenericKey<8> index_key;
+        Transaction transaction(t + 1);
+        for (int round = 0; round < 5; round++) {
+          for (int64_t key = 1 + 2 * t; key < n; key += 4) {
+            index_key.SetFromInteger(key);
+            tree.Insert(index_key, RID(0, key), &transaction);
+          }
+          for (int64_t key = 1 + 2 * t; key < n; key += 4) {
+            index_key.SetFromInteger(key);
+            tree.Remove(index_key, &transaction);
+          }
+        }
+      });
+    }
+    for (int64_t t = 0; t < 2; t++) {
+      threads.emplace_back([&]() {
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        for (int round = 0; round < 20; round++) {
+          for (int64_t key = 0; key < 40; key += 2) {
+            rids.clear();
+            index_key.SetFromInteger(key);
+            ASSERT_TRUE(tree.GetValue(index_key, &rids)) << key;
+            ASSERT_EQ(rids.size(), 1);
+            EXPECT_EQ(rids[0].GetSlotNum(), key);
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::vector<RID> rids;
+    for (int64_t key = 0; key < n; key++) {
+      rids.clear();
+      setup_key.SetFromInteger(key);
+      EXPECT_EQ(tree.GetValue(setup_key, &rids), key % 2 == 0) << key;
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
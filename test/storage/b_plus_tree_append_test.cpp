@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_append_test.cpp
+//
+// Identification: test/storage/b_plus_tree_append_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using AppendTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using AppendLeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using AppendInternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+/** @return the sizes of the leaves of tree, from left to right */
+auto LeafSizes(AppendTree *tree, BufferPoolManager *bpm) -> std::vector<int> {
+  std::vector<int> sizes;
+  auto page_id = tree->GetRootPageId();
+  auto *node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  while (!node->IsLeafPage()) {
+    auto child_id = reinterpret_cast<AppendInternalPage *>(node)->ValueAt(0);
+    bpm->UnpinPage(page_id, false);
+    page_id = child_id;
+    node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  }
+  while (true) {
+    auto *leaf = reinterpret_cast<AppendLeafPage *>(node);
+    sizes.push_back(leaf->GetSize());
+    auto next_id = leaf->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    if (next_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page_id = next_id;
+    node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  }
+  return sizes;
+}
+
+TEST(BPlusTreeTests, SequentialInsertTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  AppendTree tree("foo_pk", bpm, comparator, 5, 4);
+  AppendTree shuffled_tree("foo_pk_shuffled", bpm, comparator, 5, 4);
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  const int64_t n = 1000;
+  for (int64_t key = 1; key <= n; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+  std::vector<int64_t> keys(n);
+  for (int64_t i = 0; i < n; i++) {
+    keys[i] = i + 1;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(shuffled_tree.Insert(index_key, RID(0, key), transaction));
+  }
+
+  // the appends leave every leaf but the last one packed
+  auto sizes = LeafSizes(&tree, bpm);
+  for (size_t i = 0; i + 1 < sizes.size(); i++) {
+    EXPECT_EQ(sizes[i], 4);
+  }
+  EXPECT_EQ(sizes.size(), n / 4);
+  EXPECT_LT(sizes.size(), LeafSizes(&shuffled_tree, bpm).size());
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= n; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  int64_t expected = 1;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ((*iter).second.GetSlotNum(), expected);
+    expected++;
+  }
+  EXPECT_EQ(expected, n + 1);
+
+  // keys below the right edge and duplicates of the last key take the regular path
+  index_key.SetFromInteger(n);
+  EXPECT_FALSE(tree.Insert(index_key, RID(0, n), transaction));
+  index_key.SetFromInteger(0);
+  EXPECT_TRUE(tree.Insert(index_key, RID(0, 0), transaction));
+
+  // merges free leaves at the right edge, later appends must not go to them
+  for (int64_t key = n; key > n / 2; key--) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  for (int64_t key = n / 2 + 1; key <= n + 10; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+  expected = 0;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ((*iter).second.GetSlotNum(), expected);
+    expected++;
+  }
+  EXPECT_EQ(expected, n + 11);
+
+  for (int64_t key = 0; key <= n + 10; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
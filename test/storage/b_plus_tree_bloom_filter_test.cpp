@@ -0,0 +1,211 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bloom_filter_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bloom_filter_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/bloom_filter.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using FilteredTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+TEST(BloomFilterTests, FalsePositiveTest) {
+  std::mt19937_64 gen(15445);
+  std::vector<uint64_t> hashes(20000);
+  for (auto &hash : hashes) {
+    hash = gen();
+  }
+
+  // a filter sized for far fewer keys grows layers as they come, and never forgets one
+  BloomFilter filter(1000);
+  for (size_t i = 0; i < hashes.size() / 2; i++) {
+    filter.Insert(hashes[i]);
+  }
+  EXPECT_EQ(filter.GetKeyCount(), hashes.size() / 2);
+  EXPECT_GT(filter.GetLayerCount(), 1);
+  for (size_t i = 0; i < hashes.size() / 2; i++) {
+    ASSERT_TRUE(filter.MayContain(hashes[i])) << i;
+  }
+  EXPECT_EQ(filter.GetSkipCount(), 0);
+
+  // the hashes that were not inserted are mostly ruled out, a few more than once in a hundred as every layer is asked
+  size_t false_positives = 0;
+  for (size_t i = hashes.size() / 2; i < hashes.size(); i++) {
+    false_positives += filter.MayContain(hashes[i]) ? 1 : 0;
+  }
+  EXPECT_LT(false_positives, hashes.size() / 2 / 20);
+  EXPECT_EQ(filter.GetSkipCount(), hashes.size() / 2 - false_positives);
+
+  // filled again in one layer sized for the keys, it answers as well with less to ask
+  filter.Clear(hashes.size() / 2);
+  EXPECT_EQ(filter.GetKeyCount(), 0);
+  EXPECT_EQ(filter.GetLayerCount(), 1);
+  EXPECT_FALSE(filter.MayContain(hashes[0]));
+  for (size_t i = 0; i < hashes.size() / 2; i++) {
+    filter.Insert(hashes[i]);
+  }
+  EXPECT_EQ(filter.GetLayerCount(), 1);
+  false_positives = 0;
+  for (size_t i = hashes.size() / 2; i < hashes.size(); i++) {
+    false_positives += filter.MayContain(hashes[i]) ? 1 : 0;
+  }
+  EXPECT_LT(false_positives, hashes.size() / 2 / 50);
+}
+
+TEST(BPlusTreeTests, BloomFilterTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  FilteredTree tree("foo_pk", bpm, comparator);
+  tree.EnableBloomFilter(64);
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  // the even keys are in the tree
+  const int64_t n = 1000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < n; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+
+  auto check = [&](auto present) {
+    for (int64_t key = 0; key < n; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_EQ(tree.GetValue(index_key, &rids), present(key)) << key;
+      if (present(key)) {
+        ASSERT_EQ(rids.size(), 1);
+        ASSERT_EQ(rids[0].GetSlotNum(), key);
+      }
+    }
+  };
+
+  // most lookups of the odd keys return before they read a page
+  check([](int64_t key) { return key % 2 == 0; });
+  auto *filter = tree.GetBloomFilter();
+  ASSERT_NE(filter, nullptr);
+  EXPECT_GT(filter->GetLayerCount(), 1);
+  EXPECT_GT(filter->GetSkipCount(), n / 2 * 9 / 10);
+
+  // removed keys are still in the filter, so their lookups read the tree, until it is rebuilt
+  for (auto key : keys) {
+    if (key % 4 == 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  auto skips = filter->GetSkipCount();
+  check([](int64_t key) { return key % 4 == 2; });
+  EXPECT_LT(filter->GetSkipCount() - skips, n / 2 + n / 4);
+  tree.RebuildBloomFilter();
+  EXPECT_EQ(filter->GetLayerCount(), 1);
+  EXPECT_EQ(filter->GetKeyCount(), n / 4);
+  skips = filter->GetSkipCount();
+  check([](int64_t key) { return key % 4 == 2; });
+  EXPECT_GT(filter->GetSkipCount() - skips, (n / 2 + n / 4) * 9 / 10);
+
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  check([](int64_t /*key*/) { return false; });
+  tree.RebuildBloomFilter();
+  EXPECT_EQ(filter->GetKeyCount(), 0);
+  check([](int64_t /*key*/) { return false; });
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ConcurrentBloomFilterTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  {
+    FilteredTree tree("foo_pk", bpm, comparator);
+    tree.EnableBloomFilter(16);
+
+    // writers insert disjoint keys, growing the filter, while readers look up each key right after its writer
+    const int64_t per_thread = 1000;
+    std::vector<std::thread> threads;
+    for (int64_t t = 0; t < 4; t++) {
+      threads.emplace_back([&, t]() {
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        Transaction transaction(t + 1);
+        for (int64_t i = 0; i < per_thread; i++) {
+          index_key.SetFromInteger(i * 4 + t);
+          tree.Insert(index_key, RID(0, i * 4 + t), &transaction);
+          rids.clear();
+          ASSERT_TRUE(tree.GetValue(index_key, &rids)) << i * 4 + t;
+          index_key.SetFromInteger(-(i * 4 + t) - 1);
+          rids.clear();
+          EXPECT_FALSE(tree.GetValue(index_key, &rids));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    for (int64_t key = 0; key < per_thread * 4; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids)) << key;
+    }
+    EXPECT_EQ(tree.GetBloomFilter()->GetKeyCount(), per_thread * 4);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_change_buffer_test.cpp
+//
+// Identification: test/storage/b_plus_tree_change_buffer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BufferedTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** @return the slot numbers of the values of tree, in key order */
+auto ScanSlots(BufferedTree *tree) -> std::vector<int64_t> {
+  std::vector<int64_t> slots;
+  for (auto iter = tree->Begin(); !iter.IsEnd(); ++iter) {
+    slots.push_back((*iter).second.GetSlotNum());
+  }
+  return slots;
+}
+
+TEST(BPlusTreeTests, ChangeBufferTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  // a pool much smaller than the tree, so that most leaves are on disk
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(20, disk_manager);
+  BufferedTree tree("foo_pk", bpm, comparator, 5, 4);
+  tree.EnableChangeBuffer(64);
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  const int64_t n = 1000;
+  std::vector<int64_t> keys(n);
+  for (int64_t i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  size_t max_buffered = 0;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+    max_buffered = std::max(max_buffered, tree.GetBufferedChangeCount());
+  }
+  EXPECT_GT(max_buffered, 0);
+  EXPECT_LT(max_buffered, 64);
+
+  // a lookup merges the changes of its key, the others stay deferred
+  for (int64_t key = 0; key < n; key += 7) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids)) << key;
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  // a scan merges all of them
+  std::vector<int64_t> expected(n);
+  for (int64_t i = 0; i < n; i++) {
+    expected[i] = i;
+  }
+  EXPECT_EQ(ScanSlots(&tree), expected);
+  EXPECT_EQ(tree.GetBufferedChangeCount(), 0);
+
+  // the changes of a key apply in the order they came in, also when some are deferred
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    if (key % 3 == 0) {
+      EXPECT_TRUE(tree.Insert(index_key, RID(1, key), transaction));
+      tree.Remove(index_key, RID(0, key), transaction);
+    } else if (key % 3 == 1) {
+      tree.Remove(index_key, transaction);
+      EXPECT_TRUE(tree.Insert(index_key, RID(2, key), transaction));
+    } else {
+      tree.Remove(index_key, transaction);
+    }
+  }
+  for (int64_t key = 0; key < n; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(tree.GetValue(index_key, &rids), key % 3 != 2) << key;
+    if (key % 3 != 2) {
+      ASSERT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0].GetPageId(), key % 3 == 0 ? 1 : 2) << key;
+    }
+  }
+  expected.erase(std::remove_if(expected.begin(), expected.end(), [](auto key) { return key % 3 == 2; }),
+                 expected.end());
+  EXPECT_EQ(ScanSlots(&tree), expected);
+
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  tree.MergeChangeBuffer();
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BackgroundMergeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  {
+    BufferedTree tree("foo_pk", bpm, comparator, 5, 4);
+    tree.EnableChangeBuffer(256, std::chrono::milliseconds(1));
+
+    // inserts and removes of disjoint keys, while the merger runs and readers look keys up
+    const int64_t per_thread = 1000;
+    std::vector<std::thread> threads;
+    for (int64_t t = 0; t < 4; t++) {
+      threads.emplace_back([&, t]() {
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        Transaction transaction(t);
+        for (int64_t i = 0; i < per_thread; i++) {
+          index_key.SetFromInteger(i * 4 + t);
+          tree.Insert(index_key, RID(0, i * 4 + t), &transaction);
+          if (i % 2 == 1) {
+            index_key.SetFromInteger((i - 1) * 4 + t);
+            tree.Remove(index_key, &transaction);
+            rids.clear();
+            EXPECT_FALSE(tree.GetValue(index_key, &rids));
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // only the keys of odd i are left
+    std::vector<int64_t> expected;
+    for (int64_t key = 0; key < per_thread * 4; key++) {
+      if ((key / 4) % 2 == 1) {
+        expected.push_back(key);
+      }
+    }
+    EXPECT_EQ(ScanSlots(&tree), expected);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compression_test.cpp
+//
+// Identification: test/storage/b_plus_tree_compression_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TEST(BPlusTreeTests, KeyStoreTest) {
+  using KeyStore = BPlusTreeKeyStore<GenericKey<64>, RID>;
+  std::vector<char> buf(1024);
+  auto *store = reinterpret_cast<KeyStore *>(buf.data());
+  store->Init(buf.size());
+
+  // keys share their first 40 bytes and differ in the next one
+  auto make_key = [](int i) {
+    GenericKey<64> key;
+    memset(key.data_, 'a', 40);
+    key.data_[40] = static_cast<char>('A' + i);
+    memset(key.data_ + 41, 0, 23);
+    return key;
+  };
+  for (int i = 0; i < 10; i++) {
+    store->Insert(i, i, make_key(i), RID(i, i));
+  }
+  store->Compact(10);
+  // the common prefix is stored once, every key keeps a single byte
+  EXPECT_EQ(store->UsedSpace(10), KeyStore::HEADER_SIZE + 10 * sizeof(KeyStore::Slot) + 40 + 10);
+  for (int i = 0; i < 10; i++) {
+    auto key = store->KeyAt(i);
+    EXPECT_EQ(memcmp(key.data_, make_key(i).data_, 64), 0);
+    EXPECT_EQ(store->ValueAt(i), RID(i, i));
+  }
+
+  // a key without the prefix is stored in full and keeps the others intact
+  GenericKey<64> other;
+  memset(other.data_, 0, 64);
+  other.data_[0] = 'b';
+  store->Insert(10, 10, other, RID(10, 10));
+  EXPECT_EQ(memcmp(store->KeyAt(10).data_, other.data_, 64), 0);
+  EXPECT_EQ(memcmp(store->KeyAt(3).data_, make_key(3).data_, 64), 0);
+
+  store->Remove(0, 11);
+  EXPECT_EQ(memcmp(store->KeyAt(0).data_, make_key(1).data_, 64), 0);
+
+  // the separator sorts after the left key and not after the right one
+  auto separator = KeyStore::ShortestSeparator(make_key(1), make_key(2));
+  EXPECT_GT(memcmp(separator.data_, make_key(1).data_, 64), 0);
+  EXPECT_LE(memcmp(separator.data_, make_key(2).data_, 64), 0);
+  EXPECT_EQ(KeyStore::TrimmedLength(separator), 41);
+}
+
+TEST(BPlusTreeTests, CompressedKeyTest1) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<64> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree with the default page sizes
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", bpm, comparator);
+  GenericKey<64> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  // two column keys, the first column is shared by long runs of keys
+  auto set_key = [&](int64_t i) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue(i / 1000), ValueFactory::GetBigIntValue(i % 1000)};
+    Tuple tuple(values, key_schema.get());
+    index_key.SetFromKey(tuple);
+  };
+  std::vector<int64_t> keys(5000);
+  for (int64_t i = 0; i < static_cast<int64_t>(keys.size()); i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    set_key(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(key >> 16, key & 0xFFFF), transaction));
+  }
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    set_key(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key & 0xFFFF);
+  }
+
+  // the iterator yields the keys in order, and a leaf holds more keys than the fixed layout could
+  int64_t expected = 0;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ((*iter).second.GetSlotNum(), expected & 0xFFFF);
+    expected++;
+  }
+  EXPECT_EQ(expected, keys.size());
+  auto *root = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(tree.GetRootPageId())->GetData());
+  ASSERT_FALSE(root->IsLeafPage());
+  auto leaf_page_id = reinterpret_cast<BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>> *>(root)
+                          ->ValueAt(0);
+  bpm->UnpinPage(root->GetPageId(), false);
+  auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>> *>(
+      bpm->FetchPage(leaf_page_id)->GetData());
+  EXPECT_TRUE(leaf->IsLeafPage());
+  EXPECT_GT(leaf->GetSize(), static_cast<int>(LEAF_PAGE_DATA_SIZE / sizeof(std::pair<GenericKey<64>, RID>)));
+  bpm->UnpinPage(leaf_page_id, false);
+
+  // remove most keys, the tree merges its pages back
+  for (size_t i = 0; i + 10 < keys.size(); i++) {
+    set_key(keys[i]);
+    tree.Remove(index_key, transaction);
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    rids.clear();
+    set_key(keys[i]);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), i + 10 >= keys.size());
+  }
+  int64_t remaining = 0;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    remaining++;
+  }
+  EXPECT_EQ(remaining, 10);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
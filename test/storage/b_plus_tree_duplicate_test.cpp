@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_duplicate_test.cpp
+//
+// Identification: test/storage/b_plus_tree_duplicate_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+TEST(BPlusTreeTests, DuplicateKeyTest1) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 5);
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  // keys 1..10, key 5 is shared by enough tuples to spill over several posting pages
+  const int dup_count = 3000;
+  std::vector<RID> dup_rids;
+  for (int64_t key = 1; key <= 10; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+  index_key.SetFromInteger(5);
+  dup_rids.emplace_back(0, 5);
+  for (int i = 0; i < dup_count; i++) {
+    // scatter the rids so insertions land in the middle of the chain too
+    RID rid(1 + (i * 7919) % 997, i);
+    dup_rids.push_back(rid);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  // the exact same pair is rejected
+  EXPECT_FALSE(tree.Insert(index_key, dup_rids[42], transaction));
+
+  std::vector<RID> rids;
+  EXPECT_TRUE(tree.GetValue(index_key, &rids));
+  EXPECT_EQ(rids.size(), dup_rids.size());
+  auto rid_less = [](const RID &a, const RID &b) { return a.Get() < b.Get(); };
+  std::sort(dup_rids.begin(), dup_rids.end(), rid_less);
+  EXPECT_EQ(rids, dup_rids);
+
+  // the iterator yields one pair per rid
+  int64_t pairs = 0;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    pairs++;
+  }
+  EXPECT_EQ(pairs, 9 + dup_rids.size());
+
+  // remove the duplicates one by one, the key stays until its last rid is gone
+  for (size_t i = 0; i + 1 < dup_rids.size(); i++) {
+    EXPECT_TRUE(tree.Remove(index_key, dup_rids[i], transaction));
+  }
+  EXPECT_FALSE(tree.Remove(index_key, dup_rids[0], transaction));
+  rids.clear();
+  EXPECT_TRUE(tree.GetValue(index_key, &rids));
+  ASSERT_EQ(rids.size(), 1);
+  EXPECT_EQ(rids[0], dup_rids.back());
+
+  EXPECT_TRUE(tree.Remove(index_key, dup_rids.back(), transaction));
+  rids.clear();
+  EXPECT_FALSE(tree.GetValue(index_key, &rids));
+
+  // other keys are untouched
+  for (int64_t key = 1; key <= 10; key++) {
+    if (key == 5) {
+      continue;
+    }
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0], RID(0, key));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
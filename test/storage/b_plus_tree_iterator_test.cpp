@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_iterator_test.cpp
+//
+// Identification: test/storage/b_plus_tree_iterator_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+TEST(BPlusTreeTests, ReverseIteratorTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so the keys spread over many leaves
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  std::vector<int64_t> keys(500);
+  for (int64_t i = 0; i < static_cast<int64_t>(keys.size()); i++) {
+    keys[i] = i + 1;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key), transaction);
+  }
+  // key 100 has several values, which come back in reverse order too
+  index_key.SetFromInteger(100);
+  for (int i = 1; i <= 3; i++) {
+    tree.Insert(index_key, RID(i, 100), transaction);
+  }
+
+  std::vector<RID> expected;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    expected.push_back((*iter).second);
+  }
+  EXPECT_EQ(expected.size(), keys.size() + 3);
+
+  std::vector<RID> backward;
+  for (auto iter = tree.End(); !iter.IsBegin();) {
+    --iter;
+    backward.push_back((*iter).second);
+  }
+  std::reverse(backward.begin(), backward.end());
+  EXPECT_EQ(backward, expected);
+
+  // the prev links survive the merges of a delete
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    index_key.SetFromInteger(keys[i]);
+    tree.Remove(index_key, transaction);
+  }
+  expected.clear();
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    expected.push_back((*it).second);
+  }
+  backward.clear();
+  for (auto it = tree.End(); !it.IsBegin();) {
+    --it;
+    backward.push_back((*it).second);
+  }
+  std::reverse(backward.begin(), backward.end());
+  EXPECT_EQ(backward, expected);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_key_search_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+template <typename IntType>
+void CheckLowerBound(std::mt19937 *gen) {
+  std::uniform_int_distribution<IntType> dist(std::numeric_limits<IntType>::min(), std::numeric_limits<IntType>::max());
+  for (int size = 0; size < 200; size++) {
+    std::vector<IntType> keys(size);
+    for (auto &key : keys) {
+      // few distinct values, so that runs of equal keys straddle the vector lanes
+      key = size % 2 == 0 ? dist(*gen) : dist(*gen) % 8;
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<IntType> probes{std::numeric_limits<IntType>::min(), std::numeric_limits<IntType>::max(), 0, 3};
+    probes.insert(probes.end(), keys.begin(), keys.end());
+    for (auto probe : probes) {
+      auto expected = std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin();
+      ASSERT_EQ(ScalarLowerBound(keys.data(), size, probe), expected);
+      ASSERT_EQ(SimdLowerBound(keys.data(), size, probe), expected) << size << " " << probe;
+    }
+  }
+}
+
+TEST(BPlusTreeTests, SimdLowerBoundTest) {
+  std::mt19937 gen(15445);
+  CheckLowerBound<int32_t>(&gen);
+  CheckLowerBound<int64_t>(&gen);
+}
+
+TEST(BPlusTreeTests, IntegerLeafTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a integer");
+  MemcmpComparator<4> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small leaves, so the keys spread over many of them
+  BPlusTree<GenericKey<4>, RID, MemcmpComparator<4>> tree("foo_pk", bpm, comparator, 40, 5);
+  GenericKey<4> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  auto set_key = [&](int32_t i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i)};
+    index_key.SetFromKey(Tuple(values, key_schema.get()), *key_schema);
+  };
+  // negative and positive keys, the integer layout must order them like the normalized bytes
+  std::vector<int32_t> keys;
+  for (int32_t i = -1000; i < 1000; i++) {
+    keys.push_back(i * 7);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    set_key(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    set_key(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), static_cast<uint32_t>(key));
+    set_key(key + 1);
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  }
+
+  // the iterator yields the keys in integer order, also from a key that is not in the tree
+  int32_t expected = -7000;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ((*iter).second.GetSlotNum(), static_cast<uint32_t>(expected));
+    expected += 7;
+  }
+  EXPECT_EQ(expected, 7000);
+  set_key(-3);
+  {
+    auto iter = tree.Begin(index_key);
+    EXPECT_EQ((*iter).second.GetSlotNum(), 0);
+  }
+
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    set_key(keys[i]);
+    tree.Remove(index_key, transaction);
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    rids.clear();
+    set_key(keys[i]);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), i % 2 == 1);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_lazy_delete_test.cpp
+//
+// Identification: test/storage/b_plus_tree_lazy_delete_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using LazyTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using LazyLeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using LazyInternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+/** @return the number of leaves of tree */
+auto CountLeaves(LazyTree *tree, BufferPoolManager *bpm) -> int {
+  auto page_id = tree->GetRootPageId();
+  auto *node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  while (!node->IsLeafPage()) {
+    auto child_id = reinterpret_cast<LazyInternalPage *>(node)->ValueAt(0);
+    bpm->UnpinPage(page_id, false);
+    page_id = child_id;
+    node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  }
+  int leaves = 1;
+  auto next_id = reinterpret_cast<LazyLeafPage *>(node)->GetNextPageId();
+  bpm->UnpinPage(page_id, false);
+  while (next_id != INVALID_PAGE_ID) {
+    leaves++;
+    page_id = next_id;
+    next_id = reinterpret_cast<LazyLeafPage *>(bpm->FetchPage(page_id)->GetData())->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+  }
+  return leaves;
+}
+
+/** @return the values of tree in forward and in backward order, the latter reversed */
+auto ScanBothWays(LazyTree *tree) -> std::pair<std::vector<int64_t>, std::vector<int64_t>> {
+  std::vector<int64_t> forward;
+  for (auto iter = tree->Begin(); !iter.IsEnd(); ++iter) {
+    forward.push_back((*iter).second.GetSlotNum());
+  }
+  std::vector<int64_t> backward;
+  for (auto iter = tree->End(); !iter.IsBegin();) {
+    --iter;
+    backward.push_back((*iter).second.GetSlotNum());
+  }
+  std::reverse(backward.begin(), backward.end());
+  return {forward, backward};
+}
+
+TEST(BPlusTreeTests, LazyDeleteTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LazyTree tree("foo_pk", bpm, comparator, 5, 4);
+  tree.EnableLazyDelete();
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  std::vector<int64_t> keys(1000);
+  for (int64_t i = 0; i < static_cast<int64_t>(keys.size()); i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key), transaction);
+  }
+  // a duplicated key loses its values one by one
+  index_key.SetFromInteger(7);
+  tree.Insert(index_key, RID(1, 7), transaction);
+  EXPECT_TRUE(tree.Remove(index_key, RID(0, 7), transaction));
+  EXPECT_FALSE(tree.Remove(index_key, RID(0, 7), transaction));
+  auto leaves = CountLeaves(&tree, bpm);
+
+  // keep every tenth key, most leaves end up empty and stay in the tree
+  std::vector<int64_t> kept;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    if (key % 10 == 0) {
+      kept.push_back(key);
+    } else if (key == 7) {
+      EXPECT_TRUE(tree.Remove(index_key, RID(1, 7), transaction));
+    } else {
+      tree.Remove(index_key, transaction);
+    }
+  }
+  std::sort(kept.begin(), kept.end());
+  EXPECT_EQ(CountLeaves(&tree, bpm), leaves);
+
+  auto check = [&]() {
+    std::vector<RID> rids;
+    for (int64_t key = 0; key < static_cast<int64_t>(keys.size()); key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(tree.GetValue(index_key, &rids), key % 10 == 0);
+    }
+    // the iterators step over the empty leaves in both directions
+    auto [forward, backward] = ScanBothWays(&tree);
+    EXPECT_EQ(forward, kept);
+    EXPECT_EQ(backward, kept);
+  };
+  check();
+
+  tree.Compact();
+  EXPECT_LT(CountLeaves(&tree, bpm) * 4, leaves);
+  check();
+
+  // the compacted tree takes new keys and shrinks to nothing
+  for (auto key : keys) {
+    if (key % 10 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+    }
+  }
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_FALSE(tree.IsEmpty());
+  EXPECT_TRUE(tree.Begin().IsEnd());
+  tree.Compact();
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BackgroundCompactionTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  {
+    LazyTree tree("foo_pk", bpm, comparator, 5, 4);
+    tree.EnableLazyDelete(std::chrono::milliseconds(1));
+
+    // insert and remove churn on disjoint keys, while the compactor runs
+    const int64_t per_thread = 2000;
+    std::vector<std::thread> threads;
+    for (int64_t t = 0; t < 4; t++) {
+      threads.emplace_back([&, t]() {
+        GenericKey<8> index_key;
+        Transaction transaction(t);
+        for (int64_t i = 0; i < per_thread; i++) {
+          index_key.SetFromInteger(t * per_thread + i);
+          tree.Insert(index_key, RID(0, t * per_thread + i), &transaction);
+          if (i >= 10) {
+            index_key.SetFromInteger(t * per_thread + i - 10);
+            tree.Remove(index_key, &transaction);
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    // give the compactor a few hundred of its intervals to catch up, also on a loaded machine
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    // only the last ten keys of each thread are left, and no leaf is left empty; how many share a leaf depends on
+    // how the threads interleaved
+    std::vector<int64_t> expected;
+    for (int64_t t = 0; t < 4; t++) {
+      for (int64_t i = per_thread - 10; i < per_thread; i++) {
+        expected.push_back(t * per_thread + i);
+      }
+    }
+    auto [forward, backward] = ScanBothWays(&tree);
+    EXPECT_EQ(forward, expected);
+    EXPECT_EQ(backward, expected);
+    EXPECT_LE(CountLeaves(&tree, bpm), expected.size());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,222 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_rank_test.cpp
+//
+// Identification: test/storage/b_plus_tree_rank_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using RankTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** Compare the ranks, the size and the seeks by rank of tree with the sorted pairs it holds. */
+void CheckRanks(RankTree *tree, const std::vector<std::pair<int64_t, RID>> &pairs, int64_t max_key) {
+  GenericKey<8> index_key;
+  ASSERT_EQ(tree->Size(), pairs.size());
+  for (int64_t key = -1; key <= max_key + 1; key++) {
+    index_key.SetFromInteger(key);
+    auto less = std::lower_bound(pairs.begin(), pairs.end(), key, [](auto &p, int64_t k) { return p.first < k; });
+    auto not_greater =
+        std::upper_bound(pairs.begin(), pairs.end(), key, [](int64_t k, auto &p) { return k < p.first; });
+    ASSERT_EQ(tree->Rank(index_key), less - pairs.begin()) << key;
+    ASSERT_EQ(tree->Rank(index_key, true), not_greater - pairs.begin()) << key;
+  }
+  for (size_t rank = 0; rank < pairs.size(); rank += 3) {
+    auto iter = tree->BeginAtRank(rank);
+    ASSERT_FALSE(iter.IsEnd());
+    ASSERT_EQ((*iter).second, pairs[rank].second) << rank;
+  }
+  EXPECT_TRUE(tree->BeginAtRank(pairs.size()).IsEnd());
+}
+
+TEST(BPlusTreeTests, RankTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so the counts go through many splits, merges and redistributions
+  RankTree tree("foo_pk", bpm, comparator, 5, 4);
+  tree.EnableSubtreeCounts();
+  EXPECT_THROW(tree.EnableLazyDelete(), Exception);
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  const int64_t n = 500;
+  std::vector<int64_t> keys(n);
+  for (int64_t i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  // every seventh key has three values in a posting chain, sorted by rid
+  std::vector<std::pair<int64_t, RID>> pairs;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    for (int32_t page = 0; page < (key % 7 == 0 ? 3 : 1); page++) {
+      EXPECT_TRUE(tree.Insert(index_key, RID(page, key), transaction));
+      pairs.emplace_back(key, RID(page, key));
+    }
+  }
+  EXPECT_FALSE(tree.Insert(index_key, RID(0, keys.back()), transaction));
+  std::sort(pairs.begin(), pairs.end(),
+            [](auto &a, auto &b) { return a.first != b.first ? a.first < b.first : a.second.Get() < b.second.Get(); });
+  CheckRanks(&tree, pairs, n);
+
+  // remove whole keys and single values of the duplicated keys
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    if (key % 3 == 0) {
+      tree.Remove(index_key, transaction);
+    } else if (key % 7 == 0) {
+      EXPECT_TRUE(tree.Remove(index_key, RID(1, key), transaction));
+    }
+  }
+  auto removed = [](auto &p) { return p.first % 3 == 0 || (p.first % 7 == 0 && p.second.GetPageId() == 1); };
+  pairs.erase(std::remove_if(pairs.begin(), pairs.end(), removed), pairs.end());
+  CheckRanks(&tree, pairs, n);
+
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_EQ(tree.Size(), 0);
+  EXPECT_TRUE(tree.BeginAtRank(0).IsInvaildIndexIter());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, WideKeyRankTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<32> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // wide keys live in the key store, which shares the internal pages with the counts
+  BPlusTree<GenericKey<32>, RID, GenericComparator<32>> tree("foo_pk", bpm, comparator);
+  tree.EnableSubtreeCounts();
+  GenericKey<32> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *transaction = new Transaction(0);
+
+  const int64_t n = 20000;
+  std::vector<int64_t> keys(n);
+  for (int64_t i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+  EXPECT_EQ(tree.Size(), n);
+  for (int64_t key = 0; key < n; key += 97) {
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.Rank(index_key), key);
+    EXPECT_EQ((*tree.BeginAtRank(key)).second.GetSlotNum(), key);
+  }
+  for (int64_t key = 0; key < n; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_EQ(tree.Size(), n / 2);
+  for (int64_t key = 1; key < n; key += 97) {
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.Rank(index_key), key / 2);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ConcurrentRankTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  {
+    RankTree tree("foo_pk", bpm, comparator, 5, 4);
+    tree.EnableSubtreeCounts();
+
+    // interleaved inserts and removes of disjoint keys, while readers ask for ranks
+    const int64_t per_thread = 500;
+    std::vector<std::thread> threads;
+    for (int64_t t = 0; t < 4; t++) {
+      threads.emplace_back([&, t]() {
+        GenericKey<8> index_key;
+        Transaction transaction(t);
+        for (int64_t i = 0; i < per_thread; i++) {
+          index_key.SetFromInteger(i * 4 + t);
+          tree.Insert(index_key, RID(0, i * 4 + t), &transaction);
+          if (i % 2 == 1) {
+            index_key.SetFromInteger((i - 1) * 4 + t);
+            tree.Remove(index_key, &transaction);
+          }
+          EXPECT_LE(tree.Rank(index_key), per_thread * 4);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // only the keys of odd i are left
+    std::vector<std::pair<int64_t, RID>> pairs;
+    for (int64_t key = 0; key < per_thread * 4; key++) {
+      if ((key / 4) % 2 == 1) {
+        pairs.emplace_back(key, RID(0, key));
+      }
+    }
+    CheckRanks(&tree, pairs, per_thread * 4);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
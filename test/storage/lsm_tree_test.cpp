@@ -0,0 +1,203 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lsm_tree_test.cpp
+//
+// Identification: test/storage/lsm_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/lsm_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using LSMTreeType = LSMTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** @return the keys and slot numbers of the entries of tree, in key order */
+auto ScanEntries(LSMTreeType *tree) -> std::vector<std::pair<int64_t, int64_t>> {
+  std::vector<std::pair<int64_t, int64_t>> entries;
+  for (auto iter = tree->Begin(); !iter.IsEnd(); ++iter) {
+    entries.emplace_back((*iter).first.ToString(), (*iter).second.GetSlotNum());
+  }
+  return entries;
+}
+
+TEST(LSMTreeTests, InsertRemoveTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  {
+    // a small memory table and fanout, so that the entries are spread over runs of several levels
+    LSMTreeType tree("foo_pk", bpm, comparator, HashFunction<GenericKey<8>>(), 16, 3);
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+
+    const int64_t n = 1000;
+    std::vector<int64_t> keys(n);
+    for (int64_t i = 0; i < n; i++) {
+      keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+    // every even key has a second value
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key));
+      if (key % 2 == 0) {
+        tree.Insert(index_key, RID(1, key));
+      }
+    }
+    auto level_sizes = tree.GetLevelSizes();
+    EXPECT_GT(level_sizes.size(), 2);
+    for (auto size : level_sizes) {
+      EXPECT_LT(size, 3);
+    }
+
+    for (int64_t key = 0; key < n; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids)) << key;
+      ASSERT_EQ(rids.size(), key % 2 == 0 ? 2 : 1) << key;
+    }
+    index_key.SetFromInteger(n);
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
+
+    // the tombstones of the first values of every third key, and of both values of every fifth key
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      if (key % 3 == 0) {
+        tree.Remove(index_key, RID(0, key));
+      }
+      if (key % 5 == 0) {
+        tree.Remove(index_key, RID(0, key));
+        tree.Remove(index_key, RID(1, key));
+      }
+    }
+    // a removed value comes back, newer than its tombstone
+    index_key.SetFromInteger(15);
+    tree.Insert(index_key, RID(0, 15));
+
+    std::vector<std::pair<int64_t, int64_t>> expected;
+    for (int64_t key = 0; key < n; key++) {
+      size_t count = 0;
+      if ((key % 3 != 0 && key % 5 != 0) || key == 15) {
+        expected.emplace_back(key, key);
+        count++;
+      }
+      if (key % 2 == 0 && key % 5 != 0) {
+        expected.emplace_back(key, key);
+        count++;
+      }
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_EQ(tree.GetValue(index_key, &rids), count > 0) << key;
+      ASSERT_EQ(rids.size(), count) << key;
+    }
+    EXPECT_EQ(ScanEntries(&tree), expected);
+
+    // a backward scan from the end, and a scan from a key
+    std::vector<std::pair<int64_t, int64_t>> backward;
+    auto iter = tree.End();
+    while (!iter.IsBegin()) {
+      --iter;
+      backward.emplace_back((*iter).first.ToString(), (*iter).second.GetSlotNum());
+    }
+    std::reverse(backward.begin(), backward.end());
+    EXPECT_EQ(backward, expected);
+    index_key.SetFromInteger(500);
+    auto from_key = tree.Begin(index_key);
+    ASSERT_FALSE(from_key.IsEnd());
+    EXPECT_EQ((*from_key).first.ToString(), 502);
+
+    // once every entry is removed, neither scan direction finds one
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, RID(0, key));
+      tree.Remove(index_key, RID(1, key));
+    }
+    tree.Flush();
+    EXPECT_TRUE(tree.Begin().IsEnd());
+    EXPECT_TRUE(tree.End().IsBegin());
+  }
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(LSMTreeTests, ConcurrentInsertScanTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  {
+    LSMTreeType tree("foo_pk", bpm, comparator, HashFunction<GenericKey<8>>(), 32, 3);
+
+    // writers insert and remove disjoint keys while readers look them up and scan a snapshot
+    const int64_t per_thread = 1000;
+    std::vector<std::thread> threads;
+    for (int64_t t = 0; t < 4; t++) {
+      threads.emplace_back([&, t]() {
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        for (int64_t i = 0; i < per_thread; i++) {
+          index_key.SetFromInteger(i * 4 + t);
+          tree.Insert(index_key, RID(0, i * 4 + t));
+          rids.clear();
+          EXPECT_TRUE(tree.GetValue(index_key, &rids));
+          if (i % 2 == 1) {
+            index_key.SetFromInteger((i - 1) * 4 + t);
+            tree.Remove(index_key, RID(0, (i - 1) * 4 + t));
+            rids.clear();
+            EXPECT_FALSE(tree.GetValue(index_key, &rids));
+          }
+        }
+      });
+    }
+    for (int64_t t = 0; t < 2; t++) {
+      threads.emplace_back([&]() {
+        for (int round = 0; round < 20; round++) {
+          auto entries = ScanEntries(&tree);
+          EXPECT_TRUE(std::is_sorted(entries.begin(), entries.end()));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // only the keys of odd i are left
+    std::vector<std::pair<int64_t, int64_t>> expected;
+    for (int64_t key = 0; key < per_thread * 4; key++) {
+      if ((key / 4) % 2 == 1) {
+        expected.emplace_back(key, key);
+      }
+    }
+    EXPECT_EQ(ScanEntries(&tree), expected);
+  }
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,295 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// piecewise_geometric_model_test.cpp
+//
+// Identification: test/storage/piecewise_geometric_model_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/index/piecewise_geometric_model.h"
+#include "storage/index/piecewise_geometric_model_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using PGMType = PiecewiseGeometricModel<GenericKey<8>, RID, MemcmpComparator<8>>;
+
+/** @return the normalized key of a bigint */
+auto MakeBigintKey(int64_t value, const Schema &key_schema) -> GenericKey<8> {
+  GenericKey<8> key;
+  std::vector<Value> values{ValueFactory::GetBigIntValue(value)};
+  key.SetFromKey(Tuple(values, &key_schema), key_schema);
+  return key;
+}
+
+auto KeyValue(const GenericKey<8> &key, const Schema &key_schema) -> int64_t {
+  return key.ToValues(key_schema)[0].GetAs<int64_t>();
+}
+
+/** @return the keys and slot numbers of the entries of model, in key order */
+auto ScanEntries(PGMType *model, const Schema &key_schema) -> std::vector<std::pair<int64_t, int64_t>> {
+  std::vector<std::pair<int64_t, int64_t>> entries;
+  auto snapshot = model->GetSnapshot();
+  for (size_t i = 0; i < snapshot->Size(); i++) {
+    entries.emplace_back(KeyValue(snapshot->At(i).first, key_schema), snapshot->At(i).second.GetSlotNum());
+  }
+  return entries;
+}
+
+TEST(PiecewiseGeometricModelTests, LowerBoundTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  std::mt19937_64 gen(15445);
+
+  // evenly spread keys fit a single line, keys drawn at random or in clusters need more of them
+  std::vector<std::vector<int64_t>> key_sets(3);
+  for (int64_t i = 0; i < 50000; i++) {
+    key_sets[0].push_back(i * 10);
+    key_sets[1].push_back(static_cast<int64_t>(gen() >> 1) * (i % 2 == 0 ? 1 : -1));
+    key_sets[2].push_back((i / 100) * 1000000 + (i % 100) * (i % 7 + 1));
+  }
+  for (size_t set = 0; set < key_sets.size(); set++) {
+    auto &keys = key_sets[set];
+    std::sort(keys.begin(), keys.end());
+    std::vector<std::pair<GenericKey<8>, RID>> entries;
+    for (auto key : keys) {
+      entries.emplace_back(MakeBigintKey(key, *key_schema), RID(0, 0));
+    }
+    std::shuffle(entries.begin(), entries.end(), gen);
+    PGMType model;
+    model.BulkLoad(std::move(entries));
+    auto snapshot = model.GetSnapshot();
+    ASSERT_EQ(snapshot->Size(), std::unique(keys.begin(), keys.end()) - keys.begin());
+    keys.resize(snapshot->Size());
+    if (set == 0) {
+      EXPECT_EQ(snapshot->GetSegmentCount(), 1);
+    }
+    EXPECT_LT(snapshot->GetSegmentCount(), keys.size() / 64);
+
+    // every key is found where it is, and a key that is not there lands on the next one
+    for (size_t i = 0; i < keys.size(); i++) {
+      ASSERT_EQ(snapshot->LowerBound(MakeBigintKey(keys[i], *key_schema)), i) << set;
+      if (i == 0 || keys[i - 1] != keys[i] - 1) {
+        ASSERT_EQ(snapshot->LowerBound(MakeBigintKey(keys[i] - 1, *key_schema)), i) << set;
+      }
+    }
+    EXPECT_EQ(snapshot->LowerBound(MakeBigintKey(std::numeric_limits<int64_t>::max(), *key_schema)),
+              keys.back() == std::numeric_limits<int64_t>::max() ? keys.size() - 1 : keys.size());
+  }
+}
+
+TEST(PiecewiseGeometricModelTests, InsertRemoveTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  PGMType model;
+  std::vector<RID> rids;
+
+  // more writes than are kept aside, so that some of them are merged into the snapshot and some are not
+  const int64_t n = 3000;
+  std::vector<int64_t> keys(n);
+  for (int64_t i = 0; i < n; i++) {
+    keys[i] = i * 3;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  // every even key has a second value
+  for (auto key : keys) {
+    auto index_key = MakeBigintKey(key, *key_schema);
+    EXPECT_TRUE(model.Insert(index_key, RID(0, 1)));
+    if (key % 2 == 0) {
+      EXPECT_TRUE(model.Insert(index_key, RID(0, 2)));
+    }
+    EXPECT_FALSE(model.Insert(index_key, RID(0, 1)));
+  }
+  for (int64_t i = 0; i < n; i++) {
+    rids.clear();
+    ASSERT_TRUE(model.GetValue(MakeBigintKey(i * 3, *key_schema), &rids)) << i;
+    ASSERT_EQ(rids.size(), i % 2 == 0 ? 2 : 1) << i;
+    ASSERT_FALSE(model.GetValue(MakeBigintKey(i * 3 + 1, *key_schema), &rids)) << i;
+  }
+
+  // remove the first values of every fifth key, and put some of them back
+  for (auto key : keys) {
+    if (key % 5 == 0) {
+      EXPECT_TRUE(model.Remove(MakeBigintKey(key, *key_schema), RID(0, 1)));
+      EXPECT_FALSE(model.Remove(MakeBigintKey(key, *key_schema), RID(0, 1)));
+    }
+  }
+  for (auto key : keys) {
+    if (key % 35 == 0) {
+      EXPECT_TRUE(model.Insert(MakeBigintKey(key, *key_schema), RID(0, 1)));
+    }
+  }
+  std::vector<std::pair<int64_t, int64_t>> expected;
+  for (int64_t i = 0; i < n; i++) {
+    auto key = i * 3;
+    size_t count = 0;
+    if (key % 5 != 0 || key % 35 == 0) {
+      expected.emplace_back(key, 1);
+      count++;
+    }
+    if (key % 2 == 0) {
+      expected.emplace_back(key, 2);
+      count++;
+    }
+    rids.clear();
+    ASSERT_EQ(model.GetValue(MakeBigintKey(key, *key_schema), &rids), count > 0) << key;
+    ASSERT_EQ(rids.size(), count) << key;
+  }
+  EXPECT_EQ(ScanEntries(&model, *key_schema), expected);
+
+  // a snapshot stays the same while the model changes
+  auto snapshot = model.GetSnapshot();
+  for (auto key : keys) {
+    model.Remove(MakeBigintKey(key, *key_schema), RID(0, 1));
+    model.Remove(MakeBigintKey(key, *key_schema), RID(0, 2));
+  }
+  EXPECT_EQ(snapshot->Size(), expected.size());
+  EXPECT_EQ(model.GetSnapshot()->Size(), 0);
+}
+
+TEST(PiecewiseGeometricModelTests, ConcurrentInsertScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  PGMType model;
+
+  // writers insert and remove disjoint keys while readers look them up and scan snapshots
+  const int64_t per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<RID> rids;
+      for (int64_t i = 0; i < per_thread; i++) {
+        auto index_key = MakeBigintKey(i * 4 + t, *key_schema);
+        EXPECT_TRUE(model.Insert(index_key, RID(0, i * 4 + t)));
+        rids.clear();
+        EXPECT_TRUE(model.GetValue(index_key, &rids));
+        if (i % 2 == 1) {
+          index_key = MakeBigintKey((i - 1) * 4 + t, *key_schema);
+          EXPECT_TRUE(model.Remove(index_key, RID(0, (i - 1) * 4 + t)));
+          rids.clear();
+          EXPECT_FALSE(model.GetValue(index_key, &rids));
+        }
+      }
+    });
+  }
+  for (int64_t t = 0; t < 2; t++) {
+    threads.emplace_back([&]() {
+      for (int round = 0; round < 20; round++) {
+        auto entries = ScanEntries(&model, *key_schema);
+        EXPECT_TRUE(std::is_sorted(entries.begin(), entries.end()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // only the keys of odd i are left
+  std::vector<std::pair<int64_t, int64_t>> expected;
+  for (int64_t key = 0; key < per_thread * 4; key++) {
+    if ((key / 4) % 2 == 1) {
+      expected.emplace_back(key, key);
+    }
+  }
+  EXPECT_EQ(ScanEntries(&model, *key_schema), expected);
+}
+
+TEST(PiecewiseGeometricModelTests, RangeScanTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  Transaction txn(0);
+  {
+    Catalog catalog(bpm, nullptr, nullptr);
+    Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER)});
+    auto *table_info = catalog.CreateTable(&txn, "t", schema);
+    auto insert = [&](const Value &a) {
+      RID rid;
+      std::vector<Value> values{a, ValueFactory::GetIntegerValue(0)};
+      ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+    };
+    // a = 0, 10, ..., 9990, and two NULLs
+    for (int32_t a = 0; a < 1000; a++) {
+      insert(ValueFactory::GetIntegerValue(a * 10));
+    }
+    insert(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+    insert(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+
+    auto key_schema = Schema::CopySchema(&schema, {0});
+    auto *index_info = catalog.CreateIndex<GenericKey<4>, RID, MemcmpComparator<4>>(
+        &txn, "t_a", "t", schema, key_schema, {0}, 4, HashFunction<GenericKey<4>>(), false, true, true,
+        IndexType::PiecewiseGeometricModel);
+    auto &index = index_info->index_;
+    ASSERT_TRUE(index->IsInMemory());
+    ASSERT_TRUE(index->HasRangeScans());
+
+    auto bound = [](int32_t value, bool inclusive) {
+      return std::optional<IndexBound>{IndexBound{ValueFactory::GetIntegerValue(value), inclusive}};
+    };
+    auto scan = [&](const std::optional<IndexBound> &lower, const std::optional<IndexBound> &upper) {
+      std::vector<int32_t> keys;
+      for (auto iter = index->GetRangeIterator(lower, upper, &txn); !iter->IsEnd(); iter->Next()) {
+        keys.push_back(iter->GetKey().GetValue(&key_schema, 0).GetAs<int32_t>());
+      }
+      EXPECT_EQ(keys.size(), index->CountRange(lower, upper, &txn));
+      return keys;
+    };
+    auto expect_range = [&](const std::vector<int32_t> &keys, int32_t first, int32_t last) {
+      ASSERT_EQ(keys.size(), (last - first) / 10 + 1);
+      EXPECT_EQ(keys.front(), first);
+      EXPECT_EQ(keys.back(), last);
+    };
+    expect_range(scan(bound(100, true), bound(200, true)), 100, 200);
+    expect_range(scan(bound(100, false), bound(200, false)), 110, 190);
+    expect_range(scan(bound(95, true), bound(205, false)), 100, 200);
+    expect_range(scan(std::nullopt, bound(50, true)), 0, 50);
+    expect_range(scan(bound(9900, false), std::nullopt), 9910, 9990);
+    EXPECT_TRUE(scan(bound(200, true), bound(100, true)).empty());
+    EXPECT_TRUE(scan(bound(10000, true), std::nullopt).empty());
+    EXPECT_EQ(index->CountRange(std::nullopt, std::nullopt, &txn), 1002);
+
+    // a write is seen by the next scan, and a prefix scan finds the entries of one key
+    std::vector<Value> key_values{ValueFactory::GetIntegerValue(150)};
+    index->InsertEntry(Tuple(key_values, &key_schema), RID(1, 0), &txn);
+    index->InsertEntry(Tuple(key_values, &key_schema), RID(1, 1), &txn);
+    EXPECT_EQ(scan(bound(150, true), bound(150, true)).size(), 3);
+    size_t prefix_entries = 0;
+    for (auto iter = index->GetPrefixIterator(key_values, &txn); !iter->IsEnd(); iter->Next()) {
+      prefix_entries++;
+    }
+    EXPECT_EQ(prefix_entries, 3);
+    index->DeleteEntry(Tuple(key_values, &key_schema), RID(1, 0), &txn);
+    std::vector<RID> rids;
+    index->ScanKey(Tuple(key_values, &key_schema), &rids, &txn);
+    EXPECT_EQ(rids.size(), 2);
+
+    // the NULLs come first, so the entry of rank 2 is the first non-null one
+    auto iter = index->GetRankIterator(2, &txn);
+    ASSERT_FALSE(iter->IsEnd());
+    EXPECT_EQ(iter->GetKey().GetValue(&key_schema, 0).GetAs<int32_t>(), 0);
+    EXPECT_TRUE(index->GetRankIterator(2000, &txn)->IsEnd());
+
+    // a rebuild fits the model to the table, which does not have the entries written to the index alone
+    catalog.RebuildInMemoryIndexes(&txn);
+    EXPECT_EQ(index->CountRange(std::nullopt, std::nullopt, &txn), 1002);
+  }
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_index_test.cpp
+//
+// Identification: test/storage/trie_index_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/index/trie_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** @return the key tuple of a string, NULL if it is nullptr */
+auto MakeStringKey(const char *str, const Schema &key_schema) -> Tuple {
+  std::vector<Value> values{str == nullptr ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                                           : ValueFactory::GetVarcharValue(str)};
+  return Tuple(values, &key_schema);
+}
+
+/** @return the slot numbers of the entries a scan visits */
+auto ScanSlots(IndexScanIterator *iter) -> std::vector<int64_t> {
+  std::vector<int64_t> slots;
+  for (; !iter->IsEnd(); iter->Next()) {
+    slots.push_back(iter->GetRID().GetSlotNum());
+  }
+  return slots;
+}
+
+TEST(TrieIndexTests, PrefixScanTest) {
+  Schema schema({Column("s", TypeId::VARCHAR, 16)});
+  auto key_schema = Schema::CopySchema(&schema, {0});
+  TrieIndex index(std::make_unique<IndexMetadata>("t_s", "t", &schema, std::vector<uint32_t>{0}));
+
+  // the slot of each entry is its position in key order, NULLs come first
+  std::vector<std::pair<const char *, int64_t>> entries{{"cart", 6}, {"car", 3}, {nullptr, 0},  {"c", 2},
+                                                        {"cargo", 5}, {"b", 1},  {"car", 4},    {"d", 7}};
+  for (auto [str, slot] : entries) {
+    index.InsertEntry(MakeStringKey(str, key_schema), RID(0, slot), nullptr);
+  }
+  EXPECT_EQ(ScanSlots(index.GetScanIterator(false).get()), std::vector<int64_t>({0, 1, 2, 3, 4, 5, 6, 7}));
+  std::vector<int64_t> backward;
+  for (auto iter = index.GetScanIterator(true); !iter->IsBegin();) {
+    iter->Prev();
+    backward.push_back(iter->GetRID().GetSlotNum());
+  }
+  EXPECT_EQ(backward, std::vector<int64_t>({7, 6, 5, 4, 3, 2, 1, 0}));
+
+  // a key, the keys that start with a string, and the keys of a join prefix
+  std::vector<RID> rids;
+  index.ScanKey(MakeStringKey("car", key_schema), &rids, nullptr);
+  EXPECT_EQ(rids, std::vector<RID>({RID(0, 3), RID(0, 4)}));
+  rids.clear();
+  index.ScanStringPrefix("car", &rids);
+  EXPECT_EQ(rids, std::vector<RID>({RID(0, 3), RID(0, 4), RID(0, 5), RID(0, 6)}));
+  rids.clear();
+  index.ScanStringPrefix("", &rids);
+  EXPECT_EQ(rids.size(), 7);
+  std::vector<Value> prefix{ValueFactory::GetVarcharValue("car")};
+  EXPECT_EQ(ScanSlots(index.GetPrefixIterator(prefix, nullptr).get()), std::vector<int64_t>({3, 4}));
+  auto iter = index.GetPrefixIterator(prefix, nullptr);
+  EXPECT_EQ(iter->GetKey().GetValue(&key_schema, 0).ToString(), "car");
+
+  // a key whose entries are all gone is not found anymore
+  index.DeleteEntry(MakeStringKey("car", key_schema), RID(0, 3), nullptr);
+  index.DeleteEntry(MakeStringKey("car", key_schema), RID(0, 4), nullptr);
+  rids.clear();
+  index.ScanKey(MakeStringKey("car", key_schema), &rids, nullptr);
+  EXPECT_TRUE(rids.empty());
+  EXPECT_EQ(ScanSlots(index.GetScanIterator(false).get()), std::vector<int64_t>({0, 1, 2, 5, 6, 7}));
+}
+
+TEST(TrieIndexTests, ConcurrentInsertDeleteTest) {
+  Schema schema({Column("s", TypeId::VARCHAR, 16)});
+  auto key_schema = Schema::CopySchema(&schema, {0});
+  TrieIndex index(std::make_unique<IndexMetadata>("t_s", "t", &schema, std::vector<uint32_t>{0}));
+
+  // writers add and take away entries of the same few keys, so that their lists empty and come back
+  const int64_t per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (int64_t i = 0; i < per_thread; i++) {
+        auto key = MakeStringKey(std::to_string(i % 10).c_str(), key_schema);
+        index.InsertEntry(key, RID(t, i), nullptr);
+        if (i % 2 == 1) {
+          index.DeleteEntry(MakeStringKey(std::to_string((i - 1) % 10).c_str(), key_schema), RID(t, i - 1), nullptr);
+        }
+      }
+    });
+  }
+  threads.emplace_back([&]() {
+    for (int round = 0; round < 20; round++) {
+      std::vector<RID> rids;
+      index.ScanStringPrefix("", &rids);
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // only the entries of odd i are left
+  std::vector<RID> rids;
+  index.ScanStringPrefix("", &rids);
+  EXPECT_EQ(rids.size(), per_thread * 2);
+  for (const auto &rid : rids) {
+    EXPECT_EQ(rid.GetSlotNum() % 2, 1);
+  }
+}
+
+TEST(TrieIndexTests, CatalogTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  Transaction txn(0);
+  {
+    Catalog catalog(bpm, nullptr, nullptr);
+    Schema schema({Column("a", TypeId::INTEGER), Column("s", TypeId::VARCHAR, 16)});
+    auto *table_info = catalog.CreateTable(&txn, "t", schema);
+    for (int a = 0; a < 100; a++) {
+      RID rid;
+      std::vector<Value> values{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(std::to_string(a))};
+      ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &schema), &rid, &txn));
+    }
+
+    // the index is filled from the table when it is made, and only takes a varchar column
+    auto key_schema = Schema::CopySchema(&schema, {1});
+    auto *index_info = catalog.CreateIndex<GenericKey<8>, RID, MemcmpComparator<8>>(
+        &txn, "t_s", "t", schema, key_schema, {1}, 8, HashFunction<GenericKey<8>>(), false, true, true,
+        IndexType::Trie);
+    auto *index = dynamic_cast<TrieIndex *>(index_info->index_.get());
+    ASSERT_NE(index, nullptr);
+    std::vector<RID> rids;
+    index->ScanStringPrefix("1", &rids);
+    EXPECT_EQ(rids.size(), 11);
+    auto int_key_schema = Schema::CopySchema(&schema, {0});
+    EXPECT_THROW((catalog.CreateIndex<GenericKey<8>, RID, MemcmpComparator<8>>(
+                     &txn, "t_a", "t", schema, int_key_schema, {0}, 8, HashFunction<GenericKey<8>>(), false, true,
+                     true, IndexType::Trie)),
+                 NotImplementedException);
+  }
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
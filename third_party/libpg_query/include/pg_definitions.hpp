@@ -41,7 +41,8 @@ typedef uint32_t PGOid;
 #define FUNC_MAX_ARGS 100
 #define FLEXIBLE_ARRAY_MEMBER
 
-#define DEFAULT_INDEX_TYPE "art"
+// bustub: CREATE INDEX without USING builds a b+ tree, USING art an adaptive radix tree
+#define DEFAULT_INDEX_TYPE "btree"
 #define INTERVAL_MASK(b) (1 << (b))
 
 #ifdef _MSC_VER
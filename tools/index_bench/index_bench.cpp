@@ -0,0 +1,345 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "concurrency/transaction.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/index/adaptive_radix_tree_index.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/lsm_tree_index.h"
+#include "storage/index/piecewise_geometric_model_index.h"
+#include "storage/page/b_plus_tree_key_search.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "type/value_factory.h"
+
+namespace {
+
+using bustub::GenericComparator;
+using bustub::GenericKey;
+using bustub::MemcmpComparator;
+using bustub::RID;
+
+/** Keys are spread out, so that half of the lookups miss. */
+constexpr int64_t KEY_STRIDE = 2;
+
+/**
+ * Fill one full leaf page with sorted keys and time KeyIndex on random keys.
+ * @return nanoseconds per lookup
+ */
+template <typename KeyType, typename KeyComparator, typename MakeKey>
+auto BenchLeaf(const std::string &name, KeyComparator comparator, MakeKey make_key, size_t lookups) -> double {
+  using LeafPage = bustub::BPlusTreeLeafPage<KeyType, RID, KeyComparator>;
+  std::vector<char> buf(bustub::BUSTUB_PAGE_SIZE);
+  auto *leaf = reinterpret_cast<LeafPage *>(buf.data());
+  leaf->Init(0);
+  for (int i = 0; i < leaf->GetMaxSize(); i++) {
+    leaf->SetPairAt(i, {make_key(i * KEY_STRIDE), RID(0, i)});
+  }
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int64_t> dist(0, leaf->GetSize() * KEY_STRIDE - 1);
+  std::vector<KeyType> probes;
+  probes.reserve(lookups);
+  for (size_t i = 0; i < lookups; i++) {
+    probes.push_back(make_key(dist(gen)));
+  }
+
+  int64_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &probe : probes) {
+    found += leaf->KeyIndex(probe, comparator) != -1 ? 1 : 0;
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+  fmt::print("{:<36} entries={:<4} found={:<8} {:8.2f} ns/lookup\n", name, leaf->GetSize(), found, ns);
+  return ns;
+}
+
+/** Time the scalar and the SIMD search kernels alone on the same sorted array. */
+template <typename IntType>
+void BenchKernel(const std::string &name, int size, size_t lookups) {
+  std::vector<IntType> keys(size);
+  for (int i = 0; i < size; i++) {
+    keys[i] = static_cast<IntType>(i * KEY_STRIDE);
+  }
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int64_t> dist(0, size * KEY_STRIDE - 1);
+  std::vector<IntType> probes;
+  probes.reserve(lookups);
+  for (size_t i = 0; i < lookups; i++) {
+    probes.push_back(static_cast<IntType>(dist(gen)));
+  }
+
+  auto run = [&](const std::string &kernel, auto search) {
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto probe : probes) {
+      sum += search(keys.data(), size, probe);
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto ns = std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+    fmt::print("{:<36} entries={:<4} sum={:<12} {:8.2f} ns/lookup\n", name + " " + kernel, size, sum, ns);
+  };
+  run("scalar", [](const IntType *k, int n, IntType key) { return bustub::ScalarLowerBound(k, n, key); });
+  run("simd", [](const IntType *k, int n, IntType key) { return bustub::SimdLowerBound(k, n, key); });
+}
+
+/**
+ * Insert random integer keys into an index over a buffer pool smaller than the index, then look up keys that are
+ * in it, and report insert throughput, page writes and lookup latency.
+ */
+template <typename MakeIndex>
+void BenchIndex(const std::string &name, MakeIndex make_index, size_t inserts, size_t lookups, size_t pool_size) {
+  const std::string db_file = "index_bench.db";
+  auto disk_manager = std::make_unique<bustub::DiskManager>(db_file);
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  // the b+ tree keeps its root in the header page
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  bustub::Schema schema({bustub::Column("a", bustub::TypeId::INTEGER)});
+  std::unique_ptr<bustub::Index> index =
+      make_index(std::make_unique<bustub::IndexMetadata>("bench", "t", &schema, std::vector<uint32_t>{0}), bpm.get());
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int32_t> dist(0, std::numeric_limits<int32_t>::max());
+  std::vector<bustub::Tuple> keys;
+  keys.reserve(inserts);
+  for (size_t i = 0; i < inserts; i++) {
+    std::vector<bustub::Value> values{bustub::ValueFactory::GetIntegerValue(dist(gen))};
+    keys.emplace_back(values, &schema);
+  }
+
+  bustub::Transaction txn(0);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < inserts; i++) {
+    index->InsertEntry(keys[i], RID(static_cast<int32_t>(i >> 16), static_cast<uint32_t>(i & 0xFFFF)), &txn);
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto insert_secs = std::chrono::duration<double>(end - start).count();
+  auto writes = disk_manager->GetNumWrites();
+
+  std::uniform_int_distribution<size_t> pick(0, inserts - 1);
+  std::vector<bustub::RID> rids;
+  size_t found = 0;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < lookups; i++) {
+    rids.clear();
+    index->ScanKey(keys[pick(gen)], &rids, &txn);
+    found += rids.size();
+  }
+  end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+  fmt::print("{:<36} inserts={:<8} {:10.0f} inserts/s page_writes={:<8} found={:<8} {:8.2f} ns/lookup\n", name,
+             inserts, inserts / insert_secs, writes, found, ns);
+
+  index.reset();
+  bpm.reset();
+  disk_manager->ShutDown();
+  disk_manager.reset();
+  std::remove(db_file.c_str());
+  std::remove("index_bench.log");
+}
+
+/**
+ * Load keys spread like those of the leaderboard tables (x = 10 * i) into an index over a buffer pool that holds all
+ * of it, then look up keys that are in it, and report the memory the index takes and lookup latency. The index is
+ * not written to while it is read, the case a learned index is made for.
+ * @param memory_usage the bytes the index takes, given the index and the number of pages allocated for it
+ */
+template <typename MakeIndex, typename MemoryUsage>
+void BenchStaticIndex(const std::string &name, MakeIndex make_index, MemoryUsage memory_usage, size_t keys,
+                      size_t lookups) {
+  const std::string db_file = "index_bench.db";
+  auto disk_manager = std::make_unique<bustub::DiskManager>(db_file);
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(keys / 64 + 64, disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  bustub::Schema schema({bustub::Column("a", bustub::TypeId::INTEGER)});
+  std::unique_ptr<bustub::Index> index =
+      make_index(std::make_unique<bustub::IndexMetadata>("bench", "t", &schema, std::vector<uint32_t>{0}), bpm.get());
+
+  bustub::Transaction txn(0);
+  std::vector<bustub::Tuple> key_tuples;
+  key_tuples.reserve(keys);
+  for (size_t i = 0; i < keys; i++) {
+    std::vector<bustub::Value> values{bustub::ValueFactory::GetIntegerValue(static_cast<int32_t>(i * 10))};
+    key_tuples.emplace_back(values, &schema);
+    index->InsertEntry(key_tuples.back(), RID(static_cast<int32_t>(i >> 16), static_cast<uint32_t>(i & 0xFFFF)), &txn);
+  }
+  // a scan settles the writes that an index may keep aside
+  index->GetScanIterator(false);
+  // page ids are handed out in order, the next one counts the pages the index allocated
+  bustub::page_id_t next_page_id;
+  bpm->NewPage(&next_page_id);
+  bpm->UnpinPage(next_page_id, false);
+  auto bytes = memory_usage(index.get(), static_cast<size_t>(next_page_id - header_page_id - 1));
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<size_t> pick(0, keys - 1);
+  std::vector<size_t> probes(lookups);
+  for (auto &probe : probes) {
+    probe = pick(gen);
+  }
+  std::vector<bustub::RID> rids;
+  size_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto probe : probes) {
+    rids.clear();
+    index->ScanKey(key_tuples[probe], &rids, &txn);
+    found += rids.size();
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+  fmt::print("{:<36} keys={:<8} bytes={:<10} {:6.2f} bytes/key found={:<8} {:8.2f} ns/lookup\n", name, keys, bytes,
+             static_cast<double>(bytes) / keys, found, ns);
+
+  index.reset();
+  bpm.reset();
+  disk_manager->ShutDown();
+  disk_manager.reset();
+  std::remove(db_file.c_str());
+  std::remove("index_bench.log");
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-index-bench");
+  program.add_argument("--lookups").help("number of lookups per benchmark");
+  program.add_argument("--inserts").help("number of inserts into each index");
+  program.add_argument("--pool-size").help("number of buffer pool frames under each index");
+  program.add_argument("--static-keys").help("number of keys loaded into each read-only index");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t lookups = 1000000;
+  if (program.present("--lookups")) {
+    lookups = std::stoul(program.get("--lookups"));
+  }
+  size_t inserts = 200000;
+  if (program.present("--inserts")) {
+    inserts = std::stoul(program.get("--inserts"));
+  }
+  size_t pool_size = 64;
+  if (program.present("--pool-size")) {
+    pool_size = std::stoul(program.get("--pool-size"));
+  }
+  size_t static_keys = 50000;
+  if (program.present("--static-keys")) {
+    static_keys = std::stoul(program.get("--static-keys"));
+  }
+
+#if defined(__AVX2__)
+  fmt::print("simd: avx2\n");
+#elif defined(__SSE2__)
+  fmt::print("simd: sse2 (64-bit keys need sse4.2, build with -DBUSTUB_ENABLE_AVX2=ON)\n");
+#else
+  fmt::print("simd: none, the integer leaves use the scalar search\n");
+#endif
+
+  bustub::Schema int_schema({bustub::Column("a", bustub::TypeId::INTEGER)});
+  bustub::Schema bigint_schema({bustub::Column("a", bustub::TypeId::BIGINT)});
+
+  // the pair layout compares keys through the schema, like the b+ tree tests
+  BenchLeaf<GenericKey<4>>("leaf pairs GenericComparator<4>", GenericComparator<4>(&int_schema),
+                           [](int64_t k) {
+                             GenericKey<4> key;
+                             key.SetFromInteger(k);
+                             return key;
+                           },
+                           lookups);
+  // the integer layout of normalized keys, what CREATE INDEX builds for an int column
+  BenchLeaf<GenericKey<4>>("leaf integers MemcmpComparator<4>", MemcmpComparator<4>(&int_schema),
+                           [&](int64_t k) {
+                             GenericKey<4> key;
+                             auto value = bustub::ValueFactory::GetIntegerValue(static_cast<int32_t>(k));
+                             std::vector<bustub::Value> values{value};
+                             key.SetFromKey(bustub::Tuple(values, &int_schema), int_schema);
+                             return key;
+                           },
+                           lookups);
+  BenchLeaf<GenericKey<8>>("leaf pairs GenericComparator<8>", GenericComparator<8>(&bigint_schema),
+                           [](int64_t k) {
+                             GenericKey<8> key;
+                             key.SetFromInteger(k);
+                             return key;
+                           },
+                           lookups);
+  BenchLeaf<GenericKey<8>>("leaf integers MemcmpComparator<8>", MemcmpComparator<8>(&bigint_schema),
+                           [&](int64_t k) {
+                             GenericKey<8> key;
+                             std::vector<bustub::Value> values{bustub::ValueFactory::GetBigIntValue(k)};
+                             key.SetFromKey(bustub::Tuple(values, &bigint_schema), bigint_schema);
+                             return key;
+                           },
+                           lookups);
+
+  BenchKernel<int32_t>("kernel int32", 337, lookups);
+  BenchKernel<int64_t>("kernel int64", 253, lookups);
+
+  // the index of an insert-heavy int column, as CREATE INDEX builds it by default, without the change buffer, with
+  // USING lsm and with USING art
+  using KeyType = GenericKey<4>;
+  using Comparator = MemcmpComparator<4>;
+  using BPlusTreeIndex = bustub::BPlusTreeIndex<KeyType, RID, Comparator>;
+  for (bool change_buffer : {true, false}) {
+    BenchIndex(change_buffer ? "index b+ tree" : "index b+ tree change_buffer=false",
+               [&](auto &&metadata, bustub::BufferPoolManager *bpm) -> std::unique_ptr<bustub::Index> {
+                 auto index = std::make_unique<BPlusTreeIndex>(std::move(metadata), bpm);
+                 index->EnableAdaptiveHash();
+                 if (change_buffer) {
+                   index->EnableChangeBuffer();
+                 }
+                 return index;
+               },
+               inserts, lookups, pool_size);
+  }
+  BenchIndex("index lsm tree",
+             [](auto &&metadata, bustub::BufferPoolManager *bpm) -> std::unique_ptr<bustub::Index> {
+               return std::make_unique<bustub::LSMTreeIndex<KeyType, RID, Comparator>>(
+                   std::move(metadata), bpm, bustub::HashFunction<KeyType>());
+             },
+             inserts, lookups, pool_size);
+  BenchIndex("index adaptive radix tree",
+             [](auto &&metadata, bustub::BufferPoolManager * /*bpm*/) -> std::unique_ptr<bustub::Index> {
+               return std::make_unique<bustub::AdaptiveRadixTreeIndex<KeyType, RID, Comparator>>(std::move(metadata));
+             },
+             inserts, lookups, pool_size);
+
+  // a read-only int column, in a b+ tree and in a learned index
+  BenchStaticIndex(
+      "static b+ tree",
+      [](auto &&metadata, bustub::BufferPoolManager *bpm) -> std::unique_ptr<bustub::Index> {
+        return std::make_unique<BPlusTreeIndex>(std::move(metadata), bpm);
+      },
+      [](bustub::Index * /*index*/, size_t pages) { return pages * bustub::BUSTUB_PAGE_SIZE; }, static_keys, lookups);
+  using LearnedIndex = bustub::PiecewiseGeometricModelIndex<KeyType, RID, Comparator>;
+  BenchStaticIndex(
+      "static learned index",
+      [](auto &&metadata, bustub::BufferPoolManager * /*bpm*/) -> std::unique_ptr<bustub::Index> {
+        return std::make_unique<LearnedIndex>(std::move(metadata));
+      },
+      [](bustub::Index *index, size_t /*pages*/) { return dynamic_cast<LearnedIndex *>(index)->GetMemoryUsage(); },
+      static_keys, lookups);
+  return 0;
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <fstream>
 #include <ios>
 #include <iostream>
@@ -69,10 +70,38 @@ auto ProcessExtraOptions(const std::string &sql, bustub::BustubInstance &instanc
       instance.ExecuteSql("explain " + sql, writer);
 
       if (opt == "ensure:index_scan") {
-        if (!bustub::StringUtil::Contains(result.str(), "IndexScan")) {
+        // an index-only scan scans the index too
+        if (!bustub::StringUtil::Contains(result.str(), "IndexScan") &&
+            !bustub::StringUtil::Contains(result.str(), "IndexOnlyScan")) {
           fmt::print("IndexScan not found\n");
           return false;
         }
+      } else if (opt == "ensure:index_range_scan") {
+        // the scan reads a range of the index instead of a filter over every tuple
+        auto scans = bustub::StringUtil::Split(result.str(), "IndexScan {");
+        if (std::none_of(scans.begin() + 1, scans.end(), [](const std::string &scan) {
+              return bustub::StringUtil::Contains(scan.substr(0, scan.find('}')), "lower=");
+            })) {
+          fmt::print("index scan of a range not found\n");
+          return false;
+        }
+      } else if (opt == "ensure:index_only_scan") {
+        if (!bustub::StringUtil::Contains(result.str(), "IndexOnlyScan")) {
+          fmt::print("IndexOnlyScan not found\n");
+          return false;
+        }
+      } else if (opt == "ensure:index_seek") {
+        // the scan seeks past the offset by rank instead of a limit skipping the tuples
+        if (!bustub::StringUtil::Contains(result.str(), "descending=false, offset=") &&
+            !bustub::StringUtil::Contains(result.str(), "descending=true, offset=")) {
+          fmt::print("index scan with offset not found\n");
+          return false;
+        }
+      } else if (opt == "ensure:index_count") {
+        if (!bustub::StringUtil::Contains(result.str(), "IndexCount")) {
+          fmt::print("IndexCount not found\n");
+          return false;
+        }
       } else if (opt == "ensure:topn") {
         if (!bustub::StringUtil::Contains(result.str(), "TopN")) {
           fmt::print("TopN not found\n");